@@ -0,0 +1,521 @@
+//------------------------------------------------------------------------------
+//
+// Filename: AtomicU33.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_ATOMICU33_H
+#define OMATH_ATOMICU33_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <atomic>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33.h"
+
+//------------------------------------------------------------------------------
+//
+class AtomicU33Cas
+//
+/// @name Lock Free Atomic U33 over a single word compare and swap
+///
+/// The whole value lives in one std::atomic<U33>, which the compiler maps to
+/// a 64 bit CAS (cmpxchg / cmpxchg8b, ldxr / stxr) where the target has one.
+/// Read modify write operations are CAS loops with the wrap semantics of the
+/// U33 operators.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Construction / Destruction
+    /// @{
+    explicit AtomicU33Cas(const U33& value=U33());
+    /// @}
+
+    /// @name Atomic Operations
+    /// @{
+    U33 load(std::memory_order order=std::memory_order_seq_cst) const;
+    void store(const U33& value, std::memory_order order=std::memory_order_seq_cst);
+    U33 exchange(const U33& value, std::memory_order order=std::memory_order_seq_cst);
+    bool compareExchangeWeak(U33& expected, const U33& desired,
+                             std::memory_order order=std::memory_order_seq_cst);
+    bool compareExchangeStrong(U33& expected, const U33& desired,
+                               std::memory_order order=std::memory_order_seq_cst);
+    U33 fetchAdd(const U33& value, std::memory_order order=std::memory_order_seq_cst);
+    U33 fetchSub(const U33& value, std::memory_order order=std::memory_order_seq_cst);
+    U33 fetchAdd(unsigned int value, std::memory_order order=std::memory_order_seq_cst);
+    U33 fetchSub(unsigned int value, std::memory_order order=std::memory_order_seq_cst);
+    bool isLockFree() const;
+    /// @}
+
+private:
+
+    /// @name Disabled
+    /// @{
+    AtomicU33Cas(const AtomicU33Cas&);
+    AtomicU33Cas& operator=(const AtomicU33Cas&);
+    /// @}
+
+    /// @name Variables
+    /// @{
+    std::atomic<U33> mValue;
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+class AtomicU33SeqLock
+//
+/// @name Atomic U33 for targets without a double width compare and swap
+///
+/// The two words are guarded by a sequence count. Readers never block: they
+/// retry if a writer was active. Writers take the count from even to odd
+/// with a 32 bit CAS, so they serialise against each other but never
+/// against readers. Every operation is at least acquire / release.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Construction / Destruction
+    /// @{
+    explicit AtomicU33SeqLock(const U33& value=U33());
+    /// @}
+
+    /// @name Atomic Operations
+    /// @{
+    U33 load(std::memory_order order=std::memory_order_seq_cst) const;
+    void store(const U33& value, std::memory_order order=std::memory_order_seq_cst);
+    U33 exchange(const U33& value, std::memory_order order=std::memory_order_seq_cst);
+    bool compareExchangeWeak(U33& expected, const U33& desired,
+                             std::memory_order order=std::memory_order_seq_cst);
+    bool compareExchangeStrong(U33& expected, const U33& desired,
+                               std::memory_order order=std::memory_order_seq_cst);
+    U33 fetchAdd(const U33& value, std::memory_order order=std::memory_order_seq_cst);
+    U33 fetchSub(const U33& value, std::memory_order order=std::memory_order_seq_cst);
+    U33 fetchAdd(unsigned int value, std::memory_order order=std::memory_order_seq_cst);
+    U33 fetchSub(unsigned int value, std::memory_order order=std::memory_order_seq_cst);
+    bool isLockFree() const;
+    /// @}
+
+private:
+
+    /// @name Disabled
+    /// @{
+    AtomicU33SeqLock(const AtomicU33SeqLock&);
+    AtomicU33SeqLock& operator=(const AtomicU33SeqLock&);
+    /// @}
+
+    /// @name Helpers
+    /// @{
+    unsigned int lock();
+    void unlock(unsigned int sequence, const U33& value);
+    U33 read() const;
+    static void relax();
+    /// @}
+
+    /// @name Variables
+    /// @{
+    std::atomic<unsigned int> mSequence;    ///< Odd while a writer is active
+    std::atomic<unsigned int> mUpper;
+    std::atomic<unsigned int> mLsb32;
+    /// @}
+};
+
+/// @name Atomic U33
+///
+/// The single word CAS version where 64 bit atomics are lock free, the
+/// sequence lock otherwise (or when OMATH_ATOMIC_SEQLOCK is defined).
+#if defined(OMATH_ATOMIC_SEQLOCK) || (ATOMIC_LLONG_LOCK_FREE != 2)
+typedef AtomicU33SeqLock AtomicU33;
+#else
+typedef AtomicU33Cas AtomicU33;
+#endif
+
+//==============================================================================
+// AtomicU33Cas
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+inline AtomicU33Cas::AtomicU33Cas(const U33& value)
+//
+/// @brief Constructor
+//------------------------------------------------------------------------------
+    : mValue(value)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 AtomicU33Cas::load(std::memory_order order) const
+//
+/// @brief Atomic Read
+//------------------------------------------------------------------------------
+{
+    return mValue.load(order);
+}
+
+//------------------------------------------------------------------------------
+//
+inline void AtomicU33Cas::store(const U33& value, std::memory_order order)
+//
+/// @brief Atomic Write
+//------------------------------------------------------------------------------
+{
+    mValue.store(value, order);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 AtomicU33Cas::exchange(const U33& value, std::memory_order order)
+//
+/// @brief Atomic Swap
+/// @return The previous value
+//------------------------------------------------------------------------------
+{
+    return mValue.exchange(value, order);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool AtomicU33Cas::compareExchangeWeak(U33& expected, const U33& desired,
+                                              std::memory_order order)
+//
+/// @brief Store desired if the value is expected, else load it into expected
+/// @return True when stored; may fail spuriously
+//------------------------------------------------------------------------------
+{
+    return mValue.compare_exchange_weak(expected, desired, order);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool AtomicU33Cas::compareExchangeStrong(U33& expected, const U33& desired,
+                                                std::memory_order order)
+//
+/// @brief Store desired if the value is expected, else load it into expected
+/// @return True when stored
+//------------------------------------------------------------------------------
+{
+    return mValue.compare_exchange_strong(expected, desired, order);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 AtomicU33Cas::fetchAdd(const U33& value, std::memory_order order)
+//
+/// @brief Atomic Addition (wrapping modulo 2^33)
+/// @return The previous value
+//------------------------------------------------------------------------------
+{
+    U33 previous = mValue.load(std::memory_order_relaxed);
+
+    while (!mValue.compare_exchange_weak(previous, previous + value, order, std::memory_order_relaxed))
+    {
+    }
+
+    return previous;
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 AtomicU33Cas::fetchSub(const U33& value, std::memory_order order)
+//
+/// @brief Atomic Subtraction (wrapping modulo 2^33)
+/// @return The previous value
+//------------------------------------------------------------------------------
+{
+    U33 previous = mValue.load(std::memory_order_relaxed);
+
+    while (!mValue.compare_exchange_weak(previous, previous - value, order, std::memory_order_relaxed))
+    {
+    }
+
+    return previous;
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 AtomicU33Cas::fetchAdd(unsigned int value, std::memory_order order)
+//
+/// @brief Atomic Addition of a 32 bit value
+/// @return The previous value
+//------------------------------------------------------------------------------
+{
+    return fetchAdd(U33(0, value), order);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 AtomicU33Cas::fetchSub(unsigned int value, std::memory_order order)
+//
+/// @brief Atomic Subtraction of a 32 bit value
+/// @return The previous value
+//------------------------------------------------------------------------------
+{
+    return fetchSub(U33(0, value), order);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool AtomicU33Cas::isLockFree() const
+//
+/// @brief True when the CAS is a hardware instruction rather than a lock
+//------------------------------------------------------------------------------
+{
+    return mValue.is_lock_free();
+}
+
+//==============================================================================
+// AtomicU33SeqLock
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+inline AtomicU33SeqLock::AtomicU33SeqLock(const U33& value)
+//
+/// @brief Constructor
+//------------------------------------------------------------------------------
+    : mSequence(0)
+    , mUpper(value.getUpper())
+    , mLsb32(value.getLsb32())
+{
+}
+
+//------------------------------------------------------------------------------
+//
+inline void AtomicU33SeqLock::relax()
+//
+/// @brief Spin wait hint
+//------------------------------------------------------------------------------
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_ia32_pause();
+#endif
+}
+
+//------------------------------------------------------------------------------
+//
+inline unsigned int AtomicU33SeqLock::lock()
+//
+/// @brief Take the write side, the sequence goes from even to odd
+/// @return The (odd) sequence now held
+//------------------------------------------------------------------------------
+{
+    unsigned int sequence = mSequence.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        if (!(sequence & 1) &&
+            mSequence.compare_exchange_weak(sequence, sequence + 1,
+                                            std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            break;
+        }
+
+        relax();
+        sequence = mSequence.load(std::memory_order_relaxed);
+    }
+
+    // the odd count is visible before any of the new words
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return (sequence + 1);
+}
+
+//------------------------------------------------------------------------------
+//
+inline void AtomicU33SeqLock::unlock(unsigned int sequence, const U33& value)
+//
+/// @brief Publish value and release the write side
+//------------------------------------------------------------------------------
+{
+    mUpper.store(value.getUpper(), std::memory_order_relaxed);
+    mLsb32.store(value.getLsb32(), std::memory_order_relaxed);
+    mSequence.store(sequence + 1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 AtomicU33SeqLock::read() const
+//
+/// @brief The words as seen by the writer holding the lock
+//------------------------------------------------------------------------------
+{
+    return U33(mUpper.load(std::memory_order_relaxed), mLsb32.load(std::memory_order_relaxed));
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 AtomicU33SeqLock::load(std::memory_order) const
+//
+/// @brief Atomic Read, retried until no writer overlapped it
+//------------------------------------------------------------------------------
+{
+    for (;;)
+    {
+        const unsigned int before = mSequence.load(std::memory_order_acquire);
+
+        if (!(before & 1))
+        {
+            const U33 value = read();
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (mSequence.load(std::memory_order_relaxed) == before)
+            {
+                return value;
+            }
+        }
+
+        relax();
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+inline void AtomicU33SeqLock::store(const U33& value, std::memory_order)
+//
+/// @brief Atomic Write
+//------------------------------------------------------------------------------
+{
+    unlock(lock(), value);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 AtomicU33SeqLock::exchange(const U33& value, std::memory_order)
+//
+/// @brief Atomic Swap
+/// @return The previous value
+//------------------------------------------------------------------------------
+{
+    const unsigned int sequence = lock();
+    const U33 previous = read();
+
+    unlock(sequence, value);
+
+    return previous;
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool AtomicU33SeqLock::compareExchangeWeak(U33& expected, const U33& desired,
+                                                  std::memory_order order)
+//
+/// @brief Store desired if the value is expected, else load it into expected
+/// @return True when stored
+//------------------------------------------------------------------------------
+{
+    return compareExchangeStrong(expected, desired, order);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool AtomicU33SeqLock::compareExchangeStrong(U33& expected, const U33& desired,
+                                                    std::memory_order)
+//
+/// @brief Store desired if the value is expected, else load it into expected
+/// @return True when stored
+//------------------------------------------------------------------------------
+{
+    const unsigned int sequence = lock();
+    const U33 current = read();
+    const bool match = (current == expected);
+
+    // a failed exchange still republishes the unchanged value
+    unlock(sequence, match ? desired : current);
+    expected = current;
+
+    return match;
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 AtomicU33SeqLock::fetchAdd(const U33& value, std::memory_order)
+//
+/// @brief Atomic Addition (wrapping modulo 2^33)
+/// @return The previous value
+//------------------------------------------------------------------------------
+{
+    const unsigned int sequence = lock();
+    const U33 previous = read();
+
+    unlock(sequence, previous + value);
+
+    return previous;
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 AtomicU33SeqLock::fetchSub(const U33& value, std::memory_order)
+//
+/// @brief Atomic Subtraction (wrapping modulo 2^33)
+/// @return The previous value
+//------------------------------------------------------------------------------
+{
+    const unsigned int sequence = lock();
+    const U33 previous = read();
+
+    unlock(sequence, previous - value);
+
+    return previous;
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 AtomicU33SeqLock::fetchAdd(unsigned int value, std::memory_order order)
+//
+/// @brief Atomic Addition of a 32 bit value
+/// @return The previous value
+//------------------------------------------------------------------------------
+{
+    return fetchAdd(U33(0, value), order);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 AtomicU33SeqLock::fetchSub(unsigned int value, std::memory_order order)
+//
+/// @brief Atomic Subtraction of a 32 bit value
+/// @return The previous value
+//------------------------------------------------------------------------------
+{
+    return fetchSub(U33(0, value), order);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool AtomicU33SeqLock::isLockFree() const
+//
+/// @brief Always false, writers exclude each other
+//------------------------------------------------------------------------------
+{
+    return false;
+}
+
+#endif // OMATH_ATOMICU33_H
@@ -30,82 +30,36 @@
 //------------------------------------------------------------------------------
 // System Includes
 //------------------------------------------------------------------------------
-#include <iosfwd>
+// none
 
 //------------------------------------------------------------------------------
 // Library Includes
 //------------------------------------------------------------------------------
-// none
+#include "UInt.h"
+#include "UIntHash.h"
+#include "UIntLiteral.h"
+
+/// @name 33 Bit Unsigned Integer
+///
+/// The MPEG-TS PTS / DTS width. The build picks the storage through
+/// OMATH_U33_LAYOUT: the omath_u33_layout CMake option defaults to auto,
+/// a native 64 bit word on 64 bit hosts and 32 + 1 on 32 bit ones. The
+/// original 17 / 16 split is only the header's fallback when the macro is
+/// not defined. Other wrap widths are declared the same way, e.g. UInt<42>
+/// for a full PCR.
+typedef UInt<33> U33;
 
 //------------------------------------------------------------------------------
 //
-class U33
+template <char... Digits>
+constexpr U33 operator"" _u33()
 //
-/// @name 33 Bit Unsigned Integer
+/// @brief U33 Literal, e.g. 0x1'ffff'ffff_u33 or 90'000_u33
+///
+/// Evaluated at compile time, a literal wider than 33 bits does not compile.
 //------------------------------------------------------------------------------
 {
-public:
-
-    /// @name Construction / Destruction
-    /// @{
-    explicit U33(unsigned int lsb32);
-    U33(unsigned int msb=0, unsigned int lsb32=0);
-    U33(const U33& ref);
-    ~U33();
-    /// @}
-
-    /// @name Addition / Subtraction Methods
-    /// @{
-    U33 operator+(unsigned int val) const;
-    U33 operator-(unsigned int val) const;
-    U33 operator+(int val) const;
-    U33 operator-(int val) const;
-    U33 operator+(const U33& ref) const;
-    U33 operator-(const U33& ref) const;
-    /// @}
-
-    /// @name Assignment Operator
-    /// @{
-    const U33& operator=(const U33& ref);
-    /// @}
-
-    /// @name Addition / Subtraction Changer Methods
-    /// @{
-    const U33& operator+=(const U33& ref);
-    const U33& operator-=(const U33& ref);
-    /// @}
-
-    /// @name Equality / Inequality Methods
-    /// @{
-    bool operator==(const U33& ref) const;
-    bool operator!=(const U33& ref) const;
-    bool operator< (const U33& ref) const;
-    bool operator<=(const U33& ref) const;
-    bool operator> (const U33& ref) const;
-    bool operator>=(const U33& ref) const;
-    /// @}
-
-    /// @name Getters
-    /// @{
-    void getRaw(unsigned int& msb17, unsigned int& lsb16) const;
-    bool getMsb() const;
-    bool getLsb() const;
-    unsigned int getMsb32() const;
-    unsigned int getLsb32() const;
-    /// @}
-
-    /// @name Stream Operator
-    /// @{
-    friend std::ostream& operator<<(std::ostream& stream, const U33& value);
-    /// @}
-
-private:
-
-    /// @name Variables
-    /// @{
-    unsigned int mMsb17;    ///< The 17 most significant bits
-    unsigned int mLsb16;    ///< The 16 least significant bits
-    /// @}
-};
+    return UIntLiteral<33>::parse<Digits...>();
+}
 
 #endif // OMATH_U33_H
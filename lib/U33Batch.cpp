@@ -0,0 +1,936 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Batch.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define OMATH_BATCH_X86
+#include <immintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33Batch.h"
+#include "U33Lanes.h"
+
+/// @name Constants
+/// @{
+
+/// The kernels work directly on the words of each value, either the 17 / 16
+/// split or one native 64 bit word
+static const bool SPLIT16_LAYOUT = std::is_same<U33::LayoutType, UIntSplit16Layout<33> >::value &&
+                                   (sizeof(U33) == (2 * sizeof(unsigned int)));
+static const bool NATIVE64_LAYOUT = std::is_same<U33::LayoutType, UIntNative64Layout<33> >::value &&
+                                    (sizeof(U33) == (2 * sizeof(unsigned int)));
+static const unsigned int MASK_17BIT(0x1ffff);
+static const unsigned int MASK_16BIT(0xffff);
+static const unsigned int MASK_32BIT(0xffffffff);
+
+/// Lane shifts moving the sign of a difference / bit 32 of a value into the
+/// lane sign bit
+static const int LESS_SHIFT   = NATIVE64_LAYOUT ? 0 : 32;
+static const int SERIAL_SHIFT = NATIVE64_LAYOUT ? 31 : 47;
+
+/// 2^32 as lane words, the distance that is neither before nor after
+static const unsigned int HALF_LOW  = NATIVE64_LAYOUT ? 0 : 0x10000;
+static const unsigned int HALF_HIGH = NATIVE64_LAYOUT ? 1 : 0;
+/// @}
+
+/// @name Types
+/// @{
+typedef std::size_t (*ArithKernel)(const char* lhs, const char* rhs,
+                                   char* out, std::size_t count);
+typedef std::size_t (*CompareKernel)(const char* lhs, const char* rhs,
+                                     bool* out, std::size_t count);
+
+struct ArithKernels
+{
+    ArithKernel mSse2;
+    ArithKernel mAvx2;
+};
+
+struct CompareKernels
+{
+    CompareKernel mSse2;
+    CompareKernel mAvx2;
+};
+/// @}
+
+/// @name Variables
+/// @{
+static std::atomic<int> sIsa(-1);   ///< The selected Isa, -1 until first use
+/// @}
+
+static_assert(sizeof(bool) == 1, "compare kernels store one byte per result");
+
+#if defined(OMATH_BATCH_X86)
+
+//==============================================================================
+// SSE2 Kernels
+//
+// Each 64 bit lane holds one value. In the 17 / 16 split msb17 is the low
+// dword and lsb16 the high dword, so the carry / borrow out of lsb16 is moved
+// into the msb17 dword with a single 64 bit lane shift. A native 64 bit word
+// is already a lane and only needs masking.
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("sse2")))
+__m128i maskSse2()
+//
+/// @brief The lane words of the largest value
+//------------------------------------------------------------------------------
+{
+    return NATIVE64_LAYOUT ? _mm_set_epi32(1, MASK_32BIT, 1, MASK_32BIT)
+                           : _mm_set_epi32(MASK_16BIT, MASK_17BIT, MASK_16BIT, MASK_17BIT);
+}
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("sse2")))
+__m128i sumLanesSse2(__m128i lhs, __m128i rhs, __m128i mask)
+//
+/// @brief Two U33 additions
+//------------------------------------------------------------------------------
+{
+    if (NATIVE64_LAYOUT)
+    {
+        return _mm_and_si128(_mm_add_epi64(lhs, rhs), mask);
+    }
+
+    // add both halves, then move bit 16 of lsb16 into msb17
+    __m128i sum = _mm_add_epi32(lhs, rhs);
+    sum = _mm_add_epi32(sum, _mm_srli_epi64(sum, 48));
+
+    return _mm_and_si128(sum, mask);
+}
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("sse2")))
+__m128i diffLanesSse2(__m128i lhs, __m128i rhs)
+//
+/// @brief Two unmasked U33 subtractions, negative when lhs < rhs
+//------------------------------------------------------------------------------
+{
+    if (NATIVE64_LAYOUT)
+    {
+        return _mm_sub_epi64(lhs, rhs);
+    }
+
+    // deduct both halves, then take the borrow (bit 31 of lsb16) from msb17
+    __m128i diff = _mm_sub_epi32(lhs, rhs);
+
+    return _mm_sub_epi32(diff, _mm_srli_epi64(diff, 63));
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Broadcast>
+static __attribute__((target("sse2")))
+__m128i loadSse2(const char* values, std::size_t block, __m128i fixed)
+//
+/// @brief Load block of two values, or the broadcast scalar operand
+//------------------------------------------------------------------------------
+{
+    return Broadcast ? fixed
+                     : _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + (sizeof(__m128i) * block)));
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Broadcast>
+static __attribute__((target("sse2")))
+__m128i fixedSse2(const char* values)
+//
+/// @brief Broadcast the scalar operand to both lanes
+//------------------------------------------------------------------------------
+{
+    if (!Broadcast)
+    {
+        return _mm_setzero_si128();
+    }
+
+    const int low  = static_cast<int>(U33Lanes::getWord(values, 0));
+    const int high = static_cast<int>(U33Lanes::getWord(values, 1));
+
+    return _mm_set_epi32(high, low, high, low);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Broadcast>
+static __attribute__((target("sse2")))
+std::size_t addSse2(const char* lhs, const char* rhs,
+                    char* out, std::size_t count)
+//
+/// @brief Addition, two values at a time
+/// @return The number of values processed
+//------------------------------------------------------------------------------
+{
+    const __m128i mask  = maskSse2();
+    const __m128i fixed = fixedSse2<Broadcast>(rhs);
+    const std::size_t blocks = count / 2;
+
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        const __m128i a = loadSse2<false>(lhs, i, fixed);
+        const __m128i b = loadSse2<Broadcast>(rhs, i, fixed);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (sizeof(__m128i) * i)), sumLanesSse2(a, b, mask));
+    }
+
+    return (blocks * 2);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Broadcast>
+static __attribute__((target("sse2")))
+std::size_t subSse2(const char* lhs, const char* rhs,
+                    char* out, std::size_t count)
+//
+/// @brief Subtraction, two values at a time
+/// @return The number of values processed
+//------------------------------------------------------------------------------
+{
+    const __m128i mask  = maskSse2();
+    const __m128i fixed = fixedSse2<Broadcast>(rhs);
+    const std::size_t blocks = count / 2;
+
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        const __m128i a = loadSse2<false>(lhs, i, fixed);
+        const __m128i b = loadSse2<Broadcast>(rhs, i, fixed);
+
+        const __m128i diff = _mm_and_si128(diffLanesSse2(a, b), mask);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (sizeof(__m128i) * i)), diff);
+    }
+
+    return (blocks * 2);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Broadcast>
+static __attribute__((target("sse2")))
+std::size_t equalSse2(const char* lhs, const char* rhs,
+                      bool* out, std::size_t count)
+//
+/// @brief Equality, two values at a time
+/// @return The number of values processed
+//------------------------------------------------------------------------------
+{
+    const __m128i fixed = fixedSse2<Broadcast>(rhs);
+    const std::size_t blocks = count / 2;
+
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        const __m128i a = loadSse2<false>(lhs, i, fixed);
+        const __m128i b = loadSse2<Broadcast>(rhs, i, fixed);
+
+        // both dwords of a lane must match
+        const int bits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)));
+
+        out[(2 * i) + 0] = ((bits & 0x3) == 0x3);
+        out[(2 * i) + 1] = ((bits & 0xc) == 0xc);
+    }
+
+    return (blocks * 2);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Broadcast>
+static __attribute__((target("sse2")))
+std::size_t lessSse2(const char* lhs, const char* rhs,
+                     bool* out, std::size_t count)
+//
+/// @brief Less than, two values at a time
+/// @return The number of values processed
+//------------------------------------------------------------------------------
+{
+    const __m128i fixed = fixedSse2<Broadcast>(rhs);
+    const std::size_t blocks = count / 2;
+
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        const __m128i a = loadSse2<false>(lhs, i, fixed);
+        const __m128i b = loadSse2<Broadcast>(rhs, i, fixed);
+
+        // unmasked, the difference goes negative when lhs < rhs
+        const __m128i diff = diffLanesSse2(a, b);
+
+        // move its sign into the lane sign bit
+        const int bits = _mm_movemask_pd(_mm_castsi128_pd(_mm_slli_epi64(diff, LESS_SHIFT)));
+
+        out[(2 * i) + 0] = ((bits & 0x1) != 0);
+        out[(2 * i) + 1] = ((bits & 0x2) != 0);
+    }
+
+    return (blocks * 2);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Broadcast, bool After>
+static __attribute__((target("sse2")))
+std::size_t serialSse2(const char* lhs, const char* rhs,
+                       bool* out, std::size_t count)
+//
+/// @brief Wrap aware before / after, two values at a time
+/// @return The number of values processed
+//------------------------------------------------------------------------------
+{
+    const __m128i mask    = maskSse2();
+    const __m128i special = After ? _mm_setzero_si128()
+                                  : _mm_set_epi32(HALF_HIGH, HALF_LOW, HALF_HIGH, HALF_LOW);
+    const __m128i fixed   = fixedSse2<Broadcast>(rhs);
+    const std::size_t blocks = count / 2;
+
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        const __m128i a = loadSse2<false>(lhs, i, fixed);
+        const __m128i b = loadSse2<Broadcast>(rhs, i, fixed);
+
+        // lhs - rhs, as the subtraction kernel
+        const __m128i diff = _mm_and_si128(diffLanesSse2(a, b), mask);
+
+        // after when bit 32 is clear, before when set, excluding 0 / 2^32
+        const int sign = _mm_movemask_pd(_mm_castsi128_pd(_mm_slli_epi64(diff, SERIAL_SHIFT)));
+        const int same = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(diff, special)));
+
+        out[(2 * i) + 0] = (((sign & 0x1) != 0) != After) && ((same & 0x3) != 0x3);
+        out[(2 * i) + 1] = (((sign & 0x2) != 0) != After) && ((same & 0xc) != 0xc);
+    }
+
+    return (blocks * 2);
+}
+
+//==============================================================================
+// AVX2 Kernels
+//
+// The same lane arithmetic as the SSE2 kernels over four values at a time.
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("avx2")))
+__m256i maskAvx2()
+//
+/// @brief The lane words of the largest value
+//------------------------------------------------------------------------------
+{
+    return NATIVE64_LAYOUT ? _mm256_set_epi32(1, MASK_32BIT, 1, MASK_32BIT, 1, MASK_32BIT, 1, MASK_32BIT)
+                           : _mm256_set_epi32(MASK_16BIT, MASK_17BIT, MASK_16BIT, MASK_17BIT,
+                                              MASK_16BIT, MASK_17BIT, MASK_16BIT, MASK_17BIT);
+}
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("avx2")))
+__m256i sumLanesAvx2(__m256i lhs, __m256i rhs, __m256i mask)
+//
+/// @brief Four U33 additions
+//------------------------------------------------------------------------------
+{
+    if (NATIVE64_LAYOUT)
+    {
+        return _mm256_and_si256(_mm256_add_epi64(lhs, rhs), mask);
+    }
+
+    __m256i sum = _mm256_add_epi32(lhs, rhs);
+    sum = _mm256_add_epi32(sum, _mm256_srli_epi64(sum, 48));
+
+    return _mm256_and_si256(sum, mask);
+}
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("avx2")))
+__m256i diffLanesAvx2(__m256i lhs, __m256i rhs)
+//
+/// @brief Four unmasked U33 subtractions, negative when lhs < rhs
+//------------------------------------------------------------------------------
+{
+    if (NATIVE64_LAYOUT)
+    {
+        return _mm256_sub_epi64(lhs, rhs);
+    }
+
+    __m256i diff = _mm256_sub_epi32(lhs, rhs);
+
+    return _mm256_sub_epi32(diff, _mm256_srli_epi64(diff, 63));
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Broadcast>
+static __attribute__((target("avx2")))
+__m256i loadAvx2(const char* values, std::size_t block, __m256i fixed)
+//
+/// @brief Load block of four values, or the broadcast scalar operand
+//------------------------------------------------------------------------------
+{
+    return Broadcast ? fixed
+                     : _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + (sizeof(__m256i) * block)));
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Broadcast>
+static __attribute__((target("avx2")))
+__m256i fixedAvx2(const char* values)
+//
+/// @brief Broadcast the scalar operand to every lane
+//------------------------------------------------------------------------------
+{
+    if (!Broadcast)
+    {
+        return _mm256_setzero_si256();
+    }
+
+    const int low  = static_cast<int>(U33Lanes::getWord(values, 0));
+    const int high = static_cast<int>(U33Lanes::getWord(values, 1));
+
+    return _mm256_set_epi32(high, low, high, low, high, low, high, low);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Broadcast>
+static __attribute__((target("avx2")))
+std::size_t addAvx2(const char* lhs, const char* rhs,
+                    char* out, std::size_t count)
+//
+/// @brief Addition, four values at a time
+/// @return The number of values processed
+//------------------------------------------------------------------------------
+{
+    const __m256i mask  = maskAvx2();
+    const __m256i fixed = fixedAvx2<Broadcast>(rhs);
+    const std::size_t blocks = count / 4;
+
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        const __m256i a = loadAvx2<false>(lhs, i, fixed);
+        const __m256i b = loadAvx2<Broadcast>(rhs, i, fixed);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + (sizeof(__m256i) * i)), sumLanesAvx2(a, b, mask));
+    }
+
+    return (blocks * 4);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Broadcast>
+static __attribute__((target("avx2")))
+std::size_t subAvx2(const char* lhs, const char* rhs,
+                    char* out, std::size_t count)
+//
+/// @brief Subtraction, four values at a time
+/// @return The number of values processed
+//------------------------------------------------------------------------------
+{
+    const __m256i mask  = maskAvx2();
+    const __m256i fixed = fixedAvx2<Broadcast>(rhs);
+    const std::size_t blocks = count / 4;
+
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        const __m256i a = loadAvx2<false>(lhs, i, fixed);
+        const __m256i b = loadAvx2<Broadcast>(rhs, i, fixed);
+
+        const __m256i diff = _mm256_and_si256(diffLanesAvx2(a, b), mask);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + (sizeof(__m256i) * i)), diff);
+    }
+
+    return (blocks * 4);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Broadcast>
+static __attribute__((target("avx2")))
+std::size_t equalAvx2(const char* lhs, const char* rhs,
+                      bool* out, std::size_t count)
+//
+/// @brief Equality, four values at a time
+/// @return The number of values processed
+//------------------------------------------------------------------------------
+{
+    const __m256i fixed = fixedAvx2<Broadcast>(rhs);
+    const std::size_t blocks = count / 4;
+
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        const __m256i a = loadAvx2<false>(lhs, i, fixed);
+        const __m256i b = loadAvx2<Broadcast>(rhs, i, fixed);
+
+        const int bits = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)));
+
+        out[(4 * i) + 0] = ((bits & 0x1) != 0);
+        out[(4 * i) + 1] = ((bits & 0x2) != 0);
+        out[(4 * i) + 2] = ((bits & 0x4) != 0);
+        out[(4 * i) + 3] = ((bits & 0x8) != 0);
+    }
+
+    return (blocks * 4);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Broadcast>
+static __attribute__((target("avx2")))
+std::size_t lessAvx2(const char* lhs, const char* rhs,
+                     bool* out, std::size_t count)
+//
+/// @brief Less than, four values at a time
+/// @return The number of values processed
+//------------------------------------------------------------------------------
+{
+    const __m256i fixed = fixedAvx2<Broadcast>(rhs);
+    const std::size_t blocks = count / 4;
+
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        const __m256i a = loadAvx2<false>(lhs, i, fixed);
+        const __m256i b = loadAvx2<Broadcast>(rhs, i, fixed);
+
+        const __m256i diff = diffLanesAvx2(a, b);
+
+        const int bits = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_slli_epi64(diff, LESS_SHIFT)));
+
+        out[(4 * i) + 0] = ((bits & 0x1) != 0);
+        out[(4 * i) + 1] = ((bits & 0x2) != 0);
+        out[(4 * i) + 2] = ((bits & 0x4) != 0);
+        out[(4 * i) + 3] = ((bits & 0x8) != 0);
+    }
+
+    return (blocks * 4);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Broadcast, bool After>
+static __attribute__((target("avx2")))
+std::size_t serialAvx2(const char* lhs, const char* rhs,
+                       bool* out, std::size_t count)
+//
+/// @brief Wrap aware before / after, four values at a time
+/// @return The number of values processed
+//------------------------------------------------------------------------------
+{
+    const __m256i mask    = maskAvx2();
+    const __m256i special = After ? _mm256_setzero_si256()
+                                  : _mm256_set_epi32(HALF_HIGH, HALF_LOW, HALF_HIGH, HALF_LOW,
+                                                     HALF_HIGH, HALF_LOW, HALF_HIGH, HALF_LOW);
+    const __m256i fixed   = fixedAvx2<Broadcast>(rhs);
+    const std::size_t blocks = count / 4;
+
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        const __m256i a = loadAvx2<false>(lhs, i, fixed);
+        const __m256i b = loadAvx2<Broadcast>(rhs, i, fixed);
+
+        const __m256i diff = _mm256_and_si256(diffLanesAvx2(a, b), mask);
+
+        const int sign = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_slli_epi64(diff, SERIAL_SHIFT)));
+        const int same = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(diff, special)));
+        const int hit  = (After ? ~sign : sign) & ~same;
+
+        out[(4 * i) + 0] = ((hit & 0x1) != 0);
+        out[(4 * i) + 1] = ((hit & 0x2) != 0);
+        out[(4 * i) + 2] = ((hit & 0x4) != 0);
+        out[(4 * i) + 3] = ((hit & 0x8) != 0);
+    }
+
+    return (blocks * 4);
+}
+
+/// @name Kernel Tables
+/// @{
+static const ArithKernels   ADD_KERNELS           = { addSse2<false>,           addAvx2<false>           };
+static const ArithKernels   SUB_KERNELS           = { subSse2<false>,           subAvx2<false>           };
+static const ArithKernels   ADD_SCALAR_KERNELS    = { addSse2<true>,            addAvx2<true>            };
+static const ArithKernels   SUB_SCALAR_KERNELS    = { subSse2<true>,            subAvx2<true>            };
+static const CompareKernels EQUAL_KERNELS         = { equalSse2<false>,         equalAvx2<false>         };
+static const CompareKernels LESS_KERNELS          = { lessSse2<false>,          lessAvx2<false>          };
+static const CompareKernels EQUAL_SCALAR_KERNELS  = { equalSse2<true>,          equalAvx2<true>          };
+static const CompareKernels LESS_SCALAR_KERNELS   = { lessSse2<true>,           lessAvx2<true>           };
+static const CompareKernels BEFORE_KERNELS        = { serialSse2<false, false>, serialAvx2<false, false> };
+static const CompareKernels AFTER_KERNELS         = { serialSse2<false, true>,  serialAvx2<false, true>  };
+static const CompareKernels BEFORE_SCALAR_KERNELS = { serialSse2<true, false>,  serialAvx2<true, false>  };
+static const CompareKernels AFTER_SCALAR_KERNELS  = { serialSse2<true, true>,   serialAvx2<true, true>   };
+/// @}
+
+#else
+
+/// @name Kernel Tables
+/// @{
+static const ArithKernels   ADD_KERNELS           = { 0, 0 };
+static const ArithKernels   SUB_KERNELS           = { 0, 0 };
+static const ArithKernels   ADD_SCALAR_KERNELS    = { 0, 0 };
+static const ArithKernels   SUB_SCALAR_KERNELS    = { 0, 0 };
+static const CompareKernels EQUAL_KERNELS         = { 0, 0 };
+static const CompareKernels LESS_KERNELS          = { 0, 0 };
+static const CompareKernels EQUAL_SCALAR_KERNELS  = { 0, 0 };
+static const CompareKernels LESS_SCALAR_KERNELS   = { 0, 0 };
+static const CompareKernels BEFORE_KERNELS        = { 0, 0 };
+static const CompareKernels AFTER_KERNELS         = { 0, 0 };
+static const CompareKernels BEFORE_SCALAR_KERNELS = { 0, 0 };
+static const CompareKernels AFTER_SCALAR_KERNELS  = { 0, 0 };
+/// @}
+
+#endif // OMATH_BATCH_X86
+
+//------------------------------------------------------------------------------
+//
+static std::size_t run(const ArithKernels& kernels,
+                       const U33* lhs, const U33* rhs,
+                       U33* out, std::size_t count)
+//
+/// @brief Run the selected arithmetic kernel
+/// @return The number of values processed, the caller finishes the rest
+//------------------------------------------------------------------------------
+{
+    const char* left  = U33Lanes::bytes(lhs);
+    const char* right = U33Lanes::bytes(rhs);
+    char* result      = U33Lanes::bytes(out);
+
+    switch (U33Batch::getIsa())
+    {
+        case U33Batch::ISA_AVX2: return kernels.mAvx2(left, right, result, count);
+        case U33Batch::ISA_SSE2: return kernels.mSse2(left, right, result, count);
+        default:                 return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+static std::size_t run(const CompareKernels& kernels,
+                       const U33* lhs, const U33* rhs,
+                       bool* out, std::size_t count)
+//
+/// @brief Run the selected comparison kernel
+/// @return The number of values processed, the caller finishes the rest
+//------------------------------------------------------------------------------
+{
+    const char* left  = U33Lanes::bytes(lhs);
+    const char* right = U33Lanes::bytes(rhs);
+
+    switch (U33Batch::getIsa())
+    {
+        case U33Batch::ISA_AVX2: return kernels.mAvx2(left, right, out, count);
+        case U33Batch::ISA_SSE2: return kernels.mSse2(left, right, out, count);
+        default:                 return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+U33Batch::Isa U33Batch::getIsa()
+//
+/// @brief The instruction set used by the batch operations
+//------------------------------------------------------------------------------
+{
+    int isa = sIsa.load(std::memory_order_relaxed);
+
+    if (isa < 0)
+    {
+        isa = getBestIsa();
+        sIsa.store(isa, std::memory_order_relaxed);
+    }
+
+    return static_cast<Isa>(isa);
+}
+
+//------------------------------------------------------------------------------
+//
+U33Batch::Isa U33Batch::getBestIsa()
+//
+/// @brief The widest instruction set supported by this CPU and build
+//------------------------------------------------------------------------------
+{
+#if defined(OMATH_BATCH_X86)
+    if (SPLIT16_LAYOUT || NATIVE64_LAYOUT)
+    {
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return ISA_AVX2;
+        }
+
+        if (__builtin_cpu_supports("sse2"))
+        {
+            return ISA_SSE2;
+        }
+    }
+#endif
+
+    return ISA_SCALAR;
+}
+
+//------------------------------------------------------------------------------
+//
+U33Batch::Isa U33Batch::setIsa(Isa isa)
+//
+/// @brief Force an instruction set, e.g. to compare kernels in tests
+/// @return The instruction set actually selected (never above getBestIsa)
+//------------------------------------------------------------------------------
+{
+    const Isa best = getBestIsa();
+
+    if (isa > best)
+    {
+        isa = best;
+    }
+
+    sIsa.store(isa, std::memory_order_relaxed);
+
+    return isa;
+}
+
+//------------------------------------------------------------------------------
+//
+const char* U33Batch::getIsaName(Isa isa)
+//
+/// @brief Printable instruction set name
+//------------------------------------------------------------------------------
+{
+    switch (isa)
+    {
+        case ISA_AVX2: return "avx2";
+        case ISA_SSE2: return "sse2";
+        default:       return "scalar";
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Batch::add(const U33* lhs, const U33* rhs, U33* out, std::size_t count)
+//
+/// @brief out[i] = lhs[i] + rhs[i]
+//------------------------------------------------------------------------------
+{
+    for (std::size_t i = run(ADD_KERNELS, lhs, rhs, out, count); i < count; ++i)
+    {
+        out[i] = lhs[i] + rhs[i];
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Batch::sub(const U33* lhs, const U33* rhs, U33* out, std::size_t count)
+//
+/// @brief out[i] = lhs[i] - rhs[i]
+//------------------------------------------------------------------------------
+{
+    for (std::size_t i = run(SUB_KERNELS, lhs, rhs, out, count); i < count; ++i)
+    {
+        out[i] = lhs[i] - rhs[i];
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Batch::add(const U33* lhs, const U33& rhs, U33* out, std::size_t count)
+//
+/// @brief out[i] = lhs[i] + rhs
+//------------------------------------------------------------------------------
+{
+    const U33 value(rhs);
+
+    for (std::size_t i = run(ADD_SCALAR_KERNELS, lhs, &value, out, count); i < count; ++i)
+    {
+        out[i] = lhs[i] + value;
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Batch::sub(const U33* lhs, const U33& rhs, U33* out, std::size_t count)
+//
+/// @brief out[i] = lhs[i] - rhs
+//------------------------------------------------------------------------------
+{
+    const U33 value(rhs);
+
+    for (std::size_t i = run(SUB_SCALAR_KERNELS, lhs, &value, out, count); i < count; ++i)
+    {
+        out[i] = lhs[i] - value;
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Batch::equal(const U33* lhs, const U33* rhs, bool* out, std::size_t count)
+//
+/// @brief out[i] = (lhs[i] == rhs[i])
+//------------------------------------------------------------------------------
+{
+    for (std::size_t i = run(EQUAL_KERNELS, lhs, rhs, out, count); i < count; ++i)
+    {
+        out[i] = (lhs[i] == rhs[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Batch::less(const U33* lhs, const U33* rhs, bool* out, std::size_t count)
+//
+/// @brief out[i] = (lhs[i] < rhs[i])
+//------------------------------------------------------------------------------
+{
+    for (std::size_t i = run(LESS_KERNELS, lhs, rhs, out, count); i < count; ++i)
+    {
+        out[i] = (lhs[i] < rhs[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Batch::equal(const U33* lhs, const U33& rhs, bool* out, std::size_t count)
+//
+/// @brief out[i] = (lhs[i] == rhs)
+//------------------------------------------------------------------------------
+{
+    const U33 value(rhs);
+
+    for (std::size_t i = run(EQUAL_SCALAR_KERNELS, lhs, &value, out, count); i < count; ++i)
+    {
+        out[i] = (lhs[i] == value);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Batch::less(const U33* lhs, const U33& rhs, bool* out, std::size_t count)
+//
+/// @brief out[i] = (lhs[i] < rhs)
+//------------------------------------------------------------------------------
+{
+    const U33 value(rhs);
+
+    for (std::size_t i = run(LESS_SCALAR_KERNELS, lhs, &value, out, count); i < count; ++i)
+    {
+        out[i] = (lhs[i] < value);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Batch::isBefore(const U33* lhs, const U33* rhs, bool* out, std::size_t count)
+//
+/// @brief out[i] = lhs[i].isBefore(rhs[i])
+//------------------------------------------------------------------------------
+{
+    for (std::size_t i = run(BEFORE_KERNELS, lhs, rhs, out, count); i < count; ++i)
+    {
+        out[i] = lhs[i].isBefore(rhs[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Batch::isAfter(const U33* lhs, const U33* rhs, bool* out, std::size_t count)
+//
+/// @brief out[i] = lhs[i].isAfter(rhs[i])
+//------------------------------------------------------------------------------
+{
+    for (std::size_t i = run(AFTER_KERNELS, lhs, rhs, out, count); i < count; ++i)
+    {
+        out[i] = lhs[i].isAfter(rhs[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Batch::isBefore(const U33* lhs, const U33& rhs, bool* out, std::size_t count)
+//
+/// @brief out[i] = lhs[i].isBefore(rhs)
+//------------------------------------------------------------------------------
+{
+    const U33 value(rhs);
+
+    for (std::size_t i = run(BEFORE_SCALAR_KERNELS, lhs, &value, out, count); i < count; ++i)
+    {
+        out[i] = lhs[i].isBefore(value);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Batch::isAfter(const U33* lhs, const U33& rhs, bool* out, std::size_t count)
+//
+/// @brief out[i] = lhs[i].isAfter(rhs)
+//------------------------------------------------------------------------------
+{
+    const U33 value(rhs);
+
+    for (std::size_t i = run(AFTER_SCALAR_KERNELS, lhs, &value, out, count); i < count; ++i)
+    {
+        out[i] = lhs[i].isAfter(value);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Batch::distance(const U33* lhs, const U33* rhs, int* out, std::size_t count)
+//
+/// @brief out[i] = lhs[i].distanceTo(rhs[i])
+//------------------------------------------------------------------------------
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        out[i] = lhs[i].distanceTo(rhs[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Batch::distance(const U33* lhs, const U33& rhs, int* out, std::size_t count)
+//
+/// @brief out[i] = lhs[i].distanceTo(rhs)
+//------------------------------------------------------------------------------
+{
+    const U33 value(rhs);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        out[i] = lhs[i].distanceTo(value);
+    }
+}
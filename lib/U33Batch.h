@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Batch.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_U33BATCH_H
+#define OMATH_U33BATCH_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <cstddef>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33.h"
+
+//------------------------------------------------------------------------------
+//
+class U33Batch
+//
+/// @name Array Operations over U33
+///
+/// Element wise versions of the U33 operators over whole arrays. Each call
+/// runs the widest kernel the CPU supports (picked once at run time) and
+/// finishes any tail with the scalar operators, so the results are bit
+/// identical to a loop over U33. Outputs may alias an input exactly but must
+/// not partially overlap one.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Instruction Sets
+    /// @{
+    enum Isa
+    {
+        ISA_SCALAR,             ///< Plain U33 operators, always available
+        ISA_SSE2,               ///< 2 values per 128 bit vector
+        ISA_AVX2                ///< 4 values per 256 bit vector
+    };
+    /// @}
+
+    /// @name Dispatch
+    /// @{
+    static Isa getIsa();
+    static Isa getBestIsa();
+    static Isa setIsa(Isa isa);
+    static const char* getIsaName(Isa isa);
+    /// @}
+
+    /// @name Addition / Subtraction
+    /// @{
+    static void add(const U33* lhs, const U33* rhs, U33* out, std::size_t count);
+    static void sub(const U33* lhs, const U33* rhs, U33* out, std::size_t count);
+    static void add(const U33* lhs, const U33& rhs, U33* out, std::size_t count);
+    static void sub(const U33* lhs, const U33& rhs, U33* out, std::size_t count);
+    /// @}
+
+    /// @name Comparison
+    /// @{
+    static void equal(const U33* lhs, const U33* rhs, bool* out, std::size_t count);
+    static void less(const U33* lhs, const U33* rhs, bool* out, std::size_t count);
+    static void equal(const U33* lhs, const U33& rhs, bool* out, std::size_t count);
+    static void less(const U33* lhs, const U33& rhs, bool* out, std::size_t count);
+    /// @}
+
+    /// @name Serial Number Comparison
+    /// @{
+    static void isBefore(const U33* lhs, const U33* rhs, bool* out, std::size_t count);
+    static void isAfter(const U33* lhs, const U33* rhs, bool* out, std::size_t count);
+    static void isBefore(const U33* lhs, const U33& rhs, bool* out, std::size_t count);
+    static void isAfter(const U33* lhs, const U33& rhs, bool* out, std::size_t count);
+    static void distance(const U33* lhs, const U33* rhs, int* out, std::size_t count);
+    static void distance(const U33* lhs, const U33& rhs, int* out, std::size_t count);
+    /// @}
+};
+
+#endif // OMATH_U33BATCH_H
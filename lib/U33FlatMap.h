@@ -0,0 +1,1398 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33FlatMap.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_U33FLATMAP_H
+#define OMATH_U33FLATMAP_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33.h"
+#include "UIntHash.h"
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+class U33FlatValues
+//
+/// @name One Value per Slot, for U33FlatTable
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Slots
+    /// @{
+    void resize(std::size_t slots);
+    void move(std::size_t from, std::size_t to);
+    void take(U33FlatValues& other, std::size_t from, std::size_t to);
+    void reset(std::size_t slot);
+    void swap(U33FlatValues& other);
+    /// @}
+
+    /// @name Access
+    /// @{
+    Value& operator[](std::size_t slot);
+    const Value& operator[](std::size_t slot) const;
+    static std::size_t slotBytes();
+    /// @}
+
+private:
+
+    /// @name Variables
+    /// @{
+    std::vector<Value> mValues;     ///< Default constructed in empty slots
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+class U33FlatNoValues
+//
+/// @name No Values, for U33FlatTable as a set
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Slots
+    /// @{
+    void resize(std::size_t);
+    void move(std::size_t, std::size_t);
+    void take(U33FlatNoValues&, std::size_t, std::size_t);
+    void reset(std::size_t);
+    void swap(U33FlatNoValues&);
+    static std::size_t slotBytes();
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+class U33FlatTable
+//
+/// @name Open Addressing Table of U33 Keys
+///
+/// Linear probing over a power of two array of slots, at most 3/4 full.
+/// Each slot has a control byte (empty, or bit 32 of the key and 6 hash bits
+/// to reject most mismatches without reading the key) and the lower 32 bits
+/// of the key in a separate word array, 5 bytes per slot plus the values.
+/// Erasing shifts the rest of the probe run back rather than leaving a
+/// tombstone, so lookups never slow down with churn. Nothing is allocated
+/// per entry. Inserting may rehash, which moves every entry.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Constants
+    /// @{
+    static const std::size_t NPOS = ~static_cast<std::size_t>(0);  ///< No slot
+    /// @}
+
+    /// @name Construction / Destruction
+    /// @{
+    U33FlatTable();
+    /// @}
+
+    /// @name Size
+    /// @{
+    std::size_t size() const;
+    bool empty() const;
+    std::size_t capacity() const;
+    std::size_t memoryBytes() const;
+    void reserve(std::size_t count);
+    void clear();
+    /// @}
+
+    /// @name Slots
+    /// @{
+    std::size_t find(const U33& key) const;
+    std::size_t insert(const U33& key, bool& inserted);
+    bool erase(const U33& key);
+    void eraseSlot(std::size_t slot);
+    std::size_t next(std::size_t slot) const;
+    U33 key(std::size_t slot) const;
+    Values& values();
+    const Values& values() const;
+    /// @}
+
+private:
+
+    /// @name Constants
+    /// @{
+    static const unsigned char EMPTY    = 0x00;
+    static const unsigned char FULL     = 0x80;
+    static const unsigned char MSB      = 0x40;
+    static const std::size_t MIN_SLOTS  = 16;
+    /// @}
+
+    /// @name Helpers
+    /// @{
+    static unsigned int hash(const U33& key);
+    static unsigned char control(unsigned int hash, bool msb);
+    static std::size_t slotsFor(std::size_t count);
+    void rehash(std::size_t slots);
+    /// @}
+
+    /// @name Variables
+    /// @{
+    std::vector<unsigned char> mControl;    ///< EMPTY, or FULL | MSB | 6 hash bits
+    std::vector<unsigned int> mLsb32;       ///< The lower 32 bits of each key
+    Values mValues;                         ///< Whatever is stored per slot
+    std::size_t mSize;                      ///< The number of full slots
+    std::size_t mMask;                      ///< The number of slots - 1
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+class U33FlatMap
+//
+/// @name Flat Hash Map from U33
+///
+/// A U33FlatTable with a value per slot. Values must be default
+/// constructible and are reset to Value() when erased. Iterators and value
+/// pointers are invalidated by insertion and erasure.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Iteration
+    /// @{
+    template <bool Const> class BasicIterator;
+    typedef BasicIterator<false> Iterator;
+    typedef BasicIterator<true> ConstIterator;
+    typedef Iterator iterator;
+    typedef ConstIterator const_iterator;
+    /// @}
+
+    /// @name Size
+    /// @{
+    std::size_t size() const;
+    bool empty() const;
+    std::size_t capacity() const;
+    std::size_t memoryBytes() const;
+    void reserve(std::size_t count);
+    void clear();
+    /// @}
+
+    /// @name Lookup
+    /// @{
+    Value* find(const U33& key);
+    const Value* find(const U33& key) const;
+    bool contains(const U33& key) const;
+    /// @}
+
+    /// @name Modifiers
+    /// @{
+    bool insert(const U33& key, const Value& value);
+    Value& operator[](const U33& key);
+    bool erase(const U33& key);
+    /// @}
+
+    /// @name Iteration
+    /// @{
+    Iterator begin();
+    Iterator end();
+    ConstIterator begin() const;
+    ConstIterator end() const;
+    /// @}
+
+private:
+
+    /// @name Types
+    /// @{
+    typedef U33FlatTable<U33FlatValues<Value> > Table;
+    /// @}
+
+    /// @name Variables
+    /// @{
+    Table mTable;       ///< The keys and values
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+template <bool Const>
+class U33FlatMap<Value>::BasicIterator
+//
+/// @name Forward iterator yielding (key, value reference) pairs
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Types
+    /// @{
+    typedef typename std::conditional<Const, const Table, Table>::type TableType;
+    typedef typename std::conditional<Const, const Value&, Value&>::type ValueReference;
+    /// @}
+
+    /// @name Iterator Traits
+    /// @{
+    typedef std::forward_iterator_tag           iterator_category;
+    typedef std::pair<U33, ValueReference>      value_type;
+    typedef std::ptrdiff_t                      difference_type;
+    typedef void                                pointer;
+    typedef value_type                          reference;
+    /// @}
+
+    /// @name Construction / Destruction
+    /// @{
+    BasicIterator();
+    BasicIterator(TableType* table, std::size_t slot);
+    /// @}
+
+    /// @name Access
+    /// @{
+    value_type operator*() const;
+    U33 key() const;
+    ValueReference value() const;
+    /// @}
+
+    /// @name Movement
+    /// @{
+    BasicIterator& operator++();
+    BasicIterator operator++(int);
+    /// @}
+
+    /// @name Equality / Inequality Methods
+    /// @{
+    bool operator==(const BasicIterator& ref) const;
+    bool operator!=(const BasicIterator& ref) const;
+    /// @}
+
+private:
+
+    /// @name Variables
+    /// @{
+    TableType* mTable;      ///< The map's table
+    std::size_t mSlot;      ///< The current slot, capacity() at the end
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+class U33FlatSet
+//
+/// @name Flat Hash Set of U33
+///
+/// A U33FlatTable with nothing but the keys, 5 bytes per slot. Iterators are
+/// invalidated by insertion and erasure.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Iteration
+    /// @{
+    class ConstIterator;
+    typedef ConstIterator const_iterator;
+    /// @}
+
+    /// @name Size
+    /// @{
+    std::size_t size() const;
+    bool empty() const;
+    std::size_t capacity() const;
+    std::size_t memoryBytes() const;
+    void reserve(std::size_t count);
+    void clear();
+    /// @}
+
+    /// @name Lookup / Modifiers
+    /// @{
+    bool contains(const U33& key) const;
+    bool insert(const U33& key);
+    bool erase(const U33& key);
+    /// @}
+
+    /// @name Iteration
+    /// @{
+    ConstIterator begin() const;
+    ConstIterator end() const;
+    /// @}
+
+private:
+
+    /// @name Types
+    /// @{
+    typedef U33FlatTable<U33FlatNoValues> Table;
+    /// @}
+
+    /// @name Variables
+    /// @{
+    Table mTable;       ///< The keys
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+class U33FlatSet::ConstIterator
+//
+/// @name Forward iterator yielding the keys by value
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Iterator Traits
+    /// @{
+    typedef std::forward_iterator_tag   iterator_category;
+    typedef U33                         value_type;
+    typedef std::ptrdiff_t              difference_type;
+    typedef const U33*                  pointer;
+    typedef U33                         reference;
+    /// @}
+
+    /// @name Construction / Destruction
+    /// @{
+    ConstIterator();
+    ConstIterator(const Table* table, std::size_t slot);
+    /// @}
+
+    /// @name Access
+    /// @{
+    U33 operator*() const;
+    /// @}
+
+    /// @name Movement
+    /// @{
+    ConstIterator& operator++();
+    ConstIterator operator++(int);
+    /// @}
+
+    /// @name Equality / Inequality Methods
+    /// @{
+    bool operator==(const ConstIterator& ref) const;
+    bool operator!=(const ConstIterator& ref) const;
+    /// @}
+
+private:
+
+    /// @name Variables
+    /// @{
+    const Table* mTable;    ///< The set's table
+    std::size_t mSlot;      ///< The current slot, capacity() at the end
+    /// @}
+};
+
+//==============================================================================
+// U33FlatValues / U33FlatNoValues
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline void U33FlatValues<Value>::resize(std::size_t slots)
+//
+/// @brief Size for a new array of empty slots
+//------------------------------------------------------------------------------
+{
+    mValues.resize(slots);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline void U33FlatValues<Value>::move(std::size_t from, std::size_t to)
+//
+/// @brief Move a value between slots
+//------------------------------------------------------------------------------
+{
+    mValues[to] = std::move(mValues[from]);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline void U33FlatValues<Value>::take(U33FlatValues& other, std::size_t from, std::size_t to)
+//
+/// @brief Move a value in from another array of slots
+//------------------------------------------------------------------------------
+{
+    mValues[to] = std::move(other.mValues[from]);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline void U33FlatValues<Value>::reset(std::size_t slot)
+//
+/// @brief Release the value of an emptied slot
+//------------------------------------------------------------------------------
+{
+    mValues[slot] = Value();
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline void U33FlatValues<Value>::swap(U33FlatValues& other)
+//
+/// @brief Exchange arrays of slots
+//------------------------------------------------------------------------------
+{
+    mValues.swap(other.mValues);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline Value& U33FlatValues<Value>::operator[](std::size_t slot)
+//
+/// @brief The value in a slot
+//------------------------------------------------------------------------------
+{
+    return mValues[slot];
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline const Value& U33FlatValues<Value>::operator[](std::size_t slot) const
+//
+/// @brief The value in a slot
+//------------------------------------------------------------------------------
+{
+    return mValues[slot];
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline std::size_t U33FlatValues<Value>::slotBytes()
+//
+/// @brief The bytes each slot adds
+//------------------------------------------------------------------------------
+{
+    return sizeof(Value);
+}
+
+//------------------------------------------------------------------------------
+//
+inline void U33FlatNoValues::resize(std::size_t)
+//
+/// @brief Nothing to size
+//------------------------------------------------------------------------------
+{
+    // nothing stored
+}
+
+//------------------------------------------------------------------------------
+//
+inline void U33FlatNoValues::move(std::size_t, std::size_t)
+//
+/// @brief Nothing to move
+//------------------------------------------------------------------------------
+{
+    // nothing stored
+}
+
+//------------------------------------------------------------------------------
+//
+inline void U33FlatNoValues::take(U33FlatNoValues&, std::size_t, std::size_t)
+//
+/// @brief Nothing to move
+//------------------------------------------------------------------------------
+{
+    // nothing stored
+}
+
+//------------------------------------------------------------------------------
+//
+inline void U33FlatNoValues::reset(std::size_t)
+//
+/// @brief Nothing to release
+//------------------------------------------------------------------------------
+{
+    // nothing stored
+}
+
+//------------------------------------------------------------------------------
+//
+inline void U33FlatNoValues::swap(U33FlatNoValues&)
+//
+/// @brief Nothing to exchange
+//------------------------------------------------------------------------------
+{
+    // nothing stored
+}
+
+//------------------------------------------------------------------------------
+//
+inline std::size_t U33FlatNoValues::slotBytes()
+//
+/// @brief The bytes each slot adds
+//------------------------------------------------------------------------------
+{
+    return 0;
+}
+
+//==============================================================================
+// U33FlatTable
+//==============================================================================
+
+/// @cond
+template <typename Values> const std::size_t U33FlatTable<Values>::NPOS;
+template <typename Values> const unsigned char U33FlatTable<Values>::EMPTY;
+template <typename Values> const unsigned char U33FlatTable<Values>::FULL;
+template <typename Values> const unsigned char U33FlatTable<Values>::MSB;
+template <typename Values> const std::size_t U33FlatTable<Values>::MIN_SLOTS;
+/// @endcond
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline U33FlatTable<Values>::U33FlatTable()
+//
+/// @brief Construct an empty table, allocating nothing
+//------------------------------------------------------------------------------
+    : mSize(0),
+      mMask(0)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline std::size_t U33FlatTable<Values>::size() const
+//
+/// @brief The number of keys
+//------------------------------------------------------------------------------
+{
+    return mSize;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline bool U33FlatTable<Values>::empty() const
+//
+/// @brief True when there are no keys
+//------------------------------------------------------------------------------
+{
+    return (mSize == 0);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline std::size_t U33FlatTable<Values>::capacity() const
+//
+/// @brief The number of slots, full or empty
+//------------------------------------------------------------------------------
+{
+    return mControl.size();
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline std::size_t U33FlatTable<Values>::memoryBytes() const
+//
+/// @brief The number of bytes of slot storage allocated
+//------------------------------------------------------------------------------
+{
+    return (capacity() * (sizeof(unsigned char) + sizeof(unsigned int) + Values::slotBytes()));
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline void U33FlatTable<Values>::reserve(std::size_t count)
+//
+/// @brief Make room for count keys without a rehash
+//------------------------------------------------------------------------------
+{
+    const std::size_t slots = slotsFor(count);
+    if (slots > capacity())
+    {
+        rehash(slots);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline void U33FlatTable<Values>::clear()
+//
+/// @brief Remove every key, keeping the slots
+//------------------------------------------------------------------------------
+{
+    for (std::size_t slot = next(0); slot < capacity(); slot = next(slot + 1))
+    {
+        mControl[slot] = EMPTY;
+        mValues.reset(slot);
+    }
+
+    mSize = 0;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline std::size_t U33FlatTable<Values>::find(const U33& key) const
+//
+/// @brief The slot holding a key, NPOS if there is none
+//------------------------------------------------------------------------------
+{
+    if (mSize == 0)
+    {
+        return NPOS;
+    }
+
+    const unsigned int  keyHash = hash(key);
+    const unsigned char tag     = control(keyHash, key.getMsb());
+    const unsigned int  lsb32   = key.getLsb32();
+
+    // there is always an empty slot to stop at
+    for (std::size_t slot = keyHash & mMask; ; slot = (slot + 1) & mMask)
+    {
+        const unsigned char current = mControl[slot];
+        if ((current == tag) && (mLsb32[slot] == lsb32))
+        {
+            return slot;
+        }
+
+        if (current == EMPTY)
+        {
+            return NPOS;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline std::size_t U33FlatTable<Values>::insert(const U33& key, bool& inserted)
+//
+/// @brief The slot holding a key, adding it (inserted = true) if needed
+//------------------------------------------------------------------------------
+{
+    if (slotsFor(mSize + 1) > capacity())
+    {
+        rehash(slotsFor(mSize + 1));
+    }
+
+    const unsigned int  keyHash = hash(key);
+    const unsigned char tag     = control(keyHash, key.getMsb());
+    const unsigned int  lsb32   = key.getLsb32();
+
+    std::size_t slot = keyHash & mMask;
+    for ( ; mControl[slot] != EMPTY; slot = (slot + 1) & mMask)
+    {
+        if ((mControl[slot] == tag) && (mLsb32[slot] == lsb32))
+        {
+            inserted = false;
+            return slot;
+        }
+    }
+
+    mControl[slot] = tag;
+    mLsb32[slot]   = lsb32;
+    ++mSize;
+
+    inserted = true;
+    return slot;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline bool U33FlatTable<Values>::erase(const U33& key)
+//
+/// @brief Remove a key, false if it was not there
+//------------------------------------------------------------------------------
+{
+    const std::size_t slot = find(key);
+    if (slot == NPOS)
+    {
+        return false;
+    }
+
+    eraseSlot(slot);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+void U33FlatTable<Values>::eraseSlot(std::size_t slot)
+//
+/// @brief Empty a full slot, moving later keys of the run back into the hole
+//------------------------------------------------------------------------------
+{
+    std::size_t hole = slot;
+    for (std::size_t probe = (hole + 1) & mMask; mControl[probe] != EMPTY; probe = (probe + 1) & mMask)
+    {
+        // a key may fill the hole unless its home is after the hole
+        const std::size_t home = hash(key(probe)) & mMask;
+        if (((probe - home) & mMask) >= ((probe - hole) & mMask))
+        {
+            mControl[hole] = mControl[probe];
+            mLsb32[hole]   = mLsb32[probe];
+            mValues.move(probe, hole);
+            hole = probe;
+        }
+    }
+
+    mControl[hole] = EMPTY;
+    mValues.reset(hole);
+    --mSize;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline std::size_t U33FlatTable<Values>::next(std::size_t slot) const
+//
+/// @brief The first full slot at or after slot, capacity() if there is none
+//------------------------------------------------------------------------------
+{
+    const std::size_t slots = capacity();
+    while ((slot < slots) && (mControl[slot] == EMPTY))
+    {
+        ++slot;
+    }
+
+    return slot;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline U33 U33FlatTable<Values>::key(std::size_t slot) const
+//
+/// @brief The key in a full slot
+//------------------------------------------------------------------------------
+{
+    return U33((mControl[slot] & MSB) ? 1 : 0, mLsb32[slot]);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline Values& U33FlatTable<Values>::values()
+//
+/// @brief The per slot values
+//------------------------------------------------------------------------------
+{
+    return mValues;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline const Values& U33FlatTable<Values>::values() const
+//
+/// @brief The per slot values
+//------------------------------------------------------------------------------
+{
+    return mValues;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline unsigned int U33FlatTable<Values>::hash(const U33& key)
+//
+/// @brief The hash of a key, its low bits pick the home slot
+//------------------------------------------------------------------------------
+{
+    return UIntHash<33, U33::LayoutType>::hash32(key);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline unsigned char U33FlatTable<Values>::control(unsigned int hash, bool msb)
+//
+/// @brief The control byte of a full slot, with the top 6 hash bits as a tag
+//------------------------------------------------------------------------------
+{
+    return static_cast<unsigned char>(FULL | (msb ? MSB : 0) | (hash >> 26));
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+inline std::size_t U33FlatTable<Values>::slotsFor(std::size_t count)
+//
+/// @brief The power of two number of slots that holds count keys 3/4 full
+//------------------------------------------------------------------------------
+{
+    std::size_t slots = MIN_SLOTS;
+    while ((slots / 4) * 3 < count)
+    {
+        slots *= 2;
+    }
+
+    return slots;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Values>
+void U33FlatTable<Values>::rehash(std::size_t slots)
+//
+/// @brief Move every key into a new array of slots
+//------------------------------------------------------------------------------
+{
+    std::vector<unsigned char> control(slots, EMPTY);
+    std::vector<unsigned int> lsb32(slots);
+    Values values;
+    values.resize(slots);
+
+    const std::size_t mask = slots - 1;
+    for (std::size_t from = next(0); from < capacity(); from = next(from + 1))
+    {
+        std::size_t to = hash(key(from)) & mask;
+        while (control[to] != EMPTY)
+        {
+            to = (to + 1) & mask;
+        }
+
+        control[to] = mControl[from];
+        lsb32[to]   = mLsb32[from];
+        values.take(mValues, from, to);
+    }
+
+    mControl.swap(control);
+    mLsb32.swap(lsb32);
+    mValues.swap(values);
+    mMask = mask;
+}
+
+//==============================================================================
+// U33FlatMap
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline std::size_t U33FlatMap<Value>::size() const
+//
+/// @brief The number of keys
+//------------------------------------------------------------------------------
+{
+    return mTable.size();
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline bool U33FlatMap<Value>::empty() const
+//
+/// @brief True when there are no keys
+//------------------------------------------------------------------------------
+{
+    return mTable.empty();
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline std::size_t U33FlatMap<Value>::capacity() const
+//
+/// @brief The number of slots, full or empty
+//------------------------------------------------------------------------------
+{
+    return mTable.capacity();
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline std::size_t U33FlatMap<Value>::memoryBytes() const
+//
+/// @brief The number of bytes of slot storage allocated
+//------------------------------------------------------------------------------
+{
+    return mTable.memoryBytes();
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline void U33FlatMap<Value>::reserve(std::size_t count)
+//
+/// @brief Make room for count keys without a rehash
+//------------------------------------------------------------------------------
+{
+    mTable.reserve(count);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline void U33FlatMap<Value>::clear()
+//
+/// @brief Remove every key, keeping the slots
+//------------------------------------------------------------------------------
+{
+    mTable.clear();
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline Value* U33FlatMap<Value>::find(const U33& key)
+//
+/// @brief The value for a key, 0 if there is none
+//------------------------------------------------------------------------------
+{
+    const std::size_t slot = mTable.find(key);
+    return (slot != Table::NPOS) ? &mTable.values()[slot] : 0;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline const Value* U33FlatMap<Value>::find(const U33& key) const
+//
+/// @brief The value for a key, 0 if there is none
+//------------------------------------------------------------------------------
+{
+    const std::size_t slot = mTable.find(key);
+    return (slot != Table::NPOS) ? &mTable.values()[slot] : 0;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline bool U33FlatMap<Value>::contains(const U33& key) const
+//
+/// @brief True when a key is present
+//------------------------------------------------------------------------------
+{
+    return (mTable.find(key) != Table::NPOS);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline bool U33FlatMap<Value>::insert(const U33& key, const Value& value)
+//
+/// @brief Add a key and value, false (leaving the value) if the key is there
+//------------------------------------------------------------------------------
+{
+    bool inserted(false);
+    const std::size_t slot = mTable.insert(key, inserted);
+    if (inserted)
+    {
+        mTable.values()[slot] = value;
+    }
+
+    return inserted;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline Value& U33FlatMap<Value>::operator[](const U33& key)
+//
+/// @brief The value for a key, added as Value() if the key is not there
+//------------------------------------------------------------------------------
+{
+    bool inserted(false);
+    return mTable.values()[mTable.insert(key, inserted)];
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline bool U33FlatMap<Value>::erase(const U33& key)
+//
+/// @brief Remove a key and its value, false if it was not there
+//------------------------------------------------------------------------------
+{
+    return mTable.erase(key);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline typename U33FlatMap<Value>::Iterator U33FlatMap<Value>::begin()
+//
+/// @brief The first entry, in no particular order
+//------------------------------------------------------------------------------
+{
+    return Iterator(&mTable, mTable.next(0));
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline typename U33FlatMap<Value>::Iterator U33FlatMap<Value>::end()
+//
+/// @brief Past the last entry
+//------------------------------------------------------------------------------
+{
+    return Iterator(&mTable, mTable.capacity());
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline typename U33FlatMap<Value>::ConstIterator U33FlatMap<Value>::begin() const
+//
+/// @brief The first entry, in no particular order
+//------------------------------------------------------------------------------
+{
+    return ConstIterator(&mTable, mTable.next(0));
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+inline typename U33FlatMap<Value>::ConstIterator U33FlatMap<Value>::end() const
+//
+/// @brief Past the last entry
+//------------------------------------------------------------------------------
+{
+    return ConstIterator(&mTable, mTable.capacity());
+}
+
+//==============================================================================
+// U33FlatMap::BasicIterator
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+template <bool Const>
+inline U33FlatMap<Value>::BasicIterator<Const>::BasicIterator()
+//
+/// @brief Construct a singular iterator
+//------------------------------------------------------------------------------
+    : mTable(0),
+      mSlot(0)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+template <bool Const>
+inline U33FlatMap<Value>::BasicIterator<Const>::BasicIterator(TableType* table, std::size_t slot)
+//
+/// @brief Construct at a slot
+//------------------------------------------------------------------------------
+    : mTable(table),
+      mSlot(slot)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+template <bool Const>
+inline typename U33FlatMap<Value>::BasicIterator<Const>::value_type U33FlatMap<Value>::BasicIterator<Const>::operator*() const
+//
+/// @brief The key and a reference to the value
+//------------------------------------------------------------------------------
+{
+    return value_type(key(), value());
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+template <bool Const>
+inline U33 U33FlatMap<Value>::BasicIterator<Const>::key() const
+//
+/// @brief The key
+//------------------------------------------------------------------------------
+{
+    return mTable->key(mSlot);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+template <bool Const>
+inline typename U33FlatMap<Value>::BasicIterator<Const>::ValueReference U33FlatMap<Value>::BasicIterator<Const>::value() const
+//
+/// @brief The value
+//------------------------------------------------------------------------------
+{
+    return mTable->values()[mSlot];
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+template <bool Const>
+inline U33FlatMap<Value>::BasicIterator<Const>& U33FlatMap<Value>::BasicIterator<Const>::operator++()
+//
+/// @brief Pre-increment to the next full slot
+//------------------------------------------------------------------------------
+{
+    mSlot = mTable->next(mSlot + 1);
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+template <bool Const>
+inline U33FlatMap<Value>::BasicIterator<Const> U33FlatMap<Value>::BasicIterator<Const>::operator++(int)
+//
+/// @brief Post-increment to the next full slot
+//------------------------------------------------------------------------------
+{
+    BasicIterator previous(*this);
+    ++(*this);
+    return previous;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+template <bool Const>
+inline bool U33FlatMap<Value>::BasicIterator<Const>::operator==(const BasicIterator& ref) const
+//
+/// @brief Equality
+//------------------------------------------------------------------------------
+{
+    return (mSlot == ref.mSlot);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Value>
+template <bool Const>
+inline bool U33FlatMap<Value>::BasicIterator<Const>::operator!=(const BasicIterator& ref) const
+//
+/// @brief Inequality
+//------------------------------------------------------------------------------
+{
+    return (mSlot != ref.mSlot);
+}
+
+//==============================================================================
+// U33FlatSet
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+inline std::size_t U33FlatSet::size() const
+//
+/// @brief The number of keys
+//------------------------------------------------------------------------------
+{
+    return mTable.size();
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33FlatSet::empty() const
+//
+/// @brief True when there are no keys
+//------------------------------------------------------------------------------
+{
+    return mTable.empty();
+}
+
+//------------------------------------------------------------------------------
+//
+inline std::size_t U33FlatSet::capacity() const
+//
+/// @brief The number of slots, full or empty
+//------------------------------------------------------------------------------
+{
+    return mTable.capacity();
+}
+
+//------------------------------------------------------------------------------
+//
+inline std::size_t U33FlatSet::memoryBytes() const
+//
+/// @brief The number of bytes of slot storage allocated
+//------------------------------------------------------------------------------
+{
+    return mTable.memoryBytes();
+}
+
+//------------------------------------------------------------------------------
+//
+inline void U33FlatSet::reserve(std::size_t count)
+//
+/// @brief Make room for count keys without a rehash
+//------------------------------------------------------------------------------
+{
+    mTable.reserve(count);
+}
+
+//------------------------------------------------------------------------------
+//
+inline void U33FlatSet::clear()
+//
+/// @brief Remove every key, keeping the slots
+//------------------------------------------------------------------------------
+{
+    mTable.clear();
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33FlatSet::contains(const U33& key) const
+//
+/// @brief True when a key is present
+//------------------------------------------------------------------------------
+{
+    return (mTable.find(key) != Table::NPOS);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33FlatSet::insert(const U33& key)
+//
+/// @brief Add a key, false if it was already there
+//------------------------------------------------------------------------------
+{
+    bool inserted(false);
+    mTable.insert(key, inserted);
+    return inserted;
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33FlatSet::erase(const U33& key)
+//
+/// @brief Remove a key, false if it was not there
+//------------------------------------------------------------------------------
+{
+    return mTable.erase(key);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33FlatSet::ConstIterator U33FlatSet::begin() const
+//
+/// @brief The first key, in no particular order
+//------------------------------------------------------------------------------
+{
+    return ConstIterator(&mTable, mTable.next(0));
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33FlatSet::ConstIterator U33FlatSet::end() const
+//
+/// @brief Past the last key
+//------------------------------------------------------------------------------
+{
+    return ConstIterator(&mTable, mTable.capacity());
+}
+
+//==============================================================================
+// U33FlatSet::ConstIterator
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+inline U33FlatSet::ConstIterator::ConstIterator()
+//
+/// @brief Construct a singular iterator
+//------------------------------------------------------------------------------
+    : mTable(0),
+      mSlot(0)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33FlatSet::ConstIterator::ConstIterator(const Table* table, std::size_t slot)
+//
+/// @brief Construct at a slot
+//------------------------------------------------------------------------------
+    : mTable(table),
+      mSlot(slot)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 U33FlatSet::ConstIterator::operator*() const
+//
+/// @brief The key
+//------------------------------------------------------------------------------
+{
+    return mTable->key(mSlot);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33FlatSet::ConstIterator& U33FlatSet::ConstIterator::operator++()
+//
+/// @brief Pre-increment to the next full slot
+//------------------------------------------------------------------------------
+{
+    mSlot = mTable->next(mSlot + 1);
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33FlatSet::ConstIterator U33FlatSet::ConstIterator::operator++(int)
+//
+/// @brief Post-increment to the next full slot
+//------------------------------------------------------------------------------
+{
+    ConstIterator previous(*this);
+    ++(*this);
+    return previous;
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33FlatSet::ConstIterator::operator==(const ConstIterator& ref) const
+//
+/// @brief Equality
+//------------------------------------------------------------------------------
+{
+    return (mSlot == ref.mSlot);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33FlatSet::ConstIterator::operator!=(const ConstIterator& ref) const
+//
+/// @brief Inequality
+//------------------------------------------------------------------------------
+{
+    return (mSlot != ref.mSlot);
+}
+
+#endif // OMATH_U33FLATMAP_H
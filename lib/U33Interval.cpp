@@ -0,0 +1,508 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Interval.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33Interval.h"
+#include "U33Parallel.h"
+#include "U33Sort.h"
+
+/// @name Constants
+/// @{
+
+/// Two pieces per interval, and every piece index fits a word
+static const std::size_t MAX_COUNT = 0x7fffffff;
+
+/// Subtrees this many levels high are a short run of pieces, scanned in order
+static const unsigned int SCAN_LEVELS = 3;
+
+/// Batches are put in key order with a word per query
+static const std::size_t MAX_BATCH = 0xffffffff;
+
+/// Room for the deepest descent, two nodes per level
+static const std::size_t STACK_DEPTH = 128;
+/// @}
+
+/// @name Types
+/// @{
+
+/// A tree node waiting on the search stack
+struct SearchNode
+{
+    std::size_t mIndex;     ///< The node, which may be past the last piece
+    unsigned int mLevel;    ///< Its height, the trailing one bits of mIndex
+    bool mLeftDone;         ///< The left subtree has been pushed
+};
+
+/// The results of one chunk of a batched query
+struct BatchPart
+{
+    std::size_t mBegin;                 ///< The first query, in key order
+    std::size_t mEnd;                   ///< One past the last query
+    std::vector<std::size_t> mIds;      ///< The ids found, in key order
+};
+/// @}
+
+//------------------------------------------------------------------------------
+//
+template <typename Query>
+static void batch(const U33* keys, std::size_t count, std::vector<std::size_t>& ids,
+                  std::vector<std::size_t>& offsets, Query query)
+//
+/// @brief Run count queries on U33Parallel, query(i, found) appending the
+/// ids for query i, and join them into ids / offsets
+//------------------------------------------------------------------------------
+{
+    if (count > MAX_BATCH)
+    {
+        throw std::invalid_argument("U33IntervalIndex batch");
+    }
+
+    // queries close together share most of their path down the tree, so
+    // they run in key order and the results are put back in query order
+    std::vector<unsigned int> order(count);
+    {
+        std::vector<U33> sorted(keys, keys + count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            order[i] = static_cast<unsigned int>(i);
+        }
+        U33Sort::sort(sorted, order, 0);
+    }
+
+    std::vector<BatchPart> parts;
+    std::vector<std::size_t> local(count);
+    std::mutex lock;
+
+    offsets.assign(count + 1, 0);
+    U33Parallel::forChunks(count, [&](std::size_t /*chunk*/, std::size_t begin, std::size_t end)
+    {
+        std::vector<std::size_t> found;
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            local[i] = found.size();
+            query(order[i], found);
+            offsets[order[i] + 1] = found.size() - local[i];
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        parts.push_back(BatchPart());
+        parts.back().mBegin = begin;
+        parts.back().mEnd   = end;
+        parts.back().mIds.swap(found);
+    });
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        offsets[i + 1] += offsets[i];
+    }
+
+    ids.resize(offsets[count]);
+    for (std::size_t i = 0; i < parts.size(); ++i)
+    {
+        const BatchPart& part = parts[i];
+        for (std::size_t run = part.mBegin; run < part.mEnd; ++run)
+        {
+            const std::size_t query = order[run];
+            std::copy(part.mIds.begin() + local[run],
+                      part.mIds.begin() + local[run] + (offsets[query + 1] - offsets[query]),
+                      ids.begin() + offsets[query]);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+U33IntervalIndex::U33IntervalIndex()
+//
+/// @brief Construct an empty index
+//------------------------------------------------------------------------------
+    : mIntervals(),
+      mEntries(),
+      mLevels(0)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+U33IntervalIndex::~U33IntervalIndex()
+//
+/// @brief Destructor
+//------------------------------------------------------------------------------
+{
+}
+
+//------------------------------------------------------------------------------
+//
+void U33IntervalIndex::build(const U33Interval* intervals, std::size_t count)
+//
+/// @brief Build from a list of intervals, replacing the current ones
+///
+/// Empty intervals keep their ids but never match. Throws
+/// std::invalid_argument if there are more than 2^31 - 1 intervals.
+//------------------------------------------------------------------------------
+{
+    if (count > MAX_COUNT)
+    {
+        throw std::invalid_argument("U33IntervalIndex::build");
+    }
+
+    std::vector<U33Interval> built(intervals, intervals + count);
+
+    // a wrapped interval is a head up to 2^33 - 1 and a tail from 0
+    std::vector<Entry> pieces;
+    pieces.reserve(count);
+    for (std::size_t id = 0; id < count; ++id)
+    {
+        const U33Interval& interval = built[id];
+        if (interval.isEmpty())
+        {
+            continue;
+        }
+
+        const U33 last = interval.getEnd() - U33(0, 1);
+        const unsigned int index = static_cast<unsigned int>(id);
+        if (interval.isWrapped())
+        {
+            const Entry head = { interval.getStart(), ~U33(), ~U33(), index, false };
+            const Entry tail = { U33(), last, last, index, true };
+            pieces.push_back(head);
+            pieces.push_back(tail);
+        }
+        else
+        {
+            const Entry whole = { interval.getStart(), last, last, index, false };
+            pieces.push_back(whole);
+        }
+    }
+
+    // stable, so equal starts stay in id order
+    std::vector<U33> starts(pieces.size());
+    std::vector<unsigned int> order(pieces.size());
+    for (std::size_t i = 0; i < pieces.size(); ++i)
+    {
+        starts[i] = pieces[i].mFirst;
+        order[i]  = static_cast<unsigned int>(i);
+    }
+    U33Sort::sort(starts, order, 0);
+
+    std::vector<Entry> entries(pieces.size());
+    for (std::size_t i = 0; i < pieces.size(); ++i)
+    {
+        entries[i] = pieces[order[i]];
+    }
+
+    mIntervals.swap(built);
+    mEntries.swap(entries);
+    link();
+}
+
+//------------------------------------------------------------------------------
+//
+void U33IntervalIndex::build(const std::vector<U33Interval>& intervals)
+//
+/// @brief Build from a vector of intervals
+//------------------------------------------------------------------------------
+{
+    build(intervals.data(), intervals.size());
+}
+
+//------------------------------------------------------------------------------
+//
+void U33IntervalIndex::clear()
+//
+/// @brief Remove every interval and free the memory
+//------------------------------------------------------------------------------
+{
+    std::vector<U33Interval>().swap(mIntervals);
+    std::vector<Entry>().swap(mEntries);
+    mLevels = 0;
+}
+
+//------------------------------------------------------------------------------
+//
+void U33IntervalIndex::stab(const U33& point, std::vector<std::size_t>& ids) const
+//
+/// @brief Append the ids of the intervals containing point, in no
+/// particular order
+//------------------------------------------------------------------------------
+{
+    // a point meets only one piece of a wrapped interval
+    auto visit = [&ids](const Entry& entry) { ids.push_back(entry.mId); };
+
+    search(point, point, visit);
+}
+
+//------------------------------------------------------------------------------
+//
+void U33IntervalIndex::stab(const U33* points, std::size_t count,
+                            std::vector<std::size_t>& ids, std::vector<std::size_t>& offsets) const
+//
+/// @brief stab() each point, the ids for points[i] ending up in
+/// ids[offsets[i]] to ids[offsets[i + 1]]; offsets gets count + 1 entries
+//------------------------------------------------------------------------------
+{
+    batch(points, count, ids, offsets,
+          [this, points](std::size_t i, std::vector<std::size_t>& found) { stab(points[i], found); });
+}
+
+//------------------------------------------------------------------------------
+//
+void U33IntervalIndex::overlapping(const U33Interval& query, std::vector<std::size_t>& ids) const
+//
+/// @brief Append the ids of the intervals sharing a tick with query, in no
+/// particular order
+//------------------------------------------------------------------------------
+{
+    if (query.isEmpty())
+    {
+        return;
+    }
+
+    const U33 first = query.getStart();
+    const U33 last  = query.getEnd() - U33(0, 1);
+
+    if (!query.isWrapped())
+    {
+        // a tail counts only when its head, which runs on to 2^33 - 1, is
+        // not met, i.e. when the interval starts after the query
+        auto visit = [this, &ids, &last](const Entry& entry)
+        {
+            if (!entry.mTail || (last < mIntervals[entry.mId].getStart()))
+            {
+                ids.push_back(entry.mId);
+            }
+        };
+        search(first, last, visit);
+        return;
+    }
+
+    // up to the wrap every head is met, so tails are left out; after it so
+    // is anything that also reached the part before the wrap
+    auto before = [&ids](const Entry& entry)
+    {
+        if (!entry.mTail)
+        {
+            ids.push_back(entry.mId);
+        }
+    };
+    search(first, ~U33(), before);
+
+    auto after = [&ids, &first](const Entry& entry)
+    {
+        if (!entry.mTail && (entry.mLast < first))
+        {
+            ids.push_back(entry.mId);
+        }
+    };
+    search(U33(), last, after);
+}
+
+//------------------------------------------------------------------------------
+//
+void U33IntervalIndex::overlapping(const U33Interval* queries, std::size_t count,
+                                   std::vector<std::size_t>& ids, std::vector<std::size_t>& offsets) const
+//
+/// @brief overlapping() each query, the ids for queries[i] ending up in
+/// ids[offsets[i]] to ids[offsets[i + 1]]; offsets gets count + 1 entries
+//------------------------------------------------------------------------------
+{
+    std::vector<U33> starts(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        starts[i] = queries[i].getStart();
+    }
+
+    batch(starts.data(), count, ids, offsets,
+          [this, queries](std::size_t i, std::vector<std::size_t>& found) { overlapping(queries[i], found); });
+}
+
+//------------------------------------------------------------------------------
+//
+std::size_t U33IntervalIndex::size() const
+//
+/// @brief Get the number of intervals
+//------------------------------------------------------------------------------
+{
+    return mIntervals.size();
+}
+
+//------------------------------------------------------------------------------
+//
+bool U33IntervalIndex::empty() const
+//
+/// @brief Whether there are no intervals
+//------------------------------------------------------------------------------
+{
+    return mIntervals.empty();
+}
+
+//------------------------------------------------------------------------------
+//
+std::size_t U33IntervalIndex::memoryBytes() const
+//
+/// @brief Get the heap bytes held
+//------------------------------------------------------------------------------
+{
+    return (mIntervals.capacity() * sizeof(U33Interval)) + (mEntries.capacity() * sizeof(Entry));
+}
+
+//------------------------------------------------------------------------------
+//
+const U33Interval& U33IntervalIndex::getInterval(std::size_t id) const
+//
+/// @brief Get an interval by its position in build()
+//------------------------------------------------------------------------------
+{
+    return mIntervals[id];
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Visit>
+void U33IntervalIndex::search(const U33& first, const U33& last, Visit& visit) const
+//
+/// @brief visit(entry) for every piece meeting the ticks first to last
+//------------------------------------------------------------------------------
+{
+    const std::size_t count = mEntries.size();
+    if (count == 0)
+    {
+        return;
+    }
+
+    const Entry* entries = mEntries.data();
+    const unsigned int top = mLevels - 1;
+
+    SearchNode stack[STACK_DEPTH];
+    std::size_t depth(0);
+    stack[depth++] = { (static_cast<std::size_t>(1) << top) - 1, top, false };
+
+    while (depth != 0)
+    {
+        const SearchNode node = stack[--depth];
+
+        if (node.mLevel <= SCAN_LEVELS)
+        {
+            // the subtree is a run of pieces, sorted by start
+            const std::size_t begin = (node.mIndex >> node.mLevel) << node.mLevel;
+            const std::size_t end   = std::min(begin + (static_cast<std::size_t>(2) << node.mLevel) - 1, count);
+            for (std::size_t i = begin; (i < end) && !(last < entries[i].mFirst); ++i)
+            {
+                if (!(entries[i].mLast < first))
+                {
+                    visit(entries[i]);
+                }
+            }
+            continue;
+        }
+
+        const std::size_t half = static_cast<std::size_t>(1) << (node.mLevel - 1);
+
+        if (!node.mLeftDone)
+        {
+            // come back for this node once the left subtree is done; a left
+            // child past the end may still have pieces below it
+            const std::size_t left = node.mIndex - half;
+            stack[depth++] = { node.mIndex, node.mLevel, true };
+            if ((left >= count) || !(entries[left].mReach < first))
+            {
+                stack[depth++] = { left, node.mLevel - 1, false };
+            }
+        }
+        else if ((node.mIndex < count) && !(last < entries[node.mIndex].mFirst))
+        {
+            // everything to the right starts no earlier than this node
+            if (!(entries[node.mIndex].mLast < first))
+            {
+                visit(entries[node.mIndex]);
+            }
+            stack[depth++] = { node.mIndex + half, node.mLevel - 1, false };
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33IntervalIndex::link()
+//
+/// @brief Fill in the reach of every node of the implicit tree over mEntries
+///
+/// Leaves are the even pieces and node i of level k has k trailing one bits.
+/// A right child past the end stands for the pieces that do exist under it,
+/// whose reach is carried up level by level.
+//------------------------------------------------------------------------------
+{
+    const std::size_t count = mEntries.size();
+
+    mLevels = 0;
+    if (count == 0)
+    {
+        return;
+    }
+
+    std::size_t lastNode(0);
+    U33 lastReach;
+    for (std::size_t i = 0; i < count; i += 2)
+    {
+        mEntries[i].mReach = mEntries[i].mLast;
+        lastNode  = i;
+        lastReach = mEntries[i].mLast;
+    }
+
+    unsigned int level(1);
+    for (; (static_cast<std::size_t>(1) << level) <= count; ++level)
+    {
+        const std::size_t half = static_cast<std::size_t>(1) << (level - 1);
+        for (std::size_t i = (half << 1) - 1; i < count; i += half << 2)
+        {
+            const U33& left  = mEntries[i - half].mReach;
+            const U33& right = (i + half < count) ? mEntries[i + half].mReach : lastReach;
+
+            U33 reach = mEntries[i].mLast;
+            reach = (left > reach) ? left : reach;
+            reach = (right > reach) ? right : reach;
+            mEntries[i].mReach = reach;
+        }
+
+        // move the last node up to this level
+        lastNode = ((lastNode >> level) & 1) ? (lastNode - half) : (lastNode + half);
+        if ((lastNode < count) && (mEntries[lastNode].mReach > lastReach))
+        {
+            lastReach = mEntries[lastNode].mReach;
+        }
+    }
+
+    mLevels = level;
+}
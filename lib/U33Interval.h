@@ -0,0 +1,385 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Interval.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_U33INTERVAL_H
+#define OMATH_U33INTERVAL_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33.h"
+
+//------------------------------------------------------------------------------
+//
+class U33Interval
+//
+/// @name Half Open [start, end) Range of U33 Ticks
+///
+/// Held as a start and a length, so a range that straddles the 2^33 wrap
+/// (e.g. [2^33 - 10, 20), 30 ticks) is no different from any other and every
+/// test is a modular subtraction and one compare, where ordering the ends
+/// with operator< is wrong as soon as one of them has wrapped. [x, x) is
+/// empty, so the longest range is 2^33 - 1 ticks and the whole circle cannot
+/// be held.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Construction / Destruction
+    /// @{
+    constexpr U33Interval();
+    constexpr U33Interval(const U33& start, const U33& end);
+    static constexpr U33Interval fromLength(const U33& start, const U33& length);
+    /// @}
+
+    /// @name Operations
+    /// @{
+    constexpr bool contains(const U33& point) const;
+    constexpr bool contains(const U33Interval& other) const;
+    constexpr bool overlaps(const U33Interval& other) const;
+    constexpr U33Interval intersect(const U33Interval& other) const;
+    constexpr U33Interval unite(const U33Interval& other) const;
+    /// @}
+
+    /// @name Comparison Operators
+    /// @{
+    constexpr bool operator==(const U33Interval& rhs) const;
+    constexpr bool operator!=(const U33Interval& rhs) const;
+    /// @}
+
+    /// @name Getters
+    /// @{
+    constexpr const U33& getStart() const;
+    constexpr U33 getEnd() const;
+    constexpr const U33& getLength() const;
+    constexpr bool isEmpty() const;
+    constexpr bool isWrapped() const;
+    /// @}
+
+private:
+
+    /// @name Variables
+    /// @{
+    U33 mStart;             ///< The first tick
+    U33 mLength;            ///< The number of ticks, 0 when empty
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+class U33IntervalIndex
+//
+/// @name Immutable Index of U33 Intervals for Stabbing and Overlap Queries
+///
+/// Built once from a list of intervals, which are then named by their
+/// position in that list. A wrapped interval is stored as two pieces, up to
+/// 2^33 - 1 and on from 0, so the pieces lie on a straight line; they are
+/// radix sorted by start and viewed as an implicit binary tree (node i sits
+/// at the level of its trailing one bits, as in Li's cgranges), each node
+/// holding the last tick of its subtree. A query descends only into
+/// subtrees that can reach it, so it costs O(log n + k) for k results. A
+/// wrapped query is split the same way and each interval is reported at
+/// most once per query.
+///
+/// Batched queries are run in start order, so neighbouring queries find
+/// the top of their path down the tree in cache, spread over U33Parallel,
+/// and the results come back in CSR form in query order. Queries may run
+/// from several threads at once. The interval count is limited to 2^31 - 1
+/// and a batch to 2^32 - 1 queries.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Construction / Destruction
+    /// @{
+    U33IntervalIndex();
+    ~U33IntervalIndex();
+    /// @}
+
+    /// @name Building
+    /// @{
+    void build(const U33Interval* intervals, std::size_t count);
+    void build(const std::vector<U33Interval>& intervals);
+    void clear();
+    /// @}
+
+    /// @name Queries
+    /// @{
+    void stab(const U33& point, std::vector<std::size_t>& ids) const;
+    void stab(const U33* points, std::size_t count,
+              std::vector<std::size_t>& ids, std::vector<std::size_t>& offsets) const;
+    void overlapping(const U33Interval& query, std::vector<std::size_t>& ids) const;
+    void overlapping(const U33Interval* queries, std::size_t count,
+                     std::vector<std::size_t>& ids, std::vector<std::size_t>& offsets) const;
+    /// @}
+
+    /// @name Getters
+    /// @{
+    std::size_t size() const;
+    bool empty() const;
+    std::size_t memoryBytes() const;
+    const U33Interval& getInterval(std::size_t id) const;
+    /// @}
+
+private:
+
+    /// @name Types
+    /// @{
+    struct Entry
+    {
+        U33 mFirst;             ///< The first tick of the piece
+        U33 mLast;              ///< The last tick of the piece
+        U33 mReach;             ///< The largest mLast in the subtree under this node
+        unsigned int mId;       ///< The interval the piece belongs to
+        bool mTail;             ///< The piece after the wrap of a wrapped interval
+    };
+    /// @}
+
+    /// @name Disabled
+    /// @{
+    U33IntervalIndex(const U33IntervalIndex&);
+    U33IntervalIndex& operator=(const U33IntervalIndex&);
+    /// @}
+
+    /// @name Helpers
+    /// @{
+    template <typename Visit> void search(const U33& first, const U33& last, Visit& visit) const;
+    void link();
+    /// @}
+
+    /// @name Variables
+    /// @{
+    std::vector<U33Interval> mIntervals;    ///< The intervals as built, by id
+    std::vector<Entry> mEntries;            ///< The pieces in start order, the implicit tree
+    unsigned int mLevels;                   ///< The levels of the tree, 0 when empty
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+constexpr U33Interval::U33Interval()
+//
+/// @brief Default constructor, the empty interval at 0
+//------------------------------------------------------------------------------
+    : mStart(),
+      mLength()
+{
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr U33Interval::U33Interval(const U33& start, const U33& end)
+//
+/// @brief Constructor, [start, end), which wraps if end is before start
+//------------------------------------------------------------------------------
+    : mStart(start),
+      mLength(end - start)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr U33Interval U33Interval::fromLength(const U33& start, const U33& length)
+//
+/// @brief The interval of length ticks from start
+//------------------------------------------------------------------------------
+{
+    return U33Interval(start, start + length);
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr bool U33Interval::contains(const U33& point) const
+//
+/// @brief Whether point is in the interval
+//------------------------------------------------------------------------------
+{
+    return (point - mStart) < mLength;
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr bool U33Interval::contains(const U33Interval& other) const
+//
+/// @brief Whether all of other is in the interval, true for an empty other
+//------------------------------------------------------------------------------
+{
+    const U33 offset = other.mStart - mStart;
+
+    return other.isEmpty() || ((offset < mLength) && (other.mLength <= mLength - offset));
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr bool U33Interval::overlaps(const U33Interval& other) const
+//
+/// @brief Whether the intervals share a tick
+//------------------------------------------------------------------------------
+{
+    // two arcs meet exactly when one of them starts inside the other
+    return (!other.isEmpty() && contains(other.mStart)) || (!isEmpty() && other.contains(mStart));
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr U33Interval U33Interval::intersect(const U33Interval& other) const
+//
+/// @brief The ticks in both intervals, empty if they do not overlap
+///
+/// Two intervals that cover more than 2^33 ticks between them can meet in
+/// two pieces, at each other's starts; the piece from other's start is
+/// returned then.
+//------------------------------------------------------------------------------
+{
+    if (!other.isEmpty() && contains(other.mStart))
+    {
+        const U33 room = mLength - (other.mStart - mStart);
+        return fromLength(other.mStart, (other.mLength < room) ? other.mLength : room);
+    }
+
+    if (!isEmpty() && other.contains(mStart))
+    {
+        const U33 room = other.mLength - (mStart - other.mStart);
+        return fromLength(mStart, (mLength < room) ? mLength : room);
+    }
+
+    return U33Interval();
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr U33Interval U33Interval::unite(const U33Interval& other) const
+//
+/// @brief The shortest interval holding both, their union when they overlap
+/// or touch
+///
+/// The shortest cover starts at one of the two starts. If both intervals
+/// together need the whole circle the result is the 2^33 - 1 ticks from
+/// this start.
+//------------------------------------------------------------------------------
+{
+    if (other.isEmpty())
+    {
+        return *this;
+    }
+
+    if (isEmpty())
+    {
+        return other;
+    }
+
+    // a cover from one start runs to the far end of the other interval,
+    // which must not pass 2^33 - 1 ticks
+    const U33 ahead  = other.mStart - mStart;
+    const U33 behind = mStart - other.mStart;
+    const U33 most   = ~U33();
+
+    const U33 fromThis  = (other.mLength > most - ahead)  ? most :
+                          (ahead + other.mLength < mLength) ? mLength : ahead + other.mLength;
+    const U33 fromOther = (mLength > most - behind) ? most :
+                          (behind + mLength < other.mLength) ? other.mLength : behind + mLength;
+
+    return (fromOther < fromThis) ? fromLength(other.mStart, fromOther) : fromLength(mStart, fromThis);
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr bool U33Interval::operator==(const U33Interval& rhs) const
+//
+/// @brief Equality operator, same start and length
+//------------------------------------------------------------------------------
+{
+    return (mStart == rhs.mStart) && (mLength == rhs.mLength);
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr bool U33Interval::operator!=(const U33Interval& rhs) const
+//
+/// @brief Inequality operator
+//------------------------------------------------------------------------------
+{
+    return !(*this == rhs);
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr const U33& U33Interval::getStart() const
+//
+/// @brief Get the first tick
+//------------------------------------------------------------------------------
+{
+    return mStart;
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr U33 U33Interval::getEnd() const
+//
+/// @brief Get the tick after the last, mod 2^33
+//------------------------------------------------------------------------------
+{
+    return mStart + mLength;
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr const U33& U33Interval::getLength() const
+//
+/// @brief Get the number of ticks
+//------------------------------------------------------------------------------
+{
+    return mLength;
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr bool U33Interval::isEmpty() const
+//
+/// @brief Whether the interval has no ticks
+//------------------------------------------------------------------------------
+{
+    return mLength == U33();
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr bool U33Interval::isWrapped() const
+//
+/// @brief Whether the interval runs past 2^33 - 1 and on from 0
+//------------------------------------------------------------------------------
+{
+    // the room left before the wrap is 2^33 - start
+    return (mStart != U33()) && (mLength > U33() - mStart);
+}
+
+#endif // OMATH_U33INTERVAL_H
@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Lanes.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_U33LANES_H
+#define OMATH_U33LANES_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstring>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33.h"
+
+//------------------------------------------------------------------------------
+//
+class U33Lanes
+//
+/// @name Lane Access for the U33Batch and U33Reduce Kernels
+///
+/// The kernels treat an array of U33 as 64 bit lanes of two words, in
+/// whichever layout U33 stores. They reach those words through the bytes
+/// of the array, with unaligned vector loads / stores or getWord, so no
+/// unsigned int lvalue ever aliases U33 storage.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Access
+    /// @{
+    static const char* bytes(const U33* values);
+    static char* bytes(U33* values);
+    static unsigned int getWord(const char* bytes, std::size_t index);
+    /// @}
+};
+
+//==============================================================================
+// U33Lanes
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+inline const char* U33Lanes::bytes(const U33* values)
+//
+/// @brief The bytes of an array of U33
+//------------------------------------------------------------------------------
+{
+    return reinterpret_cast<const char*>(values);
+}
+
+//------------------------------------------------------------------------------
+//
+inline char* U33Lanes::bytes(U33* values)
+//
+/// @brief The bytes of an array of U33
+//------------------------------------------------------------------------------
+{
+    return reinterpret_cast<char*>(values);
+}
+
+//------------------------------------------------------------------------------
+//
+inline unsigned int U33Lanes::getWord(const char* bytes, std::size_t index)
+//
+/// @brief Word index of the lane words starting at bytes
+//------------------------------------------------------------------------------
+{
+    unsigned int word;
+    std::memcpy(&word, bytes + (index * sizeof(word)), sizeof(word));
+
+    return word;
+}
+
+#endif // OMATH_U33LANES_H
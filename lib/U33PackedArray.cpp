@@ -0,0 +1,456 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33PackedArray.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <stdexcept>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define OMATH_PACKED_X86
+#include <immintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33Batch.h"
+#include "U33PackedArray.h"
+
+/// @name Constants
+/// @{
+static const unsigned int SIGN_BIT(0x80000000);
+/// @}
+
+/// @name Types
+/// @{
+typedef std::size_t (*LessKernel)(const unsigned int* lsb32, const unsigned int* msb,
+                                  std::size_t words, const U33& limit);
+
+struct LessKernels
+{
+    LessKernel mSse2;
+    LessKernel mAvx2;
+};
+/// @}
+
+#if defined(OMATH_PACKED_X86)
+
+//==============================================================================
+// Kernels
+//
+// Compare the lower words of one plane word's 32 values against the limit's,
+// signed after flipping the sign bit, and gather the results into a mask.
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+static unsigned int popCount(unsigned int bits)
+//
+/// @brief The number of set bits
+//------------------------------------------------------------------------------
+{
+    bits = bits - ((bits >> 1) & 0x55555555);
+    bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+    bits = (bits + (bits >> 4)) & 0x0f0f0f0f;
+
+    return ((bits * 0x01010101) >> 24);
+}
+
+//------------------------------------------------------------------------------
+//
+static unsigned int countBelow(unsigned int plane, unsigned int below, const U33& limit)
+//
+/// @brief The number of the 32 values in one plane word less than limit
+///
+/// below has bit i set where lsb32 of value i is less than that of limit.
+/// With bit 32 of limit set a value is less when its bit 32 is clear or
+/// its lower word is less, with it clear only when both hold.
+//------------------------------------------------------------------------------
+{
+    return popCount(limit.getMsb() ? (~plane | below) : (~plane & below));
+}
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("sse2")))
+std::size_t lessSse2(const unsigned int* lsb32, const unsigned int* msb,
+                     std::size_t words, const U33& limit)
+//
+/// @brief The number of values less than limit in whole plane words
+//------------------------------------------------------------------------------
+{
+    const __m128i sign  = _mm_set1_epi32(static_cast<int>(SIGN_BIT));
+    const __m128i lower = _mm_set1_epi32(static_cast<int>(limit.getLsb32() ^ SIGN_BIT));
+
+    std::size_t count(0);
+    for (std::size_t word = 0; word < words; ++word)
+    {
+        const __m128i* block = reinterpret_cast<const __m128i*>(lsb32 + (word * 32));
+        unsigned int below(0);
+
+        for (unsigned int i = 0; i < 8; ++i)
+        {
+            const __m128i value = _mm_xor_si128(_mm_loadu_si128(block + i), sign);
+            const int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(value, lower)));
+            below |= static_cast<unsigned int>(mask) << (4 * i);
+        }
+
+        count += countBelow(msb[word], below, limit);
+    }
+
+    return count;
+}
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("avx2")))
+std::size_t lessAvx2(const unsigned int* lsb32, const unsigned int* msb,
+                     std::size_t words, const U33& limit)
+//
+/// @brief The number of values less than limit in whole plane words
+//------------------------------------------------------------------------------
+{
+    const __m256i sign  = _mm256_set1_epi32(static_cast<int>(SIGN_BIT));
+    const __m256i lower = _mm256_set1_epi32(static_cast<int>(limit.getLsb32() ^ SIGN_BIT));
+
+    std::size_t count(0);
+    for (std::size_t word = 0; word < words; ++word)
+    {
+        const __m256i* block = reinterpret_cast<const __m256i*>(lsb32 + (word * 32));
+        unsigned int below(0);
+
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            const __m256i value = _mm256_xor_si256(_mm256_loadu_si256(block + i), sign);
+            const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(lower, value)));
+            below |= static_cast<unsigned int>(mask) << (8 * i);
+        }
+
+        count += countBelow(msb[word], below, limit);
+    }
+
+    return count;
+}
+
+/// @name Kernel Tables
+/// @{
+static const LessKernels LESS_KERNELS = { lessSse2, lessAvx2 };
+/// @}
+
+#else
+
+/// @name Kernel Tables
+/// @{
+static const LessKernels LESS_KERNELS = { 0, 0 };
+/// @}
+
+#endif // OMATH_PACKED_X86
+
+//------------------------------------------------------------------------------
+//
+static std::size_t lessScalar(const unsigned int* lsb32, const unsigned int* msb,
+                              std::size_t words, const U33& limit)
+//
+/// @brief The number of values less than limit in whole plane words
+//------------------------------------------------------------------------------
+{
+    // msb first, then the low word on a tie; bitwise so it stays branch free
+    const unsigned int limitMsb = limit.getMsb();
+    const unsigned int limitLsb32 = limit.getLsb32();
+
+    std::size_t count(0);
+    for (std::size_t word = 0; word < words; ++word)
+    {
+        const unsigned int* block = lsb32 + (word * 32);
+        unsigned int bits = msb[word];
+
+        for (unsigned int i = 0; i < 32; ++i)
+        {
+            const unsigned int high = bits & 1;
+            count += ((high < limitMsb) | ((high == limitMsb) & (block[i] < limitLsb32))) ? 1 : 0;
+            bits >>= 1;
+        }
+    }
+
+    return count;
+}
+
+//------------------------------------------------------------------------------
+//
+U33PackedArray::U33PackedArray()
+//
+/// @brief Default Constructor
+//------------------------------------------------------------------------------
+    : mLsb32()
+    , mMsb()
+{
+}
+
+//------------------------------------------------------------------------------
+//
+U33PackedArray::U33PackedArray(std::size_t count, const U33& value)
+//
+/// @brief Fill Constructor
+//------------------------------------------------------------------------------
+    : mLsb32()
+    , mMsb()
+{
+    resize(count, value);
+}
+
+//------------------------------------------------------------------------------
+//
+U33PackedArray::U33PackedArray(const U33* values, std::size_t count)
+//
+/// @brief Copy Constructor from an array of U33
+//------------------------------------------------------------------------------
+    : mLsb32()
+    , mMsb()
+{
+    append(values, count);
+}
+
+//------------------------------------------------------------------------------
+//
+std::size_t U33PackedArray::capacity() const
+//
+/// @brief The number of values that fit without reallocating
+//------------------------------------------------------------------------------
+{
+    return mLsb32.capacity();
+}
+
+//------------------------------------------------------------------------------
+//
+std::size_t U33PackedArray::memoryBytes() const
+//
+/// @brief The number of bytes of element storage in use
+//------------------------------------------------------------------------------
+{
+    return ((mLsb32.size() + mMsb.size()) * sizeof(unsigned int));
+}
+
+//------------------------------------------------------------------------------
+//
+void U33PackedArray::reserve(std::size_t count)
+//
+/// @brief Reserve room for count values
+//------------------------------------------------------------------------------
+{
+    mLsb32.reserve(count);
+    mMsb.reserve(planeWords(count));
+}
+
+//------------------------------------------------------------------------------
+//
+void U33PackedArray::resize(std::size_t count, const U33& value)
+//
+/// @brief Grow with copies of value, or shrink to count values
+//------------------------------------------------------------------------------
+{
+    const std::size_t current = size();
+
+    if (count > current)
+    {
+        mLsb32.resize(count, value.getLsb32());
+        mMsb.resize(planeWords(count), 0);
+
+        if (value.getMsb())
+        {
+            for (std::size_t index = current; index < count; ++index)
+            {
+                mMsb[index / 32] |= 1u << (index % 32);
+            }
+        }
+    }
+    else
+    {
+        mLsb32.resize(count);
+        mMsb.resize(planeWords(count));
+
+        // keep the unused plane bits clear for push_back
+        if (count % 32)
+        {
+            mMsb.back() &= (1u << (count % 32)) - 1;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33PackedArray::clear()
+//
+/// @brief Remove every value
+//------------------------------------------------------------------------------
+{
+    mLsb32.clear();
+    mMsb.clear();
+}
+
+//------------------------------------------------------------------------------
+//
+U33 U33PackedArray::at(std::size_t index) const
+//
+/// @brief Checked element read
+//------------------------------------------------------------------------------
+{
+    if (index >= size())
+    {
+        throw std::out_of_range("U33PackedArray::at");
+    }
+
+    return (*this)[index];
+}
+
+//------------------------------------------------------------------------------
+//
+void U33PackedArray::append(const U33* values, std::size_t count)
+//
+/// @brief Append count values
+//------------------------------------------------------------------------------
+{
+    const std::size_t first = size();
+
+    mLsb32.resize(first + count);
+    mMsb.resize(planeWords(first + count), 0);
+
+    unsigned int* lsb32 = mLsb32.data() + first;
+    unsigned int* msb   = mMsb.data();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        lsb32[i] = values[i].getLsb32();
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const std::size_t index = first + i;
+        msb[index / 32] |= (values[i].getMsb() ? 1u : 0u) << (index % 32);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33PackedArray::appendWords(const unsigned int* lsb32, std::size_t count, bool msb)
+//
+/// @brief Append count values from their lower 32 bits, all sharing bit 32
+//------------------------------------------------------------------------------
+{
+    const std::size_t first = size();
+
+    mLsb32.insert(mLsb32.end(), lsb32, lsb32 + count);
+    mMsb.resize(planeWords(first + count), 0);
+
+    if (msb)
+    {
+        for (std::size_t index = first; index < first + count; ++index)
+        {
+            mMsb[index / 32] |= 1u << (index % 32);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33PackedArray::assign(const U33* values, std::size_t count)
+//
+/// @brief Replace the contents with count values
+//------------------------------------------------------------------------------
+{
+    clear();
+    append(values, count);
+}
+
+//------------------------------------------------------------------------------
+//
+void U33PackedArray::copyTo(std::size_t first, std::size_t count, U33* out) const
+//
+/// @brief Unpack values [first, first + count) into out
+//------------------------------------------------------------------------------
+{
+    const unsigned int* lsb32 = mLsb32.data();
+    const unsigned int* msb   = mMsb.data();
+    const std::size_t last    = first + count;
+
+    // one plane word per 32 values, shifted down in a register
+    std::size_t index = first;
+    while (index < last)
+    {
+        const std::size_t end  = ((index / 32) + 1) * 32;
+        const std::size_t stop = (end < last) ? end : last;
+        unsigned int bits = msb[index / 32] >> (index % 32);
+
+        for (; index < stop; ++index)
+        {
+            *out++ = U33(bits & 1, lsb32[index]);
+            bits >>= 1;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+std::vector<U33> U33PackedArray::toVector() const
+//
+/// @brief Unpack every value
+//------------------------------------------------------------------------------
+{
+    std::vector<U33> values(size());
+
+    copyTo(0, values.size(), values.data());
+
+    return values;
+}
+
+//------------------------------------------------------------------------------
+//
+std::size_t U33PackedArray::countLess(const U33& limit) const
+//
+/// @brief The number of values less than limit
+///
+/// Compares 32 lower words at a time with the widest instruction set
+/// U33Batch allows and combines them with the plane word, no U33 is built.
+//------------------------------------------------------------------------------
+{
+    const std::size_t words = size() / 32;
+    std::size_t count(0);
+
+    switch (U33Batch::getIsa())
+    {
+        case U33Batch::ISA_AVX2: count = LESS_KERNELS.mAvx2(mLsb32.data(), mMsb.data(), words, limit); break;
+        case U33Batch::ISA_SSE2: count = LESS_KERNELS.mSse2(mLsb32.data(), mMsb.data(), words, limit); break;
+        default:                 count = lessScalar(mLsb32.data(), mMsb.data(), words, limit);         break;
+    }
+
+    // then the partial word
+    for (std::size_t index = words * 32; index < size(); ++index)
+    {
+        count += ((*this)[index] < limit) ? 1 : 0;
+    }
+
+    return count;
+}
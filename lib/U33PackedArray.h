@@ -0,0 +1,690 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33PackedArray.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_U33PACKEDARRAY_H
+#define OMATH_U33PACKEDARRAY_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33.h"
+
+//------------------------------------------------------------------------------
+//
+class U33PackedArray
+//
+/// @name Bit Packed Array of U33
+///
+/// Holds the lower 32 bits of every value in one dense word array and bit 32
+/// in a separate plane of one bit per value, 4.125 bytes per element rather
+/// than sizeof(U33). Elements are read and written by value.
+///
+/// Scans that only compare or filter should use forEachWord, countIf or
+/// countLess, which work on the words directly instead of building a U33 per
+/// value.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Iteration
+    /// @{
+    class ConstIterator;
+    typedef ConstIterator const_iterator;
+    /// @}
+
+    /// @name Construction / Destruction
+    /// @{
+    U33PackedArray();
+    explicit U33PackedArray(std::size_t count, const U33& value=U33());
+    U33PackedArray(const U33* values, std::size_t count);
+    /// @}
+
+    /// @name Size
+    /// @{
+    std::size_t size() const;
+    bool empty() const;
+    std::size_t capacity() const;
+    std::size_t memoryBytes() const;
+    void reserve(std::size_t count);
+    void resize(std::size_t count, const U33& value=U33());
+    void clear();
+    /// @}
+
+    /// @name Element Access
+    /// @{
+    U33 operator[](std::size_t index) const;
+    U33 at(std::size_t index) const;
+    void set(std::size_t index, const U33& value);
+    bool getMsb(std::size_t index) const;
+    const unsigned int* lsb32Data() const;
+    const unsigned int* msbPlaneData() const;
+    /// @}
+
+    /// @name Modifiers
+    /// @{
+    void push_back(const U33& value);
+    void append(const U33* values, std::size_t count);
+    void appendWords(const unsigned int* lsb32, std::size_t count, bool msb);
+    void assign(const U33* values, std::size_t count);
+    /// @}
+
+    /// @name Bulk Conversion
+    /// @{
+    void copyTo(std::size_t first, std::size_t count, U33* out) const;
+    std::vector<U33> toVector() const;
+    /// @}
+
+    /// @name Iteration
+    /// @{
+    ConstIterator begin() const;
+    ConstIterator end() const;
+    template <typename Function> void forEach(Function function) const;
+    template <typename Visitor> void forEachWord(Visitor visitor) const;
+    /// @}
+
+    /// @name Counting
+    /// @{
+    template <typename Predicate> std::size_t countIf(Predicate predicate) const;
+    std::size_t countLess(const U33& limit) const;
+    /// @}
+
+private:
+
+    /// @name Helpers
+    /// @{
+    static std::size_t planeWords(std::size_t count);
+    /// @}
+
+    /// @name Variables
+    /// @{
+    std::vector<unsigned int> mLsb32;   ///< The lower 32 bits of each value
+    std::vector<unsigned int> mMsb;     ///< Bit 32 of each value, 32 per word
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+class U33PackedArray::ConstIterator
+//
+/// @name Random access iterator yielding U33 values
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Iterator Traits
+    /// @{
+    class Pointer;
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef U33                             value_type;
+    typedef std::ptrdiff_t                  difference_type;
+    typedef Pointer                         pointer;
+    typedef U33                             reference;
+    /// @}
+
+    /// @name Construction / Destruction
+    /// @{
+    ConstIterator();
+    ConstIterator(const unsigned int* lsb32, const unsigned int* msb, std::size_t index);
+    /// @}
+
+    /// @name Access
+    /// @{
+    U33 operator*() const;
+    Pointer operator->() const;
+    U33 operator[](difference_type offset) const;
+    /// @}
+
+    /// @name Movement
+    /// @{
+    ConstIterator& operator++();
+    ConstIterator operator++(int);
+    ConstIterator& operator--();
+    ConstIterator operator--(int);
+    ConstIterator& operator+=(difference_type offset);
+    ConstIterator& operator-=(difference_type offset);
+    ConstIterator operator+(difference_type offset) const;
+    ConstIterator operator-(difference_type offset) const;
+    difference_type operator-(const ConstIterator& ref) const;
+    /// @}
+
+    /// @name Equality / Inequality Methods
+    /// @{
+    bool operator==(const ConstIterator& ref) const;
+    bool operator!=(const ConstIterator& ref) const;
+    bool operator< (const ConstIterator& ref) const;
+    bool operator<=(const ConstIterator& ref) const;
+    bool operator> (const ConstIterator& ref) const;
+    bool operator>=(const ConstIterator& ref) const;
+    /// @}
+
+private:
+
+    /// @name Variables
+    /// @{
+    const unsigned int* mLsb32;     ///< The array's lower 32 bit words
+    const unsigned int* mMsb;       ///< The array's bit 32 plane
+    std::size_t mIndex;             ///< The current element
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+class U33PackedArray::ConstIterator::Pointer
+//
+/// @name The result of ConstIterator::operator->, holding the value read
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Construction / Destruction
+    /// @{
+    explicit Pointer(const U33& value);
+    /// @}
+
+    /// @name Access
+    /// @{
+    const U33* operator->() const;
+    /// @}
+
+private:
+
+    /// @name Variables
+    /// @{
+    U33 mValue;     ///< The element pointed at
+    /// @}
+};
+
+//==============================================================================
+// U33PackedArray
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+inline std::size_t U33PackedArray::planeWords(std::size_t count)
+//
+/// @brief The number of msb plane words needed for count values
+//------------------------------------------------------------------------------
+{
+    return ((count + 31) / 32);
+}
+
+//------------------------------------------------------------------------------
+//
+inline std::size_t U33PackedArray::size() const
+//
+/// @brief The number of values held
+//------------------------------------------------------------------------------
+{
+    return mLsb32.size();
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33PackedArray::empty() const
+//
+/// @brief True when no values are held
+//------------------------------------------------------------------------------
+{
+    return mLsb32.empty();
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 U33PackedArray::operator[](std::size_t index) const
+//
+/// @brief Unchecked element read
+//------------------------------------------------------------------------------
+{
+    return U33((mMsb[index / 32] >> (index % 32)) & 1, mLsb32[index]);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33PackedArray::getMsb(std::size_t index) const
+//
+/// @brief Unchecked read of bit 32 alone
+//------------------------------------------------------------------------------
+{
+    return (((mMsb[index / 32] >> (index % 32)) & 1) != 0);
+}
+
+//------------------------------------------------------------------------------
+//
+inline void U33PackedArray::set(std::size_t index, const U33& value)
+//
+/// @brief Unchecked element write
+//------------------------------------------------------------------------------
+{
+    const unsigned int bit = 1u << (index % 32);
+    unsigned int& word = mMsb[index / 32];
+
+    mLsb32[index] = value.getLsb32();
+    word = (word & ~bit) | (value.getMsb() ? bit : 0);
+}
+
+//------------------------------------------------------------------------------
+//
+inline void U33PackedArray::push_back(const U33& value)
+//
+/// @brief Append a single value
+//------------------------------------------------------------------------------
+{
+    const std::size_t index = mLsb32.size();
+
+    if ((index % 32) == 0)
+    {
+        mMsb.push_back(0);
+    }
+
+    mLsb32.push_back(value.getLsb32());
+    mMsb.back() |= (value.getMsb() ? 1u : 0u) << (index % 32);
+}
+
+//------------------------------------------------------------------------------
+//
+inline const unsigned int* U33PackedArray::lsb32Data() const
+//
+/// @brief The lower 32 bit word array, one word per value
+//------------------------------------------------------------------------------
+{
+    return mLsb32.data();
+}
+
+//------------------------------------------------------------------------------
+//
+inline const unsigned int* U33PackedArray::msbPlaneData() const
+//
+/// @brief The bit 32 plane, value i is bit (i % 32) of word (i / 32)
+//------------------------------------------------------------------------------
+{
+    return mMsb.data();
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator U33PackedArray::begin() const
+//
+/// @brief Iterator to the first value
+//------------------------------------------------------------------------------
+{
+    return ConstIterator(mLsb32.data(), mMsb.data(), 0);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator U33PackedArray::end() const
+//
+/// @brief Iterator past the last value
+//------------------------------------------------------------------------------
+{
+    return ConstIterator(mLsb32.data(), mMsb.data(), size());
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Function>
+inline void U33PackedArray::forEach(Function function) const
+//
+/// @brief Call function(const U33&) for every value in order
+//------------------------------------------------------------------------------
+{
+    forEachWord([&function](unsigned int msb, unsigned int lsb32)
+    {
+        function(U33(msb, lsb32));
+    });
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Visitor>
+inline void U33PackedArray::forEachWord(Visitor visitor) const
+//
+/// @brief Call visitor(unsigned int msb, unsigned int lsb32) for every value
+///        in order, msb being bit 32 (0 or 1) and lsb32 the lower word
+///
+/// The fastest general sequential scan: each plane word is loaded once and
+/// shifted down in a register rather than indexed per value.
+//------------------------------------------------------------------------------
+{
+    const unsigned int* lsb32 = mLsb32.data();
+    const unsigned int* msb   = mMsb.data();
+    const std::size_t words   = size() / 32;
+
+    // whole plane words with a fixed trip count
+    for (std::size_t word = 0; word < words; ++word)
+    {
+        const unsigned int* block = lsb32 + (word * 32);
+        unsigned int bits = msb[word];
+
+        for (unsigned int i = 0; i < 32; ++i)
+        {
+            visitor(bits & 1, block[i]);
+            bits >>= 1;
+        }
+    }
+
+    // then the partial word
+    const std::size_t tail = size() % 32;
+    if (tail)
+    {
+        const unsigned int* block = lsb32 + (words * 32);
+        unsigned int bits = msb[words];
+
+        for (std::size_t i = 0; i < tail; ++i)
+        {
+            visitor(bits & 1, block[i]);
+            bits >>= 1;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Predicate>
+inline std::size_t U33PackedArray::countIf(Predicate predicate) const
+//
+/// @brief The number of values for which predicate(unsigned int msb,
+///        unsigned int lsb32) is true, see forEachWord
+//------------------------------------------------------------------------------
+{
+    std::size_t count(0);
+
+    forEachWord([&count, &predicate](unsigned int msb, unsigned int lsb32)
+    {
+        count += predicate(msb, lsb32) ? 1 : 0;
+    });
+
+    return count;
+}
+
+//==============================================================================
+// U33PackedArray::ConstIterator
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator::ConstIterator()
+//
+/// @brief Default Constructor
+//------------------------------------------------------------------------------
+    : mLsb32(0)
+    , mMsb(0)
+    , mIndex(0)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator::ConstIterator(const unsigned int* lsb32,
+                                                    const unsigned int* msb,
+                                                    std::size_t index)
+//
+/// @brief Constructor
+//------------------------------------------------------------------------------
+    : mLsb32(lsb32)
+    , mMsb(msb)
+    , mIndex(index)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 U33PackedArray::ConstIterator::operator*() const
+//
+/// @brief Dereference Operator
+//------------------------------------------------------------------------------
+{
+    return U33((mMsb[mIndex / 32] >> (mIndex % 32)) & 1, mLsb32[mIndex]);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator::Pointer U33PackedArray::ConstIterator::operator->() const
+//
+/// @brief Member Access Operator, through a copy of the element
+//------------------------------------------------------------------------------
+{
+    return Pointer(**this);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 U33PackedArray::ConstIterator::operator[](difference_type offset) const
+//
+/// @brief Subscript Operator
+//------------------------------------------------------------------------------
+{
+    const std::size_t index = mIndex + offset;
+    return U33((mMsb[index / 32] >> (index % 32)) & 1, mLsb32[index]);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator& U33PackedArray::ConstIterator::operator++()
+//
+/// @brief Pre Increment Operator
+//------------------------------------------------------------------------------
+{
+    ++mIndex;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator U33PackedArray::ConstIterator::operator++(int)
+//
+/// @brief Post Increment Operator
+//------------------------------------------------------------------------------
+{
+    const ConstIterator previous(*this);
+    ++mIndex;
+    return previous;
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator& U33PackedArray::ConstIterator::operator--()
+//
+/// @brief Pre Decrement Operator
+//------------------------------------------------------------------------------
+{
+    --mIndex;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator U33PackedArray::ConstIterator::operator--(int)
+//
+/// @brief Post Decrement Operator
+//------------------------------------------------------------------------------
+{
+    const ConstIterator previous(*this);
+    --mIndex;
+    return previous;
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator&
+U33PackedArray::ConstIterator::operator+=(difference_type offset)
+//
+/// @brief Addition Equals Operator
+//------------------------------------------------------------------------------
+{
+    mIndex += offset;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator&
+U33PackedArray::ConstIterator::operator-=(difference_type offset)
+//
+/// @brief Subtraction Equals Operator
+//------------------------------------------------------------------------------
+{
+    mIndex -= offset;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator
+U33PackedArray::ConstIterator::operator+(difference_type offset) const
+//
+/// @brief Addition Operator
+//------------------------------------------------------------------------------
+{
+    return ConstIterator(mLsb32, mMsb, mIndex + offset);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator
+U33PackedArray::ConstIterator::operator-(difference_type offset) const
+//
+/// @brief Subtraction Operator
+//------------------------------------------------------------------------------
+{
+    return ConstIterator(mLsb32, mMsb, mIndex - offset);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator::difference_type
+U33PackedArray::ConstIterator::operator-(const ConstIterator& ref) const
+//
+/// @brief Distance Operator
+//------------------------------------------------------------------------------
+{
+    return static_cast<difference_type>(mIndex) - static_cast<difference_type>(ref.mIndex);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33PackedArray::ConstIterator::operator==(const ConstIterator& ref) const
+//
+/// @brief Equality Operator
+//------------------------------------------------------------------------------
+{
+    return (mIndex == ref.mIndex);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33PackedArray::ConstIterator::operator!=(const ConstIterator& ref) const
+//
+/// @brief Inequality Operator
+//------------------------------------------------------------------------------
+{
+    return (mIndex != ref.mIndex);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33PackedArray::ConstIterator::operator<(const ConstIterator& ref) const
+//
+/// @brief Less Than Operator
+//------------------------------------------------------------------------------
+{
+    return (mIndex < ref.mIndex);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33PackedArray::ConstIterator::operator<=(const ConstIterator& ref) const
+//
+/// @brief Less Than Equals Operator
+//------------------------------------------------------------------------------
+{
+    return (mIndex <= ref.mIndex);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33PackedArray::ConstIterator::operator>(const ConstIterator& ref) const
+//
+/// @brief More Than Operator
+//------------------------------------------------------------------------------
+{
+    return (mIndex > ref.mIndex);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33PackedArray::ConstIterator::operator>=(const ConstIterator& ref) const
+//
+/// @brief More Than Equals Operator
+//------------------------------------------------------------------------------
+{
+    return (mIndex >= ref.mIndex);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator
+operator+(U33PackedArray::ConstIterator::difference_type offset,
+          const U33PackedArray::ConstIterator& ref)
+//
+/// @brief Addition Operator, offset + iterator
+//------------------------------------------------------------------------------
+{
+    return (ref + offset);
+}
+
+//==============================================================================
+// U33PackedArray::ConstIterator::Pointer
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+inline U33PackedArray::ConstIterator::Pointer::Pointer(const U33& value)
+//
+/// @brief Constructor
+//------------------------------------------------------------------------------
+    : mValue(value)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+inline const U33* U33PackedArray::ConstIterator::Pointer::operator->() const
+//
+/// @brief Member Access Operator
+//------------------------------------------------------------------------------
+{
+    return &mValue;
+}
+
+#endif // OMATH_U33PACKEDARRAY_H
@@ -0,0 +1,484 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Parallel.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33Parallel.h"
+
+/// @name Constants
+/// @{
+
+/// 4096 values, 32 KiB of U33 in and out, so a chunk stays in L1 / L2
+static const std::size_t DEFAULT_CHUNK_SIZE = 4096;
+
+/// Runs pack the next and end chunk into one 64 bit word
+static const std::size_t MAX_CHUNKS = 0xffffffff;
+
+/// Runs sit this far apart so workers don't share cache lines
+static const std::size_t CACHE_LINE = 64;
+/// @}
+
+/// @name Types
+/// @{
+
+/// The chunks [next, end) a worker has left, packed as next << 32 | end
+struct Run
+{
+    std::atomic<unsigned long long> mChunks;
+    char mPad[CACHE_LINE - sizeof(std::atomic<unsigned long long>)];
+};
+
+// C++14 new[] ignores an alignas wider than max_align_t, so it is the stride
+// that keeps the mChunks of neighbouring runs on different cache lines
+static_assert(sizeof(Run) == CACHE_LINE, "runs must be exactly one cache line apart");
+
+/// One call, shared by the calling thread and the helpers
+struct Job
+{
+    U33Parallel::ChunkBody mBody;
+    void* mContext;
+    std::size_t mCount;
+    std::size_t mChunkSize;
+    unsigned int mWorkers;
+    std::unique_ptr<Run[]> mRuns;
+    std::atomic<bool> mFailed;
+    std::mutex mErrorMutex;
+    std::exception_ptr mError;      ///< The first exception thrown
+};
+/// @}
+
+/// @name Variables
+/// @{
+static std::atomic<unsigned int> sThreads(0);       ///< The thread limit, 0 for one per core
+static std::atomic<std::size_t> sChunkSize(0);      ///< The chunk size, 0 for the default
+static thread_local bool sInside(false);            ///< Set on threads running a chunk
+/// @}
+
+//------------------------------------------------------------------------------
+//
+static unsigned long long pack(std::size_t next, std::size_t end)
+//
+/// @brief Pack a run of chunks
+//------------------------------------------------------------------------------
+{
+    return (static_cast<unsigned long long>(next) << 32) | end;
+}
+
+//------------------------------------------------------------------------------
+//
+static bool take(Run& run, std::size_t& chunk)
+//
+/// @brief Take the next chunk of the worker's own run
+/// @return False when the run is empty
+//------------------------------------------------------------------------------
+{
+    unsigned long long chunks = run.mChunks.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        const std::size_t next = static_cast<std::size_t>(chunks >> 32);
+        const std::size_t end  = static_cast<std::size_t>(chunks & 0xffffffff);
+
+        if (next >= end)
+        {
+            return false;
+        }
+
+        if (run.mChunks.compare_exchange_weak(chunks, pack(next + 1, end), std::memory_order_acq_rel))
+        {
+            chunk = next;
+            return true;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+static bool steal(Job& job, unsigned int self)
+//
+/// @brief Move the far half of the longest run left into the worker's own
+/// @return False when every run is empty
+//------------------------------------------------------------------------------
+{
+    for (;;)
+    {
+        unsigned int victim(self);
+        unsigned long long chunks(0);
+        std::size_t longest(0);
+
+        for (unsigned int i = 1; i < job.mWorkers; ++i)
+        {
+            const unsigned int other = (self + i) % job.mWorkers;
+            const unsigned long long run = job.mRuns[other].mChunks.load(std::memory_order_acquire);
+            const std::size_t next = static_cast<std::size_t>(run >> 32);
+            const std::size_t end  = static_cast<std::size_t>(run & 0xffffffff);
+
+            if ((next < end) && ((end - next) > longest))
+            {
+                victim  = other;
+                chunks  = run;
+                longest = end - next;
+            }
+        }
+
+        if (longest == 0)
+        {
+            return false;
+        }
+
+        // the owner keeps the near half, a single chunk is stolen whole
+        const std::size_t next  = static_cast<std::size_t>(chunks >> 32);
+        const std::size_t end   = static_cast<std::size_t>(chunks & 0xffffffff);
+        const std::size_t split = end - ((longest + 1) / 2);
+
+        if (job.mRuns[victim].mChunks.compare_exchange_strong(chunks, pack(next, split), std::memory_order_acq_rel))
+        {
+            job.mRuns[self].mChunks.store(pack(split, end), std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+static void runChunk(Job& job, std::size_t chunk)
+//
+/// @brief Run the body over one chunk, keeping the first exception
+//------------------------------------------------------------------------------
+{
+    const std::size_t begin = chunk * job.mChunkSize;
+    const std::size_t end   = std::min(job.mCount, begin + job.mChunkSize);
+
+    try
+    {
+        job.mBody(job.mContext, chunk, begin, end);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(job.mErrorMutex);
+
+        if (!job.mError)
+        {
+            job.mError = std::current_exception();
+        }
+
+        job.mFailed.store(true, std::memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+static void work(Job& job, unsigned int self)
+//
+/// @brief One worker's share of a job: its own run, then whatever it steals
+//------------------------------------------------------------------------------
+{
+    std::size_t chunk(0);
+
+    do
+    {
+        while (!job.mFailed.load(std::memory_order_relaxed) && take(job.mRuns[self], chunk))
+        {
+            runChunk(job, chunk);
+        }
+    }
+    while (!job.mFailed.load(std::memory_order_relaxed) && steal(job, self));
+}
+
+//------------------------------------------------------------------------------
+//
+class Pool
+//
+/// @name The helper threads, started on first use and kept until exit
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Construction / Destruction
+    /// @{
+    Pool();
+    ~Pool();
+    /// @}
+
+    /// @name Running
+    /// @{
+    void run(Job& job);
+    /// @}
+
+private:
+
+    /// @name Helpers
+    /// @{
+    void helper(unsigned int self);
+    /// @}
+
+    /// @name Variables
+    /// @{
+    std::mutex mRunMutex;               ///< One job at a time
+    std::mutex mMutex;                  ///< Guards the rest
+    std::condition_variable mWake;      ///< A job was posted, or stop
+    std::condition_variable mDone;      ///< The last helper finished
+    std::vector<std::thread> mThreads;
+    Job* mJob;
+    unsigned long long mGeneration;     ///< Counts the jobs posted
+    unsigned int mActive;               ///< Helpers still on the job
+    bool mStop;
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+Pool::Pool()
+//
+/// @brief Constructor, no threads until the first job
+//------------------------------------------------------------------------------
+    : mJob(0),
+      mGeneration(0),
+      mActive(0),
+      mStop(false)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+Pool::~Pool()
+//
+/// @brief Destructor, stops and joins the helpers
+//------------------------------------------------------------------------------
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+
+    mWake.notify_all();
+
+    for (std::size_t i = 0; i < mThreads.size(); ++i)
+    {
+        mThreads[i].join();
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void Pool::run(Job& job)
+//
+/// @brief Run a job on the calling thread (worker 0) and job.mWorkers - 1
+/// helpers, returning once every chunk is done
+//------------------------------------------------------------------------------
+{
+    std::lock_guard<std::mutex> runLock(mRunMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        // helper i is worker i, start any that are missing
+        while (mThreads.size() + 1 < job.mWorkers)
+        {
+            mThreads.push_back(std::thread(&Pool::helper, this, static_cast<unsigned int>(mThreads.size() + 1)));
+        }
+
+        mJob    = &job;
+        mActive = job.mWorkers - 1;
+        ++mGeneration;
+    }
+
+    mWake.notify_all();
+
+    sInside = true;
+    work(job, 0);
+    sInside = false;
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDone.wait(lock, [this] { return (mActive == 0); });
+    mJob = 0;
+}
+
+//------------------------------------------------------------------------------
+//
+void Pool::helper(unsigned int self)
+//
+/// @brief Helper thread body, joins each job that has work for it
+//------------------------------------------------------------------------------
+{
+    sInside = true;
+
+    unsigned long long seen(0);
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    for (;;)
+    {
+        mWake.wait(lock, [&] { return mStop || ((mJob != 0) && (mGeneration != seen)); });
+
+        if (mStop)
+        {
+            return;
+        }
+
+        seen = mGeneration;
+        Job& job = *mJob;
+
+        if (self < job.mWorkers)
+        {
+            lock.unlock();
+            work(job, self);
+            lock.lock();
+
+            if (--mActive == 0)
+            {
+                mDone.notify_all();
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+static Pool& pool()
+//
+/// @brief The shared pool
+//------------------------------------------------------------------------------
+{
+    static Pool sPool;
+    return sPool;
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Parallel::run(std::size_t count, ChunkBody body, void* context)
+//
+/// @brief body(context, chunk, begin, end) over every chunk of count
+/// indexes, the type erased core of the loops
+//------------------------------------------------------------------------------
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // only a huge count grows the chunks, so the boundaries stay fixed
+    std::size_t size = getChunkSize();
+    size = std::max(size, ((count - 1) / MAX_CHUNKS) + 1);
+
+    const std::size_t chunks  = ((count - 1) / size) + 1;
+    const unsigned int workers = static_cast<unsigned int>(std::min<std::size_t>(getThreads(), chunks));
+
+    if ((workers == 1) || sInside)
+    {
+        for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            body(context, chunk, chunk * size, std::min(count, (chunk + 1) * size));
+        }
+
+        return;
+    }
+
+    Job job;
+    job.mBody      = body;
+    job.mContext   = context;
+    job.mCount     = count;
+    job.mChunkSize = size;
+    job.mWorkers   = workers;
+    job.mRuns.reset(new Run[workers]);
+    job.mFailed.store(false, std::memory_order_relaxed);
+
+    // equal runs to start with, stealing evens out the rest
+    for (unsigned int i = 0; i < workers; ++i)
+    {
+        job.mRuns[i].mChunks.store(pack((chunks * i) / workers, (chunks * (i + 1)) / workers),
+                                   std::memory_order_relaxed);
+    }
+
+    pool().run(job);
+
+    if (job.mError)
+    {
+        std::rethrow_exception(job.mError);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+unsigned int U33Parallel::getThreads()
+//
+/// @brief The most threads a call will use, including the caller
+//------------------------------------------------------------------------------
+{
+    const unsigned int threads = sThreads.load(std::memory_order_relaxed);
+
+    return threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+//------------------------------------------------------------------------------
+//
+unsigned int U33Parallel::setThreads(unsigned int threads)
+//
+/// @brief Limit the threads a call will use, 0 for one per core
+/// @return The resulting limit
+//------------------------------------------------------------------------------
+{
+    sThreads.store(threads, std::memory_order_relaxed);
+
+    return getThreads();
+}
+
+//------------------------------------------------------------------------------
+//
+std::size_t U33Parallel::getChunkSize()
+//
+/// @brief The values per chunk
+//------------------------------------------------------------------------------
+{
+    const std::size_t size = sChunkSize.load(std::memory_order_relaxed);
+
+    return size ? size : DEFAULT_CHUNK_SIZE;
+}
+
+//------------------------------------------------------------------------------
+//
+std::size_t U33Parallel::setChunkSize(std::size_t values)
+//
+/// @brief Set the values per chunk, 0 for the default (4096)
+/// @return The resulting chunk size
+//------------------------------------------------------------------------------
+{
+    sChunkSize.store(values, std::memory_order_relaxed);
+
+    return getChunkSize();
+}
@@ -0,0 +1,205 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Parallel.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_U33PARALLEL_H
+#define OMATH_U33PARALLEL_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <cstddef>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33.h"
+
+//------------------------------------------------------------------------------
+//
+class U33Parallel
+//
+/// @name Parallel Element Wise Transforms over U33 Arrays
+///
+/// Runs user functions (offset, rescale, clamp, remap...) over large arrays
+/// on a work stealing thread pool. The array is cut into chunks of
+/// getChunkSize() values, each worker starts on an equal run of chunks and
+/// an idle worker steals the far half of the busiest run left, so uneven
+/// functions still balance. The calling thread works too.
+///
+/// Chunk boundaries depend only on the count and the chunk size, never on
+/// the threads or the schedule. Each element (and each chunk of forChunks)
+/// is visited exactly once, so a function whose result depends only on its
+/// element, or that writes per chunk slots, gives bit identical output for
+/// any thread count. Functions are called from several threads at once so
+/// must not share unguarded state. The first exception a function throws
+/// stops the remaining chunks and is rethrown to the caller. Calls made
+/// from inside a function run on that thread alone.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Types
+    /// @{
+    typedef void (*ChunkBody)(void* context, std::size_t chunk, std::size_t begin, std::size_t end);
+    /// @}
+
+    /// @name Loops
+    /// @{
+    template <typename Function> static void transform(const U33* in, U33* out, std::size_t count,
+                                                       Function function);
+    template <typename Function> static void forEach(U33* values, std::size_t count, Function function);
+    template <typename Function> static void forChunks(std::size_t count, Function function);
+    static void run(std::size_t count, ChunkBody body, void* context);
+    /// @}
+
+    /// @name Threading
+    /// @{
+    static unsigned int getThreads();
+    static unsigned int setThreads(unsigned int threads);
+    static std::size_t getChunkSize();
+    static std::size_t setChunkSize(std::size_t values);
+    /// @}
+
+private:
+
+    /// @name Helpers
+    /// @{
+    template <typename Function> struct TransformContext;
+    template <typename Function> struct ForEachContext;
+    template <typename Function> static void transformChunk(void* context, std::size_t chunk,
+                                                            std::size_t begin, std::size_t end);
+    template <typename Function> static void forEachChunk(void* context, std::size_t chunk,
+                                                          std::size_t begin, std::size_t end);
+    template <typename Function> static void functionChunk(void* context, std::size_t chunk,
+                                                           std::size_t begin, std::size_t end);
+    /// @}
+};
+
+/// @cond
+template <typename Function>
+struct U33Parallel::TransformContext
+{
+    const U33* mIn;
+    U33* mOut;
+    Function* mFunction;
+};
+
+template <typename Function>
+struct U33Parallel::ForEachContext
+{
+    U33* mValues;
+    Function* mFunction;
+};
+/// @endcond
+
+//------------------------------------------------------------------------------
+//
+template <typename Function>
+inline void U33Parallel::transform(const U33* in, U33* out, std::size_t count, Function function)
+//
+/// @brief out[i] = function(in[i]), out may be in but must not partially
+/// overlap it
+//------------------------------------------------------------------------------
+{
+    TransformContext<Function> context = { in, out, &function };
+
+    run(count, transformChunk<Function>, &context);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Function>
+inline void U33Parallel::forEach(U33* values, std::size_t count, Function function)
+//
+/// @brief function(values[i]) in place, function takes a U33&
+//------------------------------------------------------------------------------
+{
+    ForEachContext<Function> context = { values, &function };
+
+    run(count, forEachChunk<Function>, &context);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Function>
+inline void U33Parallel::forChunks(std::size_t count, Function function)
+//
+/// @brief function(chunk, begin, end) for the chunks of count indexes, e.g.
+/// into per chunk partial results that are then combined in chunk order
+//------------------------------------------------------------------------------
+{
+    run(count, functionChunk<Function>, &function);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Function>
+inline void U33Parallel::transformChunk(void* context, std::size_t /*chunk*/,
+                                        std::size_t begin, std::size_t end)
+//
+/// @brief One chunk of transform()
+//------------------------------------------------------------------------------
+{
+    const TransformContext<Function>& transform = *static_cast<TransformContext<Function>*>(context);
+    Function& function = *transform.mFunction;
+
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        transform.mOut[i] = function(transform.mIn[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Function>
+inline void U33Parallel::forEachChunk(void* context, std::size_t /*chunk*/,
+                                      std::size_t begin, std::size_t end)
+//
+/// @brief One chunk of forEach()
+//------------------------------------------------------------------------------
+{
+    const ForEachContext<Function>& forEach = *static_cast<ForEachContext<Function>*>(context);
+    Function& function = *forEach.mFunction;
+
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        function(forEach.mValues[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Function>
+inline void U33Parallel::functionChunk(void* context, std::size_t chunk,
+                                       std::size_t begin, std::size_t end)
+//
+/// @brief One chunk of forChunks()
+//------------------------------------------------------------------------------
+{
+    (*static_cast<Function*>(context))(chunk, begin, end);
+}
+
+#endif // OMATH_U33PARALLEL_H
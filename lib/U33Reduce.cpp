@@ -0,0 +1,855 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Reduce.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define OMATH_REDUCE_X86
+#include <immintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33Batch.h"
+#include "U33Lanes.h"
+#include "U33Reduce.h"
+
+/// @name Constants
+/// @{
+static const unsigned int MASK_17BIT(0x1ffff);
+static const unsigned int MASK_16BIT(0xffff);
+static const unsigned int MASK_32BIT(0xffffffff);
+
+/// The kernels only run on the split or native layouts (see U33Batch), this
+/// picks the lane arithmetic
+static const bool NATIVE64_LAYOUT = std::is_same<U33::LayoutType, UIntNative64Layout<33> >::value;
+
+/// Blocks summed before the lsb16 lanes are folded, so they can't overflow
+static const std::size_t FOLD_BLOCKS = 1 << 15;
+
+/// Fewer values than this per thread are not worth starting a thread for
+static const std::size_t MIN_PER_THREAD = 1 << 16;
+
+/// Chunks start on a multiple of this many values, a whole AVX2 block
+static const std::size_t CHUNK_ALIGN = 4;
+/// @}
+
+/// @name Types
+/// @{
+typedef std::size_t (*SumKernel)(const char* values, std::size_t count, U33& total);
+typedef std::size_t (*ExtremeKernel)(const char* values, std::size_t count,
+                                     const char* base, U33& key);
+typedef std::size_t (*ScanKernel)(const char* in, char* out, std::size_t count,
+                                  const char* offset, U33& running);
+
+struct SumKernels
+{
+    SumKernel mSse2;
+    SumKernel mAvx2;
+};
+
+struct ExtremeKernels
+{
+    ExtremeKernel mSse2;
+    ExtremeKernel mAvx2;
+};
+
+struct ScanKernels
+{
+    ScanKernel mSse2;
+    ScanKernel mAvx2;
+};
+/// @}
+
+/// @name Variables
+/// @{
+static std::atomic<unsigned int> sThreads(0);   ///< The thread limit, 0 for one per core
+/// @}
+
+//------------------------------------------------------------------------------
+//
+static U33 fromWords(unsigned int low, unsigned int high)
+//
+/// @brief The value of the lane words low / high, either may be unnormalised
+//------------------------------------------------------------------------------
+{
+    if (NATIVE64_LAYOUT)
+    {
+        return U33(high, low);
+    }
+
+    // msb17 * 2^16 + lsb16
+    return ((U33(0, low) << 16) + U33(0, high));
+}
+
+#if defined(OMATH_REDUCE_X86)
+
+//==============================================================================
+// SSE2 Kernels
+//
+// The lane layout of the U33Batch kernels: each 64 bit lane holds one value,
+// either msb17 in the low dword and lsb16 in the high dword or one native
+// 64 bit word. A native lane sums modulo 2^64, a multiple of 2^33.
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("sse2")))
+__m128i addSse2(__m128i lhs, __m128i rhs)
+//
+/// @brief Two U33 additions, moving the carry out of lsb16 into msb17
+//------------------------------------------------------------------------------
+{
+    if (NATIVE64_LAYOUT)
+    {
+        return _mm_and_si128(_mm_add_epi64(lhs, rhs), _mm_set_epi32(1, MASK_32BIT, 1, MASK_32BIT));
+    }
+
+    const __m128i mask = _mm_set_epi32(MASK_16BIT, MASK_17BIT, MASK_16BIT, MASK_17BIT);
+
+    __m128i sum = _mm_add_epi32(lhs, rhs);
+    sum = _mm_add_epi32(sum, _mm_srli_epi64(sum, 48));
+
+    return _mm_and_si128(sum, mask);
+}
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("sse2")))
+__m128i subSse2(__m128i lhs, __m128i rhs)
+//
+/// @brief Two U33 subtractions, taking the borrow out of lsb16 from msb17
+//------------------------------------------------------------------------------
+{
+    if (NATIVE64_LAYOUT)
+    {
+        return _mm_and_si128(_mm_sub_epi64(lhs, rhs), _mm_set_epi32(1, MASK_32BIT, 1, MASK_32BIT));
+    }
+
+    const __m128i mask = _mm_set_epi32(MASK_16BIT, MASK_17BIT, MASK_16BIT, MASK_17BIT);
+
+    __m128i diff = _mm_sub_epi32(lhs, rhs);
+    diff = _mm_sub_epi32(diff, _mm_srli_epi64(diff, 63));
+
+    return _mm_and_si128(diff, mask);
+}
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("sse2")))
+__m128i lessSse2(__m128i lhs, __m128i rhs)
+//
+/// @brief All ones in each lane where lhs < rhs
+//------------------------------------------------------------------------------
+{
+    if (NATIVE64_LAYOUT)
+    {
+        const __m128i diff = _mm_sub_epi64(lhs, rhs);
+        return _mm_shuffle_epi32(_mm_srai_epi32(diff, 31), _MM_SHUFFLE(3, 3, 1, 1));
+    }
+
+    // unmasked borrow chain, msb17 goes negative when lhs < rhs
+    __m128i diff = _mm_sub_epi32(lhs, rhs);
+    diff = _mm_sub_epi32(diff, _mm_srli_epi64(diff, 63));
+
+    return _mm_shuffle_epi32(_mm_srai_epi32(diff, 31), _MM_SHUFFLE(2, 2, 0, 0));
+}
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("sse2")))
+__m128i broadcastSse2(const char* value)
+//
+/// @brief One value in both lanes
+//------------------------------------------------------------------------------
+{
+    const int low  = static_cast<int>(U33Lanes::getWord(value, 0));
+    const int high = static_cast<int>(U33Lanes::getWord(value, 1));
+
+    return _mm_set_epi32(high, low, high, low);
+}
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("sse2")))
+std::size_t sumSse2(const char* values, std::size_t count, U33& total)
+//
+/// @brief Sum, two values at a time, added to total
+/// @return The number of values processed
+//------------------------------------------------------------------------------
+{
+    const std::size_t blocks = count / 2;
+
+    for (std::size_t start = 0; start < blocks; start += FOLD_BLOCKS)
+    {
+        const std::size_t stop = std::min(blocks, start + FOLD_BLOCKS);
+
+        // each dword lane sums one part, the lsb16 lanes stay below 2^32
+        __m128i acc = _mm_setzero_si128();
+        for (std::size_t i = start; i < stop; ++i)
+        {
+            const char* block = values + (sizeof(__m128i) * i);
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+            acc = NATIVE64_LAYOUT ? _mm_add_epi64(acc, value) : _mm_add_epi32(acc, value);
+        }
+
+        unsigned int lanes[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        total += fromWords(lanes[0], lanes[1]) + fromWords(lanes[2], lanes[3]);
+    }
+
+    return (blocks * 2);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Max>
+static __attribute__((target("sse2")))
+std::size_t extremeSse2(const char* values, std::size_t count,
+                        const char* base, U33& key)
+//
+/// @brief Minimum / maximum of value - base, two values at a time
+/// @return The number of values processed, key is only set when non zero
+//------------------------------------------------------------------------------
+{
+    const std::size_t blocks = count / 2;
+    if (blocks == 0)
+    {
+        return 0;
+    }
+
+    const __m128i offset = broadcastSse2(base);
+    __m128i best = subSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values)), offset);
+
+    for (std::size_t i = 1; i < blocks; ++i)
+    {
+        const char* block = values + (sizeof(__m128i) * i);
+        const __m128i next = subSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block)), offset);
+        const __m128i take = Max ? lessSse2(best, next) : lessSse2(next, best);
+
+        best = _mm_or_si128(_mm_and_si128(take, next), _mm_andnot_si128(take, best));
+    }
+
+    unsigned int lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), best);
+
+    const U33 lhs = fromWords(lanes[0], lanes[1]);
+    const U33 rhs = fromWords(lanes[2], lanes[3]);
+    key = ((lhs < rhs) == Max) ? rhs : lhs;
+
+    return (blocks * 2);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Inclusive>
+static __attribute__((target("sse2")))
+std::size_t scanSse2(const char* in, char* out, std::size_t count,
+                     const char* offset, U33& running)
+//
+/// @brief Prefix sum from offset, two values at a time
+/// @return The number of values processed, running is the sum so far
+//------------------------------------------------------------------------------
+{
+    const std::size_t blocks = count / 2;
+    __m128i carry = broadcastSse2(offset);
+
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        const std::size_t at = sizeof(__m128i) * i;
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + at));
+
+        // the upper lane adds the lower, then both add the sum so far
+        __m128i sum = addSse2(value, _mm_slli_si128(value, 8));
+        sum = addSse2(sum, carry);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + at), Inclusive ? sum : subSse2(sum, value));
+        carry = _mm_shuffle_epi32(sum, _MM_SHUFFLE(3, 2, 3, 2));
+    }
+
+    unsigned int lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), carry);
+    running = fromWords(lanes[0], lanes[1]);
+
+    return (blocks * 2);
+}
+
+//==============================================================================
+// AVX2 Kernels
+//
+// The same lane arithmetic as the SSE2 kernels over four values at a time.
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("avx2")))
+__m256i addAvx2(__m256i lhs, __m256i rhs)
+//
+/// @brief Four U33 additions, moving the carry out of lsb16 into msb17
+//------------------------------------------------------------------------------
+{
+    if (NATIVE64_LAYOUT)
+    {
+        return _mm256_and_si256(_mm256_add_epi64(lhs, rhs),
+                                _mm256_set_epi32(1, MASK_32BIT, 1, MASK_32BIT, 1, MASK_32BIT, 1, MASK_32BIT));
+    }
+
+    const __m256i mask = _mm256_set_epi32(MASK_16BIT, MASK_17BIT, MASK_16BIT, MASK_17BIT,
+                                          MASK_16BIT, MASK_17BIT, MASK_16BIT, MASK_17BIT);
+
+    __m256i sum = _mm256_add_epi32(lhs, rhs);
+    sum = _mm256_add_epi32(sum, _mm256_srli_epi64(sum, 48));
+
+    return _mm256_and_si256(sum, mask);
+}
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("avx2")))
+__m256i subAvx2(__m256i lhs, __m256i rhs)
+//
+/// @brief Four U33 subtractions, taking the borrow out of lsb16 from msb17
+//------------------------------------------------------------------------------
+{
+    if (NATIVE64_LAYOUT)
+    {
+        return _mm256_and_si256(_mm256_sub_epi64(lhs, rhs),
+                                _mm256_set_epi32(1, MASK_32BIT, 1, MASK_32BIT, 1, MASK_32BIT, 1, MASK_32BIT));
+    }
+
+    const __m256i mask = _mm256_set_epi32(MASK_16BIT, MASK_17BIT, MASK_16BIT, MASK_17BIT,
+                                          MASK_16BIT, MASK_17BIT, MASK_16BIT, MASK_17BIT);
+
+    __m256i diff = _mm256_sub_epi32(lhs, rhs);
+    diff = _mm256_sub_epi32(diff, _mm256_srli_epi64(diff, 63));
+
+    return _mm256_and_si256(diff, mask);
+}
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("avx2")))
+__m256i lessAvx2(__m256i lhs, __m256i rhs)
+//
+/// @brief All ones in each lane where lhs < rhs
+//------------------------------------------------------------------------------
+{
+    if (NATIVE64_LAYOUT)
+    {
+        return _mm256_cmpgt_epi64(rhs, lhs);
+    }
+
+    __m256i diff = _mm256_sub_epi32(lhs, rhs);
+    diff = _mm256_sub_epi32(diff, _mm256_srli_epi64(diff, 63));
+
+    return _mm256_shuffle_epi32(_mm256_srai_epi32(diff, 31), _MM_SHUFFLE(2, 2, 0, 0));
+}
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("avx2")))
+__m256i broadcastAvx2(const char* value)
+//
+/// @brief One value in every lane
+//------------------------------------------------------------------------------
+{
+    const int low  = static_cast<int>(U33Lanes::getWord(value, 0));
+    const int high = static_cast<int>(U33Lanes::getWord(value, 1));
+
+    return _mm256_set_epi32(high, low, high, low, high, low, high, low);
+}
+
+//------------------------------------------------------------------------------
+//
+static __attribute__((target("avx2")))
+std::size_t sumAvx2(const char* values, std::size_t count, U33& total)
+//
+/// @brief Sum, four values at a time, added to total
+/// @return The number of values processed
+//------------------------------------------------------------------------------
+{
+    const std::size_t blocks = count / 4;
+
+    for (std::size_t start = 0; start < blocks; start += FOLD_BLOCKS)
+    {
+        const std::size_t stop = std::min(blocks, start + FOLD_BLOCKS);
+
+        __m256i acc = _mm256_setzero_si256();
+        for (std::size_t i = start; i < stop; ++i)
+        {
+            const char* block = values + (sizeof(__m256i) * i);
+            const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+            acc = NATIVE64_LAYOUT ? _mm256_add_epi64(acc, value) : _mm256_add_epi32(acc, value);
+        }
+
+        unsigned int lanes[8];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        total += fromWords(lanes[0], lanes[1]) + fromWords(lanes[2], lanes[3]) +
+                 fromWords(lanes[4], lanes[5]) + fromWords(lanes[6], lanes[7]);
+    }
+
+    return (blocks * 4);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Max>
+static __attribute__((target("avx2")))
+std::size_t extremeAvx2(const char* values, std::size_t count,
+                        const char* base, U33& key)
+//
+/// @brief Minimum / maximum of value - base, four values at a time
+/// @return The number of values processed, key is only set when non zero
+//------------------------------------------------------------------------------
+{
+    const std::size_t blocks = count / 4;
+    if (blocks == 0)
+    {
+        return 0;
+    }
+
+    const __m256i offset = broadcastAvx2(base);
+    __m256i best = subAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values)), offset);
+
+    for (std::size_t i = 1; i < blocks; ++i)
+    {
+        const char* block = values + (sizeof(__m256i) * i);
+        const __m256i next = subAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block)), offset);
+        const __m256i take = Max ? lessAvx2(best, next) : lessAvx2(next, best);
+
+        best = _mm256_blendv_epi8(best, next, take);
+    }
+
+    unsigned int lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), best);
+
+    key = fromWords(lanes[0], lanes[1]);
+    for (unsigned int i = 1; i < 4; ++i)
+    {
+        const U33 lane = fromWords(lanes[2 * i], lanes[(2 * i) + 1]);
+        key = ((key < lane) == Max) ? lane : key;
+    }
+
+    return (blocks * 4);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Inclusive>
+static __attribute__((target("avx2")))
+std::size_t scanAvx2(const char* in, char* out, std::size_t count,
+                     const char* offset, U33& running)
+//
+/// @brief Prefix sum from offset, four values at a time
+/// @return The number of values processed, running is the sum so far
+//------------------------------------------------------------------------------
+{
+    const std::size_t blocks = count / 4;
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i carry = broadcastAvx2(offset);
+
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        const std::size_t at = sizeof(__m256i) * i;
+        const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + at));
+
+        // add the lanes one then two below, then the sum so far
+        const __m256i one = _mm256_blend_epi32(_mm256_permute4x64_epi64(value, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03);
+        __m256i sum = addAvx2(value, one);
+
+        const __m256i two = _mm256_blend_epi32(_mm256_permute4x64_epi64(sum, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x0f);
+        sum = addAvx2(sum, two);
+        sum = addAvx2(sum, carry);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + at), Inclusive ? sum : subAvx2(sum, value));
+        carry = _mm256_permute4x64_epi64(sum, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+
+    unsigned int lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), carry);
+    running = fromWords(lanes[0], lanes[1]);
+
+    return (blocks * 4);
+}
+
+/// @name Kernel Tables
+/// @{
+static const SumKernels     SUM_KERNELS       = { sumSse2,               sumAvx2               };
+static const ExtremeKernels MIN_KERNELS       = { extremeSse2<false>,    extremeAvx2<false>    };
+static const ExtremeKernels MAX_KERNELS       = { extremeSse2<true>,     extremeAvx2<true>     };
+static const ScanKernels    INCLUSIVE_KERNELS = { scanSse2<true>,        scanAvx2<true>        };
+static const ScanKernels    EXCLUSIVE_KERNELS = { scanSse2<false>,       scanAvx2<false>       };
+/// @}
+
+#else
+
+/// @name Kernel Tables
+/// @{
+static const SumKernels     SUM_KERNELS       = { 0, 0 };
+static const ExtremeKernels MIN_KERNELS       = { 0, 0 };
+static const ExtremeKernels MAX_KERNELS       = { 0, 0 };
+static const ScanKernels    INCLUSIVE_KERNELS = { 0, 0 };
+static const ScanKernels    EXCLUSIVE_KERNELS = { 0, 0 };
+/// @}
+
+#endif // OMATH_REDUCE_X86
+
+//------------------------------------------------------------------------------
+//
+static U33 sumChunk(const U33* values, std::size_t count)
+//
+/// @brief Sum of one chunk on the calling thread
+//------------------------------------------------------------------------------
+{
+    const char* lanes = U33Lanes::bytes(values);
+
+    U33 total;
+    std::size_t i(0);
+
+    switch (U33Batch::getIsa())
+    {
+        case U33Batch::ISA_AVX2: i = SUM_KERNELS.mAvx2(lanes, count, total); break;
+        case U33Batch::ISA_SSE2: i = SUM_KERNELS.mSse2(lanes, count, total); break;
+        default:                 break;
+    }
+
+    for (; i < count; ++i)
+    {
+        total += values[i];
+    }
+
+    return total;
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Max>
+static U33 extremeChunk(const U33* values, std::size_t count, const U33& base)
+//
+/// @brief Minimum / maximum of value - base over one non empty chunk
+//------------------------------------------------------------------------------
+{
+    const ExtremeKernels& kernels = Max ? MAX_KERNELS : MIN_KERNELS;
+    const char* lanes  = U33Lanes::bytes(values);
+    const char* origin = U33Lanes::bytes(&base);
+
+    U33 key = values[0] - base;
+    std::size_t i(0);
+
+    switch (U33Batch::getIsa())
+    {
+        case U33Batch::ISA_AVX2: i = kernels.mAvx2(lanes, count, origin, key); break;
+        case U33Batch::ISA_SSE2: i = kernels.mSse2(lanes, count, origin, key); break;
+        default:                 break;
+    }
+
+    for (; i < count; ++i)
+    {
+        const U33 next = values[i] - base;
+        key = ((key < next) == Max) ? next : key;
+    }
+
+    return key;
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Inclusive>
+static void scanChunk(const U33* in, U33* out, std::size_t count, const U33& offset)
+//
+/// @brief Prefix sum of one chunk starting from offset
+//------------------------------------------------------------------------------
+{
+    const ScanKernels& kernels = Inclusive ? INCLUSIVE_KERNELS : EXCLUSIVE_KERNELS;
+    const char* source = U33Lanes::bytes(in);
+    char* target       = U33Lanes::bytes(out);
+    const char* start  = U33Lanes::bytes(&offset);
+
+    U33 running(offset);
+    std::size_t i(0);
+
+    switch (U33Batch::getIsa())
+    {
+        case U33Batch::ISA_AVX2: i = kernels.mAvx2(source, target, count, start, running); break;
+        case U33Batch::ISA_SSE2: i = kernels.mSse2(source, target, count, start, running); break;
+        default:                 break;
+    }
+
+    for (; i < count; ++i)
+    {
+        // read before writing, out may be in
+        const U33 value = in[i];
+        out[i] = Inclusive ? (running + value) : running;
+        running += value;
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+static std::size_t chunksFor(std::size_t count)
+//
+/// @brief The number of chunks (and threads) for count values
+//------------------------------------------------------------------------------
+{
+    const std::size_t threads = U33Reduce::getThreads();
+    const std::size_t worth   = count / MIN_PER_THREAD;
+
+    return std::max<std::size_t>(1, std::min(threads, worth));
+}
+
+//------------------------------------------------------------------------------
+//
+static void chunkBounds(std::size_t count, std::size_t chunks, std::size_t chunk,
+                        std::size_t& begin, std::size_t& end)
+//
+/// @brief The values of one chunk, each starting on a whole SIMD block
+//------------------------------------------------------------------------------
+{
+    const std::size_t size = (((count / chunks) + CHUNK_ALIGN - 1) / CHUNK_ALIGN) * CHUNK_ALIGN;
+
+    begin = std::min(count, chunk * size);
+    end   = (chunk + 1 == chunks) ? count : std::min(count, begin + size);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Task>
+static void runChunks(std::size_t count, std::size_t chunks, Task task)
+//
+/// @brief Run task(chunk, begin, end) for every chunk, one thread each
+//------------------------------------------------------------------------------
+{
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+
+    std::size_t begin(0);
+    std::size_t end(0);
+
+    for (std::size_t chunk = 1; chunk < chunks; ++chunk)
+    {
+        chunkBounds(count, chunks, chunk, begin, end);
+        workers.push_back(std::thread(task, chunk, begin, end));
+    }
+
+    // the calling thread takes the first chunk
+    chunkBounds(count, chunks, 0, begin, end);
+    task(0, begin, end);
+
+    for (std::size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i].join();
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+static U33 sumAll(const U33* values, std::size_t count)
+//
+/// @brief Sum over every chunk, combined in order
+//------------------------------------------------------------------------------
+{
+    const std::size_t chunks = chunksFor(count);
+    if (chunks == 1)
+    {
+        return sumChunk(values, count);
+    }
+
+    std::vector<U33> partial(chunks);
+    runChunks(count, chunks, [&](std::size_t chunk, std::size_t begin, std::size_t end)
+    {
+        partial[chunk] = sumChunk(values + begin, end - begin);
+    });
+
+    return sumChunk(&partial[0], chunks);
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Max>
+static U33 extremeAll(const U33* values, std::size_t count, const U33& base)
+//
+/// @brief Minimum / maximum of value - base over every chunk, plus base
+//------------------------------------------------------------------------------
+{
+    if (count == 0)
+    {
+        return U33();
+    }
+
+    const std::size_t chunks = chunksFor(count);
+    if (chunks == 1)
+    {
+        return extremeChunk<Max>(values, count, base) + base;
+    }
+
+    std::vector<U33> partial(chunks);
+    runChunks(count, chunks, [&](std::size_t chunk, std::size_t begin, std::size_t end)
+    {
+        partial[chunk] = extremeChunk<Max>(values + begin, end - begin, base) + base;
+    });
+
+    return extremeChunk<Max>(&partial[0], chunks, base) + base;
+}
+
+//------------------------------------------------------------------------------
+//
+template <bool Inclusive>
+static void scanAll(const U33* in, U33* out, std::size_t count, const U33& init)
+//
+/// @brief Prefix sum over every chunk
+///
+/// The chunk sums are found first, so each chunk can then be scanned from
+/// its own starting offset at the same time as the others.
+//------------------------------------------------------------------------------
+{
+    const std::size_t chunks = chunksFor(count);
+    if (chunks == 1)
+    {
+        scanChunk<Inclusive>(in, out, count, init);
+        return;
+    }
+
+    std::vector<U33> offsets(chunks);
+    runChunks(count, chunks, [&](std::size_t chunk, std::size_t begin, std::size_t end)
+    {
+        offsets[chunk] = sumChunk(in + begin, end - begin);
+    });
+
+    // offsets[c] becomes init plus the sums of the chunks before c
+    scanChunk<false>(&offsets[0], &offsets[0], chunks, init);
+
+    runChunks(count, chunks, [&](std::size_t chunk, std::size_t begin, std::size_t end)
+    {
+        scanChunk<Inclusive>(in + begin, out + begin, end - begin, offsets[chunk]);
+    });
+}
+
+//------------------------------------------------------------------------------
+//
+U33 U33Reduce::sum(const U33* values, std::size_t count)
+//
+/// @brief values[0] + values[1] + ... modulo 2^33
+//------------------------------------------------------------------------------
+{
+    return sumAll(values, count);
+}
+
+//------------------------------------------------------------------------------
+//
+U33 U33Reduce::min(const U33* values, std::size_t count)
+//
+/// @brief The smallest value
+//------------------------------------------------------------------------------
+{
+    return extremeAll<false>(values, count, U33());
+}
+
+//------------------------------------------------------------------------------
+//
+U33 U33Reduce::max(const U33* values, std::size_t count)
+//
+/// @brief The largest value
+//------------------------------------------------------------------------------
+{
+    return extremeAll<true>(values, count, U33());
+}
+
+//------------------------------------------------------------------------------
+//
+U33 U33Reduce::earliest(const U33* values, std::size_t count)
+//
+/// @brief The wrap aware minimum
+///
+/// The minimum on the line from values[0] - 2^32 up to values[0] + 2^32.
+//------------------------------------------------------------------------------
+{
+    return (count == 0) ? U33() : extremeAll<false>(values, count, values[0] + U33(1, 0));
+}
+
+//------------------------------------------------------------------------------
+//
+U33 U33Reduce::latest(const U33* values, std::size_t count)
+//
+/// @brief The wrap aware maximum
+///
+/// The maximum on the line from values[0] - 2^32 up to values[0] + 2^32.
+//------------------------------------------------------------------------------
+{
+    return (count == 0) ? U33() : extremeAll<true>(values, count, values[0] + U33(1, 0));
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Reduce::inclusiveScan(const U33* in, U33* out, std::size_t count, const U33& init)
+//
+/// @brief out[i] = init + in[0] + ... + in[i], out may be in
+//------------------------------------------------------------------------------
+{
+    scanAll<true>(in, out, count, U33(init));
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Reduce::exclusiveScan(const U33* in, U33* out, std::size_t count, const U33& init)
+//
+/// @brief out[i] = init + in[0] + ... + in[i - 1], out may be in
+//------------------------------------------------------------------------------
+{
+    scanAll<false>(in, out, count, U33(init));
+}
+
+//------------------------------------------------------------------------------
+//
+unsigned int U33Reduce::getThreads()
+//
+/// @brief The most threads a call will use
+//------------------------------------------------------------------------------
+{
+    const unsigned int threads = sThreads.load(std::memory_order_relaxed);
+
+    return threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+//------------------------------------------------------------------------------
+//
+unsigned int U33Reduce::setThreads(unsigned int threads)
+//
+/// @brief Limit the threads a call will use, 0 for one per core
+/// @return The resulting limit
+//------------------------------------------------------------------------------
+{
+    sThreads.store(threads, std::memory_order_relaxed);
+
+    return getThreads();
+}
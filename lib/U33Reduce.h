@@ -0,0 +1,81 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Reduce.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_U33REDUCE_H
+#define OMATH_U33REDUCE_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <cstddef>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33.h"
+
+//------------------------------------------------------------------------------
+//
+class U33Reduce
+//
+/// @name Reductions and Prefix Scans over U33 Arrays
+///
+/// Large arrays are split into one chunk per thread, each chunk runs the
+/// U33Batch instruction set and the chunk results are combined in order, so
+/// the results are bit identical to the sequential loop over U33. Sums and
+/// scans wrap modulo 2^33.
+///
+/// The wrap aware earliest / latest place every value within half the range
+/// of the first value, as U33Unwrapper would for a series that never moves
+/// that far from its start, and take the minimum / maximum on that line.
+/// An empty array reduces to zero.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Reductions
+    /// @{
+    static U33 sum(const U33* values, std::size_t count);
+    static U33 min(const U33* values, std::size_t count);
+    static U33 max(const U33* values, std::size_t count);
+    static U33 earliest(const U33* values, std::size_t count);
+    static U33 latest(const U33* values, std::size_t count);
+    /// @}
+
+    /// @name Prefix Scans
+    /// @{
+    static void inclusiveScan(const U33* in, U33* out, std::size_t count, const U33& init=U33());
+    static void exclusiveScan(const U33* in, U33* out, std::size_t count, const U33& init=U33());
+    /// @}
+
+    /// @name Threading
+    /// @{
+    static unsigned int getThreads();
+    static unsigned int setThreads(unsigned int threads);
+    /// @}
+};
+
+#endif // OMATH_U33REDUCE_H
@@ -0,0 +1,83 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Rescaler.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+// none
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33Rescaler.h"
+
+//------------------------------------------------------------------------------
+//
+void U33Rescaler::rescale(const U33* ticks, Extended* out, std::size_t count) const
+//
+/// @brief Rescale an array of U33 values, out may alias nothing
+//------------------------------------------------------------------------------
+{
+    // an integer ratio is one multiply per value
+    if (mRemainder == 0)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            unsigned int hi(0);
+            unsigned int lo(0);
+            UIntMath::mul32(ticks[i].getLsb32(), mQuotient, hi, lo);
+            out[i] = Extended(hi + (ticks[i].getMsb() ? mQuotient : 0), lo);
+        }
+        return;
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        out[i] = rescale(ticks[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Rescaler::rescale(const Extended* ticks, Extended* out, std::size_t count) const
+//
+/// @brief Rescale an array of unwrapped 64 bit times, out may equal ticks
+//------------------------------------------------------------------------------
+{
+    if (mRemainder == 0)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            out[i] = ticks[i] * mQuotient;
+        }
+        return;
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        out[i] = rescale(ticks[i]);
+    }
+}
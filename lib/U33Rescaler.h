@@ -0,0 +1,373 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Rescaler.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_U33RESCALER_H
+#define OMATH_U33RESCALER_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <stdexcept>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33.h"
+
+//------------------------------------------------------------------------------
+//
+class U33Rescaler
+//
+/// @name Time Base Conversion, ticks * num / den
+///
+/// Converts U33 ticks (or unwrapped 64 bit times) between clocks, e.g.
+/// 90 kHz to 27 MHz, 48 kHz samples or 30000 / 1001 frames, rounded as
+/// chosen. The factor is reduced and split when the rescaler is built:
+/// with num = q * den + r and r * 2^32 = Q * den + R, a U33 value
+/// h * 2^32 + l scales to l * q + h * (q * 2^32 + Q) + (l * r + h * R) / den.
+/// That last quotient fits a word, so it is a two word by one word division
+/// through a precomputed normalized reciprocal (Moller & Granlund), and a
+/// conversion is three 32 x 32 bit multiplies and some shifts, with no 64
+/// bit type or division instruction. An integer ratio is one multiply.
+/// Exact while the result fits 64 bits.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Types
+    /// @{
+    typedef UInt<64> Extended;
+
+    enum Rounding
+    {
+        ROUND_DOWN,             ///< Towards zero
+        ROUND_UP,               ///< Away from zero
+        ROUND_NEAREST,          ///< To the nearest, halves up
+        ROUND_NEAREST_EVEN      ///< To the nearest, halves to even
+    };
+    /// @}
+
+    /// @name Construction / Destruction
+    /// @{
+    constexpr U33Rescaler(unsigned int num, unsigned int den, Rounding rounding=ROUND_NEAREST);
+    static constexpr U33Rescaler fromRates(unsigned int fromNum, unsigned int fromDen,
+                                           unsigned int toNum, unsigned int toDen,
+                                           Rounding rounding=ROUND_NEAREST);
+    /// @}
+
+    /// @name Rescaling
+    /// @{
+    constexpr Extended rescale(const U33& ticks) const;
+    constexpr Extended rescale(const Extended& ticks) const;
+    void rescale(const U33* ticks, Extended* out, std::size_t count) const;
+    void rescale(const Extended* ticks, Extended* out, std::size_t count) const;
+    /// @}
+
+    /// @name Getters
+    /// @{
+    constexpr unsigned int getNumerator() const;
+    constexpr unsigned int getDenominator() const;
+    constexpr Rounding getRounding() const;
+    /// @}
+
+private:
+
+    /// @name Helpers
+    /// @{
+    static constexpr unsigned int gcd(unsigned int lhs, unsigned int rhs);
+    static constexpr unsigned int product(unsigned int lhs, unsigned int rhs);
+    static constexpr unsigned int leadingZeros(unsigned int value);
+    constexpr unsigned int divide(unsigned int hi, unsigned int lo, unsigned int& remainder) const;
+    constexpr Extended round(const Extended& quotient, unsigned int remainder) const;
+    /// @}
+
+    /// @name Variables
+    /// @{
+    unsigned int mNum;                  ///< The reduced numerator
+    unsigned int mDen;                  ///< The reduced denominator
+    Rounding mRounding;                 ///< How a remainder is rounded
+    unsigned int mShift;                ///< Leading zeros of den
+    unsigned int mNormal;               ///< den << mShift, top bit set
+    unsigned int mReciprocal;           ///< (2^64 - 1) / mNormal - 2^32
+    unsigned int mQuotient;             ///< q = num / den
+    unsigned int mRemainder;            ///< r = num % den
+    unsigned int mHighQuotient;         ///< Q = (r * 2^32) / den
+    unsigned int mHighRemainder;        ///< R = (r * 2^32) % den
+    Extended mHigh;                     ///< q * 2^32 + Q, the whole part for bit 32
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+constexpr U33Rescaler::U33Rescaler(unsigned int num, unsigned int den, Rounding rounding)
+//
+/// @brief Constructor, reduces num / den and precomputes the split
+///
+/// Throws std::invalid_argument for a zero denominator.
+//------------------------------------------------------------------------------
+    : mNum((den != 0) ? (num / gcd(num, den)) : throw std::invalid_argument("U33Rescaler")),
+      mDen(den / gcd(num, den)),
+      mRounding(rounding),
+      mShift(leadingZeros(mDen)),
+      mNormal(mDen << mShift),
+      mReciprocal((Extended(~0u, ~0u) / Extended(0, mNormal)).getLsb32()),
+      mQuotient(mNum / mDen),
+      mRemainder(mNum % mDen),
+      mHighQuotient(0),
+      mHighRemainder(0),
+      mHigh()
+{
+    // r < den, so (r * 2^32) / den fits a word
+    mHighQuotient = divide(mRemainder, 0, mHighRemainder);
+    mHigh         = Extended(mQuotient, mHighQuotient);
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr U33Rescaler U33Rescaler::fromRates(unsigned int fromNum, unsigned int fromDen,
+                                             unsigned int toNum, unsigned int toDen,
+                                             Rounding rounding)
+//
+/// @brief The rescaler from one rate to another, each as a fraction in Hz
+///
+/// e.g. fromRates(90000, 1, 30000, 1001) turns 90 kHz ticks into NTSC frame
+/// numbers. Throws std::invalid_argument if the reduced factor does not fit
+/// 32 bit words.
+//------------------------------------------------------------------------------
+{
+    // ticks * (toNum / toDen) / (fromNum / fromDen), cross reduced first
+    const unsigned int rates = gcd(fromNum, toNum);
+    const unsigned int dens  = gcd(fromDen, toDen);
+
+    return U33Rescaler(product(toNum / rates, fromDen / dens),
+                       product(fromNum / rates, toDen / dens), rounding);
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr U33Rescaler::Extended U33Rescaler::rescale(const U33& ticks) const
+//
+/// @brief Rescale a U33 value
+//------------------------------------------------------------------------------
+{
+    const unsigned int lsb32 = ticks.getLsb32();
+    const bool msb = ticks.getMsb();
+
+    unsigned int hi(0);
+    unsigned int lo(0);
+    UIntMath::mul32(lsb32, mQuotient, hi, lo);
+
+    // bit 32 brings q * 2^32 + Q, and R over den
+    const Extended whole = Extended(hi, lo) + (msb ? mHigh : Extended());
+    if (mRemainder == 0)
+    {
+        return whole;
+    }
+
+    unsigned int carry(0);
+    UIntMath::mul32(lsb32, mRemainder, hi, lo);
+    lo = UIntMath::add32(lo, msb ? mHighRemainder : 0, carry);
+
+    unsigned int remainder(0);
+    const unsigned int part = divide(hi + carry, lo, remainder);
+
+    return round(whole + Extended(0, part), remainder);
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr U33Rescaler::Extended U33Rescaler::rescale(const Extended& ticks) const
+//
+/// @brief Rescale an unwrapped 64 bit time
+//------------------------------------------------------------------------------
+{
+    const unsigned int upper = ticks.getUpper();
+    const unsigned int lsb32 = ticks.getLsb32();
+
+    unsigned int hi(0);
+    unsigned int lo(0);
+    UIntMath::mul32(upper, mHighQuotient, hi, lo);
+
+    const Extended whole = (ticks * mQuotient) + Extended(hi, lo);
+    if (mRemainder == 0)
+    {
+        return whole;
+    }
+
+    // upper * R over den first, its remainder joins lsb32 * r
+    unsigned int carried(0);
+    UIntMath::mul32(upper, mHighRemainder, hi, lo);
+    const unsigned int high = divide(hi, lo, carried);
+
+    unsigned int carry(0);
+    UIntMath::mul32(lsb32, mRemainder, hi, lo);
+    lo = UIntMath::add32(lo, carried, carry);
+
+    unsigned int remainder(0);
+    const unsigned int part = divide(hi + carry, lo, remainder);
+
+    return round(whole + Extended(0, high) + Extended(0, part), remainder);
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr unsigned int U33Rescaler::getNumerator() const
+//
+/// @brief The numerator, in lowest terms
+//------------------------------------------------------------------------------
+{
+    return mNum;
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr unsigned int U33Rescaler::getDenominator() const
+//
+/// @brief The denominator, in lowest terms
+//------------------------------------------------------------------------------
+{
+    return mDen;
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr U33Rescaler::Rounding U33Rescaler::getRounding() const
+//
+/// @brief Rounding Getter
+//------------------------------------------------------------------------------
+{
+    return mRounding;
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr unsigned int U33Rescaler::gcd(unsigned int lhs, unsigned int rhs)
+//
+/// @brief Greatest common divisor, gcd(0, 0) taken as 1
+//------------------------------------------------------------------------------
+{
+    while (rhs != 0)
+    {
+        const unsigned int next = lhs % rhs;
+        lhs = rhs;
+        rhs = next;
+    }
+
+    return (lhs != 0) ? lhs : 1;
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr unsigned int U33Rescaler::product(unsigned int lhs, unsigned int rhs)
+//
+/// @brief lhs * rhs, throwing std::invalid_argument if it does not fit a word
+//------------------------------------------------------------------------------
+{
+    return ((rhs == 0) || (lhs <= (0xffffffffu / rhs))) ? (lhs * rhs)
+                                                         : throw std::invalid_argument("U33Rescaler");
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr unsigned int U33Rescaler::leadingZeros(unsigned int value)
+//
+/// @brief The number of leading zero bits of a non zero word
+//------------------------------------------------------------------------------
+{
+    unsigned int zeros(0);
+    while ((value & 0x80000000u) == 0)
+    {
+        value <<= 1;
+        ++zeros;
+    }
+
+    return zeros;
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr unsigned int U33Rescaler::divide(unsigned int hi, unsigned int lo, unsigned int& remainder) const
+//
+/// @brief (hi * 2^32 + lo) / den, where hi < den, with the remainder
+//------------------------------------------------------------------------------
+{
+    // normalize so the divisor has its top bit set, hi stays below it
+    const unsigned int u1 = (hi << mShift) | ((lo >> 1) >> (31 - mShift));
+    const unsigned int u0 = lo << mShift;
+
+    // estimate from the reciprocal, at most two low
+    unsigned int q1(0);
+    unsigned int q0(0);
+    unsigned int carry(0);
+    UIntMath::mul32(mReciprocal, u1, q1, q0);
+    q0 = UIntMath::add32(q0, u0, carry);
+    q1 = q1 + u1 + carry + 1;
+
+    // masks rather than branches, the first correction is a coin toss
+    unsigned int rest = u0 - (q1 * mNormal);
+    const unsigned int over = 0u - ((rest > q0) ? 1u : 0u);
+    q1   += over;
+    rest += mNormal & over;
+
+    const unsigned int under = 0u - ((rest >= mNormal) ? 1u : 0u);
+    q1   -= under;
+    rest -= mNormal & under;
+
+    remainder = rest >> mShift;
+    return q1;
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr U33Rescaler::Extended U33Rescaler::round(const Extended& quotient, unsigned int remainder) const
+//
+/// @brief Round a quotient by its remainder over den
+//------------------------------------------------------------------------------
+{
+    // half way when remainder == den - remainder
+    const unsigned int rest = mDen - remainder;
+
+    bool up(false);
+    switch (mRounding)
+    {
+    case ROUND_DOWN:
+        break;
+    case ROUND_UP:
+        up = (remainder != 0);
+        break;
+    case ROUND_NEAREST:
+        up = (remainder >= rest);
+        break;
+    case ROUND_NEAREST_EVEN:
+        up = (remainder > rest) || ((remainder == rest) && ((quotient.getLsb32() & 1) != 0));
+        break;
+    }
+
+    return (quotient + Extended(0, up ? 1 : 0));
+}
+
+#endif // OMATH_U33RESCALER_H
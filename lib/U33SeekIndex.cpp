@@ -0,0 +1,587 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33SeekIndex.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define OMATH_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define OMATH_PREFETCH(address)
+#endif
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33SeekIndex.h"
+
+/// @name Constants
+/// @{
+const std::size_t U33SeekIndex::NPOS;
+
+/// Every section of the image starts on its own cache line
+static const std::size_t LINE_BYTES = 64;
+
+/// Searches run in lock step in groups this size, so their misses overlap
+static const std::size_t LANES = 8;
+
+static const char MAGIC[8] = { 'O', 'M', 'U', '3', '3', 'I', 'D', 'X' };
+static const unsigned int VERSION = 1;
+
+/// Rank 0xffffffff is kept free so every rank and count fits a word
+static const std::size_t MAX_COUNT = 0xfffffffe;
+/// @}
+
+/// @name Types
+/// @{
+
+/// The first line of the image
+struct Header
+{
+    char mMagic[8];                 ///< MAGIC
+    unsigned int mVersion;          ///< VERSION
+    unsigned int mCount;            ///< The number of entries
+    U33SeekIndex::Extended mProbe;  ///< PROBE, to reject another byte order or layout
+    unsigned char mPad[40];         ///< Zero
+};
+
+/// The byte offset of each section for a given entry count
+struct Sections
+{
+    explicit Sections(std::size_t count);
+
+    std::size_t mKeys;      ///< count + 1 Eytzinger keys, slot 0 unused
+    std::size_t mRanks;     ///< count + 1 sorted indices, slot 0 unused
+    std::size_t mTimes;     ///< count sorted times
+    std::size_t mOffsets;   ///< count sorted offsets
+    std::size_t mBytes;     ///< The whole image
+};
+/// @}
+
+static_assert(sizeof(Header) == LINE_BYTES, "the header is one line");
+static_assert(sizeof(U33SeekIndex::Extended) == 8, "8 keys per line");
+
+static const U33SeekIndex::Extended PROBE(0x01020304, 0x05060708);
+
+//------------------------------------------------------------------------------
+//
+static std::size_t roundUp(std::size_t bytes)
+//
+/// @brief Round a size up to a whole number of lines
+//------------------------------------------------------------------------------
+{
+    return ((bytes + LINE_BYTES - 1) / LINE_BYTES) * LINE_BYTES;
+}
+
+//------------------------------------------------------------------------------
+//
+Sections::Sections(std::size_t count)
+//
+/// @brief Lay out the image for count entries
+//------------------------------------------------------------------------------
+{
+    mKeys    = sizeof(Header);
+    mRanks   = mKeys  + roundUp((count + 1) * sizeof(U33SeekIndex::Extended));
+    mTimes   = mRanks + roundUp((count + 1) * sizeof(unsigned int));
+    mOffsets = mTimes + roundUp(count * sizeof(U33SeekIndex::Extended));
+    mBytes   = mOffsets + roundUp(count * sizeof(U33SeekIndex::Offset));
+}
+
+//------------------------------------------------------------------------------
+//
+static bool isValid(const unsigned char* image, std::size_t bytes)
+//
+/// @brief True when an image of this size has a header this build can use
+//------------------------------------------------------------------------------
+{
+    if (bytes < sizeof(Header))
+    {
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, image, sizeof(header));
+
+    return ((std::memcmp(header.mMagic, MAGIC, sizeof(MAGIC)) == 0) &&
+            (header.mVersion == VERSION) &&
+            (header.mProbe == PROBE) &&
+            (header.mCount <= MAX_COUNT) &&
+            (Sections(header.mCount).mBytes == bytes));
+}
+
+//------------------------------------------------------------------------------
+//
+static std::size_t eytzinger(const U33SeekIndex::Extended* sorted, std::size_t count, std::size_t next,
+                             std::size_t node, U33SeekIndex::Extended* keys, unsigned int* ranks)
+//
+/// @brief Place the sorted times in order under node, returning the next unplaced
+//------------------------------------------------------------------------------
+{
+    if (node <= count)
+    {
+        next = eytzinger(sorted, count, next, 2 * node, keys, ranks);
+        keys[node]  = sorted[next];
+        ranks[node] = static_cast<unsigned int>(next);
+        next = eytzinger(sorted, count, next + 1, (2 * node) + 1, keys, ranks);
+    }
+
+    return next;
+}
+
+//------------------------------------------------------------------------------
+//
+static std::size_t ancestor(std::size_t node)
+//
+/// @brief The node where the search last went left, 0 if it never did
+//------------------------------------------------------------------------------
+{
+    // each trailing one is a step right, the zero above them the step left
+#if defined(__GNUC__) || defined(__clang__)
+    if (sizeof(std::size_t) == sizeof(unsigned long))
+    {
+        return (node >> (__builtin_ctzl(~static_cast<unsigned long>(node)) + 1));
+    }
+#endif
+
+    while (node & 1)
+    {
+        node >>= 1;
+    }
+
+    return (node >> 1);
+}
+
+//------------------------------------------------------------------------------
+//
+U33SeekIndex::U33SeekIndex()
+//
+/// @brief Construct an empty index
+//------------------------------------------------------------------------------
+    : mImage(0),
+      mBytes(0),
+      mMapping(0),
+      mCount(0),
+      mKeys(0),
+      mRanks(0),
+      mTimes(0),
+      mOffsets(0)
+{
+    clear();
+}
+
+//------------------------------------------------------------------------------
+//
+U33SeekIndex::~U33SeekIndex()
+//
+/// @brief Destructor
+//------------------------------------------------------------------------------
+{
+    unmap();
+}
+
+//------------------------------------------------------------------------------
+//
+void U33SeekIndex::build(const U33* pts, const Offset* offsets, std::size_t count)
+//
+/// @brief Build from pairs in recording order, replacing the current entries
+//------------------------------------------------------------------------------
+{
+    if (count > MAX_COUNT)
+    {
+        throw std::invalid_argument("U33SeekIndex::build");
+    }
+
+    // onto the 64 bit timeline, following the wrap
+    std::vector<Extended> times(count);
+    U33Unwrapper unwrapper;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        times[i] = unwrapper.unwrap(pts[i]);
+    }
+
+    // reordered frames leave the times out of order, equal times keep their order
+    std::vector<unsigned int> order(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        order[i] = static_cast<unsigned int>(i);
+    }
+
+    if (!std::is_sorted(times.begin(), times.end()))
+    {
+        std::stable_sort(order.begin(), order.end(),
+                         [&times](unsigned int lhs, unsigned int rhs) { return times[lhs] < times[rhs]; });
+    }
+
+    const Sections sections(count);
+    std::vector<unsigned char> buffer(sections.mBytes + LINE_BYTES - 1, 0);
+    const std::size_t misalign = reinterpret_cast<std::size_t>(buffer.data()) % LINE_BYTES;
+    unsigned char* image = buffer.data() + ((LINE_BYTES - misalign) % LINE_BYTES);
+
+    // value initialised, so mPad is zero
+    Header header = Header();
+    std::memcpy(header.mMagic, MAGIC, sizeof(MAGIC));
+    header.mVersion = VERSION;
+    header.mCount   = static_cast<unsigned int>(count);
+    header.mProbe   = PROBE;
+    std::memcpy(image, &header, sizeof(header));
+
+    Extended*     keys        = reinterpret_cast<Extended*>(image + sections.mKeys);
+    unsigned int* ranks       = reinterpret_cast<unsigned int*>(image + sections.mRanks);
+    Extended*     sortedTimes = reinterpret_cast<Extended*>(image + sections.mTimes);
+    Offset*       sortedOffsets = reinterpret_cast<Offset*>(image + sections.mOffsets);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        sortedTimes[i]   = times[order[i]];
+        sortedOffsets[i] = offsets[order[i]];
+    }
+
+    eytzinger(sortedTimes, count, 0, 1, keys, ranks);
+
+    unmap();
+    mBuffer.swap(buffer);
+    attach(image, sections.mBytes);
+}
+
+//------------------------------------------------------------------------------
+//
+void U33SeekIndex::build(const std::vector<U33>& pts, const std::vector<Offset>& offsets)
+//
+/// @brief Build from pairs in recording order held in two vectors
+//------------------------------------------------------------------------------
+{
+    if (pts.size() != offsets.size())
+    {
+        throw std::invalid_argument("U33SeekIndex::build");
+    }
+
+    build(pts.data(), offsets.data(), pts.size());
+}
+
+//------------------------------------------------------------------------------
+//
+bool U33SeekIndex::save(const std::string& name) const
+//
+/// @brief Write the image to a file, false on failure
+//------------------------------------------------------------------------------
+{
+    std::ofstream file(name.c_str(), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(mImage), static_cast<std::streamsize>(mBytes));
+    file.close();
+
+    return !file.fail();
+}
+
+//------------------------------------------------------------------------------
+//
+bool U33SeekIndex::load(const std::string& name)
+//
+/// @brief Map a saved index, false (keeping the current entries) on failure
+//------------------------------------------------------------------------------
+{
+#if defined(_WIN32)
+    std::ifstream file(name.c_str(), std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    const std::vector<unsigned char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<unsigned char> buffer(contents.size() + LINE_BYTES - 1);
+    const std::size_t misalign = reinterpret_cast<std::size_t>(buffer.data()) % LINE_BYTES;
+    unsigned char* image = buffer.data() + ((LINE_BYTES - misalign) % LINE_BYTES);
+    std::copy(contents.begin(), contents.end(), image);
+
+    if (!isValid(image, contents.size()))
+    {
+        return false;
+    }
+
+    unmap();
+    mBuffer.swap(buffer);
+    attach(image, contents.size());
+    return true;
+#else
+    const int fd = ::open(name.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || (static_cast<std::size_t>(info.st_size) < sizeof(Header)))
+    {
+        close(fd);
+        return false;
+    }
+
+    const std::size_t bytes = static_cast<std::size_t>(info.st_size);
+    void* data = mmap(0, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // check the header before letting go of the current entries
+    if (!isValid(static_cast<const unsigned char*>(data), bytes))
+    {
+        munmap(data, bytes);
+        return false;
+    }
+
+#if defined(MADV_RANDOM)
+    // a lookup touches one line per three levels, read ahead would be wasted
+    madvise(data, bytes, MADV_RANDOM);
+#endif
+
+    unmap();
+    mMapping = data;
+    attach(static_cast<const unsigned char*>(data), bytes);
+    return true;
+#endif
+}
+
+//------------------------------------------------------------------------------
+//
+void U33SeekIndex::clear()
+//
+/// @brief Remove every entry
+//------------------------------------------------------------------------------
+{
+    build(0, 0, 0);
+}
+
+//------------------------------------------------------------------------------
+//
+std::size_t U33SeekIndex::find(const Extended& time) const
+//
+/// @brief The sorted index of the last entry at or before an unwrapped time
+//------------------------------------------------------------------------------
+{
+    const Extended* keys = mKeys;
+    const std::size_t count = mCount;
+
+    std::size_t node(1);
+    while (node <= count)
+    {
+        // the 8 nodes three levels down share a line
+        OMATH_PREFETCH(keys + std::min(8 * node, count));
+        node = (2 * node) + ((keys[node] <= time) ? 1 : 0);
+    }
+
+    return rankBelow(node);
+}
+
+//------------------------------------------------------------------------------
+//
+std::size_t U33SeekIndex::find(const U33& pts) const
+//
+/// @brief The sorted index of the last entry at or before a PTS
+///
+/// The PTS is taken to be within 2^32 ticks (13.2 hours at 90 kHz) after the
+/// first entry. One before the first entry, by the serial number rule, finds
+/// nothing. Longer recordings should look up unwrapped times.
+//------------------------------------------------------------------------------
+{
+    Extended time;
+    return toTime(pts, time) ? find(time) : NPOS;
+}
+
+//------------------------------------------------------------------------------
+//
+void U33SeekIndex::find(const Extended* times, std::size_t count, std::size_t* out) const
+//
+/// @brief find() for an array of unwrapped times
+//------------------------------------------------------------------------------
+{
+    for (std::size_t first = 0; first < count; first += LANES)
+    {
+        findGroup(times + first, std::min(LANES, count - first), out + first);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33SeekIndex::find(const U33* pts, std::size_t count, std::size_t* out) const
+//
+/// @brief find() for an array of PTS values
+//------------------------------------------------------------------------------
+{
+    Extended times[LANES];
+    bool valid[LANES];
+
+    for (std::size_t first = 0; first < count; first += LANES)
+    {
+        const std::size_t lanes = std::min(LANES, count - first);
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+        {
+            valid[lane] = toTime(pts[first + lane], times[lane]);
+        }
+
+        findGroup(times, lanes, out + first);
+
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+        {
+            out[first + lane] = valid[lane] ? out[first + lane] : NPOS;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+bool U33SeekIndex::seek(const U33& pts, Offset& offset) const
+//
+/// @brief The offset to start reading from for a PTS, false if there is none
+//------------------------------------------------------------------------------
+{
+    const std::size_t index = find(pts);
+    if (index == NPOS)
+    {
+        return false;
+    }
+
+    offset = mOffsets[index];
+    return true;
+}
+
+//------------------------------------------------------------------------------
+//
+bool U33SeekIndex::toTime(const U33& pts, Extended& time) const
+//
+/// @brief Place a PTS on the timeline after the first entry, false if before it
+//------------------------------------------------------------------------------
+{
+    if (mCount == 0)
+    {
+        return false;
+    }
+
+    const U33 step = pts - getPts(0);
+    time = mTimes[0] + Extended(0, step.getLsb32());
+
+    return !step.getMsb();
+}
+
+//------------------------------------------------------------------------------
+//
+std::size_t U33SeekIndex::rankBelow(std::size_t node) const
+//
+/// @brief The sorted index before the first key greater than the search time
+//------------------------------------------------------------------------------
+{
+    // past the last key when the search never went left
+    const std::size_t upper = ancestor(node);
+    const std::size_t rank  = (upper != 0) ? mRanks[upper] : mCount;
+
+    return (rank != 0) ? (rank - 1) : NPOS;
+}
+
+//------------------------------------------------------------------------------
+//
+void U33SeekIndex::findGroup(const Extended* times, std::size_t count, std::size_t* out) const
+//
+/// @brief Up to LANES searches a level at a time
+//------------------------------------------------------------------------------
+{
+    const Extended* keys = mKeys;
+    std::size_t nodes[LANES];
+    std::fill(nodes, nodes + count, 1);
+
+    // every search ends after this many levels or one fewer
+    unsigned int levels(0);
+    for (std::size_t remaining = mCount; remaining != 0; remaining >>= 1)
+    {
+        ++levels;
+    }
+
+    for (unsigned int level = 0; level < levels; ++level)
+    {
+        for (std::size_t lane = 0; lane < count; ++lane)
+        {
+            const std::size_t node   = nodes[lane];
+            const bool        inside = (node <= mCount);
+            const std::size_t next   = (2 * node) + ((keys[inside ? node : 0] <= times[lane]) ? 1 : 0);
+
+            nodes[lane] = inside ? next : node;
+            OMATH_PREFETCH(keys + std::min(8 * nodes[lane], mCount));
+        }
+    }
+
+    for (std::size_t lane = 0; lane < count; ++lane)
+    {
+        out[lane] = rankBelow(nodes[lane]);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33SeekIndex::attach(const unsigned char* image, std::size_t bytes)
+//
+/// @brief Point the sections into a checked image
+//------------------------------------------------------------------------------
+{
+    const Header* header = reinterpret_cast<const Header*>(image);
+    const Sections sections(header->mCount);
+
+    mImage   = image;
+    mBytes   = bytes;
+    mCount   = header->mCount;
+    mKeys    = reinterpret_cast<const Extended*>(image + sections.mKeys);
+    mRanks   = reinterpret_cast<const unsigned int*>(image + sections.mRanks);
+    mTimes   = reinterpret_cast<const Extended*>(image + sections.mTimes);
+    mOffsets = reinterpret_cast<const Offset*>(image + sections.mOffsets);
+}
+
+//------------------------------------------------------------------------------
+//
+void U33SeekIndex::unmap()
+//
+/// @brief Release a mapped file
+//------------------------------------------------------------------------------
+{
+#if !defined(_WIN32)
+    if (mMapping)
+    {
+        munmap(mMapping, mBytes);
+    }
+#endif
+
+    mMapping = 0;
+}
@@ -0,0 +1,211 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33SeekIndex.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_U33SEEKINDEX_H
+#define OMATH_U33SEEKINDEX_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33.h"
+#include "U33Unwrapper.h"
+
+//------------------------------------------------------------------------------
+//
+class U33SeekIndex
+//
+/// @name Immutable Timestamp to Byte Offset Index
+///
+/// Built from (PTS, offset) pairs in recording order. The PTS values are
+/// unwrapped onto the 64 bit timeline first, so a recording that crosses the
+/// 2^33 wrap stays sorted, then the times are laid out in Eytzinger (breadth
+/// first) order with 8 keys per 64 byte line. A lookup walks down that array
+/// and prefetches the line holding the next three levels, so it touches far
+/// fewer lines than a binary search over the sorted pairs.
+///
+/// The image is one flat block that save() writes as is and load() maps
+/// read only, so a saved index opens without being rebuilt. The entry count
+/// is limited to 2^32 - 2.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Types
+    /// @{
+    typedef U33Unwrapper::Extended Extended;
+    typedef UInt<64> Offset;
+    /// @}
+
+    /// @name Constants
+    /// @{
+    static const std::size_t NPOS = ~static_cast<std::size_t>(0);  ///< The result when no entry is <= the time
+    /// @}
+
+    /// @name Construction / Destruction
+    /// @{
+    U33SeekIndex();
+    ~U33SeekIndex();
+    /// @}
+
+    /// @name Building / Files
+    /// @{
+    void build(const U33* pts, const Offset* offsets, std::size_t count);
+    void build(const std::vector<U33>& pts, const std::vector<Offset>& offsets);
+    bool save(const std::string& name) const;
+    bool load(const std::string& name);
+    void clear();
+    /// @}
+
+    /// @name Lookup
+    /// @{
+    std::size_t find(const Extended& time) const;
+    std::size_t find(const U33& pts) const;
+    void find(const Extended* times, std::size_t count, std::size_t* out) const;
+    void find(const U33* pts, std::size_t count, std::size_t* out) const;
+    bool seek(const U33& pts, Offset& offset) const;
+    /// @}
+
+    /// @name Getters
+    /// @{
+    std::size_t size() const;
+    bool empty() const;
+    bool isMapped() const;
+    std::size_t memoryBytes() const;
+    const Extended& getTime(std::size_t index) const;
+    U33 getPts(std::size_t index) const;
+    const Offset& getOffset(std::size_t index) const;
+    /// @}
+
+private:
+
+    /// @name Disabled
+    /// @{
+    U33SeekIndex(const U33SeekIndex&);
+    U33SeekIndex& operator=(const U33SeekIndex&);
+    /// @}
+
+    /// @name Helpers
+    /// @{
+    bool toTime(const U33& pts, Extended& time) const;
+    std::size_t rankBelow(std::size_t node) const;
+    void findGroup(const Extended* times, std::size_t count, std::size_t* out) const;
+    void attach(const unsigned char* image, std::size_t bytes);
+    void unmap();
+    /// @}
+
+    /// @name Variables
+    /// @{
+    std::vector<unsigned char> mBuffer;     ///< The image when built or read, with room to align it
+    const unsigned char* mImage;            ///< The 64 byte aligned image, built or mapped
+    std::size_t mBytes;                     ///< The size of the image
+    void* mMapping;                         ///< The mapped file, if any
+    std::size_t mCount;                     ///< The number of entries
+    const Extended* mKeys;                  ///< Times in Eytzinger order, from index 1
+    const unsigned int* mRanks;             ///< The sorted index of each key
+    const Extended* mTimes;                 ///< Times in sorted order
+    const Offset* mOffsets;                 ///< Offsets in sorted order
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+inline std::size_t U33SeekIndex::size() const
+//
+/// @brief The number of entries
+//------------------------------------------------------------------------------
+{
+    return mCount;
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33SeekIndex::empty() const
+//
+/// @brief True when there are no entries
+//------------------------------------------------------------------------------
+{
+    return (mCount == 0);
+}
+
+//------------------------------------------------------------------------------
+//
+inline bool U33SeekIndex::isMapped() const
+//
+/// @brief True when the image is a mapped file rather than heap memory
+//------------------------------------------------------------------------------
+{
+    return (mMapping != 0);
+}
+
+//------------------------------------------------------------------------------
+//
+inline std::size_t U33SeekIndex::memoryBytes() const
+//
+/// @brief The size of the image, which is also the size of a saved file
+//------------------------------------------------------------------------------
+{
+    return mBytes;
+}
+
+//------------------------------------------------------------------------------
+//
+inline const U33SeekIndex::Extended& U33SeekIndex::getTime(std::size_t index) const
+//
+/// @brief The unwrapped time of the entry at a sorted index
+//------------------------------------------------------------------------------
+{
+    return mTimes[index];
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33 U33SeekIndex::getPts(std::size_t index) const
+//
+/// @brief The 33 bit PTS of the entry at a sorted index
+//------------------------------------------------------------------------------
+{
+    const Extended& time = mTimes[index];
+    return U33(time.getMsb32() & 1, time.getLsb32());
+}
+
+//------------------------------------------------------------------------------
+//
+inline const U33SeekIndex::Offset& U33SeekIndex::getOffset(std::size_t index) const
+//
+/// @brief The byte offset of the entry at a sorted index
+//------------------------------------------------------------------------------
+{
+    return mOffsets[index];
+}
+
+#endif // OMATH_U33SEEKINDEX_H
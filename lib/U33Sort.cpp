@@ -0,0 +1,377 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Sort.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33Sort.h"
+
+/// @name Constants
+/// @{
+static const unsigned int DIGIT_BITS = 11;
+static const unsigned int BUCKETS    = 1 << DIGIT_BITS;
+static const unsigned int DIGIT_MASK = BUCKETS - 1;
+static const unsigned int PASSES     = 3;
+
+/// Below this the bucket prefix sums cost more than an insertion sort
+static const std::size_t SMALL = 64;
+
+/// Fewer keys than this per thread are not worth starting a thread for
+static const std::size_t MIN_PER_THREAD = 1 << 16;
+/// @}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Pass>
+static unsigned int digit(const U33& key)
+//
+/// @brief The 11 bit digit of a U33 key for a pass
+//------------------------------------------------------------------------------
+{
+    const unsigned int lsb32 = key.getLsb32();
+
+    return (Pass < 2) ? ((lsb32 >> (Pass * DIGIT_BITS)) & DIGIT_MASK)
+                      : ((lsb32 >> (2 * DIGIT_BITS)) | (key.getUpper() << (32 - (2 * DIGIT_BITS))));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Pass>
+static unsigned int digit(unsigned int key)
+//
+/// @brief The digit of a 32 bit key for a pass, the last has 10 bits
+//------------------------------------------------------------------------------
+{
+    return ((key >> (Pass * DIGIT_BITS)) & DIGIT_MASK);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Key>
+static unsigned int digit(const Key& key, unsigned int pass)
+//
+/// @brief The digit of a key for a pass chosen at run time
+//------------------------------------------------------------------------------
+{
+    switch (pass)
+    {
+        case 0:  return digit<0>(key);
+        case 1:  return digit<1>(key);
+        default: return digit<2>(key);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Key>
+static void countDigits(const Key* keys, std::size_t count, std::size_t* counts)
+//
+/// @brief Add the digits of count keys to the three pass histograms
+//------------------------------------------------------------------------------
+{
+    std::size_t* counts0 = counts;
+    std::size_t* counts1 = counts + BUCKETS;
+    std::size_t* counts2 = counts + (2 * BUCKETS);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const Key key = keys[i];
+        ++counts0[digit<0>(key)];
+        ++counts1[digit<1>(key)];
+        ++counts2[digit<2>(key)];
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Key>
+static void histogram(const Key* keys, std::size_t count, unsigned int threads,
+                      std::vector<std::size_t>& counts)
+//
+/// @brief The three pass histograms, split across up to threads threads
+//------------------------------------------------------------------------------
+{
+    counts.assign(PASSES * BUCKETS, 0);
+
+    const std::size_t limit = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t parts = std::max<std::size_t>(1, std::min(limit, count / MIN_PER_THREAD));
+
+    if (parts == 1)
+    {
+        countDigits(keys, count, counts.data());
+        return;
+    }
+
+    // a private histogram per thread, summed at the end
+    std::vector<std::vector<std::size_t> > partial(parts, std::vector<std::size_t>(PASSES * BUCKETS, 0));
+    std::vector<std::thread> workers;
+    const std::size_t size = count / parts;
+
+    for (std::size_t part = 0; part < parts; ++part)
+    {
+        const std::size_t begin = part * size;
+        const std::size_t end   = (part + 1 == parts) ? count : (begin + size);
+
+        if (part + 1 == parts)
+        {
+            countDigits(keys + begin, end - begin, partial[part].data());
+        }
+        else
+        {
+            workers.push_back(std::thread(countDigits<Key>, keys + begin, end - begin, partial[part].data()));
+        }
+    }
+
+    for (std::size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i].join();
+    }
+
+    for (std::size_t part = 0; part < parts; ++part)
+    {
+        for (std::size_t i = 0; i < counts.size(); ++i)
+        {
+            counts[i] += partial[part][i];
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Pass, typename Key>
+static void scatter(const Key* from, Key* to, const unsigned int* fromPayloads, unsigned int* toPayloads,
+                    std::size_t count, std::size_t* offsets)
+//
+/// @brief Stable scatter of one pass, offsets are the bucket starts
+//------------------------------------------------------------------------------
+{
+    if (fromPayloads)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const Key key = from[i];
+            const std::size_t at = offsets[digit<Pass>(key)]++;
+            to[at] = key;
+            toPayloads[at] = fromPayloads[i];
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const Key key = from[i];
+            to[offsets[digit<Pass>(key)]++] = key;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Key>
+static void insertionSort(Key* keys, unsigned int* payloads, std::size_t count)
+//
+/// @brief Stable sort of a few keys
+//------------------------------------------------------------------------------
+{
+    for (std::size_t i = 1; i < count; ++i)
+    {
+        const Key key = keys[i];
+        const unsigned int payload = payloads ? payloads[i] : 0;
+
+        std::size_t j = i;
+        for (; (j > 0) && (key < keys[j - 1]); --j)
+        {
+            keys[j] = keys[j - 1];
+            if (payloads)
+            {
+                payloads[j] = payloads[j - 1];
+            }
+        }
+
+        keys[j] = key;
+        if (payloads)
+        {
+            payloads[j] = payload;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Key>
+static void radixSort(Key* keys, unsigned int* payloads, std::size_t count, unsigned int threads)
+//
+/// @brief Sort keys (and payloads when not null) in place
+//------------------------------------------------------------------------------
+{
+    if (count < SMALL)
+    {
+        insertionSort(keys, payloads, count);
+        return;
+    }
+
+    std::vector<std::size_t> counts;
+    histogram(keys, count, threads, counts);
+
+    std::vector<Key> keyScratch(count);
+    std::vector<unsigned int> payloadScratch(payloads ? count : 0);
+
+    Key* from = keys;
+    Key* to   = keyScratch.data();
+    unsigned int* fromPayloads = payloads;
+    unsigned int* toPayloads   = payloads ? payloadScratch.data() : 0;
+
+    for (unsigned int pass = 0; pass < PASSES; ++pass)
+    {
+        std::size_t* offsets = &counts[pass * BUCKETS];
+
+        // every key in one bucket, the pass would not move anything
+        if (offsets[digit(from[0], pass)] == count)
+        {
+            continue;
+        }
+
+        std::size_t total(0);
+        for (unsigned int bucket = 0; bucket < BUCKETS; ++bucket)
+        {
+            const std::size_t size = offsets[bucket];
+            offsets[bucket] = total;
+            total += size;
+        }
+
+        switch (pass)
+        {
+            case 0:  scatter<0>(from, to, fromPayloads, toPayloads, count, offsets); break;
+            case 1:  scatter<1>(from, to, fromPayloads, toPayloads, count, offsets); break;
+            default: scatter<2>(from, to, fromPayloads, toPayloads, count, offsets); break;
+        }
+
+        std::swap(from, to);
+        std::swap(fromPayloads, toPayloads);
+    }
+
+    // an odd number of passes leaves the result in the scratch buffers
+    if (from != keys)
+    {
+        std::copy(from, from + count, keys);
+        if (payloads)
+        {
+            std::copy(fromPayloads, fromPayloads + count, payloads);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Sort::sort(U33* keys, std::size_t count, unsigned int threads)
+//
+/// @brief Sort an array of keys
+//------------------------------------------------------------------------------
+{
+    radixSort(keys, static_cast<unsigned int*>(0), count, threads);
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Sort::sort(std::vector<U33>& keys, unsigned int threads)
+//
+/// @brief Sort a vector of keys
+//------------------------------------------------------------------------------
+{
+    radixSort(keys.data(), static_cast<unsigned int*>(0), keys.size(), threads);
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Sort::sort(U33PackedArray& keys, unsigned int threads)
+//
+/// @brief Sort a packed array
+///
+/// Every key with bit 32 clear sorts before every key with it set, so the
+/// lower words are split on bit 32 and each side sorted as 32 bit keys,
+/// moving 4 bytes per key per pass.
+//------------------------------------------------------------------------------
+{
+    const std::size_t count = keys.size();
+    const unsigned int* lsb32 = keys.lsb32Data();
+    const unsigned int* plane = keys.msbPlaneData();
+
+    // clear from the front, set from the back
+    std::vector<unsigned int> words(count);
+    std::size_t clear(0);
+    std::size_t set(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if ((plane[i / 32] >> (i % 32)) & 1)
+        {
+            words[--set] = lsb32[i];
+        }
+        else
+        {
+            words[clear++] = lsb32[i];
+        }
+    }
+
+    radixSort(words.data(), static_cast<unsigned int*>(0), clear, threads);
+    radixSort(words.data() + clear, static_cast<unsigned int*>(0), count - clear, threads);
+
+    keys.clear();
+    keys.appendWords(words.data(), clear, false);
+    keys.appendWords(words.data() + clear, count - clear, true);
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Sort::sort(U33* keys, unsigned int* payloads, std::size_t count, unsigned int threads)
+//
+/// @brief Sort keys, moving each payload with its key
+//------------------------------------------------------------------------------
+{
+    radixSort(keys, payloads, count, threads);
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Sort::sort(std::vector<U33>& keys, std::vector<unsigned int>& payloads, unsigned int threads)
+//
+/// @brief Sort keys, moving each payload with its key
+//------------------------------------------------------------------------------
+{
+    if (payloads.size() != keys.size())
+    {
+        throw std::invalid_argument("U33Sort::sort");
+    }
+
+    radixSort(keys.data(), payloads.data(), keys.size(), threads);
+}
@@ -0,0 +1,73 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Sort.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_U33SORT_H
+#define OMATH_U33SORT_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33.h"
+#include "U33PackedArray.h"
+
+//------------------------------------------------------------------------------
+//
+class U33Sort
+//
+/// @name LSD Radix Sort for U33 Keys
+///
+/// Three passes over 11 bit digits (bits 0-10, 11-21 and 22-32), each a
+/// stable counting scatter, after one read that builds all three digit
+/// histograms. That read can be split across threads (0 for one per core).
+/// A pass is skipped when every key has the same digit. Pairs carry an
+/// unsigned int payload per key (e.g. an index into the caller's records)
+/// and keep equal keys in their original order. Sorts ascending by
+/// operator<, in place, with a scratch buffer the size of the input.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Keys
+    /// @{
+    static void sort(U33* keys, std::size_t count, unsigned int threads=1);
+    static void sort(std::vector<U33>& keys, unsigned int threads=1);
+    static void sort(U33PackedArray& keys, unsigned int threads=1);
+    /// @}
+
+    /// @name Key / Payload Pairs
+    /// @{
+    static void sort(U33* keys, unsigned int* payloads, std::size_t count, unsigned int threads=1);
+    static void sort(std::vector<U33>& keys, std::vector<unsigned int>& payloads, unsigned int threads=1);
+    /// @}
+};
+
+#endif // OMATH_U33SORT_H
@@ -0,0 +1,196 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Unwrapper.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+// none
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33Unwrapper.h"
+
+//------------------------------------------------------------------------------
+// Constants
+//------------------------------------------------------------------------------
+/// The batch is classified in blocks of this many samples on the stack
+static const std::size_t BLOCK = 256;
+
+//------------------------------------------------------------------------------
+//
+U33Unwrapper::U33Unwrapper(const U33& maxStep)
+//
+/// @brief Constructor, steps larger than maxStep are flagged as discontinuities
+//------------------------------------------------------------------------------
+    : mMaxStep(maxStep)
+    , mLast()
+    , mEpoch(0)
+    , mStarted(false)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Unwrapper::unwrap(const U33* values, std::size_t count, Extended* out, unsigned char* flags)
+//
+/// @brief Unwrap count samples into out, and optionally their flags
+///
+/// The first pass classifies each step from its pair of samples alone, so it
+/// has no loop carried state and is left to the vectoriser. The second pass
+/// is the running sum of the epoch changes.
+//------------------------------------------------------------------------------
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (!mStarted)
+    {
+        unsigned int first(0);
+        out[0] = unwrap(values[0], first);
+        if (flags)
+        {
+            flags[0] = static_cast<unsigned char>(first);
+        }
+
+        ++values;
+        ++out;
+        flags = flags ? flags + 1 : 0;
+        --count;
+    }
+
+    signed char   change[BLOCK];
+    unsigned char state[BLOCK];
+
+    const U33 maxStep = mMaxStep;
+
+    while (count)
+    {
+        const std::size_t block = (count < BLOCK) ? count : BLOCK;
+
+        // classify every step against the sample before it
+        int first(0);
+        state[0]  = static_cast<unsigned char>(classify(mLast, values[0], maxStep, first));
+        change[0] = static_cast<signed char>(first);
+
+        for (std::size_t i = 1; i < block; ++i)
+        {
+            int step(0);
+            state[i]  = static_cast<unsigned char>(classify(values[i - 1], values[i], maxStep, step));
+            change[i] = static_cast<signed char>(step);
+        }
+
+        // accumulate the epoch and rebuild the extended values
+        unsigned int epoch = mEpoch;
+        for (std::size_t i = 0; i < block; ++i)
+        {
+            epoch += static_cast<unsigned int>(static_cast<int>(change[i]));
+            out[i] = extend(epoch, values[i]);
+            state[i] |= static_cast<unsigned char>((epoch >> 31) ? FLAG_CLAMPED : 0);
+        }
+
+        if (flags)
+        {
+            for (std::size_t i = 0; i < block; ++i)
+            {
+                flags[i] = state[i];
+            }
+            flags += block;
+        }
+
+        mEpoch = epoch;
+        mLast  = values[block - 1];
+
+        values += block;
+        out    += block;
+        count  -= block;
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Unwrapper::reset()
+//
+/// @brief Forget the stream, the next sample starts a new timeline at epoch 0
+//------------------------------------------------------------------------------
+{
+    mLast    = U33();
+    mEpoch   = 0;
+    mStarted = false;
+}
+
+//------------------------------------------------------------------------------
+//
+bool U33Unwrapper::isStarted() const
+//
+/// @brief True once a sample has been unwrapped
+//------------------------------------------------------------------------------
+{
+    return mStarted;
+}
+
+//------------------------------------------------------------------------------
+//
+const U33& U33Unwrapper::getLast() const
+//
+/// @brief The previous sample
+//------------------------------------------------------------------------------
+{
+    return mLast;
+}
+
+//------------------------------------------------------------------------------
+//
+unsigned int U33Unwrapper::getEpoch() const
+//
+/// @brief The number of 2^33 periods before the previous sample (modulo
+/// 2^32, so 0xffffffff is the period before the timeline's zero)
+//------------------------------------------------------------------------------
+{
+    return mEpoch;
+}
+
+//------------------------------------------------------------------------------
+//
+U33Unwrapper::Extended U33Unwrapper::getExtended() const
+//
+/// @brief The extended value of the previous sample, 0 if it was clamped
+//------------------------------------------------------------------------------
+{
+    return extend(mEpoch, mLast);
+}
+
+//------------------------------------------------------------------------------
+//
+const U33& U33Unwrapper::getMaxStep() const
+//
+/// @brief The largest step that is not flagged as a discontinuity
+//------------------------------------------------------------------------------
+{
+    return mMaxStep;
+}
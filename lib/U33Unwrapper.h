@@ -0,0 +1,180 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Unwrapper.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_U33UNWRAPPER_H
+#define OMATH_U33UNWRAPPER_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <cstddef>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33.h"
+
+//------------------------------------------------------------------------------
+//
+class U33Unwrapper
+//
+/// @name Wraparound Unwrapper from U33 onto a 64 bit timeline
+///
+/// Each sample is placed in the 2^33 period nearest the previous sample, so
+/// the extended value is epoch * 2^33 + sample where the epoch only moves
+/// when consecutive samples straddle the wrap. Steps of less than half the
+/// range (2^32) are followed in either direction, exactly half counts as
+/// backwards. A step backwards is flagged rather than clamped, so reordered
+/// timestamps (e.g. B frame PTS) keep their true position. The timeline
+/// starts at epoch 0, so a sample before its zero (a step back across the
+/// wrap before any step forward across it) is returned as 0 and flagged;
+/// the extended values never decrease past the start. O(1) per sample with
+/// no allocation.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Types
+    /// @{
+    typedef UInt<64> Extended;
+
+    enum Flags
+    {
+        FLAG_FIRST          = 0x01,     ///< First sample since construction / reset
+        FLAG_WRAP           = 0x02,     ///< The epoch changed on this sample
+        FLAG_BACKWARD       = 0x04,     ///< The sample is before the previous one
+        FLAG_DISCONTINUITY  = 0x08,     ///< The step exceeded the maximum step
+        FLAG_CLAMPED        = 0x10      ///< The sample is before the timeline's zero, returned as 0
+    };
+    /// @}
+
+    /// @name Construction / Destruction
+    /// @{
+    explicit U33Unwrapper(const U33& maxStep=U33(1, 0));
+    /// @}
+
+    /// @name Unwrapping
+    /// @{
+    Extended unwrap(const U33& value);
+    Extended unwrap(const U33& value, unsigned int& flags);
+    void unwrap(const U33* values, std::size_t count, Extended* out, unsigned char* flags=0);
+    void reset();
+    /// @}
+
+    /// @name Getters
+    /// @{
+    bool isStarted() const;
+    const U33& getLast() const;
+    unsigned int getEpoch() const;
+    Extended getExtended() const;
+    const U33& getMaxStep() const;
+    /// @}
+
+private:
+
+    /// @name Helpers
+    /// @{
+    static Extended extend(unsigned int epoch, const U33& value);
+    static unsigned int classify(const U33& previous, const U33& value, const U33& maxStep, int& change);
+    /// @}
+
+    /// @name Variables
+    /// @{
+    U33 mMaxStep;           ///< Steps larger than this are discontinuities
+    U33 mLast;              ///< The previous sample
+    unsigned int mEpoch;    ///< The number of 2^33 periods before mLast, negative (bit 31) before zero
+    bool mStarted;          ///< True once a sample has been seen
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+inline U33Unwrapper::Extended U33Unwrapper::extend(unsigned int epoch, const U33& value)
+//
+/// @brief epoch * 2^33 + value, or 0 for a negative epoch
+//------------------------------------------------------------------------------
+{
+    // all ones from epoch 0 to 2^31 - 1, zero below it
+    const unsigned int keep = (epoch >> 31) - 1;
+
+    return Extended(((epoch << 1) | (value.getMsb() ? 1 : 0)) & keep, value.getLsb32() & keep);
+}
+
+//------------------------------------------------------------------------------
+//
+inline unsigned int U33Unwrapper::classify(const U33& previous, const U33& value, const U33& maxStep, int& change)
+//
+/// @brief The flags for the step from previous to value, and the epoch change
+//------------------------------------------------------------------------------
+{
+    // a step with bit 32 set is a (shorter) step backwards
+    const U33  step     = value - previous;
+    const bool backward = step.getMsb();
+    const U33  distance = backward ? (previous - value) : step;
+
+    // forwards past MAX33 or backwards past zero
+    const bool up   = !backward && (value < previous);
+    const bool down =  backward && (previous < value);
+
+    change = (up ? 1 : 0) - (down ? 1 : 0);
+
+    return ((up || down)          ? FLAG_WRAP : 0)      |
+           (backward              ? FLAG_BACKWARD : 0)  |
+           ((maxStep < distance)  ? FLAG_DISCONTINUITY : 0);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33Unwrapper::Extended U33Unwrapper::unwrap(const U33& value)
+//
+/// @brief Unwrap the next sample
+//------------------------------------------------------------------------------
+{
+    unsigned int flags(0);
+    return unwrap(value, flags);
+}
+
+//------------------------------------------------------------------------------
+//
+inline U33Unwrapper::Extended U33Unwrapper::unwrap(const U33& value, unsigned int& flags)
+//
+/// @brief Unwrap the next sample, reporting what happened in flags
+//------------------------------------------------------------------------------
+{
+    // the first sample is taken as its own reference
+    int change(0);
+    flags = classify(mStarted ? mLast : value, value, mMaxStep, change) |
+            (mStarted ? 0 : FLAG_FIRST);
+
+    mEpoch   = mEpoch + static_cast<unsigned int>(change);
+    mLast    = value;
+    mStarted = true;
+    flags   |= (mEpoch >> 31) ? FLAG_CLAMPED : 0;
+
+    return extend(mEpoch, value);
+}
+
+#endif // OMATH_U33UNWRAPPER_H
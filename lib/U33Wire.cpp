@@ -0,0 +1,119 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Wire.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+// none
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33Wire.h"
+
+//------------------------------------------------------------------------------
+// Constants
+//------------------------------------------------------------------------------
+const std::size_t U33Wire::TIMESTAMP_BYTES;
+const std::size_t U33Wire::PCR_BYTES;
+const unsigned int U33Wire::PREFIX_DTS;
+const unsigned int U33Wire::PREFIX_PTS;
+const unsigned int U33Wire::PREFIX_PTS_DTS;
+
+//------------------------------------------------------------------------------
+//
+std::size_t U33Wire::decodeTimestamps(const unsigned char* in, std::size_t stride,
+                                      U33* values, std::size_t count, bool* valid)
+//
+/// @brief Gather count PTS / DTS fields that are stride bytes apart
+/// @return The number with valid marker bits, valid[i] flags each one
+//------------------------------------------------------------------------------
+{
+    std::size_t good(0);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const bool marked = decodeTimestamp(in + (i * stride), values[i]);
+
+        if (valid)
+        {
+            valid[i] = marked;
+        }
+
+        good += marked ? 1 : 0;
+    }
+
+    return good;
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Wire::encodeTimestamps(unsigned char* out, std::size_t stride,
+                               const U33* values, std::size_t count, unsigned int prefix)
+//
+/// @brief Scatter count PTS / DTS fields stride bytes apart
+//------------------------------------------------------------------------------
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        encodeTimestamp(out + (i * stride), values[i], prefix);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Wire::decodePcrs(const unsigned char* in, std::size_t stride,
+                         U33* bases, unsigned int* extensions, std::size_t count)
+//
+/// @brief Gather count PCR fields stride bytes apart, extensions may be null
+//------------------------------------------------------------------------------
+{
+    unsigned int extension(0);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        decodePcr(in + (i * stride), bases[i], extension);
+
+        if (extensions)
+        {
+            extensions[i] = extension;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void U33Wire::encodePcrs(unsigned char* out, std::size_t stride,
+                         const U33* bases, const unsigned int* extensions, std::size_t count)
+//
+/// @brief Scatter count PCR fields stride bytes apart, null extensions are 0
+//------------------------------------------------------------------------------
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        encodePcr(out + (i * stride), bases[i], extensions ? extensions[i] : 0);
+    }
+}
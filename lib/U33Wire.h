@@ -0,0 +1,173 @@
+//------------------------------------------------------------------------------
+//
+// Filename: U33Wire.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_U33WIRE_H
+#define OMATH_U33WIRE_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <cstddef>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33.h"
+
+//------------------------------------------------------------------------------
+//
+class U33Wire
+//
+/// @name MPEG-TS Wire Formats holding 33 bit fields
+///
+/// Reads and writes the fields in place in the packet buffer, the caller
+/// passes a pointer to the first byte of the field.
+///
+/// PES PTS / DTS (5 bytes, ISO 13818-1 2.4.3.7):
+///   pppp 3332  2222 2222  1111 111m  1111 1111  0000 000m
+/// with the 4 bit prefix p, bits 32..0 of the value and marker bits m = 1.
+///
+/// PCR (6 bytes, ISO 13818-1 2.4.3.5): the 33 bit base, 6 reserved bits
+/// (written as 1) and the 9 bit extension, all big endian.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Constants
+    /// @{
+    static const std::size_t TIMESTAMP_BYTES = 5;
+    static const std::size_t PCR_BYTES       = 6;
+
+    static const unsigned int PREFIX_DTS        = 0x1;  ///< DTS after a PTS
+    static const unsigned int PREFIX_PTS        = 0x2;  ///< PTS without a DTS
+    static const unsigned int PREFIX_PTS_DTS    = 0x3;  ///< PTS followed by a DTS
+    /// @}
+
+    /// @name PES PTS / DTS
+    /// @{
+    static bool decodeTimestamp(const unsigned char* in, U33& value);
+    static void encodeTimestamp(unsigned char* out, const U33& value, unsigned int prefix);
+    static std::size_t decodeTimestamps(const unsigned char* in, std::size_t stride,
+                                        U33* values, std::size_t count, bool* valid=0);
+    static void encodeTimestamps(unsigned char* out, std::size_t stride,
+                                 const U33* values, std::size_t count, unsigned int prefix);
+    /// @}
+
+    /// @name PCR
+    /// @{
+    static void decodePcr(const unsigned char* in, U33& base, unsigned int& extension);
+    static void encodePcr(unsigned char* out, const U33& base, unsigned int extension);
+    static UInt<42> toPcrTicks(const U33& base, unsigned int extension);
+    static void decodePcrs(const unsigned char* in, std::size_t stride,
+                           U33* bases, unsigned int* extensions, std::size_t count);
+    static void encodePcrs(unsigned char* out, std::size_t stride,
+                           const U33* bases, const unsigned int* extensions, std::size_t count);
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+inline bool U33Wire::decodeTimestamp(const unsigned char* in, U33& value)
+//
+/// @brief Read a PES PTS / DTS
+/// @return True when all three marker bits are set (value is read regardless)
+//------------------------------------------------------------------------------
+{
+    const unsigned int b0 = in[0];
+    const unsigned int b1 = in[1];
+    const unsigned int b2 = in[2];
+    const unsigned int b3 = in[3];
+    const unsigned int b4 = in[4];
+
+    value = U33((b0 >> 3) & 1,
+                (((b0 >> 1) & 0x3) << 30) | (b1 << 22) | ((b2 >> 1) << 15) | (b3 << 7) | (b4 >> 1));
+
+    return ((b0 & b2 & b4 & 1) != 0);
+}
+
+//------------------------------------------------------------------------------
+//
+inline void U33Wire::encodeTimestamp(unsigned char* out, const U33& value, unsigned int prefix)
+//
+/// @brief Write a PES PTS / DTS with the given 4 bit prefix and marker bits
+//------------------------------------------------------------------------------
+{
+    const unsigned int msb   = value.getUpper();
+    const unsigned int lsb32 = value.getLsb32();
+
+    out[0] = static_cast<unsigned char>(((prefix & 0xf) << 4) | (msb << 3) | ((lsb32 >> 29) & 0x6) | 1);
+    out[1] = static_cast<unsigned char>(lsb32 >> 22);
+    out[2] = static_cast<unsigned char>(((lsb32 >> 14) & 0xfe) | 1);
+    out[3] = static_cast<unsigned char>(lsb32 >> 7);
+    out[4] = static_cast<unsigned char>(((lsb32 << 1) & 0xfe) | 1);
+}
+
+//------------------------------------------------------------------------------
+//
+inline void U33Wire::decodePcr(const unsigned char* in, U33& base, unsigned int& extension)
+//
+/// @brief Read a PCR base and extension
+//------------------------------------------------------------------------------
+{
+    const unsigned int b0 = in[0];
+    const unsigned int b4 = in[4];
+
+    base = U33(b0 >> 7,
+               ((b0 & 0x7f) << 25) | (static_cast<unsigned int>(in[1]) << 17) |
+               (static_cast<unsigned int>(in[2]) << 9) | (static_cast<unsigned int>(in[3]) << 1) | (b4 >> 7));
+
+    extension = ((b4 & 1) << 8) | in[5];
+}
+
+//------------------------------------------------------------------------------
+//
+inline void U33Wire::encodePcr(unsigned char* out, const U33& base, unsigned int extension)
+//
+/// @brief Write a PCR base and (9 bit) extension, the reserved bits set
+//------------------------------------------------------------------------------
+{
+    const unsigned int msb   = base.getUpper();
+    const unsigned int lsb32 = base.getLsb32();
+
+    out[0] = static_cast<unsigned char>((msb << 7) | (lsb32 >> 25));
+    out[1] = static_cast<unsigned char>(lsb32 >> 17);
+    out[2] = static_cast<unsigned char>(lsb32 >> 9);
+    out[3] = static_cast<unsigned char>(lsb32 >> 1);
+    out[4] = static_cast<unsigned char>(((lsb32 & 1) << 7) | 0x7e | ((extension >> 8) & 1));
+    out[5] = static_cast<unsigned char>(extension);
+}
+
+//------------------------------------------------------------------------------
+//
+inline UInt<42> U33Wire::toPcrTicks(const U33& base, unsigned int extension)
+//
+/// @brief The full 27 MHz PCR, base * 300 + extension
+//------------------------------------------------------------------------------
+{
+    return ((UInt<42>(base.getUpper(), base.getLsb32()) * 300u) + extension);
+}
+
+#endif // OMATH_U33WIRE_H
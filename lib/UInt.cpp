@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------------
+//
+// Filename: UInt.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <iostream>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "UInt.h"
+
+//------------------------------------------------------------------------------
+// Namespaces
+//------------------------------------------------------------------------------
+using namespace std;
+
+//------------------------------------------------------------------------------
+//
+std::ostream& UIntStream::write(std::ostream& stream,
+                                unsigned int upper, unsigned int upperDigits,
+                                unsigned int lsb32, unsigned int lsb32Digits)
+//
+/// @brief Stream Output
+/// @return A Reference to the modified stream
+//------------------------------------------------------------------------------
+{
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    // "0x" and up to 16 digits, formatted here so the stream state is untouched
+    char text[2 + 16 + 1];
+    char* out = text;
+
+    *out++ = '0';
+    *out++ = 'x';
+
+    for (unsigned int digit = upperDigits; digit > 0; --digit)
+    {
+        *out++ = HEX_DIGITS[(upper >> (4 * (digit - 1))) & 0xf];
+    }
+
+    for (unsigned int digit = lsb32Digits; digit > 0; --digit)
+    {
+        *out++ = HEX_DIGITS[(lsb32 >> (4 * (digit - 1))) & 0xf];
+    }
+
+    *out = '\0';
+
+    return (stream << text);
+}
@@ -0,0 +1,2485 @@
+//------------------------------------------------------------------------------
+//
+// Filename: UInt.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_UINT_H
+#define OMATH_UINT_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <iosfwd>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+// none
+
+//------------------------------------------------------------------------------
+// Configuration
+//------------------------------------------------------------------------------
+#ifndef OMATH_INSTRUMENTATION
+#define OMATH_INSTRUMENTATION 0
+#endif
+
+/// The U33 storage: 16 for the 17 / 16 split, 32 for 32 + 1 or 64 for one
+/// native 64 bit word. The omath_u33_layout CMake option sets it per target.
+#ifndef OMATH_U33_LAYOUT
+#define OMATH_U33_LAYOUT 16
+#endif
+
+#if (OMATH_U33_LAYOUT != 16) && (OMATH_U33_LAYOUT != 32) && (OMATH_U33_LAYOUT != 64)
+#error "OMATH_U33_LAYOUT must be 16, 32 or 64"
+#endif
+
+//------------------------------------------------------------------------------
+//
+class UIntProbe
+//
+/// @name Hot path hook of the opt in U33 instrumentation
+///
+/// With OMATH_INSTRUMENTATION set (the omath_enable_instrumentation CMake
+/// option) the U33 operators count what they do into per thread counters,
+/// which UIntCounters merges on demand. Otherwise OMATH_COUNT expands to
+/// nothing and neither the counts nor their conditions are compiled.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Types
+    /// @{
+    enum Event
+    {
+        ADD,                    ///< operator+ and +=
+        SUB,                    ///< operator- and -=
+        ADD_UINT,               ///< operator+ with an unsigned operand
+        ADD_INT,                ///< operator+ with an int operand
+        SUB_UINT,               ///< operator- with an unsigned operand
+        SUB_INT,                ///< operator- with an int operand
+        MUL_UINT,               ///< operator* with an unsigned operand
+        DIVIDE_UINT,            ///< operator/ with an unsigned operand
+        MODULO_UINT,            ///< operator% with an unsigned operand
+        MUL,                    ///< operator*
+        DIVIDE,                 ///< operator/ and %, the bit serial slow path
+        DIVIDE_CONSTANT,        ///< divideBy() and remainderBy(), which also
+                                ///< counts its multiply and subtract
+        SATURATE,               ///< addSaturate() and subSaturate()
+        SERIAL,                 ///< isBefore(), isAfter() and distanceTo()
+        ADD_WRAP,               ///< Additions that wrapped past the maximum
+        SUB_UNDERFLOW,          ///< Subtractions that wrapped below zero
+        SATURATED,              ///< Saturating operations that clamped
+        DIVIDE_BY_ZERO,         ///< Divisions and remainders by zero
+        DISTANCE_CLAMPED,       ///< distanceTo() results clamped to an int
+        EVENT_COUNT
+    };
+    /// @}
+
+    /// @name Constants
+    /// @{
+    static const bool ENABLED = (OMATH_INSTRUMENTATION != 0);
+    /// @}
+
+    /// @name Counting
+    /// @{
+    static void count(Event event);
+    /// @}
+};
+
+/// @brief Counts event for a U33 when condition holds, outside constant
+///        evaluation. Compiles to nothing unless OMATH_INSTRUMENTATION is set.
+#if OMATH_INSTRUMENTATION
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define OMATH_HAS_CONSTANT_EVALUATED 1
+#endif
+#elif (defined(__GNUC__) && (__GNUC__ >= 9)) || (defined(_MSC_VER) && (_MSC_VER >= 1925))
+#define OMATH_HAS_CONSTANT_EVALUATED 1
+#endif
+#ifndef OMATH_HAS_CONSTANT_EVALUATED
+#error "OMATH_INSTRUMENTATION needs __builtin_is_constant_evaluated (GCC 9, Clang 9, MSVC 19.25)"
+#endif
+#define OMATH_COUNT(bits, event, condition) \
+    ((((bits) == 33) && !__builtin_is_constant_evaluated() && (condition)) ? UIntProbe::count(event) : (void)0)
+#else
+#define OMATH_COUNT(bits, event, condition) ((void)0)
+#endif
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int N>
+struct UIntMask
+//
+/// @name Mask of the N least significant bits (N <= 32)
+//------------------------------------------------------------------------------
+{
+    static const unsigned int VALUE = (N >= 32) ? 0xffffffffu
+                                                : ((1u << (N % 32)) - 1u);
+};
+
+//------------------------------------------------------------------------------
+//
+class UIntMath
+//
+/// @name 32 bit building blocks shared by the layouts
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Multiplication
+    /// @{
+    static constexpr void mul32(unsigned int lhs, unsigned int rhs, unsigned int& hi, unsigned int& lo);
+    /// @}
+
+    /// @name Carry / Borrow
+    /// @{
+    static constexpr unsigned int add32(unsigned int lhs, unsigned int rhs, unsigned int& carry);
+    static constexpr unsigned int sub32(unsigned int lhs, unsigned int rhs, unsigned int& borrow);
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+class UIntWordLayout
+//
+/// @name Single word storage for widths of up to 32 bits
+//------------------------------------------------------------------------------
+{
+public:
+
+    static_assert((Bits >= 1) && (Bits <= 32), "word layout holds 1 to 32 bits");
+
+    /// @name Storage
+    /// @{
+    struct Storage
+    {
+        unsigned int mWord;     ///< The value
+    };
+    /// @}
+
+    /// @name Conversion
+    /// @{
+    static constexpr Storage make(unsigned int upper, unsigned int lsb32);
+    static constexpr unsigned int upper(const Storage& value);
+    static constexpr unsigned int lsb32(const Storage& value);
+    /// @}
+
+    /// @name Arithmetic / Comparison
+    /// @{
+    static constexpr Storage add(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage sub(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage addCarry(const Storage& lhs, const Storage& rhs, unsigned int& carry);
+    static constexpr Storage subBorrow(const Storage& lhs, const Storage& rhs, unsigned int& borrow);
+    static constexpr Storage mul(const Storage& lhs, const Storage& rhs);
+    static constexpr bool equal(const Storage& lhs, const Storage& rhs);
+    static constexpr bool less(const Storage& lhs, const Storage& rhs);
+    /// @}
+
+    /// @name Bitwise
+    /// @{
+    static constexpr Storage bitAnd(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage bitOr(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage bitXor(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage bitNot(const Storage& value);
+    /// @}
+
+    /// @name Lanes
+    /// @{
+    static const unsigned int LANE_SHIFT = 32;
+    static constexpr unsigned long long laneHi(const Storage& value);
+    static constexpr unsigned long long laneLo(const Storage& value);
+    static constexpr Storage fromLanes(unsigned long long hi, unsigned long long lo);
+    /// @}
+
+private:
+
+    /// @name Constants
+    /// @{
+    static const unsigned int MASK = UIntMask<Bits>::VALUE;
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+class UIntSplit16Layout
+//
+/// @name Upper (Bits - 16) bits / lower 16 bits storage
+///
+/// The carry out of the lower half lands in bit 16 and a borrow sets bit 31,
+/// so both propagate with a shift and no compare. This is the original U33
+/// 17 / 16 layout.
+//------------------------------------------------------------------------------
+{
+public:
+
+    static_assert((Bits >= 33) && (Bits <= 47), "split 16 layout holds 33 to 47 bits");
+
+    /// @name Storage
+    /// @{
+    struct Storage
+    {
+        unsigned int mHi;       ///< The (Bits - 16) most significant bits
+        unsigned int mLo;       ///< The 16 least significant bits
+    };
+    /// @}
+
+    /// @name Conversion
+    /// @{
+    static constexpr Storage make(unsigned int upper, unsigned int lsb32);
+    static constexpr unsigned int upper(const Storage& value);
+    static constexpr unsigned int lsb32(const Storage& value);
+    /// @}
+
+    /// @name Arithmetic / Comparison
+    /// @{
+    static constexpr Storage add(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage sub(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage addCarry(const Storage& lhs, const Storage& rhs, unsigned int& carry);
+    static constexpr Storage subBorrow(const Storage& lhs, const Storage& rhs, unsigned int& borrow);
+    static constexpr Storage mul(const Storage& lhs, const Storage& rhs);
+    static constexpr bool equal(const Storage& lhs, const Storage& rhs);
+    static constexpr bool less(const Storage& lhs, const Storage& rhs);
+    /// @}
+
+    /// @name Bitwise
+    /// @{
+    static constexpr Storage bitAnd(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage bitOr(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage bitXor(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage bitNot(const Storage& value);
+    /// @}
+
+    /// @name Lanes
+    /// @{
+    static const unsigned int LANE_SHIFT = 16;
+    static constexpr unsigned long long laneHi(const Storage& value);
+    static constexpr unsigned long long laneLo(const Storage& value);
+    static constexpr Storage fromLanes(unsigned long long hi, unsigned long long lo);
+    /// @}
+
+private:
+
+    /// @name Constants
+    /// @{
+    static const unsigned int MASK_HI    = UIntMask<Bits - 16>::VALUE;
+    static const unsigned int MASK_UPPER = UIntMask<Bits - 32>::VALUE;
+    static const unsigned int MASK_16BIT = 0xffff;
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+class UIntSplit32Layout
+//
+/// @name Lower 32 bits / upper (Bits - 32) bits storage
+//------------------------------------------------------------------------------
+{
+public:
+
+    static_assert((Bits >= 33) && (Bits <= 64), "split 32 layout holds 33 to 64 bits");
+
+    /// @name Storage
+    /// @{
+    struct Storage
+    {
+        unsigned int mLo;       ///< The 32 least significant bits
+        unsigned int mHi;       ///< The (Bits - 32) most significant bits
+    };
+    /// @}
+
+    /// @name Conversion
+    /// @{
+    static constexpr Storage make(unsigned int upper, unsigned int lsb32);
+    static constexpr unsigned int upper(const Storage& value);
+    static constexpr unsigned int lsb32(const Storage& value);
+    /// @}
+
+    /// @name Arithmetic / Comparison
+    /// @{
+    static constexpr Storage add(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage sub(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage addCarry(const Storage& lhs, const Storage& rhs, unsigned int& carry);
+    static constexpr Storage subBorrow(const Storage& lhs, const Storage& rhs, unsigned int& borrow);
+    static constexpr Storage mul(const Storage& lhs, const Storage& rhs);
+    static constexpr bool equal(const Storage& lhs, const Storage& rhs);
+    static constexpr bool less(const Storage& lhs, const Storage& rhs);
+    /// @}
+
+    /// @name Bitwise
+    /// @{
+    static constexpr Storage bitAnd(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage bitOr(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage bitXor(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage bitNot(const Storage& value);
+    /// @}
+
+    /// @name Lanes
+    /// @{
+    static const unsigned int LANE_SHIFT = 32;
+    static constexpr unsigned long long laneHi(const Storage& value);
+    static constexpr unsigned long long laneLo(const Storage& value);
+    static constexpr Storage fromLanes(unsigned long long hi, unsigned long long lo);
+    /// @}
+
+private:
+
+    /// @name Constants
+    /// @{
+    static const unsigned int MASK_HI = UIntMask<Bits - 32>::VALUE;
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+class UIntNative64Layout
+//
+/// @name Single 64 bit word storage for widths of 33 to 64 bits
+///
+/// For targets with 64 bit registers, where each operation is one
+/// instruction and a mask. The one layout that uses a 64 bit type.
+//------------------------------------------------------------------------------
+{
+public:
+
+    static_assert((Bits >= 33) && (Bits <= 64), "native 64 layout holds 33 to 64 bits");
+
+    /// @name Storage
+    /// @{
+    struct Storage
+    {
+        unsigned long long mWord;   ///< The value
+    };
+    /// @}
+
+    /// @name Conversion
+    /// @{
+    static constexpr Storage make(unsigned int upper, unsigned int lsb32);
+    static constexpr unsigned int upper(const Storage& value);
+    static constexpr unsigned int lsb32(const Storage& value);
+    /// @}
+
+    /// @name Arithmetic / Comparison
+    /// @{
+    static constexpr Storage add(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage sub(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage addCarry(const Storage& lhs, const Storage& rhs, unsigned int& carry);
+    static constexpr Storage subBorrow(const Storage& lhs, const Storage& rhs, unsigned int& borrow);
+    static constexpr Storage mul(const Storage& lhs, const Storage& rhs);
+    static constexpr bool equal(const Storage& lhs, const Storage& rhs);
+    static constexpr bool less(const Storage& lhs, const Storage& rhs);
+    /// @}
+
+    /// @name Bitwise
+    /// @{
+    static constexpr Storage bitAnd(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage bitOr(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage bitXor(const Storage& lhs, const Storage& rhs);
+    static constexpr Storage bitNot(const Storage& value);
+    /// @}
+
+    /// @name Lanes
+    /// @{
+    static const unsigned int LANE_SHIFT = 32;
+    static constexpr unsigned long long laneHi(const Storage& value);
+    static constexpr unsigned long long laneLo(const Storage& value);
+    static constexpr Storage fromLanes(unsigned long long hi, unsigned long long lo);
+    /// @}
+
+private:
+
+    /// @name Constants
+    /// @{
+    static const unsigned long long MASK = ~0ULL >> (64 - Bits);
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits,
+          unsigned int Kind = (Bits <= 32) ? 1 : ((Bits <= 47) ? 2 : 3)>
+struct UIntDefaultLayout
+//
+/// @name Compile time layout selection for a given width
+///
+/// Up to 32 bits fit a single word. Up to 47 bits use the 16 bit split, whose
+/// upper half still has a spare sign bit for the borrow chain compare. Wider
+/// values keep a whole 32 bit lower word. 33 bits take the layout named by
+/// OMATH_U33_LAYOUT, which the build sets (see U33).
+//------------------------------------------------------------------------------
+{
+    typedef UIntWordLayout<Bits> Type;
+};
+
+/// @cond
+template <unsigned int Bits>
+struct UIntDefaultLayout<Bits, 2> { typedef UIntSplit16Layout<Bits> Type; };
+
+template <unsigned int Bits>
+struct UIntDefaultLayout<Bits, 3> { typedef UIntSplit32Layout<Bits> Type; };
+
+#if (OMATH_U33_LAYOUT == 32)
+template <>
+struct UIntDefaultLayout<33, 2> { typedef UIntSplit32Layout<33> Type; };
+#elif (OMATH_U33_LAYOUT == 64)
+template <>
+struct UIntDefaultLayout<33, 2> { typedef UIntNative64Layout<33> Type; };
+#endif
+/// @endcond
+
+/// @name Forward Declarations
+/// @{
+template <unsigned int Bits, typename Layout> class UIntDivider;
+template <unsigned int Bits, typename Layout, unsigned int Divisor> struct UIntConstantDivider;
+/// @}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout = typename UIntDefaultLayout<Bits>::Type>
+class UInt
+//
+/// @name Fixed Width Unsigned Integer
+///
+/// Unsigned arithmetic modulo 2^Bits for 1 <= Bits <= 64 built from 32 bit
+/// unsigned ints, or one 64 bit word with UIntNative64Layout. The storage is
+/// chosen at compile time by the Layout policy. Everything is constexpr and
+/// the class is a trivially copyable literal type, so values and tables of
+/// values can be built at compile time.
+//------------------------------------------------------------------------------
+{
+public:
+
+    static_assert((Bits >= 1) && (Bits <= 64), "UInt holds 1 to 64 bits");
+
+    /// @name Types / Constants
+    /// @{
+    typedef Layout LayoutType;
+    static const unsigned int BITS = Bits;
+    static const unsigned int LANE_SHIFT = Layout::LANE_SHIFT;
+    /// @}
+
+    /// @name Construction / Destruction
+    /// @{
+    explicit constexpr UInt(unsigned int lsb32);
+    constexpr UInt(unsigned int msb=0, unsigned int lsb32=0);
+    static constexpr UInt fromLanes(unsigned long long hi, unsigned long long lo);
+    /// @}
+
+    /// @name Addition / Subtraction Methods
+    /// @{
+    constexpr UInt operator+(unsigned int val) const;
+    constexpr UInt operator-(unsigned int val) const;
+    constexpr UInt operator+(int val) const;
+    constexpr UInt operator-(int val) const;
+    constexpr UInt operator+(const UInt& ref) const;
+    constexpr UInt operator-(const UInt& ref) const;
+    /// @}
+
+    /// @name Carry / Saturating Methods
+    /// @{
+    constexpr UInt addCarry(const UInt& ref, bool& carry) const;
+    constexpr UInt subBorrow(const UInt& ref, bool& borrow) const;
+    constexpr UInt addSaturate(const UInt& ref) const;
+    constexpr UInt subSaturate(const UInt& ref) const;
+    /// @}
+
+    /// @name Multiplication / Division Methods
+    /// @{
+    constexpr UInt operator*(unsigned int val) const;
+    constexpr UInt operator/(unsigned int val) const;
+    constexpr UInt operator%(unsigned int val) const;
+    constexpr UInt operator*(const UInt& ref) const;
+    constexpr UInt operator/(const UInt& ref) const;
+    constexpr UInt operator%(const UInt& ref) const;
+    template <unsigned int Divisor> constexpr UInt divideBy() const;
+    template <unsigned int Divisor> constexpr UInt remainderBy() const;
+    /// @}
+
+    /// @name Shift / Bitwise Methods
+    /// @{
+    constexpr UInt operator<<(unsigned int shift) const;
+    constexpr UInt operator>>(unsigned int shift) const;
+    constexpr UInt operator&(const UInt& ref) const;
+    constexpr UInt operator|(const UInt& ref) const;
+    constexpr UInt operator^(const UInt& ref) const;
+    constexpr UInt operator~() const;
+    /// @}
+
+    /// @name Changer Methods
+    /// @{
+    constexpr const UInt& operator+=(const UInt& ref);
+    constexpr const UInt& operator-=(const UInt& ref);
+    constexpr const UInt& operator*=(const UInt& ref);
+    constexpr const UInt& operator/=(const UInt& ref);
+    constexpr const UInt& operator%=(const UInt& ref);
+    constexpr const UInt& operator<<=(unsigned int shift);
+    constexpr const UInt& operator>>=(unsigned int shift);
+    constexpr const UInt& operator&=(const UInt& ref);
+    constexpr const UInt& operator|=(const UInt& ref);
+    constexpr const UInt& operator^=(const UInt& ref);
+    /// @}
+
+    /// @name Equality / Inequality Methods
+    /// @{
+    constexpr bool operator==(const UInt& ref) const;
+    constexpr bool operator!=(const UInt& ref) const;
+    constexpr bool operator< (const UInt& ref) const;
+    constexpr bool operator<=(const UInt& ref) const;
+    constexpr bool operator> (const UInt& ref) const;
+    constexpr bool operator>=(const UInt& ref) const;
+    /// @}
+
+    /// @name Serial Number Methods
+    /// @{
+    constexpr bool isBefore(const UInt& ref) const;
+    constexpr bool isAfter(const UInt& ref) const;
+    constexpr int distanceTo(const UInt& ref) const;
+    /// @}
+
+    /// @name Getters
+    /// @{
+    constexpr void getRaw(unsigned int& msb, unsigned int& lsb16) const;
+    constexpr void getLanes(unsigned long long& hi, unsigned long long& lo) const;
+    constexpr bool getMsb() const;
+    constexpr bool getLsb() const;
+    constexpr unsigned int getMsb32() const;
+    constexpr unsigned int getLsb32() const;
+    constexpr unsigned int getUpper() const;
+    /// @}
+
+private:
+
+    /// @name Types
+    /// @{
+    typedef typename Layout::Storage Storage;
+    /// @}
+
+    /// @name Helpers
+    /// @{
+    static constexpr UInt fromStorage(const Storage& data);
+    static constexpr void divMod(const UInt& dividend, const UInt& divisor, UInt& quotient, UInt& remainder);
+    /// @}
+
+    /// @name Constants
+    /// @{
+    static const unsigned int UPPER_BITS = (Bits > 32) ? (Bits - 32) : 0;
+    /// @}
+
+    /// @name Variables
+    /// @{
+    Storage mData;          ///< The value in the layout's representation
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+class UIntStream
+//
+/// @name Out of line stream support shared by every width
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Output
+    /// @{
+    static std::ostream& write(std::ostream& stream,
+                               unsigned int upper, unsigned int upperDigits,
+                               unsigned int lsb32, unsigned int lsb32Digits);
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+inline std::ostream& operator<<(std::ostream& stream, const UInt<Bits, Layout>& value)
+//
+/// @brief Stream Output Operator
+/// @return A Reference to the modified stream
+//------------------------------------------------------------------------------
+{
+    // one hex digit per nibble of each word
+    const unsigned int upperDigits = (Bits > 32) ? ((Bits - 29) / 4) : 0;
+    const unsigned int lsb32Digits = (Bits > 32) ? 8 : ((Bits + 3) / 4);
+
+    return UIntStream::write(stream, value.getUpper(), upperDigits,
+                             value.getLsb32(), lsb32Digits);
+}
+
+//==============================================================================
+// UIntMath
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+constexpr void UIntMath::mul32(unsigned int lhs, unsigned int rhs, unsigned int& hi, unsigned int& lo)
+//
+/// @brief Full 32 x 32 -> 64 bit product from four 16 x 16 partial products
+//------------------------------------------------------------------------------
+{
+    const unsigned int p00 = (lhs & 0xffff) * (rhs & 0xffff);
+    const unsigned int p01 = (lhs & 0xffff) * (rhs >> 16);
+    const unsigned int p10 = (lhs >> 16)    * (rhs & 0xffff);
+    const unsigned int p11 = (lhs >> 16)    * (rhs >> 16);
+
+    // the middle column holds at most three 16 bit values
+    const unsigned int mid = (p00 >> 16) + (p01 & 0xffff) + (p10 & 0xffff);
+
+    lo = (mid << 16) | (p00 & 0xffff);
+    hi = p11 + (p01 >> 16) + (p10 >> 16) + (mid >> 16);
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr unsigned int UIntMath::add32(unsigned int lhs, unsigned int rhs, unsigned int& carry)
+//
+/// @brief Full word addition with carry in and out (each 0 or 1)
+//------------------------------------------------------------------------------
+{
+    const unsigned int sum = lhs + rhs + carry;
+
+    // the carry out is the majority of the operand and inverted sum top bits
+    carry = ((lhs & rhs) | ((lhs | rhs) & ~sum)) >> 31;
+
+    return sum;
+}
+
+//------------------------------------------------------------------------------
+//
+constexpr unsigned int UIntMath::sub32(unsigned int lhs, unsigned int rhs, unsigned int& borrow)
+//
+/// @brief Full word subtraction with borrow in and out (each 0 or 1)
+//------------------------------------------------------------------------------
+{
+    const unsigned int diff = lhs - rhs - borrow;
+
+    borrow = ((~lhs & rhs) | (~(lhs ^ rhs) & diff)) >> 31;
+
+    return diff;
+}
+
+//==============================================================================
+// UIntWordLayout
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntWordLayout<Bits>::Storage
+UIntWordLayout<Bits>::make(unsigned int /*upper*/, unsigned int lsb32)
+//
+/// @brief Build the storage from the bits above 32 and the lower 32 bits
+//------------------------------------------------------------------------------
+{
+    const Storage result = { lsb32 & MASK };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned int UIntWordLayout<Bits>::upper(const Storage& /*value*/)
+//
+/// @brief The bits above the lower 32
+//------------------------------------------------------------------------------
+{
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned int UIntWordLayout<Bits>::lsb32(const Storage& value)
+//
+/// @brief The lower 32 bits
+//------------------------------------------------------------------------------
+{
+    return value.mWord;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntWordLayout<Bits>::Storage
+UIntWordLayout<Bits>::add(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Modular Addition
+//------------------------------------------------------------------------------
+{
+    const Storage result = { (lhs.mWord + rhs.mWord) & MASK };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntWordLayout<Bits>::Storage
+UIntWordLayout<Bits>::sub(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Modular Subtraction
+//------------------------------------------------------------------------------
+{
+    const Storage result = { (lhs.mWord - rhs.mWord) & MASK };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntWordLayout<Bits>::Storage
+UIntWordLayout<Bits>::addCarry(const Storage& lhs, const Storage& rhs, unsigned int& carry)
+//
+/// @brief Addition with carry in and out (each 0 or 1)
+//------------------------------------------------------------------------------
+{
+    if (Bits == 32)
+    {
+        const Storage result = { UIntMath::add32(lhs.mWord, rhs.mWord, carry) };
+        return result;
+    }
+
+    // the carry out lands in bit Bits
+    const unsigned int sum = lhs.mWord + rhs.mWord + carry;
+    carry = sum >> (Bits % 32);
+
+    const Storage result = { sum & MASK };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntWordLayout<Bits>::Storage
+UIntWordLayout<Bits>::subBorrow(const Storage& lhs, const Storage& rhs, unsigned int& borrow)
+//
+/// @brief Subtraction with borrow in and out (each 0 or 1)
+//------------------------------------------------------------------------------
+{
+    if (Bits == 32)
+    {
+        const Storage result = { UIntMath::sub32(lhs.mWord, rhs.mWord, borrow) };
+        return result;
+    }
+
+    // a borrow out sets bit 31
+    const unsigned int diff = lhs.mWord - rhs.mWord - borrow;
+    borrow = diff >> 31;
+
+    const Storage result = { diff & MASK };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr bool UIntWordLayout<Bits>::equal(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Equality
+//------------------------------------------------------------------------------
+{
+    return (lhs.mWord == rhs.mWord);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr bool UIntWordLayout<Bits>::less(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Less Than
+//------------------------------------------------------------------------------
+{
+    return (lhs.mWord < rhs.mWord);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntWordLayout<Bits>::Storage
+UIntWordLayout<Bits>::mul(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Modular Multiplication
+//------------------------------------------------------------------------------
+{
+    const Storage result = { (lhs.mWord * rhs.mWord) & MASK };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntWordLayout<Bits>::Storage
+UIntWordLayout<Bits>::bitAnd(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Bitwise And
+//------------------------------------------------------------------------------
+{
+    const Storage result = { lhs.mWord & rhs.mWord };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntWordLayout<Bits>::Storage
+UIntWordLayout<Bits>::bitOr(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Bitwise Or
+//------------------------------------------------------------------------------
+{
+    const Storage result = { lhs.mWord | rhs.mWord };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntWordLayout<Bits>::Storage
+UIntWordLayout<Bits>::bitXor(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Bitwise Exclusive Or
+//------------------------------------------------------------------------------
+{
+    const Storage result = { lhs.mWord ^ rhs.mWord };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntWordLayout<Bits>::Storage
+UIntWordLayout<Bits>::bitNot(const Storage& value)
+//
+/// @brief Bitwise Complement
+//------------------------------------------------------------------------------
+{
+    const Storage result = { ~value.mWord & MASK };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned long long UIntWordLayout<Bits>::laneHi(const Storage& /*value*/)
+//
+/// @brief The high lane, weighted 2^LANE_SHIFT
+//------------------------------------------------------------------------------
+{
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned long long UIntWordLayout<Bits>::laneLo(const Storage& value)
+//
+/// @brief The low lane
+//------------------------------------------------------------------------------
+{
+    return value.mWord;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntWordLayout<Bits>::Storage
+UIntWordLayout<Bits>::fromLanes(unsigned long long /*hi*/, unsigned long long lo)
+//
+/// @brief Normalise summed lanes, which may have wrapped modulo 2^64
+//------------------------------------------------------------------------------
+{
+    const Storage result = { static_cast<unsigned int>(lo) & MASK };
+    return result;
+}
+
+//==============================================================================
+// UIntSplit16Layout
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit16Layout<Bits>::Storage
+UIntSplit16Layout<Bits>::make(unsigned int upper, unsigned int lsb32)
+//
+/// @brief Build the storage from the bits above 32 and the lower 32 bits
+//------------------------------------------------------------------------------
+{
+    const Storage result = { ((upper & MASK_UPPER) << 16) | (lsb32 >> 16),
+                             lsb32 & MASK_16BIT };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned int UIntSplit16Layout<Bits>::upper(const Storage& value)
+//
+/// @brief The bits above the lower 32
+//------------------------------------------------------------------------------
+{
+    return (value.mHi >> 16);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned int UIntSplit16Layout<Bits>::lsb32(const Storage& value)
+//
+/// @brief The lower 32 bits
+//------------------------------------------------------------------------------
+{
+    return ((value.mHi << 16) | value.mLo);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit16Layout<Bits>::Storage
+UIntSplit16Layout<Bits>::add(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Modular Addition
+//------------------------------------------------------------------------------
+{
+    // the carry out of the lower half lands in bit 16
+    const unsigned int lo = lhs.mLo + rhs.mLo;
+
+    const Storage result = { (lhs.mHi + rhs.mHi + (lo >> 16)) & MASK_HI,
+                             lo & MASK_16BIT };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit16Layout<Bits>::Storage
+UIntSplit16Layout<Bits>::sub(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Modular Subtraction
+//------------------------------------------------------------------------------
+{
+    // a borrow out of the lower half sets bit 31
+    const unsigned int lo = lhs.mLo - rhs.mLo;
+
+    const Storage result = { (lhs.mHi - rhs.mHi - (lo >> 31)) & MASK_HI,
+                             lo & MASK_16BIT };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit16Layout<Bits>::Storage
+UIntSplit16Layout<Bits>::addCarry(const Storage& lhs, const Storage& rhs, unsigned int& carry)
+//
+/// @brief Addition with carry in and out (each 0 or 1)
+//------------------------------------------------------------------------------
+{
+    // the carry out of each part lands just above it
+    const unsigned int lo = lhs.mLo + rhs.mLo + carry;
+    const unsigned int hi = lhs.mHi + rhs.mHi + (lo >> 16);
+    carry = hi >> (Bits - 16);
+
+    const Storage result = { hi & MASK_HI, lo & MASK_16BIT };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit16Layout<Bits>::Storage
+UIntSplit16Layout<Bits>::subBorrow(const Storage& lhs, const Storage& rhs, unsigned int& borrow)
+//
+/// @brief Subtraction with borrow in and out (each 0 or 1)
+//------------------------------------------------------------------------------
+{
+    // a borrow out of either part sets bit 31
+    const unsigned int lo = lhs.mLo - rhs.mLo - borrow;
+    const unsigned int hi = lhs.mHi - rhs.mHi - (lo >> 31);
+    borrow = hi >> 31;
+
+    const Storage result = { hi & MASK_HI, lo & MASK_16BIT };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr bool UIntSplit16Layout<Bits>::equal(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Equality
+//------------------------------------------------------------------------------
+{
+    return (((lhs.mHi ^ rhs.mHi) | (lhs.mLo ^ rhs.mLo)) == 0);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr bool UIntSplit16Layout<Bits>::less(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Less Than
+///
+/// Runs the borrow chain of (lhs - rhs) without masking: the upper half
+/// goes negative exactly when rhs is the larger value.
+//------------------------------------------------------------------------------
+{
+    const unsigned int borrow = (lhs.mLo - rhs.mLo) >> 31;
+    return (((lhs.mHi - rhs.mHi - borrow) >> 31) != 0);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit16Layout<Bits>::Storage
+UIntSplit16Layout<Bits>::mul(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Modular Multiplication
+//------------------------------------------------------------------------------
+{
+    // lo * lo is a full 16x16 product, the carry from it and the cross terms
+    // are only needed modulo 2^(Bits - 16) so they may wrap
+    const unsigned int lo = lhs.mLo * rhs.mLo;
+    const unsigned int hi = (lo >> 16) +
+                            (lhs.mHi * rhs.mLo) +
+                            (lhs.mLo * rhs.mHi) +
+                            ((lhs.mHi * rhs.mHi) << 16);
+
+    const Storage result = { hi & MASK_HI, lo & MASK_16BIT };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit16Layout<Bits>::Storage
+UIntSplit16Layout<Bits>::bitAnd(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Bitwise And
+//------------------------------------------------------------------------------
+{
+    const Storage result = { lhs.mHi & rhs.mHi, lhs.mLo & rhs.mLo };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit16Layout<Bits>::Storage
+UIntSplit16Layout<Bits>::bitOr(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Bitwise Or
+//------------------------------------------------------------------------------
+{
+    const Storage result = { lhs.mHi | rhs.mHi, lhs.mLo | rhs.mLo };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit16Layout<Bits>::Storage
+UIntSplit16Layout<Bits>::bitXor(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Bitwise Exclusive Or
+//------------------------------------------------------------------------------
+{
+    const Storage result = { lhs.mHi ^ rhs.mHi, lhs.mLo ^ rhs.mLo };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit16Layout<Bits>::Storage
+UIntSplit16Layout<Bits>::bitNot(const Storage& value)
+//
+/// @brief Bitwise Complement
+//------------------------------------------------------------------------------
+{
+    const Storage result = { ~value.mHi & MASK_HI, ~value.mLo & MASK_16BIT };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned long long UIntSplit16Layout<Bits>::laneHi(const Storage& value)
+//
+/// @brief The high lane, weighted 2^LANE_SHIFT
+//------------------------------------------------------------------------------
+{
+    return value.mHi;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned long long UIntSplit16Layout<Bits>::laneLo(const Storage& value)
+//
+/// @brief The low lane
+//------------------------------------------------------------------------------
+{
+    return value.mLo;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit16Layout<Bits>::Storage
+UIntSplit16Layout<Bits>::fromLanes(unsigned long long hi, unsigned long long lo)
+//
+/// @brief Normalise summed lanes, which may have wrapped modulo 2^64
+//------------------------------------------------------------------------------
+{
+    // the bits of lo above 16 carry into hi, 2^33 divides 2^64 so a wrapped
+    // (negative) lo folds out too
+    const Storage result = { static_cast<unsigned int>(hi + (lo >> 16)) & MASK_HI,
+                             static_cast<unsigned int>(lo) & MASK_16BIT };
+    return result;
+}
+
+//==============================================================================
+// UIntSplit32Layout
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit32Layout<Bits>::Storage
+UIntSplit32Layout<Bits>::make(unsigned int upper, unsigned int lsb32)
+//
+/// @brief Build the storage from the bits above 32 and the lower 32 bits
+//------------------------------------------------------------------------------
+{
+    const Storage result = { lsb32, upper & MASK_HI };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned int UIntSplit32Layout<Bits>::upper(const Storage& value)
+//
+/// @brief The bits above the lower 32
+//------------------------------------------------------------------------------
+{
+    return value.mHi;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned int UIntSplit32Layout<Bits>::lsb32(const Storage& value)
+//
+/// @brief The lower 32 bits
+//------------------------------------------------------------------------------
+{
+    return value.mLo;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit32Layout<Bits>::Storage
+UIntSplit32Layout<Bits>::add(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Modular Addition
+//------------------------------------------------------------------------------
+{
+    // the lower word wrapped if it ended up below either operand
+    const unsigned int lo    = lhs.mLo + rhs.mLo;
+    const unsigned int carry = (lo < rhs.mLo) ? 1 : 0;
+
+    const Storage result = { lo, (lhs.mHi + rhs.mHi + carry) & MASK_HI };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit32Layout<Bits>::Storage
+UIntSplit32Layout<Bits>::sub(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Modular Subtraction
+//------------------------------------------------------------------------------
+{
+    const unsigned int borrow = (lhs.mLo < rhs.mLo) ? 1 : 0;
+
+    const Storage result = { lhs.mLo - rhs.mLo,
+                             (lhs.mHi - rhs.mHi - borrow) & MASK_HI };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit32Layout<Bits>::Storage
+UIntSplit32Layout<Bits>::addCarry(const Storage& lhs, const Storage& rhs, unsigned int& carry)
+//
+/// @brief Addition with carry in and out (each 0 or 1)
+//------------------------------------------------------------------------------
+{
+    const unsigned int lo = UIntMath::add32(lhs.mLo, rhs.mLo, carry);
+
+    if (Bits == 64)
+    {
+        const Storage result = { lo, UIntMath::add32(lhs.mHi, rhs.mHi, carry) };
+        return result;
+    }
+
+    const unsigned int hi = lhs.mHi + rhs.mHi + carry;
+    carry = hi >> (Bits % 32);
+
+    const Storage result = { lo, hi & MASK_HI };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit32Layout<Bits>::Storage
+UIntSplit32Layout<Bits>::subBorrow(const Storage& lhs, const Storage& rhs, unsigned int& borrow)
+//
+/// @brief Subtraction with borrow in and out (each 0 or 1)
+//------------------------------------------------------------------------------
+{
+    const unsigned int lo = UIntMath::sub32(lhs.mLo, rhs.mLo, borrow);
+
+    if (Bits == 64)
+    {
+        const Storage result = { lo, UIntMath::sub32(lhs.mHi, rhs.mHi, borrow) };
+        return result;
+    }
+
+    const unsigned int hi = lhs.mHi - rhs.mHi - borrow;
+    borrow = hi >> 31;
+
+    const Storage result = { lo, hi & MASK_HI };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr bool UIntSplit32Layout<Bits>::equal(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Equality
+//------------------------------------------------------------------------------
+{
+    return (((lhs.mHi ^ rhs.mHi) | (lhs.mLo ^ rhs.mLo)) == 0);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr bool UIntSplit32Layout<Bits>::less(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Less Than
+//------------------------------------------------------------------------------
+{
+    return ((lhs.mHi < rhs.mHi) | ((lhs.mHi == rhs.mHi) & (lhs.mLo < rhs.mLo)));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit32Layout<Bits>::Storage
+UIntSplit32Layout<Bits>::mul(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Modular Multiplication
+//------------------------------------------------------------------------------
+{
+    // the full 64 bit product of the lower words, the cross terms are only
+    // needed modulo 2^(Bits - 32) so they may wrap
+    unsigned int hi(0);
+    unsigned int lo(0);
+    UIntMath::mul32(lhs.mLo, rhs.mLo, hi, lo);
+
+    hi += (lhs.mHi * rhs.mLo) + (lhs.mLo * rhs.mHi);
+
+    const Storage result = { lo, hi & MASK_HI };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit32Layout<Bits>::Storage
+UIntSplit32Layout<Bits>::bitAnd(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Bitwise And
+//------------------------------------------------------------------------------
+{
+    const Storage result = { lhs.mLo & rhs.mLo, lhs.mHi & rhs.mHi };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit32Layout<Bits>::Storage
+UIntSplit32Layout<Bits>::bitOr(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Bitwise Or
+//------------------------------------------------------------------------------
+{
+    const Storage result = { lhs.mLo | rhs.mLo, lhs.mHi | rhs.mHi };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit32Layout<Bits>::Storage
+UIntSplit32Layout<Bits>::bitXor(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Bitwise Exclusive Or
+//------------------------------------------------------------------------------
+{
+    const Storage result = { lhs.mLo ^ rhs.mLo, lhs.mHi ^ rhs.mHi };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit32Layout<Bits>::Storage
+UIntSplit32Layout<Bits>::bitNot(const Storage& value)
+//
+/// @brief Bitwise Complement
+//------------------------------------------------------------------------------
+{
+    const Storage result = { ~value.mLo, ~value.mHi & MASK_HI };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned long long UIntSplit32Layout<Bits>::laneHi(const Storage& value)
+//
+/// @brief The high lane, weighted 2^LANE_SHIFT
+//------------------------------------------------------------------------------
+{
+    return value.mHi;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned long long UIntSplit32Layout<Bits>::laneLo(const Storage& value)
+//
+/// @brief The low lane
+//------------------------------------------------------------------------------
+{
+    return value.mLo;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntSplit32Layout<Bits>::Storage
+UIntSplit32Layout<Bits>::fromLanes(unsigned long long hi, unsigned long long lo)
+//
+/// @brief Normalise summed lanes, which may have wrapped modulo 2^64
+//------------------------------------------------------------------------------
+{
+    const Storage result = { static_cast<unsigned int>(lo),
+                             static_cast<unsigned int>(hi + (lo >> 32)) & MASK_HI };
+    return result;
+}
+
+//==============================================================================
+// UIntNative64Layout
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntNative64Layout<Bits>::Storage
+UIntNative64Layout<Bits>::make(unsigned int upper, unsigned int lsb32)
+//
+/// @brief Build the storage from the bits above 32 and the lower 32 bits
+//------------------------------------------------------------------------------
+{
+    const Storage result = { ((static_cast<unsigned long long>(upper) << 32) | lsb32) & MASK };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned int UIntNative64Layout<Bits>::upper(const Storage& value)
+//
+/// @brief The bits above the lower 32
+//------------------------------------------------------------------------------
+{
+    return static_cast<unsigned int>(value.mWord >> 32);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned int UIntNative64Layout<Bits>::lsb32(const Storage& value)
+//
+/// @brief The lower 32 bits
+//------------------------------------------------------------------------------
+{
+    return static_cast<unsigned int>(value.mWord);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntNative64Layout<Bits>::Storage
+UIntNative64Layout<Bits>::add(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Modular Addition
+//------------------------------------------------------------------------------
+{
+    const Storage result = { (lhs.mWord + rhs.mWord) & MASK };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntNative64Layout<Bits>::Storage
+UIntNative64Layout<Bits>::sub(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Modular Subtraction
+//------------------------------------------------------------------------------
+{
+    const Storage result = { (lhs.mWord - rhs.mWord) & MASK };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntNative64Layout<Bits>::Storage
+UIntNative64Layout<Bits>::addCarry(const Storage& lhs, const Storage& rhs, unsigned int& carry)
+//
+/// @brief Addition with carry in and out (each 0 or 1)
+//------------------------------------------------------------------------------
+{
+    const unsigned long long partial = lhs.mWord + rhs.mWord;
+    const unsigned long long sum     = partial + carry;
+
+    // below 64 bits the carry out is the bit above the value
+    carry = (Bits == 64) ? (((partial < lhs.mWord) | (sum < partial)) ? 1 : 0)
+                         : static_cast<unsigned int>(sum >> (Bits % 64));
+
+    const Storage result = { sum & MASK };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntNative64Layout<Bits>::Storage
+UIntNative64Layout<Bits>::subBorrow(const Storage& lhs, const Storage& rhs, unsigned int& borrow)
+//
+/// @brief Subtraction with borrow in and out (each 0 or 1)
+//------------------------------------------------------------------------------
+{
+    const unsigned long long partial = lhs.mWord - rhs.mWord;
+    const unsigned long long diff    = partial - borrow;
+
+    // below 64 bits a borrow sets the top bit
+    borrow = (Bits == 64) ? (((lhs.mWord < rhs.mWord) | (partial < borrow)) ? 1 : 0)
+                          : static_cast<unsigned int>(diff >> 63);
+
+    const Storage result = { diff & MASK };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntNative64Layout<Bits>::Storage
+UIntNative64Layout<Bits>::mul(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Modular Multiplication
+//------------------------------------------------------------------------------
+{
+    const Storage result = { (lhs.mWord * rhs.mWord) & MASK };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr bool UIntNative64Layout<Bits>::equal(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Equality
+//------------------------------------------------------------------------------
+{
+    return (lhs.mWord == rhs.mWord);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr bool UIntNative64Layout<Bits>::less(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Less Than
+//------------------------------------------------------------------------------
+{
+    return (lhs.mWord < rhs.mWord);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntNative64Layout<Bits>::Storage
+UIntNative64Layout<Bits>::bitAnd(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Bitwise And
+//------------------------------------------------------------------------------
+{
+    const Storage result = { lhs.mWord & rhs.mWord };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntNative64Layout<Bits>::Storage
+UIntNative64Layout<Bits>::bitOr(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Bitwise Or
+//------------------------------------------------------------------------------
+{
+    const Storage result = { lhs.mWord | rhs.mWord };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntNative64Layout<Bits>::Storage
+UIntNative64Layout<Bits>::bitXor(const Storage& lhs, const Storage& rhs)
+//
+/// @brief Bitwise Exclusive Or
+//------------------------------------------------------------------------------
+{
+    const Storage result = { lhs.mWord ^ rhs.mWord };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntNative64Layout<Bits>::Storage
+UIntNative64Layout<Bits>::bitNot(const Storage& value)
+//
+/// @brief Bitwise Complement
+//------------------------------------------------------------------------------
+{
+    const Storage result = { ~value.mWord & MASK };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned long long UIntNative64Layout<Bits>::laneHi(const Storage& /*value*/)
+//
+/// @brief The high lane, weighted 2^LANE_SHIFT
+//------------------------------------------------------------------------------
+{
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr unsigned long long UIntNative64Layout<Bits>::laneLo(const Storage& value)
+//
+/// @brief The low lane
+//------------------------------------------------------------------------------
+{
+    return value.mWord;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+constexpr typename UIntNative64Layout<Bits>::Storage
+UIntNative64Layout<Bits>::fromLanes(unsigned long long hi, unsigned long long lo)
+//
+/// @brief Normalise summed lanes, which may have wrapped modulo 2^64
+//------------------------------------------------------------------------------
+{
+    const Storage result = { ((hi << LANE_SHIFT) + lo) & MASK };
+    return result;
+}
+
+//==============================================================================
+// UInt
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout>::UInt(unsigned int lsb32)
+//
+/// @brief Default Constructor
+//------------------------------------------------------------------------------
+    : mData(Layout::make(0, lsb32))
+{
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout>::UInt(unsigned int msb, unsigned int lsb32)
+//
+/// @brief Default Constructor
+/// @param msb   The bits above the lower 32 (ignored when Bits <= 32)
+/// @param lsb32 The lower 32 bits
+//------------------------------------------------------------------------------
+    : mData(Layout::make(msb, lsb32))
+{
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::fromLanes(unsigned long long hi, unsigned long long lo)
+//
+/// @brief Lane Constructor
+///
+/// The value hi * 2^LANE_SHIFT + lo modulo 2^Bits, for lanes summed from
+/// getLanes() that may have wrapped modulo 2^64.
+//------------------------------------------------------------------------------
+{
+    return fromStorage(Layout::fromLanes(hi, lo));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::fromStorage(const Storage& data)
+//
+/// @brief Wrap an already normalised storage value
+//------------------------------------------------------------------------------
+{
+    UInt newValue;
+    newValue.mData = data;
+    return newValue;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator+(unsigned int val) const
+//
+/// @brief Addition Operator
+//------------------------------------------------------------------------------
+{
+    OMATH_COUNT(Bits, UIntProbe::ADD_UINT, true);
+    return (*this + UInt(0, val));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator+(int val) const
+//
+/// @brief Addition Operator
+///
+/// The value is sign extended to Bits, so a negative value is deducted.
+//------------------------------------------------------------------------------
+{
+    const unsigned int lsb32 = static_cast<unsigned int>(val);
+    const Storage sum = Layout::add(mData, UInt(0u - (lsb32 >> 31), lsb32).mData);
+
+    // a negative value counts as the subtraction it performs
+    OMATH_COUNT(Bits, UIntProbe::ADD_INT, true);
+    OMATH_COUNT(Bits, (val < 0) ? UIntProbe::SUB : UIntProbe::ADD, true);
+    OMATH_COUNT(Bits, (val < 0) ? UIntProbe::SUB_UNDERFLOW : UIntProbe::ADD_WRAP,
+                (val < 0) ? Layout::less(mData, sum) : Layout::less(sum, mData));
+    return fromStorage(sum);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator-(unsigned int val) const
+//
+/// @brief Subtraction Operator
+//------------------------------------------------------------------------------
+{
+    OMATH_COUNT(Bits, UIntProbe::SUB_UINT, true);
+    return (*this - UInt(0, val));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator-(int val) const
+//
+/// @brief Subtraction Operator
+///
+/// The value is sign extended to Bits, so a negative value is added.
+//------------------------------------------------------------------------------
+{
+    const unsigned int lsb32 = static_cast<unsigned int>(val);
+    const Storage diff = Layout::sub(mData, UInt(0u - (lsb32 >> 31), lsb32).mData);
+
+    // a negative value counts as the addition it performs
+    OMATH_COUNT(Bits, UIntProbe::SUB_INT, true);
+    OMATH_COUNT(Bits, (val < 0) ? UIntProbe::ADD : UIntProbe::SUB, true);
+    OMATH_COUNT(Bits, (val < 0) ? UIntProbe::ADD_WRAP : UIntProbe::SUB_UNDERFLOW,
+                (val < 0) ? Layout::less(diff, mData) : Layout::less(mData, diff));
+    return fromStorage(diff);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator+(const UInt& ref) const
+//
+/// @brief Addition Operator
+//------------------------------------------------------------------------------
+{
+    const Storage sum = Layout::add(mData, ref.mData);
+
+    OMATH_COUNT(Bits, UIntProbe::ADD, true);
+    OMATH_COUNT(Bits, UIntProbe::ADD_WRAP, Layout::less(sum, mData));
+    return fromStorage(sum);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator-(const UInt& ref) const
+//
+/// @brief Subtraction Operator
+///
+/// Wraps modulo 2^Bits when ref is the larger value.
+//------------------------------------------------------------------------------
+{
+    OMATH_COUNT(Bits, UIntProbe::SUB, true);
+    OMATH_COUNT(Bits, UIntProbe::SUB_UNDERFLOW, Layout::less(mData, ref.mData));
+    return fromStorage(Layout::sub(mData, ref.mData));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::addCarry(const UInt& ref, bool& carry) const
+//
+/// @brief Addition with Carry
+///
+/// Adds ref and the incoming carry; carry is replaced by the carry out, so
+/// wider sums chain word by word.
+//------------------------------------------------------------------------------
+{
+    unsigned int flag = carry ? 1 : 0;
+    const UInt result = fromStorage(Layout::addCarry(mData, ref.mData, flag));
+
+    carry = (flag != 0);
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::subBorrow(const UInt& ref, bool& borrow) const
+//
+/// @brief Subtraction with Borrow
+///
+/// Deducts ref and the incoming borrow; borrow is replaced by the borrow out.
+//------------------------------------------------------------------------------
+{
+    unsigned int flag = borrow ? 1 : 0;
+    const UInt result = fromStorage(Layout::subBorrow(mData, ref.mData, flag));
+
+    borrow = (flag != 0);
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::addSaturate(const UInt& ref) const
+//
+/// @brief Saturating Addition, sticks at the maximum rather than wrapping
+//------------------------------------------------------------------------------
+{
+    unsigned int carry(0);
+    const Storage sum = Layout::addCarry(mData, ref.mData, carry);
+
+    OMATH_COUNT(Bits, UIntProbe::SATURATE, true);
+    OMATH_COUNT(Bits, UIntProbe::SATURATED, carry != 0);
+
+    // all ones when the sum carried out
+    return fromStorage(Layout::bitOr(sum, Layout::sub(UInt().mData, UInt(0u, carry).mData)));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::subSaturate(const UInt& ref) const
+//
+/// @brief Saturating Subtraction, sticks at zero rather than wrapping
+//------------------------------------------------------------------------------
+{
+    unsigned int borrow(0);
+    const Storage diff = Layout::subBorrow(mData, ref.mData, borrow);
+
+    OMATH_COUNT(Bits, UIntProbe::SATURATE, true);
+    OMATH_COUNT(Bits, UIntProbe::SATURATED, borrow != 0);
+
+    // all zeros when the difference borrowed
+    return fromStorage(Layout::bitAnd(diff, Layout::sub(UInt().mData, UInt(0u, borrow ^ 1).mData)));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator*(unsigned int val) const
+//
+/// @brief Multiplication Operator
+//------------------------------------------------------------------------------
+{
+    OMATH_COUNT(Bits, UIntProbe::MUL_UINT, true);
+    return (*this * UInt(0, val));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator/(unsigned int val) const
+//
+/// @brief Division Operator
+//------------------------------------------------------------------------------
+{
+    OMATH_COUNT(Bits, UIntProbe::DIVIDE_UINT, true);
+    return (*this / UInt(0, val));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator%(unsigned int val) const
+//
+/// @brief Modulo Operator
+//------------------------------------------------------------------------------
+{
+    OMATH_COUNT(Bits, UIntProbe::MODULO_UINT, true);
+    return (*this % UInt(0, val));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator*(const UInt& ref) const
+//
+/// @brief Multiplication Operator
+///
+/// Keeps the lower Bits of the product.
+//------------------------------------------------------------------------------
+{
+    OMATH_COUNT(Bits, UIntProbe::MUL, true);
+    return fromStorage(Layout::mul(mData, ref.mData));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator/(const UInt& ref) const
+//
+/// @brief Division Operator
+///
+/// Division by zero gives all ones. For a divisor known at compile time
+/// divideBy() is much faster.
+//------------------------------------------------------------------------------
+{
+    UInt quotient;
+    UInt remainder;
+    divMod(*this, ref, quotient, remainder);
+
+    return quotient;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator%(const UInt& ref) const
+//
+/// @brief Modulo Operator
+///
+/// The remainder of division by zero is the dividend.
+//------------------------------------------------------------------------------
+{
+    UInt quotient;
+    UInt remainder;
+    divMod(*this, ref, quotient, remainder);
+
+    return remainder;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+template <unsigned int Divisor>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::divideBy() const
+//
+/// @brief Division by a compile time constant
+///
+/// Multiplies by a precomputed reciprocal rather than running the bit
+/// serial long division of operator/.
+//------------------------------------------------------------------------------
+{
+    static_assert(Divisor != 0, "division by zero");
+
+    OMATH_COUNT(Bits, UIntProbe::DIVIDE_CONSTANT, true);
+    return UIntConstantDivider<Bits, Layout, Divisor>::DIVIDER.divide(*this);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+template <unsigned int Divisor>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::remainderBy() const
+//
+/// @brief Remainder by a compile time constant
+//------------------------------------------------------------------------------
+{
+    static_assert(Divisor != 0, "division by zero");
+
+    OMATH_COUNT(Bits, UIntProbe::DIVIDE_CONSTANT, true);
+    return UIntConstantDivider<Bits, Layout, Divisor>::DIVIDER.remainder(*this);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr void UInt<Bits, Layout>::divMod(const UInt& dividend, const UInt& divisor,
+                                        UInt& quotient, UInt& remainder)
+//
+/// @brief Restoring long division, one quotient bit per step
+//------------------------------------------------------------------------------
+{
+    OMATH_COUNT(Bits, UIntProbe::DIVIDE, true);
+    OMATH_COUNT(Bits, UIntProbe::DIVIDE_BY_ZERO, divisor == UInt());
+
+    // the steps work on the storage so they are not counted as operations
+    UInt value(dividend);
+    UInt partial;
+    UInt result;
+
+    for (unsigned int i = 0; i < Bits; ++i)
+    {
+        // shift the next dividend bit into the partial remainder, which can
+        // briefly need Bits + 1 bits
+        const bool carry = partial.getMsb();
+        partial = fromStorage(Layout::add(Layout::add(partial.mData, partial.mData),
+                                          UInt(0, value.getMsb() ? 1 : 0).mData));
+        value = fromStorage(Layout::add(value.mData, value.mData));
+
+        // the modular subtraction is exact as the true difference fits
+        const bool fits = carry || !(partial < divisor);
+        partial = fits ? fromStorage(Layout::sub(partial.mData, divisor.mData)) : partial;
+        result = fromStorage(Layout::add(Layout::add(result.mData, result.mData),
+                                         UInt(0, fits ? 1 : 0).mData));
+    }
+
+    quotient  = result;
+    remainder = partial;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator<<(unsigned int shift) const
+//
+/// @brief Left Shift Operator
+///
+/// Shifting by Bits or more gives zero.
+//------------------------------------------------------------------------------
+{
+    const unsigned int upper = Layout::upper(mData);
+    const unsigned int lsb32 = Layout::lsb32(mData);
+
+    if (shift >= Bits)
+    {
+        return UInt();
+    }
+
+    if (shift >= 32)
+    {
+        return UInt(lsb32 << (shift - 32), 0);
+    }
+
+    if (shift == 0)
+    {
+        return *this;
+    }
+
+    return UInt((upper << shift) | (lsb32 >> (32 - shift)), lsb32 << shift);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator>>(unsigned int shift) const
+//
+/// @brief Right Shift Operator
+///
+/// Shifting by Bits or more gives zero.
+//------------------------------------------------------------------------------
+{
+    const unsigned int upper = Layout::upper(mData);
+    const unsigned int lsb32 = Layout::lsb32(mData);
+
+    if (shift >= Bits)
+    {
+        return UInt();
+    }
+
+    if (shift >= 32)
+    {
+        return UInt(0, upper >> (shift - 32));
+    }
+
+    if (shift == 0)
+    {
+        return *this;
+    }
+
+    return UInt(upper >> shift, (lsb32 >> shift) | (upper << (32 - shift)));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator&(const UInt& ref) const
+//
+/// @brief Bitwise And Operator
+//------------------------------------------------------------------------------
+{
+    return fromStorage(Layout::bitAnd(mData, ref.mData));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator|(const UInt& ref) const
+//
+/// @brief Bitwise Or Operator
+//------------------------------------------------------------------------------
+{
+    return fromStorage(Layout::bitOr(mData, ref.mData));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator^(const UInt& ref) const
+//
+/// @brief Bitwise Exclusive Or Operator
+//------------------------------------------------------------------------------
+{
+    return fromStorage(Layout::bitXor(mData, ref.mData));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UInt<Bits, Layout>::operator~() const
+//
+/// @brief Bitwise Complement Operator
+//------------------------------------------------------------------------------
+{
+    return fromStorage(Layout::bitNot(mData));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr const UInt<Bits, Layout>& UInt<Bits, Layout>::operator+=(const UInt& ref)
+//
+/// @brief Addition Equals Operator
+//------------------------------------------------------------------------------
+{
+    OMATH_COUNT(Bits, UIntProbe::ADD, true);
+    OMATH_COUNT(Bits, UIntProbe::ADD_WRAP, Layout::less(Layout::add(mData, ref.mData), mData));
+    mData = Layout::add(mData, ref.mData);
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr const UInt<Bits, Layout>& UInt<Bits, Layout>::operator-=(const UInt& ref)
+//
+/// @brief Subtraction Equals Operator
+//------------------------------------------------------------------------------
+{
+    OMATH_COUNT(Bits, UIntProbe::SUB, true);
+    OMATH_COUNT(Bits, UIntProbe::SUB_UNDERFLOW, Layout::less(mData, ref.mData));
+    mData = Layout::sub(mData, ref.mData);
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr const UInt<Bits, Layout>& UInt<Bits, Layout>::operator*=(const UInt& ref)
+//
+/// @brief Multiplication Equals Operator
+//------------------------------------------------------------------------------
+{
+    *this = *this * ref;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr const UInt<Bits, Layout>& UInt<Bits, Layout>::operator/=(const UInt& ref)
+//
+/// @brief Division Equals Operator
+//------------------------------------------------------------------------------
+{
+    *this = *this / ref;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr const UInt<Bits, Layout>& UInt<Bits, Layout>::operator%=(const UInt& ref)
+//
+/// @brief Modulo Equals Operator
+//------------------------------------------------------------------------------
+{
+    *this = *this % ref;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr const UInt<Bits, Layout>& UInt<Bits, Layout>::operator&=(const UInt& ref)
+//
+/// @brief Bitwise And Equals Operator
+//------------------------------------------------------------------------------
+{
+    *this = *this & ref;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr const UInt<Bits, Layout>& UInt<Bits, Layout>::operator|=(const UInt& ref)
+//
+/// @brief Bitwise Or Equals Operator
+//------------------------------------------------------------------------------
+{
+    *this = *this | ref;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr const UInt<Bits, Layout>& UInt<Bits, Layout>::operator^=(const UInt& ref)
+//
+/// @brief Bitwise Exclusive Or Equals Operator
+//------------------------------------------------------------------------------
+{
+    *this = *this ^ ref;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr const UInt<Bits, Layout>& UInt<Bits, Layout>::operator<<=(unsigned int shift)
+//
+/// @brief Left Shift Equals Operator
+//------------------------------------------------------------------------------
+{
+    *this = *this << shift;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr const UInt<Bits, Layout>& UInt<Bits, Layout>::operator>>=(unsigned int shift)
+//
+/// @brief Right Shift Equals Operator
+//------------------------------------------------------------------------------
+{
+    *this = *this >> shift;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr bool UInt<Bits, Layout>::operator==(const UInt& ref) const
+//
+/// @brief Equality Operator
+//------------------------------------------------------------------------------
+{
+    return Layout::equal(mData, ref.mData);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr bool UInt<Bits, Layout>::operator!=(const UInt& ref) const
+//
+/// @brief Inequality Operator
+//------------------------------------------------------------------------------
+{
+    return !Layout::equal(mData, ref.mData);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr bool UInt<Bits, Layout>::operator<(const UInt& ref) const
+//
+/// @brief Less Than Operator
+//------------------------------------------------------------------------------
+{
+    return Layout::less(mData, ref.mData);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr bool UInt<Bits, Layout>::operator<=(const UInt& ref) const
+//
+/// @brief Less Than Equals Operator
+//------------------------------------------------------------------------------
+{
+    return !Layout::less(ref.mData, mData);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr bool UInt<Bits, Layout>::operator>(const UInt& ref) const
+//
+/// @brief More Than Operator
+//------------------------------------------------------------------------------
+{
+    return Layout::less(ref.mData, mData);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr bool UInt<Bits, Layout>::operator>=(const UInt& ref) const
+//
+/// @brief More Than Equals Operator
+//------------------------------------------------------------------------------
+{
+    return !Layout::less(mData, ref.mData);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr bool UInt<Bits, Layout>::isBefore(const UInt& ref) const
+//
+/// @brief Wrap Aware Less Than (RFC 1982 serial number arithmetic)
+///
+/// True when ref is less than half the range ahead of this value, so a
+/// timestamp just before the wrap is before one just after it. Values
+/// exactly half the range apart are neither before nor after each other.
+//------------------------------------------------------------------------------
+{
+    const UInt ahead = fromStorage(Layout::sub(ref.mData, mData));
+
+    OMATH_COUNT(Bits, UIntProbe::SERIAL, true);
+    return !ahead.getMsb() & (ahead != UInt());
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr bool UInt<Bits, Layout>::isAfter(const UInt& ref) const
+//
+/// @brief Wrap Aware More Than (RFC 1982 serial number arithmetic)
+//------------------------------------------------------------------------------
+{
+    return ref.isBefore(*this);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr int UInt<Bits, Layout>::distanceTo(const UInt& ref) const
+//
+/// @brief Signed Shortest Distance from this value to ref
+/// @return ref - this in [-2^(Bits-1), 2^(Bits-1)), saturated to the range
+///         of int when Bits > 32. Half the range apart counts as negative.
+//------------------------------------------------------------------------------
+{
+    const UInt ahead = fromStorage(Layout::sub(ref.mData, mData));
+
+    OMATH_COUNT(Bits, UIntProbe::SERIAL, true);
+
+    if (Bits <= 32)
+    {
+        // sign extend from the top bit
+        const unsigned int sign = 1u << ((Bits - 1) % 32);
+        return static_cast<int>((ahead.getLsb32() ^ sign) - sign);
+    }
+
+    // the magnitude, and its limit as an int (one more when negative)
+    const bool         behind    = ahead.getMsb();
+    const UInt         magnitude = behind ? fromStorage(Layout::sub(mData, ref.mData)) : ahead;
+    const unsigned int limit     = 0x7fffffffu + (behind ? 1 : 0);
+    const unsigned int lsb32     = magnitude.getLsb32();
+
+    const unsigned int clamped = ((magnitude.getUpper() != 0) | (lsb32 > limit)) ? limit : lsb32;
+
+    OMATH_COUNT(Bits, UIntProbe::DISTANCE_CLAMPED, clamped != lsb32);
+
+    return static_cast<int>(behind ? (0u - clamped) : clamped);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr void UInt<Bits, Layout>::getRaw(unsigned int& msb, unsigned int& lsb16) const
+//
+/// @brief Raw Access Getter
+///
+/// Splits the value into the (Bits - 16) most and 16 least significant bits,
+/// the original U33 17 / 16 representation, whatever the storage layout.
+//------------------------------------------------------------------------------
+{
+    static_assert(Bits <= 48, "getRaw needs the upper part to fit 32 bits");
+
+    const unsigned int lsb32 = Layout::lsb32(mData);
+
+    msb   = (Layout::upper(mData) << 16) | (lsb32 >> 16);
+    lsb16 = lsb32 & 0xffff;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr void UInt<Bits, Layout>::getLanes(unsigned long long& hi, unsigned long long& lo) const
+//
+/// @brief Lane Access Getter
+///
+/// The storage words widened to 64 bits, value = hi * 2^LANE_SHIFT + lo.
+/// Lanes of many values can be summed and folded back once by fromLanes(),
+/// see UIntExpr.h.
+//------------------------------------------------------------------------------
+{
+    hi = Layout::laneHi(mData);
+    lo = Layout::laneLo(mData);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr bool UInt<Bits, Layout>::getMsb() const
+//
+/// @brief MSB Getter
+/// @return The MSB of the value
+//------------------------------------------------------------------------------
+{
+    return (Bits > 32) ? (((Layout::upper(mData) >> ((Bits - 33) % 32)) & 1) != 0)
+                       : (((Layout::lsb32(mData) >> ((Bits - 1) % 32)) & 1) != 0);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr bool UInt<Bits, Layout>::getLsb() const
+//
+/// @brief LSB Getter
+/// @return The LSB of the value
+//------------------------------------------------------------------------------
+{
+    return ((Layout::lsb32(mData) & 1) != 0);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr unsigned int UInt<Bits, Layout>::getMsb32() const
+//
+/// @brief 32bit MSB Getter
+/// @return The 32 MSB of the value (the whole value when Bits <= 32)
+//------------------------------------------------------------------------------
+{
+    if ((UPPER_BITS == 0) || (UPPER_BITS == 32))
+    {
+        return (UPPER_BITS == 0) ? Layout::lsb32(mData) : Layout::upper(mData);
+    }
+
+    return ((Layout::upper(mData) << ((32 - UPPER_BITS) % 32)) |
+            (Layout::lsb32(mData) >> (UPPER_BITS % 32)));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr unsigned int UInt<Bits, Layout>::getLsb32() const
+//
+/// @brief 32bit LSB Getter
+/// @return The 32 LSB of the value
+//------------------------------------------------------------------------------
+{
+    return Layout::lsb32(mData);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr unsigned int UInt<Bits, Layout>::getUpper() const
+//
+/// @brief Upper Bits Getter
+/// @return The bits above the lower 32 (zero when Bits <= 32)
+//------------------------------------------------------------------------------
+{
+    return Layout::upper(mData);
+}
+
+//------------------------------------------------------------------------------
+// Library Includes (needing the definitions above)
+//------------------------------------------------------------------------------
+#include "UIntDivider.h"
+
+#endif // OMATH_UINT_H
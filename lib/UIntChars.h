@@ -0,0 +1,516 @@
+//------------------------------------------------------------------------------
+//
+// Filename: UIntChars.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_UINTCHARS_H
+#define OMATH_UINTCHARS_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <cstddef>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "UInt.h"
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits>
+struct UIntCharsSize
+//
+/// @name The most characters toChars writes for one value of Bits
+//------------------------------------------------------------------------------
+{
+    static const unsigned int DECIMAL = ((Bits * 30103) / 100000) + 1;
+    static const unsigned int HEX     = (Bits + 3) / 4;
+};
+
+//------------------------------------------------------------------------------
+//
+class UIntChars
+//
+/// @name Text Conversion in the style of std::to_chars / std::from_chars
+///
+/// Formats to and parses from caller buffers without allocating, throwing,
+/// consulting the locale or using a 64 bit type. Hex is lower case without
+/// a prefix, decimal has no sign, and neither skips white space. The batch
+/// versions convert arrays of values joined by a separator character.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Types
+    /// @{
+    enum Base
+    {
+        BASE_DECIMAL    = 10,
+        BASE_HEX        = 16
+    };
+
+    enum Error
+    {
+        ERROR_NONE,             ///< Success
+        ERROR_INVALID,          ///< No digits where a value was expected
+        ERROR_OUT_OF_RANGE,     ///< The digits do not fit Bits
+        ERROR_TOO_SMALL         ///< The output buffer is too small
+    };
+
+    struct ToResult
+    {
+        char* mPtr;             ///< One past the last character written
+        Error mError;
+        std::size_t mCount;     ///< The number of values written
+    };
+
+    struct FromResult
+    {
+        const char* mPtr;       ///< One past the last character consumed
+        Error mError;
+        std::size_t mCount;     ///< The number of values parsed
+    };
+    /// @}
+
+    /// @name Single Values
+    /// @{
+    template <unsigned int Bits, typename Layout>
+    static ToResult toChars(char* first, char* last, const UInt<Bits, Layout>& value,
+                            Base base=BASE_DECIMAL);
+
+    template <unsigned int Bits, typename Layout>
+    static FromResult fromChars(const char* first, const char* last, UInt<Bits, Layout>& value,
+                                Base base=BASE_DECIMAL);
+    /// @}
+
+    /// @name Arrays
+    /// @{
+    template <unsigned int Bits, typename Layout>
+    static ToResult toChars(char* first, char* last, const UInt<Bits, Layout>* values,
+                            std::size_t count, char separator, Base base=BASE_DECIMAL);
+
+    template <unsigned int Bits, typename Layout>
+    static FromResult fromChars(const char* first, const char* last, UInt<Bits, Layout>* values,
+                                std::size_t count, char separator, Base base=BASE_DECIMAL);
+    /// @}
+
+private:
+
+    /// @name 32 Bit Helpers
+    /// @{
+    static unsigned int decimalDigits(unsigned int value);
+    static unsigned int hexDigits(unsigned int value);
+    static char* writeDecimal(char* out, unsigned int value, unsigned int digits);
+    static char* writeHex(char* out, unsigned int value, unsigned int digits);
+    static unsigned int readDecimal(const char* in, unsigned int digits);
+    static unsigned int readHex(const char* in, unsigned int digits);
+    static unsigned int hexValue(char c);
+    /// @}
+
+    /// @name Constants
+    /// @{
+    static const char DIGIT_PAIRS[201];         ///< "00" to "99"
+    static const char HEX_DIGITS[17];
+    static const unsigned int POWERS_OF_10[10];
+    static const unsigned int NOT_HEX = 16;     ///< hexValue of a non digit
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+inline unsigned int UIntChars::decimalDigits(unsigned int value)
+//
+/// @brief The number of decimal digits in value (at least one)
+//------------------------------------------------------------------------------
+{
+    unsigned int digits(1);
+
+    while ((digits < 10) && (value >= POWERS_OF_10[digits]))
+    {
+        ++digits;
+    }
+
+    return digits;
+}
+
+//------------------------------------------------------------------------------
+//
+inline unsigned int UIntChars::hexDigits(unsigned int value)
+//
+/// @brief The number of hex digits in value (at least one)
+//------------------------------------------------------------------------------
+{
+    unsigned int digits(1);
+
+    while ((digits < 8) && (value >> (4 * digits)))
+    {
+        ++digits;
+    }
+
+    return digits;
+}
+
+//------------------------------------------------------------------------------
+//
+inline char* UIntChars::writeDecimal(char* out, unsigned int value, unsigned int digits)
+//
+/// @brief Write exactly digits decimal digits of value, two at a time
+/// @return One past the last digit
+//------------------------------------------------------------------------------
+{
+    char* end = out + digits;
+    char* pos = end;
+
+    while (digits >= 2)
+    {
+        const unsigned int pair = 2 * (value % 100);
+        value /= 100;
+        *--pos = DIGIT_PAIRS[pair + 1];
+        *--pos = DIGIT_PAIRS[pair];
+        digits -= 2;
+    }
+
+    if (digits)
+    {
+        *--pos = static_cast<char>('0' + (value % 10));
+    }
+
+    return end;
+}
+
+//------------------------------------------------------------------------------
+//
+inline char* UIntChars::writeHex(char* out, unsigned int value, unsigned int digits)
+//
+/// @brief Write exactly digits hex digits of value
+/// @return One past the last digit
+//------------------------------------------------------------------------------
+{
+    for (unsigned int i = 0; i < digits; ++i)
+    {
+        out[i] = HEX_DIGITS[(value >> (4 * (digits - 1 - i))) & 0xf];
+    }
+
+    return (out + digits);
+}
+
+//------------------------------------------------------------------------------
+//
+inline unsigned int UIntChars::readDecimal(const char* in, unsigned int digits)
+//
+/// @brief The value of up to nine decimal digits
+//------------------------------------------------------------------------------
+{
+    unsigned int value(0);
+
+    for (unsigned int i = 0; i < digits; ++i)
+    {
+        value = (value * 10) + static_cast<unsigned int>(in[i] - '0');
+    }
+
+    return value;
+}
+
+//------------------------------------------------------------------------------
+//
+inline unsigned int UIntChars::readHex(const char* in, unsigned int digits)
+//
+/// @brief The value of up to eight hex digits
+//------------------------------------------------------------------------------
+{
+    unsigned int value(0);
+
+    for (unsigned int i = 0; i < digits; ++i)
+    {
+        value = (value << 4) | hexValue(in[i]);
+    }
+
+    return value;
+}
+
+//------------------------------------------------------------------------------
+//
+inline unsigned int UIntChars::hexValue(char c)
+//
+/// @brief The value of a hex digit of either case, NOT_HEX otherwise
+//------------------------------------------------------------------------------
+{
+    if ((c >= '0') && (c <= '9')) return static_cast<unsigned int>(c - '0');
+    if ((c >= 'a') && (c <= 'f')) return static_cast<unsigned int>(c - 'a' + 10);
+    if ((c >= 'A') && (c <= 'F')) return static_cast<unsigned int>(c - 'A' + 10);
+
+    return NOT_HEX;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+inline UIntChars::ToResult UIntChars::toChars(char* first, char* last,
+                                              const UInt<Bits, Layout>& value, Base base)
+//
+/// @brief Format value into [first, last)
+/// @return The end of the text, or last and ERROR_TOO_SMALL when it won't fit
+//------------------------------------------------------------------------------
+{
+    const std::ptrdiff_t room = last - first;
+
+    if (base == BASE_HEX)
+    {
+        // the lsb32 is zero padded below any upper digits
+        const unsigned int upper = value.getUpper();
+        const unsigned int lsb32 = value.getLsb32();
+        const unsigned int upperDigits = upper ? hexDigits(upper) : 0;
+        const unsigned int lsb32Digits = upper ? 8 : hexDigits(lsb32);
+
+        if (room < static_cast<std::ptrdiff_t>(upperDigits + lsb32Digits))
+        {
+            const ToResult result = { last, ERROR_TOO_SMALL, 0 };
+            return result;
+        }
+
+        char* out = writeHex(first, upper, upperDigits);
+        const ToResult result = { writeHex(out, lsb32, lsb32Digits), ERROR_NONE, 1 };
+        return result;
+    }
+
+    // split into a head and nine digit chunks, least significant first
+    unsigned int chunks[3];
+    unsigned int count(0);
+    unsigned int head = value.getLsb32();
+
+    if (Bits > 32)
+    {
+        const UInt<Bits, Layout> billion(0u, 1000000000u);
+        UInt<Bits, Layout> rest(value);
+
+        while (billion <= rest)
+        {
+            const UInt<Bits, Layout> quotient = rest.template divideBy<1000000000>();
+            chunks[count++] = (rest - (quotient * 1000000000u)).getLsb32();
+            rest = quotient;
+        }
+
+        head = rest.getLsb32();
+    }
+
+    const unsigned int headDigits = decimalDigits(head);
+
+    if (room < static_cast<std::ptrdiff_t>(headDigits + (9 * count)))
+    {
+        const ToResult result = { last, ERROR_TOO_SMALL, 0 };
+        return result;
+    }
+
+    char* out = writeDecimal(first, head, headDigits);
+    while (count)
+    {
+        out = writeDecimal(out, chunks[--count], 9);
+    }
+
+    const ToResult result = { out, ERROR_NONE, 1 };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+inline UIntChars::FromResult UIntChars::fromChars(const char* first, const char* last,
+                                                  UInt<Bits, Layout>& value, Base base)
+//
+/// @brief Parse the digits at the start of [first, last) into value
+///
+/// Stops at the first character that is not a digit. On error value is left
+/// unchanged; ERROR_INVALID consumes nothing and ERROR_OUT_OF_RANGE consumes
+/// every digit.
+//------------------------------------------------------------------------------
+{
+    typedef UInt<Bits, Layout> Value;
+
+    // skip the leading zeros, then find the significant digits
+    const char* digits = first;
+    while ((digits != last) && (*digits == '0'))
+    {
+        ++digits;
+    }
+
+    const char* end = digits;
+    if (base == BASE_HEX)
+    {
+        while ((end != last) && (hexValue(*end) != NOT_HEX)) ++end;
+    }
+    else
+    {
+        while ((end != last) && (*end >= '0') && (*end <= '9')) ++end;
+    }
+
+    if (end == first)
+    {
+        const FromResult result = { first, ERROR_INVALID, 0 };
+        return result;
+    }
+
+    const FromResult outOfRange = { end, ERROR_OUT_OF_RANGE, 0 };
+    const FromResult success    = { end, ERROR_NONE, 1 };
+    const unsigned int count = static_cast<unsigned int>(end - digits);
+
+    if (base == BASE_HEX)
+    {
+        // the top digit may only be partly used
+        const unsigned int topBits = Bits % 4;
+        if ((count > UIntCharsSize<Bits>::HEX) ||
+            ((count == UIntCharsSize<Bits>::HEX) && topBits && (hexValue(*digits) >> topBits)))
+        {
+            return outOfRange;
+        }
+
+        const unsigned int lsb32Digits = (count > 8) ? 8 : count;
+        value = Value(readHex(digits, count - lsb32Digits),
+                      readHex(end - lsb32Digits, lsb32Digits));
+        return success;
+    }
+
+    if (count > UIntCharsSize<Bits>::DECIMAL)
+    {
+        return outOfRange;
+    }
+
+    // fewer digits than the maximum can't overflow, nine at a time
+    const bool longest = (count == UIntCharsSize<Bits>::DECIMAL);
+    const char* stop = longest ? (end - 1) : end;
+
+    Value total;
+    for (const char* in = digits; in != stop; )
+    {
+        const unsigned int chunk = ((stop - in) < 9) ? static_cast<unsigned int>(stop - in) : 9;
+        total = (total * POWERS_OF_10[chunk]) + readDecimal(in, chunk);
+        in += chunk;
+    }
+
+    // the last of the longest numbers is checked against the maximum
+    if (longest)
+    {
+        constexpr Value maximum = ~Value();
+        constexpr Value tenth = maximum.template divideBy<10>();
+        const unsigned int lastDigit = static_cast<unsigned int>(*stop - '0');
+        const unsigned int lastLimit = (maximum - (tenth * 10u)).getLsb32();
+
+        if ((tenth < total) || ((tenth == total) && (lastDigit > lastLimit)))
+        {
+            return outOfRange;
+        }
+
+        total = (total * 10u) + lastDigit;
+    }
+
+    value = total;
+    return success;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+inline UIntChars::ToResult UIntChars::toChars(char* first, char* last,
+                                              const UInt<Bits, Layout>* values,
+                                              std::size_t count, char separator, Base base)
+//
+/// @brief Format count values joined by separator into [first, last)
+/// @return The end of the text; on ERROR_TOO_SMALL the end of the last value
+///         that fit, with mCount values written
+//------------------------------------------------------------------------------
+{
+    ToResult result = { first, ERROR_NONE, 0 };
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        char* out = result.mPtr;
+
+        if (i)
+        {
+            if (out == last)
+            {
+                result.mError = ERROR_TOO_SMALL;
+                return result;
+            }
+            *out++ = separator;
+        }
+
+        const ToResult single = toChars(out, last, values[i], base);
+        if (single.mError != ERROR_NONE)
+        {
+            result.mError = single.mError;
+            return result;
+        }
+
+        result.mPtr = single.mPtr;
+        ++result.mCount;
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+inline UIntChars::FromResult UIntChars::fromChars(const char* first, const char* last,
+                                                  UInt<Bits, Layout>* values,
+                                                  std::size_t count, char separator, Base base)
+//
+/// @brief Parse up to count values joined by separator from [first, last)
+/// @return The end of the last value parsed, with mCount values parsed. The
+///         text may end early; a value that fails to parse stops with its
+///         error and mPtr at the failing position.
+//------------------------------------------------------------------------------
+{
+    FromResult result = { first, ERROR_NONE, 0 };
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const char* in = result.mPtr;
+
+        if (i)
+        {
+            if ((in == last) || (*in != separator))
+            {
+                return result;
+            }
+            ++in;
+        }
+
+        const FromResult single = fromChars(in, last, values[i], base);
+        if (single.mError != ERROR_NONE)
+        {
+            result.mPtr   = single.mPtr;
+            result.mError = single.mError;
+            return result;
+        }
+
+        result.mPtr = single.mPtr;
+        ++result.mCount;
+    }
+
+    return result;
+}
+
+#endif // OMATH_UINTCHARS_H
@@ -0,0 +1,344 @@
+//------------------------------------------------------------------------------
+//
+// Filename: UIntCounters.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "UIntChars.h"
+#include "UIntCounters.h"
+
+/// @name Constants
+/// @{
+static const unsigned int EVENTS = UIntProbe::EVENT_COUNT;
+
+/// Indexed by event, the keys of the text and JSON output
+static const char* const NAMES[] =
+{
+    "add",
+    "sub",
+    "add_uint",
+    "add_int",
+    "sub_uint",
+    "sub_int",
+    "mul_uint",
+    "divide_uint",
+    "modulo_uint",
+    "mul",
+    "divide",
+    "divide_constant",
+    "saturate",
+    "serial",
+    "add_wrap",
+    "sub_underflow",
+    "saturated",
+    "divide_by_zero",
+    "distance_clamped"
+};
+/// @}
+
+static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == EVENTS, "one name per event");
+
+/// @name Types
+/// @{
+
+/// The counters of one thread. Only the owning thread writes them; a count
+/// is a 32 bit store, and the rare carry into the upper word runs under a
+/// sequence count so readers never see the two words torn.
+struct ThreadCounters
+{
+    ThreadCounters();
+    ~ThreadCounters();
+
+    std::atomic<unsigned int> mSequence;            ///< Odd while carrying
+    std::atomic<unsigned int> mLsb32[EVENTS];
+    std::atomic<unsigned int> mUpper[EVENTS];
+};
+
+/// Every thread's counters, the sums of the finished threads and the zero
+/// point of the last reset, all guarded by mMutex
+struct Registry
+{
+    std::mutex mMutex;
+    std::vector<const ThreadCounters*> mLive;
+    UIntCounters::Count mRetired[EVENTS];
+    UIntCounters::Count mBaseline[EVENTS];
+};
+/// @}
+
+//------------------------------------------------------------------------------
+//
+static Registry& registry()
+//
+/// @brief The registry, built on first use by the first counting thread
+//------------------------------------------------------------------------------
+{
+    static Registry sRegistry;
+    return sRegistry;
+}
+
+//------------------------------------------------------------------------------
+//
+static void read(const ThreadCounters& counters, UIntCounters::Count* totals)
+//
+/// @brief Add a consistent copy of one thread's counters to totals
+//------------------------------------------------------------------------------
+{
+    unsigned int upper[EVENTS];
+    unsigned int lsb32[EVENTS];
+    unsigned int before(0);
+    unsigned int after(0);
+
+    do
+    {
+        before = counters.mSequence.load(std::memory_order_acquire);
+
+        for (unsigned int i = 0; i < EVENTS; ++i)
+        {
+            upper[i] = counters.mUpper[i].load(std::memory_order_relaxed);
+            lsb32[i] = counters.mLsb32[i].load(std::memory_order_relaxed);
+        }
+
+        // pairs with the release stores of the counts, so a count made after
+        // a carry also shows the carry's sequence
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = counters.mSequence.load(std::memory_order_relaxed);
+    }
+    while (((before & 1) != 0) || (before != after));
+
+    for (unsigned int i = 0; i < EVENTS; ++i)
+    {
+        totals[i] += UIntCounters::Count(upper[i], lsb32[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+static void total(Registry& counters, UIntCounters::Count* totals)
+//
+/// @brief The sums over every thread, with the registry locked
+//------------------------------------------------------------------------------
+{
+    std::copy(counters.mRetired, counters.mRetired + EVENTS, totals);
+
+    for (std::size_t i = 0; i < counters.mLive.size(); ++i)
+    {
+        read(*counters.mLive[i], totals);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+static std::string toDecimal(const UIntCounters::Count& count)
+//
+/// @brief The decimal digits of a count
+//------------------------------------------------------------------------------
+{
+    std::string digits(UIntCharsSize<64>::DECIMAL, '0');
+    const char* const end = UIntChars::toChars(&digits[0], &digits[0] + digits.size(), count).mPtr;
+
+    digits.resize(end - digits.data());
+    return digits;
+}
+
+//------------------------------------------------------------------------------
+//
+ThreadCounters::ThreadCounters()
+//
+/// @brief Constructor, registers the calling thread's counters
+//------------------------------------------------------------------------------
+: mSequence(0)
+{
+    for (unsigned int i = 0; i < EVENTS; ++i)
+    {
+        mLsb32[i].store(0, std::memory_order_relaxed);
+        mUpper[i].store(0, std::memory_order_relaxed);
+    }
+
+    Registry& counters = registry();
+    std::lock_guard<std::mutex> lock(counters.mMutex);
+    counters.mLive.push_back(this);
+}
+
+//------------------------------------------------------------------------------
+//
+ThreadCounters::~ThreadCounters()
+//
+/// @brief Destructor, folds the exiting thread's counts into the retired sums
+//------------------------------------------------------------------------------
+{
+    Registry& counters = registry();
+    std::lock_guard<std::mutex> lock(counters.mMutex);
+
+    read(*this, counters.mRetired);
+    counters.mLive.erase(std::find(counters.mLive.begin(), counters.mLive.end(), this));
+}
+
+/// @name Variables
+/// @{
+static thread_local ThreadCounters tCounters;   ///< The calling thread's counters
+/// @}
+
+//------------------------------------------------------------------------------
+//
+void UIntProbe::count(Event event)
+//
+/// @brief Count one event on the calling thread
+//------------------------------------------------------------------------------
+{
+    ThreadCounters& counters = tCounters;
+    const unsigned int lsb32 = counters.mLsb32[event].load(std::memory_order_relaxed) + 1;
+
+    if (lsb32 == 0)
+    {
+        // carry into the upper word once every 2^32 counts
+        const unsigned int sequence = counters.mSequence.load(std::memory_order_relaxed);
+        counters.mSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        counters.mUpper[event].store(counters.mUpper[event].load(std::memory_order_relaxed) + 1,
+                                     std::memory_order_relaxed);
+        counters.mLsb32[event].store(0, std::memory_order_relaxed);
+        counters.mSequence.store(sequence + 2, std::memory_order_release);
+        return;
+    }
+
+    counters.mLsb32[event].store(lsb32, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+//
+UIntCounters::UIntCounters()
+//
+/// @brief Constructor, every count zero
+//------------------------------------------------------------------------------
+{
+}
+
+//------------------------------------------------------------------------------
+//
+UIntCounters UIntCounters::snapshot()
+//
+/// @brief The counts of every thread since the last reset
+//------------------------------------------------------------------------------
+{
+    UIntCounters result;
+    Registry& counters = registry();
+    std::lock_guard<std::mutex> lock(counters.mMutex);
+
+    total(counters, result.mCounts);
+
+    for (unsigned int i = 0; i < EVENTS; ++i)
+    {
+        result.mCounts[i] -= counters.mBaseline[i];
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+void UIntCounters::reset()
+//
+/// @brief Start every count again from zero
+//------------------------------------------------------------------------------
+{
+    Registry& counters = registry();
+    std::lock_guard<std::mutex> lock(counters.mMutex);
+
+    total(counters, counters.mBaseline);
+}
+
+//------------------------------------------------------------------------------
+//
+const UIntCounters::Count& UIntCounters::get(UIntProbe::Event event) const
+//
+/// @brief Count Getter
+//------------------------------------------------------------------------------
+{
+    return mCounts[event];
+}
+
+//------------------------------------------------------------------------------
+//
+const char* UIntCounters::getName(UIntProbe::Event event)
+//
+/// @brief Event Name Getter, the key used by toText() and toJson()
+//------------------------------------------------------------------------------
+{
+    return NAMES[event];
+}
+
+//------------------------------------------------------------------------------
+//
+std::string UIntCounters::toText() const
+//
+/// @brief One "name count" line per event, the counts aligned
+//------------------------------------------------------------------------------
+{
+    std::string text;
+
+    for (unsigned int i = 0; i < EVENTS; ++i)
+    {
+        const std::string name(NAMES[i]);
+        const std::string digits = toDecimal(mCounts[i]);
+
+        text += name;
+        text.append(40 - name.size() - digits.size(), ' ');
+        text += digits;
+        text += '\n';
+    }
+
+    return text;
+}
+
+//------------------------------------------------------------------------------
+//
+std::string UIntCounters::toJson() const
+//
+/// @brief A JSON object with one member per event
+//------------------------------------------------------------------------------
+{
+    std::string json("{");
+
+    for (unsigned int i = 0; i < EVENTS; ++i)
+    {
+        json += (i == 0) ? "\n  \"" : ",\n  \"";
+        json += NAMES[i];
+        json += "\": ";
+        json += toDecimal(mCounts[i]);
+    }
+
+    json += "\n}\n";
+    return json;
+}
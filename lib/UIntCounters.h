@@ -0,0 +1,93 @@
+//------------------------------------------------------------------------------
+//
+// Filename: UIntCounters.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_UINTCOUNTERS_H
+#define OMATH_UINTCOUNTERS_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <string>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "UInt.h"
+
+//------------------------------------------------------------------------------
+//
+class UIntCounters
+//
+/// @name Snapshot of the U33 instrumentation counters
+///
+/// Each thread counts the UIntProbe events into its own counters with plain
+/// stores, and snapshot() sums the counters of every thread, running or
+/// finished, since the last reset(). A snapshot taken while other threads
+/// run sees each of their counters at some recent value. reset() moves the
+/// zero point rather than clearing the threads' counters, so it never races
+/// with them. Without OMATH_INSTRUMENTATION nothing counts and every value
+/// is zero.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Types
+    /// @{
+    typedef UInt<64> Count;
+    /// @}
+
+    /// @name Construction / Destruction
+    /// @{
+    UIntCounters();
+    /// @}
+
+    /// @name Collection
+    /// @{
+    static UIntCounters snapshot();
+    static void reset();
+    /// @}
+
+    /// @name Getters
+    /// @{
+    const Count& get(UIntProbe::Event event) const;
+    static const char* getName(UIntProbe::Event event);
+    /// @}
+
+    /// @name Output
+    /// @{
+    std::string toText() const;
+    std::string toJson() const;
+    /// @}
+
+private:
+
+    /// @name Variables
+    /// @{
+    Count mCounts[UIntProbe::EVENT_COUNT];  ///< Indexed by event
+    /// @}
+};
+
+#endif // OMATH_UINTCOUNTERS_H
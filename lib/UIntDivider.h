@@ -0,0 +1,235 @@
+//------------------------------------------------------------------------------
+//
+// Filename: UIntDivider.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_UINTDIVIDER_H
+#define OMATH_UINTDIVIDER_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+// none
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "UInt.h"
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout = typename UIntDefaultLayout<Bits>::Type>
+class UIntDivider
+//
+/// @name Division by a fixed divisor through its reciprocal
+///
+/// With l = ceil(log2(divisor)) and m = ceil(2^(Bits + l) / divisor),
+/// value / divisor == (value * m) >> (Bits + l) for every Bits wide value
+/// (Granlund & Montgomery). m has at most Bits + 1 bits and the product is
+/// formed from 16 x 16 partial products, so no 64 bit type is needed and
+/// there is no per bit loop. The divisor must not be zero.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Types
+    /// @{
+    typedef UInt<Bits, Layout> Value;
+    /// @}
+
+    /// @name Construction / Destruction
+    /// @{
+    explicit constexpr UIntDivider(unsigned int divisor);
+    /// @}
+
+    /// @name Division
+    /// @{
+    constexpr Value divide(const Value& value) const;
+    constexpr Value remainder(const Value& value) const;
+    /// @}
+
+    /// @name Getters
+    /// @{
+    constexpr unsigned int getDivisor() const;
+    /// @}
+
+private:
+
+    /// @name Constants
+    /// @{
+    static const unsigned int VALUE_LIMBS   = (Bits + 15) / 16;
+    static const unsigned int MAGIC_LIMBS   = (Bits + 16) / 16;
+    static const unsigned int PRODUCT_LIMBS = ((Bits + 64) / 16) + 3;
+    /// @}
+
+    /// @name Variables
+    /// @{
+    unsigned int mDivisor;                  ///< The divisor
+    unsigned int mShift;                    ///< Bits + ceil(log2(divisor))
+    unsigned int mMagic[MAGIC_LIMBS];       ///< The reciprocal, 16 bits per limb
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UIntDivider<Bits, Layout>::UIntDivider(unsigned int divisor)
+//
+/// @brief Constructor, precomputes the reciprocal
+//------------------------------------------------------------------------------
+    : mDivisor(divisor)
+    , mShift(Bits)
+    , mMagic()
+{
+    // l = ceil(log2(divisor))
+    while (((mShift - Bits) < 32) && ((1u << (mShift - Bits)) < divisor))
+    {
+        ++mShift;
+    }
+
+    // long division of 2^mShift by the divisor, one bit at a time
+    unsigned int quotient[MAGIC_LIMBS + 1] = { 0 };
+    unsigned int partial(0);
+
+    for (unsigned int bit = 0; bit <= mShift; ++bit)
+    {
+        // the partial remainder is below the divisor, so if doubling it
+        // overflows the true value is certainly big enough to deduct
+        const bool carry = ((partial >> 31) != 0);
+        partial = (partial << 1) | ((bit == 0) ? 1 : 0);
+
+        const bool fits = carry || (partial >= divisor);
+        partial = fits ? (partial - divisor) : partial;
+
+        unsigned int in = fits ? 1 : 0;
+        for (unsigned int i = 0; i <= MAGIC_LIMBS; ++i)
+        {
+            const unsigned int limb = (quotient[i] << 1) | in;
+            in = limb >> 16;
+            quotient[i] = limb & 0xffff;
+        }
+    }
+
+    // round the quotient up
+    unsigned int in = (partial != 0) ? 1 : 0;
+    for (unsigned int i = 0; i < MAGIC_LIMBS; ++i)
+    {
+        const unsigned int limb = quotient[i] + in;
+        in = limb >> 16;
+        mMagic[i] = limb & 0xffff;
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr typename UIntDivider<Bits, Layout>::Value
+UIntDivider<Bits, Layout>::divide(const Value& value) const
+//
+/// @brief Quotient
+//------------------------------------------------------------------------------
+{
+    const unsigned int upper = value.getUpper();
+    const unsigned int lsb32 = value.getLsb32();
+
+    const unsigned int limbs[4] = { lsb32 & 0xffff, lsb32 >> 16,
+                                    upper & 0xffff, upper >> 16 };
+
+    // schoolbook product, each column stays far below 2^32
+    unsigned int product[PRODUCT_LIMBS] = { 0 };
+
+    for (unsigned int i = 0; i < VALUE_LIMBS; ++i)
+    {
+        for (unsigned int j = 0; j < MAGIC_LIMBS; ++j)
+        {
+            const unsigned int partial = limbs[i] * mMagic[j];
+            product[i + j]     += partial & 0xffff;
+            product[i + j + 1] += partial >> 16;
+        }
+    }
+
+    for (unsigned int i = 0; (i + 1) < PRODUCT_LIMBS; ++i)
+    {
+        product[i + 1] += product[i] >> 16;
+        product[i] &= 0xffff;
+    }
+
+    // read 32 bit words starting at bit mShift
+    const unsigned int limb   = mShift / 16;
+    const unsigned int offset = mShift % 16;
+
+    const unsigned int word0 = product[limb + 0] | (product[limb + 1] << 16);
+    const unsigned int word1 = product[limb + 2] | (product[limb + 3] << 16);
+    const unsigned int word2 = product[limb + 4];
+
+    const unsigned int resultLsb32 = offset ? ((word0 >> offset) | (word1 << (32 - offset))) : word0;
+    const unsigned int resultUpper = offset ? ((word1 >> offset) | (word2 << (32 - offset))) : word1;
+
+    return Value(resultUpper, resultLsb32);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr typename UIntDivider<Bits, Layout>::Value
+UIntDivider<Bits, Layout>::remainder(const Value& value) const
+//
+/// @brief Remainder
+//------------------------------------------------------------------------------
+{
+    // the product is at most value, so the modular arithmetic is exact
+    return (value - (divide(value) * mDivisor));
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr unsigned int UIntDivider<Bits, Layout>::getDivisor() const
+//
+/// @brief Divisor Getter
+//------------------------------------------------------------------------------
+{
+    return mDivisor;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout, unsigned int Divisor>
+struct UIntConstantDivider
+//
+/// @name The divider for a compile time divisor, built at compile time
+///
+/// Backs UInt::divideBy() and remainderBy(), the reciprocal lands in read
+/// only data with no function local static or guard.
+//------------------------------------------------------------------------------
+{
+    static constexpr UIntDivider<Bits, Layout> DIVIDER = UIntDivider<Bits, Layout>(Divisor);
+};
+
+/// @cond
+template <unsigned int Bits, typename Layout, unsigned int Divisor>
+constexpr UIntDivider<Bits, Layout> UIntConstantDivider<Bits, Layout, Divisor>::DIVIDER;
+/// @endcond
+
+#endif // OMATH_UINTDIVIDER_H
@@ -0,0 +1,391 @@
+//------------------------------------------------------------------------------
+//
+// Filename: UIntExpr.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_UINTEXPR_H
+#define OMATH_UINTEXPR_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <type_traits>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "U33.h"
+
+/// @name Forward Declarations
+/// @{
+template <typename Lhs, typename Rhs, bool Subtract> class UIntSumExpr;
+/// @}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout = typename UIntDefaultLayout<Bits>::Type>
+class UIntExpr
+//
+/// @name Lazily evaluated chain of UInt additions / subtractions
+///
+/// U33Expr(pts) + offset - delay + adjust only records its terms, as a nest
+/// of UIntSumExpr. Converting the chain to its UInt type sums the terms in
+/// 64 bit lanes (see UInt::getLanes) and normalises once with fromLanes(),
+/// where the operators normalise every intermediate value. Addition modulo
+/// 2^Bits is associative and 2^Bits divides 2^64, so the result is bit
+/// identical to evaluating the operators left to right.
+///
+/// Terms may be UInt values of the same type, int, unsigned int or another
+/// chain. They are held by value, so a chain may outlive them. Chains do not
+/// count into the UIntProbe instrumentation.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Types
+    /// @{
+    typedef UInt<Bits, Layout> Value;
+    /// @}
+
+    /// @name Construction / Destruction
+    /// @{
+    explicit constexpr UIntExpr(const Value& value);
+    /// @}
+
+    /// @name Chaining
+    /// @{
+    template <typename Rhs> constexpr UIntSumExpr<UIntExpr, Rhs, false> operator+(const Rhs& rhs) const;
+    template <typename Rhs> constexpr UIntSumExpr<UIntExpr, Rhs, true> operator-(const Rhs& rhs) const;
+    /// @}
+
+    /// @name Evaluation
+    /// @{
+    constexpr Value value() const;
+    constexpr operator Value() const;
+    constexpr void addLanes(unsigned long long& hi, unsigned long long& lo) const;
+    /// @}
+
+private:
+
+    /// @name Variables
+    /// @{
+    Value mValue;           ///< The first term
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+template <typename Lhs, typename Rhs, bool Subtract>
+class UIntSumExpr
+//
+/// @name One + / - step of a UIntExpr chain
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Types
+    /// @{
+    typedef typename Lhs::Value Value;
+    /// @}
+
+    /// @name Construction / Destruction
+    /// @{
+    constexpr UIntSumExpr(const Lhs& lhs, const Rhs& rhs);
+    /// @}
+
+    /// @name Chaining
+    /// @{
+    template <typename Next> constexpr UIntSumExpr<UIntSumExpr, Next, false> operator+(const Next& rhs) const;
+    template <typename Next> constexpr UIntSumExpr<UIntSumExpr, Next, true> operator-(const Next& rhs) const;
+    /// @}
+
+    /// @name Evaluation
+    /// @{
+    constexpr Value value() const;
+    constexpr operator Value() const;
+    constexpr void addLanes(unsigned long long& hi, unsigned long long& lo) const;
+    /// @}
+
+private:
+
+    /// @name Helpers
+    /// @{
+    static constexpr void termLanes(const Value& term, unsigned long long& hi, unsigned long long& lo);
+    static constexpr void termLanes(unsigned int term, unsigned long long& hi, unsigned long long& lo);
+    static constexpr void termLanes(int term, unsigned long long& hi, unsigned long long& lo);
+    template <unsigned int Bits, typename Layout>
+    static constexpr void termLanes(const UIntExpr<Bits, Layout>& term, unsigned long long& hi, unsigned long long& lo);
+    template <typename TermLhs, typename TermRhs, bool TermSubtract>
+    static constexpr void termLanes(const UIntSumExpr<TermLhs, TermRhs, TermSubtract>& term,
+                                    unsigned long long& hi, unsigned long long& lo);
+    /// @}
+
+    /// @name Variables
+    /// @{
+    Lhs mLhs;               ///< The chain so far
+    Rhs mRhs;               ///< The term added / subtracted
+    /// @}
+};
+
+/// @name Types
+/// @{
+typedef UIntExpr<33> U33Expr;
+/// @}
+
+//==============================================================================
+// UIntExpr
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UIntExpr<Bits, Layout>::UIntExpr(const Value& value)
+//
+/// @brief Constructor, starts a chain at value
+//------------------------------------------------------------------------------
+    : mValue(value)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+template <typename Rhs>
+constexpr UIntSumExpr<UIntExpr<Bits, Layout>, Rhs, false>
+UIntExpr<Bits, Layout>::operator+(const Rhs& rhs) const
+//
+/// @brief Chain an addition
+//------------------------------------------------------------------------------
+{
+    return UIntSumExpr<UIntExpr, Rhs, false>(*this, rhs);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+template <typename Rhs>
+constexpr UIntSumExpr<UIntExpr<Bits, Layout>, Rhs, true>
+UIntExpr<Bits, Layout>::operator-(const Rhs& rhs) const
+//
+/// @brief Chain a subtraction
+//------------------------------------------------------------------------------
+{
+    return UIntSumExpr<UIntExpr, Rhs, true>(*this, rhs);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UInt<Bits, Layout> UIntExpr<Bits, Layout>::value() const
+//
+/// @brief Evaluate the chain
+//------------------------------------------------------------------------------
+{
+    return mValue;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr UIntExpr<Bits, Layout>::operator UInt<Bits, Layout>() const
+//
+/// @brief Evaluate the chain on assignment
+//------------------------------------------------------------------------------
+{
+    return value();
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr void UIntExpr<Bits, Layout>::addLanes(unsigned long long& hi, unsigned long long& lo) const
+//
+/// @brief Add the lanes of the chain to hi / lo
+//------------------------------------------------------------------------------
+{
+    unsigned long long termHi(0);
+    unsigned long long termLo(0);
+    mValue.getLanes(termHi, termLo);
+
+    hi += termHi;
+    lo += termLo;
+}
+
+//==============================================================================
+// UIntSumExpr
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//
+template <typename Lhs, typename Rhs, bool Subtract>
+constexpr UIntSumExpr<Lhs, Rhs, Subtract>::UIntSumExpr(const Lhs& lhs, const Rhs& rhs)
+//
+/// @brief Constructor
+//------------------------------------------------------------------------------
+    : mLhs(lhs),
+      mRhs(rhs)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Lhs, typename Rhs, bool Subtract>
+template <typename Next>
+constexpr UIntSumExpr<UIntSumExpr<Lhs, Rhs, Subtract>, Next, false>
+UIntSumExpr<Lhs, Rhs, Subtract>::operator+(const Next& rhs) const
+//
+/// @brief Chain an addition
+//------------------------------------------------------------------------------
+{
+    return UIntSumExpr<UIntSumExpr, Next, false>(*this, rhs);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Lhs, typename Rhs, bool Subtract>
+template <typename Next>
+constexpr UIntSumExpr<UIntSumExpr<Lhs, Rhs, Subtract>, Next, true>
+UIntSumExpr<Lhs, Rhs, Subtract>::operator-(const Next& rhs) const
+//
+/// @brief Chain a subtraction
+//------------------------------------------------------------------------------
+{
+    return UIntSumExpr<UIntSumExpr, Next, true>(*this, rhs);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Lhs, typename Rhs, bool Subtract>
+constexpr typename UIntSumExpr<Lhs, Rhs, Subtract>::Value UIntSumExpr<Lhs, Rhs, Subtract>::value() const
+//
+/// @brief Evaluate the chain
+//------------------------------------------------------------------------------
+{
+    unsigned long long hi(0);
+    unsigned long long lo(0);
+    addLanes(hi, lo);
+
+    return Value::fromLanes(hi, lo);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Lhs, typename Rhs, bool Subtract>
+constexpr UIntSumExpr<Lhs, Rhs, Subtract>::operator typename UIntSumExpr<Lhs, Rhs, Subtract>::Value() const
+//
+/// @brief Evaluate the chain on assignment
+//------------------------------------------------------------------------------
+{
+    return value();
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Lhs, typename Rhs, bool Subtract>
+constexpr void UIntSumExpr<Lhs, Rhs, Subtract>::addLanes(unsigned long long& hi, unsigned long long& lo) const
+//
+/// @brief Add the lanes of the chain to hi / lo
+///
+/// The lanes wrap modulo 2^64, a multiple of 2^Bits, so borrows below zero
+/// fold out exactly like carries.
+//------------------------------------------------------------------------------
+{
+    mLhs.addLanes(hi, lo);
+
+    unsigned long long termHi(0);
+    unsigned long long termLo(0);
+    termLanes(mRhs, termHi, termLo);
+
+    hi = Subtract ? (hi - termHi) : (hi + termHi);
+    lo = Subtract ? (lo - termLo) : (lo + termLo);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Lhs, typename Rhs, bool Subtract>
+constexpr void UIntSumExpr<Lhs, Rhs, Subtract>::termLanes(const Value& term,
+                                                          unsigned long long& hi, unsigned long long& lo)
+//
+/// @brief The lanes of a value
+//------------------------------------------------------------------------------
+{
+    term.getLanes(hi, lo);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Lhs, typename Rhs, bool Subtract>
+constexpr void UIntSumExpr<Lhs, Rhs, Subtract>::termLanes(unsigned int term,
+                                                          unsigned long long& /*hi*/, unsigned long long& lo)
+//
+/// @brief The lanes of an unsigned int, as UInt::operator+(unsigned int)
+//------------------------------------------------------------------------------
+{
+    lo = term;
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Lhs, typename Rhs, bool Subtract>
+constexpr void UIntSumExpr<Lhs, Rhs, Subtract>::termLanes(int term,
+                                                          unsigned long long& /*hi*/, unsigned long long& lo)
+//
+/// @brief The lanes of an int, as UInt::operator+(int) a negative term
+/// subtracts its magnitude
+//------------------------------------------------------------------------------
+{
+    lo = static_cast<unsigned long long>(static_cast<long long>(term));
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Lhs, typename Rhs, bool Subtract>
+template <unsigned int Bits, typename Layout>
+constexpr void UIntSumExpr<Lhs, Rhs, Subtract>::termLanes(const UIntExpr<Bits, Layout>& term,
+                                                          unsigned long long& hi, unsigned long long& lo)
+//
+/// @brief The lanes of a chain of one value
+//------------------------------------------------------------------------------
+{
+    static_assert(std::is_same<UInt<Bits, Layout>, Value>::value, "chained terms must have the same UInt type");
+
+    term.addLanes(hi, lo);
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Lhs, typename Rhs, bool Subtract>
+template <typename TermLhs, typename TermRhs, bool TermSubtract>
+constexpr void UIntSumExpr<Lhs, Rhs, Subtract>::termLanes(const UIntSumExpr<TermLhs, TermRhs, TermSubtract>& term,
+                                                          unsigned long long& hi, unsigned long long& lo)
+//
+/// @brief The lanes of a nested chain, e.g. a - (U33Expr(b) + c)
+//------------------------------------------------------------------------------
+{
+    static_assert(std::is_same<typename TermLhs::Value, Value>::value, "chained terms must have the same UInt type");
+
+    term.addLanes(hi, lo);
+}
+
+#endif // OMATH_UINTEXPR_H
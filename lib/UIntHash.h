@@ -0,0 +1,106 @@
+//------------------------------------------------------------------------------
+//
+// Filename: UIntHash.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_UINTHASH_H
+#define OMATH_UINTHASH_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <functional>
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "UInt.h"
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout = typename UIntDefaultLayout<Bits>::Type>
+struct UIntHash
+//
+/// @name Well mixed 32 bit hash of a UInt
+///
+/// Folds the upper bits into the lower word with a golden ratio multiply,
+/// then runs the MurmurHash3 finalizer, so every input bit reaches every
+/// output bit. Timestamps that step by a frame period still spread over
+/// the low bits a power of two table indexes with. Also std::hash<UInt>.
+//------------------------------------------------------------------------------
+{
+    /// @name Types
+    /// @{
+    typedef UInt<Bits, Layout> Value;
+    /// @}
+
+    /// @name Hashing
+    /// @{
+    static constexpr unsigned int hash32(const Value& value);
+    std::size_t operator()(const Value& value) const;
+    /// @}
+};
+
+/// @cond
+namespace std
+{
+    template <unsigned int Bits, typename Layout>
+    struct hash<UInt<Bits, Layout> > : public UIntHash<Bits, Layout>
+    {
+    };
+}
+/// @endcond
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr unsigned int UIntHash<Bits, Layout>::hash32(const Value& value)
+//
+/// @brief The 32 bit hash of a value
+//------------------------------------------------------------------------------
+{
+    unsigned int hash = value.getLsb32() ^ (value.getUpper() * 0x9e3779b9u);
+
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+inline std::size_t UIntHash<Bits, Layout>::operator()(const Value& value) const
+//
+/// @brief The hash of a value, for the standard unordered containers
+//------------------------------------------------------------------------------
+{
+    return hash32(value);
+}
+
+#endif // OMATH_UINTHASH_H
@@ -0,0 +1,176 @@
+//------------------------------------------------------------------------------
+//
+// Filename: UIntLiteral.h
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef OMATH_UINTLITERAL_H
+#define OMATH_UINTLITERAL_H
+
+//------------------------------------------------------------------------------
+// System Includes
+//------------------------------------------------------------------------------
+// none
+
+//------------------------------------------------------------------------------
+// Library Includes
+//------------------------------------------------------------------------------
+#include "UInt.h"
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout = typename UIntDefaultLayout<Bits>::Type>
+class UIntLiteral
+//
+/// @name Compile time parsing of integer literals into UInt
+///
+/// Backs the user defined literals (e.g. _u33) through the character
+/// template form, so the digits are read with 32 bit arithmetic and a
+/// literal that does not fit Bits is a compile error rather than wrapping.
+/// Takes decimal, 0x hex, 0b binary and leading 0 octal, with ' separators.
+//------------------------------------------------------------------------------
+{
+public:
+
+    /// @name Types
+    /// @{
+    typedef UInt<Bits, Layout> Value;
+    /// @}
+
+    /// @name Parsing
+    /// @{
+    template <char... Digits> static constexpr Value parse();
+    static constexpr bool fits(const char* text);
+    static constexpr Value value(const char* text);
+    /// @}
+
+private:
+
+    /// @name Helpers
+    /// @{
+    static constexpr unsigned int digit(char c);
+    static constexpr bool read(const char* text, Value& value);
+    /// @}
+};
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+template <char... Digits>
+constexpr typename UIntLiteral<Bits, Layout>::Value UIntLiteral<Bits, Layout>::parse()
+//
+/// @brief The value of the literal spelt by Digits
+//------------------------------------------------------------------------------
+{
+    constexpr char text[] = { Digits..., '\0' };
+    static_assert(fits(text), "literal is not an integer that fits the UInt width");
+
+    return value(text);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr bool UIntLiteral<Bits, Layout>::fits(const char* text)
+//
+/// @brief True when the text is an integer literal that fits Bits
+//------------------------------------------------------------------------------
+{
+    Value result;
+    return read(text, result);
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr typename UIntLiteral<Bits, Layout>::Value UIntLiteral<Bits, Layout>::value(const char* text)
+//
+/// @brief The value of an integer literal, wrapped when it does not fit
+//------------------------------------------------------------------------------
+{
+    Value result;
+    read(text, result);
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr unsigned int UIntLiteral<Bits, Layout>::digit(char c)
+//
+/// @brief The value of a digit in any base up to 16, 16 for anything else
+//------------------------------------------------------------------------------
+{
+    return ((c >= '0') && (c <= '9')) ? static_cast<unsigned int>(c - '0')
+         : ((c >= 'a') && (c <= 'f')) ? static_cast<unsigned int>(c - 'a' + 10)
+         : ((c >= 'A') && (c <= 'F')) ? static_cast<unsigned int>(c - 'A' + 10)
+         : 16;
+}
+
+//------------------------------------------------------------------------------
+//
+template <unsigned int Bits, typename Layout>
+constexpr bool UIntLiteral<Bits, Layout>::read(const char* text, Value& value)
+//
+/// @brief Accumulate the digits into value
+/// @return False on a character that isn't a digit of the base (e.g. a
+///         floating point literal) or when the value overflows Bits
+//------------------------------------------------------------------------------
+{
+    // the base from the prefix, as for the built in literals
+    unsigned int base(10);
+    if ((text[0] == '0') && ((text[1] == 'x') || (text[1] == 'X')))
+    {
+        base = 16;
+        text += 2;
+    }
+    else if ((text[0] == '0') && ((text[1] == 'b') || (text[1] == 'B')))
+    {
+        base = 2;
+        text += 2;
+    }
+    else if (text[0] == '0')
+    {
+        base = 8;
+    }
+
+    const Value maximum = ~Value();
+    bool valid = (*text != '\0');
+
+    for (; *text != '\0'; ++text)
+    {
+        if (*text == '\'')
+        {
+            continue;
+        }
+
+        // value * base + next must not pass the maximum
+        const unsigned int next = digit(*text);
+        valid = valid && (next < base) && !(((maximum - next) / base) < value);
+        value = (value * base) + next;
+    }
+
+    return valid;
+}
+
+#endif // OMATH_UINTLITERAL_H
@@ -0,0 +1,193 @@
+//------------------------------------------------------------------------------
+//
+// Filename: gen_ts.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include "U33Wire.h"
+
+/// Writes a synthetic transport stream for scan_ts: a video PID with
+/// reordered PTS / DTS and a PCR per frame, and an audio PID with a PTS per
+/// audio frame. The clocks start a minute before the 33 bit wrap and jump ten
+/// seconds half way through. Stops at the first frame
+/// boundary after the requested number of packets. With a drop index the
+/// sync byte of that packet is left out, as a capture that lost a byte.
+///
+/// Usage: gen_ts <file> [packets] [drop]
+
+using namespace std;
+
+static const unsigned int PACKET = 188;
+static const unsigned int VIDEO_PID = 0x100;
+static const unsigned int AUDIO_PID = 0x101;
+static const unsigned int VIDEO_TICKS = 3003;       ///< 29.97 Hz in 90 kHz ticks
+static const unsigned int AUDIO_TICKS = 1920;       ///< 1024 samples at 48 kHz
+static const unsigned int VIDEO_PAYLOAD_PACKETS = 3;
+static const unsigned int JUMP_TICKS = 900000;
+
+class Writer
+{
+public:
+    Writer(FILE* file, unsigned long drop) : mFile(file), mPackets(0), mDrop(drop)
+    {
+        memset(mCounters, 0, sizeof(mCounters));
+    }
+
+    /// A packet with an optional PCR and an optional PES header carrying a
+    /// PTS and optionally a DTS, padded with 0xff
+    void packet(unsigned int pid, const U33* pcr, const U33* pts, const U33* dts)
+    {
+        unsigned char buffer[PACKET];
+        memset(buffer, 0xff, sizeof(buffer));
+
+        const bool start = (pts != 0);
+        buffer[0] = 0x47;
+        buffer[1] = static_cast<unsigned char>((start ? 0x40 : 0) | (pid >> 8));
+        buffer[2] = static_cast<unsigned char>(pid);
+        buffer[3] = static_cast<unsigned char>((pcr ? 0x30 : 0x10) | (mCounters[pid & 0xf]++ & 0xf));
+
+        unsigned char* payload = buffer + 4;
+        if (pcr)
+        {
+            // adaptation field: length, flags (PCR), PCR
+            buffer[4] = 7;
+            buffer[5] = 0x10;
+            U33Wire::encodePcr(buffer + 6, *pcr, static_cast<unsigned int>(mPackets % 300));
+            payload = buffer + 12;
+        }
+
+        if (start)
+        {
+            // PES header with the optional header extension
+            payload[0] = 0x00;
+            payload[1] = 0x00;
+            payload[2] = 0x01;
+            payload[3] = (pid == VIDEO_PID) ? 0xe0 : 0xc0;
+            payload[4] = 0x00;
+            payload[5] = 0x00;
+            payload[6] = 0x80;
+            payload[7] = dts ? 0xc0 : 0x80;
+            payload[8] = dts ? 10 : 5;
+            U33Wire::encodeTimestamp(payload + 9, *pts, dts ? U33Wire::PREFIX_PTS_DTS : U33Wire::PREFIX_PTS);
+            if (dts)
+            {
+                U33Wire::encodeTimestamp(payload + 14, *dts, U33Wire::PREFIX_DTS);
+            }
+        }
+
+        const size_t skip = (mPackets == mDrop) ? 1 : 0;
+        fwrite(buffer + skip, 1, sizeof(buffer) - skip, mFile);
+        ++mPackets;
+    }
+
+    unsigned long packets() const
+    {
+        return mPackets;
+    }
+
+private:
+    FILE* mFile;
+    unsigned long mPackets;
+    unsigned long mDrop;
+    unsigned int mCounters[16];
+};
+
+int main(int argc, char** argv)
+{
+    if ((argc < 2) || (argc > 4))
+    {
+        cerr << "Usage: " << argv[0] << " <file> [packets] [drop]" << endl;
+        return 1;
+    }
+
+    unsigned long target(1000000);
+    if (argc >= 3)
+    {
+        istringstream iss(argv[2]);
+        iss >> target;
+    }
+
+    unsigned long drop(~0ul);
+    if (argc == 4)
+    {
+        istringstream iss(argv[3]);
+        iss >> drop;
+    }
+
+    FILE* file = fopen(argv[1], "wb");
+    if (!file)
+    {
+        cerr << "Cannot open " << argv[1] << endl;
+        return 1;
+    }
+
+    // a minute before the wrap, with the PCR 100 ms ahead of the DTS
+    U33 clock = U33(1, 0xffffffff) - U33(0, 60 * 90000) + 1u;
+    U33 audio = clock;
+
+    Writer writer(file, drop);
+    bool jumped(false);
+    unsigned long frame(0);
+
+    for (; writer.packets() < target; ++frame)
+    {
+        if (!jumped && (writer.packets() >= target / 2))
+        {
+            clock += U33(0, JUMP_TICKS);
+            audio += U33(0, JUMP_TICKS);
+            jumped = true;
+        }
+
+        // decode order I0 P3 B1 B2 P6 B4 B5 ...: display index per frame
+        const unsigned long display = (frame == 0) ? 0 :
+                                      (((frame % 3) == 1) ? (frame + 2) : (frame - 1));
+
+        const U33 dts = clock + U33(0, 9009);
+        const U33 pts = clock + U33(0, 9009) + U33(0, VIDEO_TICKS) * static_cast<unsigned int>(display + 1 - frame);
+
+        writer.packet(VIDEO_PID, &clock, &pts, &dts);
+        for (unsigned int p = 0; p < VIDEO_PAYLOAD_PACKETS; ++p)
+        {
+            writer.packet(VIDEO_PID, 0, 0, 0);
+        }
+
+        // audio catches up with the video
+        while (audio.isBefore(clock + U33(0, 9009)))
+        {
+            writer.packet(AUDIO_PID, 0, &audio, 0);
+            audio += U33(0, AUDIO_TICKS);
+        }
+
+        clock += U33(0, VIDEO_TICKS);
+    }
+
+    fclose(file);
+
+    cout << "Wrote " << writer.packets() << " packets (" << frame << " video frames) to " << argv[1] << endl;
+
+    return 0;
+}
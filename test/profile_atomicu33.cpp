@@ -0,0 +1,137 @@
+//------------------------------------------------------------------------------
+//
+// Filename: profile_atomicu33.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "AtomicU33.h"
+
+/// Contention benchmark: every thread adds to one shared counter through
+/// each AtomicU33 backend and through a mutex around U33::operator+=.
+/// Usage: profile_atomicu33 [operations per thread] [max threads]
+
+using namespace std;
+
+class MutexU33
+{
+public:
+    U33 fetchAdd(unsigned int value)
+    {
+        lock_guard<mutex> lock(mLock);
+        const U33 previous = mValue;
+        mValue += U33(0, value);
+        return previous;
+    }
+
+    U33 load()
+    {
+        lock_guard<mutex> lock(mLock);
+        return mValue;
+    }
+
+private:
+    mutex mLock;
+    U33 mValue;
+};
+
+template <typename Counter>
+double run(unsigned int threads, unsigned int count)
+{
+    Counter counter;
+    atomic<unsigned int> ready(0);
+
+    const auto work = [&]()
+    {
+        // start together so every thread contends
+        ready.fetch_add(1);
+        while (ready.load() < threads)
+        {
+        }
+
+        for (unsigned int i = 0; i < count; ++i)
+            counter.fetchAdd(1u);
+    };
+
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    vector<thread> workers;
+    for (unsigned int t = 1; t < threads; ++t)
+        workers.push_back(thread(work));
+    work();
+    for (size_t t = 0; t < workers.size(); ++t)
+        workers[t].join();
+
+    const double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+    if (counter.load() != U33(0, threads * count))
+    {
+        cerr << "Count mismatch" << endl;
+    }
+
+    return (ns / (static_cast<double>(threads) * count));
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int count(1000000);
+    unsigned int maxThreads(max(thread::hardware_concurrency(), 1u) * 2);
+
+    if (argc > 1)
+    {
+        istringstream iss(argv[1]);
+        iss >> count;
+    }
+
+    if (argc > 2)
+    {
+        istringstream iss(argv[2]);
+        iss >> maxThreads;
+    }
+
+    AtomicU33Cas probe;
+    cout << "Operations per thread: " << count << ", CAS lock free: " << boolalpha << probe.isLockFree() << endl;
+    cout << setw(8) << "threads" << setw(14) << "cas ns/op" << setw(16) << "seqlock ns/op"
+         << setw(14) << "mutex ns/op" << setw(16) << "cas Mops/s" << endl;
+
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        const double cas     = run<AtomicU33Cas>(threads, count);
+        const double seqlock = run<AtomicU33SeqLock>(threads, count);
+        const double locked  = run<MutexU33>(threads, count);
+
+        cout << setw(8) << threads << fixed << setprecision(2)
+             << setw(14) << cas << setw(16) << seqlock << setw(14) << locked
+             << setw(16) << (1e3 / cas) << endl;
+    }
+
+    return 0;
+}
@@ -1,6 +1,6 @@
 //------------------------------------------------------------------------------
 //
-// Filename: profile.cpp
+// Filename: profile_u33.cpp
 // Author:   Ed FitzGerald
 //
 // Copyright (c) 2012 Ed FitzGerald
@@ -24,41 +24,706 @@
 // THE SOFTWARE.
 //------------------------------------------------------------------------------
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <sstream>
+#include <string>
+#include <vector>
 #include "U33.h"
+#include "UIntChars.h"
+#include "UIntCounters.h"
+#include "UIntExpr.h"
+
+/// Times every U33 operator against the same operation on a masked 64 bit
+/// integer. Usage: profile_u33 [count] [--csv | --json] [--layouts]
+///                              [--compare file.csv]
+///
+/// --layouts times the core operators on each U33 storage layout side by
+/// side instead, the configured one (OMATH_U33_LAYOUT) marked with a '*'.
+///
+/// Build with omath_enable_instrumentation to see its cost, the table then
+/// ends with the counts of every U33 event the run made.
+///
+/// --compare times each case against the ns/op of the same case in a --csv
+/// run saved from another build, e.g. one without the instrumentation hooks,
+/// and prints the change. Cases missing from either run are skipped.
+
+typedef unsigned long long U64;
 
 using namespace std;
 
-static const U33 A(0,1);
-static const U33 B(1,0xffffffff);
+static const U64 MASK33 = 0x1ffffffffULL;
+
+/// Operands cycle through tables of this many values (a power of two)
+static const unsigned int TABLE = 1024;
+
+/// Each case is timed this many times and the fastest run is reported
+static const unsigned int REPEATS = 5;
+
+static U33 sA[TABLE];
+static U33 sB[TABLE];
+static U33 sSmall[TABLE];           ///< Less than sA, for the non wrapping subtraction
+static U33 sLarge[TABLE];           ///< More than sA, for the underflowing subtraction
+static U33 sDivisor[TABLE];
+static int sInt[TABLE];
+static unsigned int sShift[TABLE];
+
+static U64 sA64[TABLE];
+static U64 sB64[TABLE];
+static U64 sSmall64[TABLE];
+static U64 sLarge64[TABLE];
+static U64 sDivisor64[TABLE];
+
+static ostringstream sStream;
+static char sText[TABLE][16];       ///< sA in decimal, for parsing
+static char sBuffer[32];
+
+/// Identifies the build in the output so runs can be diffed across builds
+#if defined(__VERSION__)
+static const char* COMPILER = __VERSION__;
+#else
+static const char* COMPILER = "unknown";
+#endif
+
+#if defined(__OPTIMIZE__)
+static const bool OPTIMIZED = true;
+#else
+static const bool OPTIMIZED = false;
+#endif
+
+struct Result
+{
+    string mName;
+    double mNs;             ///< ns per U33 operation
+    double mBaselineNs;     ///< ns per masked 64 bit operation
+};
+
+/// The storage layouts compared by --layouts, in column order
+static const unsigned int LAYOUTS = 3;
+static const char* LAYOUT_NAMES[LAYOUTS] = { "split16", "split32", "native64" };
+static const int LAYOUT_VALUES[LAYOUTS] = { 16, 32, 64 };
 
-void loop(U33& value)
+struct LayoutResult
 {
-    value = A - B;
+    string mName;
+    double mNs[LAYOUTS];    ///< ns per operation on each layout
+    double mBaselineNs;     ///< ns per masked 64 bit operation
+};
+
+//------------------------------------------------------------------------------
+// Dead code elimination barriers
+//------------------------------------------------------------------------------
+template <typename T>
+inline void keep(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<const volatile char*>(&value);
+#endif
 }
 
-int main(int argc, char** argv)
+U64 toU64(const U33& value)
+{
+    return (static_cast<U64>(value.getUpper()) << 32) | value.getLsb32();
+}
+
+U33 toU33(U64 value)
+{
+    return U33(static_cast<unsigned int>(value >> 32) & 1, static_cast<unsigned int>(value));
+}
+
+void makeTables()
 {
-    if (argc == 2)
+    U64 state(0x9e3779b97f4a7c15ULL);
+
+    for (unsigned int i = 0; i < TABLE; ++i)
     {
-        unsigned int count(0);
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        const U64 a = state & MASK33;
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        const U64 b = state & MASK33;
+
+        sA64[i]       = a;
+        sB64[i]       = b;
+        sSmall64[i]   = a - ((a < b) ? a / 2 : b);
+        sLarge64[i]   = a + 1 + ((MASK33 - a) / 2);
+        sDivisor64[i] = (b >> (state % 30)) | 1;
+
+        sA[i]       = toU33(sA64[i]);
+        sB[i]       = toU33(sB64[i]);
+        sSmall[i]   = toU33(sSmall64[i]);
+        sLarge[i]   = toU33(sLarge64[i]);
+        sDivisor[i] = toU33(sDivisor64[i]);
+        sInt[i]     = static_cast<int>(static_cast<unsigned int>(state >> 7));
+        sShift[i]   = static_cast<unsigned int>(state % 33);
+
+        *UIntChars::toChars(sText[i], sText[i] + 15, sA[i]).mPtr = '\0';
+    }
+}
 
-        istringstream iss(argv[1]);
-        iss >> count;
+//------------------------------------------------------------------------------
+// Timing
+//------------------------------------------------------------------------------
+template <typename Function>
+double time(Function function, unsigned int count)
+{
+    double best = numeric_limits<double>::max();
+
+    for (unsigned int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        const chrono::steady_clock::time_point start = chrono::steady_clock::now();
 
-        cout << "Count: " << count << endl;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            keep(function(i & (TABLE - 1)));
+        }
 
-        U33 val;
+        const chrono::steady_clock::time_point stop = chrono::steady_clock::now();
 
-        for (unsigned int i=0; i<count; ++i)
-            loop(val);
+        best = min(best, chrono::duration<double, nano>(stop - start).count());
     }
-    else
+
+    return (best / count);
+}
+
+template <typename Function, typename Baseline>
+void bench(vector<Result>& results, const char* name, Function function, Baseline baseline,
+           unsigned int count)
+{
+    Result result;
+    result.mName       = name;
+    result.mNs         = time(function, count);
+    result.mBaselineNs = time(baseline, count);
+
+    results.push_back(result);
+}
+
+//------------------------------------------------------------------------------
+// Cases
+//------------------------------------------------------------------------------
+vector<Result> run(unsigned int count)
+{
+    vector<Result> results;
+
+    // slow cases run a fraction of the count
+    const unsigned int slow = max(count / 20, 1u);
+
+    bench(results, "add",
+          [](unsigned int i) { return sA[i] + sB[i]; },
+          [](unsigned int i) { return (sA64[i] + sB64[i]) & MASK33; }, count);
+    bench(results, "sub",
+          [](unsigned int i) { return sA[i] - sSmall[i]; },
+          [](unsigned int i) { return (sA64[i] - sSmall64[i]) & MASK33; }, count);
+    bench(results, "sub_underflow",
+          [](unsigned int i) { return sA[i] - sLarge[i]; },
+          [](unsigned int i) { return (sA64[i] - sLarge64[i]) & MASK33; }, count);
+    bench(results, "add_carry",
+          [](unsigned int i) { bool carry(false); const U33 sum = sA[i].addCarry(sB[i], carry); keep(carry); return sum; },
+          [](unsigned int i) { const U64 sum = sA64[i] + sB64[i]; keep(sum >> 33); return sum & MASK33; }, count);
+    bench(results, "sub_borrow",
+          [](unsigned int i) { bool borrow(false); const U33 diff = sA[i].subBorrow(sB[i], borrow); keep(borrow); return diff; },
+          [](unsigned int i) { const U64 diff = sA64[i] - sB64[i]; keep(diff >> 63); return diff & MASK33; }, count);
+    bench(results, "add_saturate",
+          [](unsigned int i) { return sA[i].addSaturate(sB[i]); },
+          [](unsigned int i) { return min(sA64[i] + sB64[i], MASK33); }, count);
+    bench(results, "sub_saturate",
+          [](unsigned int i) { return sA[i].subSaturate(sB[i]); },
+          [](unsigned int i) { return (sA64[i] > sB64[i]) ? (sA64[i] - sB64[i]) : 0; }, count);
+    bench(results, "add_int",
+          [](unsigned int i) { return sA[i] + sInt[i]; },
+          [](unsigned int i) { return (sA64[i] + static_cast<U64>(static_cast<long long>(sInt[i]))) & MASK33; }, count);
+    bench(results, "sub_int",
+          [](unsigned int i) { return sA[i] - sInt[i]; },
+          [](unsigned int i) { return (sA64[i] - static_cast<U64>(static_cast<long long>(sInt[i]))) & MASK33; }, count);
+    bench(results, "add_unsigned",
+          [](unsigned int i) { return sA[i] + static_cast<unsigned int>(sInt[i]); },
+          [](unsigned int i) { return (sA64[i] + static_cast<unsigned int>(sInt[i])) & MASK33; }, count);
+    bench(results, "sub_unsigned",
+          [](unsigned int i) { return sA[i] - static_cast<unsigned int>(sInt[i]); },
+          [](unsigned int i) { return (sA64[i] - static_cast<unsigned int>(sInt[i])) & MASK33; }, count);
+    bench(results, "add_chain",
+          [](unsigned int i) { return sA[i] + sB[i] - sSmall[i] + sLarge[i]; },
+          [](unsigned int i) { return (sA64[i] + sB64[i] - sSmall64[i] + sLarge64[i]) & MASK33; }, count);
+    bench(results, "add_chain_expr",
+          [](unsigned int i) { return U33(U33Expr(sA[i]) + sB[i] - sSmall[i] + sLarge[i]); },
+          [](unsigned int i) { return (sA64[i] + sB64[i] - sSmall64[i] + sLarge64[i]) & MASK33; }, count);
+    bench(results, "mul",
+          [](unsigned int i) { return sA[i] * sB[i]; },
+          [](unsigned int i) { return (sA64[i] * sB64[i]) & MASK33; }, count);
+    bench(results, "div",
+          [](unsigned int i) { return sA[i] / sDivisor[i]; },
+          [](unsigned int i) { return sA64[i] / sDivisor64[i]; }, slow);
+    bench(results, "mod",
+          [](unsigned int i) { return sA[i] % sDivisor[i]; },
+          [](unsigned int i) { return sA64[i] % sDivisor64[i]; }, slow);
+    bench(results, "div_const_90000",
+          [](unsigned int i) { return sA[i].divideBy<90000>(); },
+          [](unsigned int i) { return sA64[i] / 90000; }, count);
+    bench(results, "shl",
+          [](unsigned int i) { return sA[i] << sShift[i]; },
+          [](unsigned int i) { return (sA64[i] << sShift[i]) & MASK33; }, count);
+    bench(results, "shr",
+          [](unsigned int i) { return sA[i] >> sShift[i]; },
+          [](unsigned int i) { return sA64[i] >> sShift[i]; }, count);
+    bench(results, "and",
+          [](unsigned int i) { return sA[i] & sB[i]; },
+          [](unsigned int i) { return sA64[i] & sB64[i]; }, count);
+    bench(results, "or",
+          [](unsigned int i) { return sA[i] | sB[i]; },
+          [](unsigned int i) { return sA64[i] | sB64[i]; }, count);
+    bench(results, "xor",
+          [](unsigned int i) { return sA[i] ^ sB[i]; },
+          [](unsigned int i) { return sA64[i] ^ sB64[i]; }, count);
+    bench(results, "not",
+          [](unsigned int i) { return ~sA[i]; },
+          [](unsigned int i) { return ~sA64[i] & MASK33; }, count);
+    bench(results, "equal",
+          [](unsigned int i) { return sA[i] == sB[i]; },
+          [](unsigned int i) { return sA64[i] == sB64[i]; }, count);
+    bench(results, "less",
+          [](unsigned int i) { return sA[i] < sB[i]; },
+          [](unsigned int i) { return sA64[i] < sB64[i]; }, count);
+    bench(results, "less_equal",
+          [](unsigned int i) { return sA[i] <= sB[i]; },
+          [](unsigned int i) { return sA64[i] <= sB64[i]; }, count);
+    bench(results, "is_before",
+          [](unsigned int i) { return sA[i].isBefore(sB[i]); },
+          [](unsigned int i) { const U64 d = (sB64[i] - sA64[i]) & MASK33; return (d != 0) && (d < (1ULL << 32)); }, count);
+    bench(results, "distance_to",
+          [](unsigned int i) { return sA[i].distanceTo(sB[i]); },
+          [](unsigned int i)
+          {
+              const long long d = static_cast<long long>(((sB64[i] - sA64[i]) & MASK33) << 31) >> 31;
+              return static_cast<int>(max(min(d, 0x7fffffffLL), -0x80000000LL));
+          }, count);
+    bench(results, "stream_out",
+          [](unsigned int i) { sStream.seekp(0); sStream << sA[i]; return sStream.tellp(); },
+          [](unsigned int i) { sStream.seekp(0); sStream << "0x" << hex << setw(9) << setfill('0') << sA64[i] << dec; return sStream.tellp(); },
+          slow);
+    bench(results, "to_chars_dec",
+          [](unsigned int i) { return UIntChars::toChars(sBuffer, sBuffer + sizeof(sBuffer), sA[i]).mPtr; },
+          [](unsigned int i) { return snprintf(sBuffer, sizeof(sBuffer), "%llu", sA64[i]); }, count);
+    bench(results, "to_chars_hex",
+          [](unsigned int i) { return UIntChars::toChars(sBuffer, sBuffer + sizeof(sBuffer), sA[i], UIntChars::BASE_HEX).mPtr; },
+          [](unsigned int i) { return snprintf(sBuffer, sizeof(sBuffer), "%llx", sA64[i]); }, count);
+    bench(results, "from_chars_dec",
+          [](unsigned int i) { U33 value; UIntChars::fromChars(sText[i], sText[i] + 16, value); return value; },
+          [](unsigned int i) { return strtoull(sText[i], 0, 10); }, count);
+
+    return results;
+}
+
+//------------------------------------------------------------------------------
+// Layout Cases
+//------------------------------------------------------------------------------
+template <typename Layout>
+struct LayoutTables
+{
+    typedef UInt<33, Layout> Value;
+
+    static Value sA[TABLE];
+    static Value sB[TABLE];
+    static Value sSmall[TABLE];
+    static Value sLarge[TABLE];
+    static Value sDivisor[TABLE];
+
+    static Value make(U64 value)
     {
-        std::cerr << "Usage: " << argv[0] << " <count>" << std::endl;
+        return Value(static_cast<unsigned int>(value >> 32) & 1, static_cast<unsigned int>(value));
+    }
+
+    static void fill()
+    {
+        for (unsigned int i = 0; i < TABLE; ++i)
+        {
+            sA[i]       = make(sA64[i]);
+            sB[i]       = make(sB64[i]);
+            sSmall[i]   = make(sSmall64[i]);
+            sLarge[i]   = make(sLarge64[i]);
+            sDivisor[i] = make(sDivisor64[i]);
+        }
+    }
+};
+
+template <typename Layout> UInt<33, Layout> LayoutTables<Layout>::sA[TABLE];
+template <typename Layout> UInt<33, Layout> LayoutTables<Layout>::sB[TABLE];
+template <typename Layout> UInt<33, Layout> LayoutTables<Layout>::sSmall[TABLE];
+template <typename Layout> UInt<33, Layout> LayoutTables<Layout>::sLarge[TABLE];
+template <typename Layout> UInt<33, Layout> LayoutTables<Layout>::sDivisor[TABLE];
+
+template <typename Layout>
+void benchLayout(vector<LayoutResult>& results, unsigned int column, unsigned int count)
+{
+    typedef LayoutTables<Layout> T;
+    T::fill();
+
+    const unsigned int slow = max(count / 20, 1u);
+    const double ns[] =
+    {
+        time([](unsigned int i) { return T::sA[i] + T::sB[i]; }, count),
+        time([](unsigned int i) { return T::sA[i] - T::sSmall[i]; }, count),
+        time([](unsigned int i) { return T::sA[i] - T::sLarge[i]; }, count),
+        time([](unsigned int i) { return T::sA[i] + sInt[i]; }, count),
+        time([](unsigned int i) { return T::sA[i] + T::sB[i] - T::sSmall[i] + T::sLarge[i]; }, count),
+        time([](unsigned int i) { return typename T::Value(UIntExpr<33, Layout>(T::sA[i]) + T::sB[i] - T::sSmall[i] + T::sLarge[i]); }, count),
+        time([](unsigned int i) { return T::sA[i] * T::sB[i]; }, count),
+        time([](unsigned int i) { return T::sA[i] / T::sDivisor[i]; }, slow),
+        time([](unsigned int i) { return T::sA[i].template divideBy<90000>(); }, count),
+        time([](unsigned int i) { return T::sA[i] << sShift[i]; }, count),
+        time([](unsigned int i) { return T::sA[i] >> sShift[i]; }, count),
+        time([](unsigned int i) { return T::sA[i] == T::sB[i]; }, count),
+        time([](unsigned int i) { return T::sA[i] < T::sB[i]; }, count),
+        time([](unsigned int i) { return T::sA[i].isBefore(T::sB[i]); }, count),
+        time([](unsigned int i) { return T::sA[i].distanceTo(T::sB[i]); }, count),
+        time([](unsigned int i) { return UIntChars::toChars(sBuffer, sBuffer + sizeof(sBuffer), T::sA[i]).mPtr; }, count)
+    };
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        results[i].mNs[column] = ns[i];
+    }
+}
+
+vector<LayoutResult> runLayouts(unsigned int count)
+{
+    const char* names[] =
+    {
+        "add", "sub", "sub_underflow", "add_int", "add_chain", "add_chain_expr", "mul", "div", "div_const_90000",
+        "shl", "shr", "equal", "less", "is_before", "distance_to", "to_chars_dec"
+    };
+
+    vector<LayoutResult> results(sizeof(names) / sizeof(names[0]));
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        results[i].mName = names[i];
+    }
+
+    benchLayout<UIntSplit16Layout<33> >(results, 0, count);
+    benchLayout<UIntSplit32Layout<33> >(results, 1, count);
+    benchLayout<UIntNative64Layout<33> >(results, 2, count);
+
+    // the baselines of the matching operations in run()
+    const unsigned int slow = max(count / 20, 1u);
+    const double baseline[] =
+    {
+        time([](unsigned int i) { return (sA64[i] + sB64[i]) & MASK33; }, count),
+        time([](unsigned int i) { return (sA64[i] - sSmall64[i]) & MASK33; }, count),
+        time([](unsigned int i) { return (sA64[i] - sLarge64[i]) & MASK33; }, count),
+        time([](unsigned int i) { return (sA64[i] + static_cast<U64>(static_cast<long long>(sInt[i]))) & MASK33; }, count),
+        time([](unsigned int i) { return (sA64[i] + sB64[i] - sSmall64[i] + sLarge64[i]) & MASK33; }, count),
+        time([](unsigned int i) { return (sA64[i] + sB64[i] - sSmall64[i] + sLarge64[i]) & MASK33; }, count),
+        time([](unsigned int i) { return (sA64[i] * sB64[i]) & MASK33; }, count),
+        time([](unsigned int i) { return sA64[i] / sDivisor64[i]; }, slow),
+        time([](unsigned int i) { return sA64[i] / 90000; }, count),
+        time([](unsigned int i) { return (sA64[i] << sShift[i]) & MASK33; }, count),
+        time([](unsigned int i) { return sA64[i] >> sShift[i]; }, count),
+        time([](unsigned int i) { return sA64[i] == sB64[i]; }, count),
+        time([](unsigned int i) { return sA64[i] < sB64[i]; }, count),
+        time([](unsigned int i) { const U64 d = (sB64[i] - sA64[i]) & MASK33; return (d != 0) && (d < (1ULL << 32)); }, count),
+        time([](unsigned int i)
+        {
+            const long long d = static_cast<long long>(((sB64[i] - sA64[i]) & MASK33) << 31) >> 31;
+            return static_cast<int>(max(min(d, 0x7fffffffLL), -0x80000000LL));
+        }, count),
+        time([](unsigned int i) { return snprintf(sBuffer, sizeof(sBuffer), "%llu", sA64[i]); }, count)
+    };
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        results[i].mBaselineNs = baseline[i];
+    }
+
+    return results;
+}
+
+//------------------------------------------------------------------------------
+// Output
+//------------------------------------------------------------------------------
+void printTable(const vector<Result>& results, unsigned int count)
+{
+    cout << "Count: " << count << " (best of " << REPEATS << ")" << endl;
+    cout << "Build: " << COMPILER << (OPTIMIZED ? "" : " (unoptimised)")
+         << (UIntProbe::ENABLED ? " (instrumented)" : "") << endl;
+    cout << left << setw(18) << "operation"
+         << right << setw(12) << "ns/op" << setw(16) << "ops/s"
+         << setw(14) << "u64 ns/op" << setw(10) << "ratio" << endl;
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& result = results[i];
+        cout << left << setw(18) << result.mName << right << fixed
+             << setw(12) << setprecision(3) << result.mNs
+             << setw(16) << setprecision(0) << (1e9 / result.mNs)
+             << setw(14) << setprecision(3) << result.mBaselineNs
+             << setw(10) << setprecision(2) << (result.mNs / result.mBaselineNs) << endl;
+    }
+
+    if (UIntProbe::ENABLED)
+    {
+        cout << endl << UIntCounters::snapshot().toText();
+    }
+}
+
+bool readCsv(const string& path, map<string, double>& reference)
+{
+    ifstream file(path.c_str());
+    string line;
+
+    // skip the header, then operation,ns_per_op,...
+    if (!getline(file, line))
+        return false;
+
+    while (getline(file, line))
+    {
+        istringstream iss(line);
+        string name;
+        double ns(0);
+
+        if (getline(iss, name, ',') && (iss >> ns) && (ns > 0))
+            reference[name] = ns;
+    }
+
+    return !reference.empty();
+}
+
+void printComparison(const vector<Result>& results, const map<string, double>& reference,
+                     const string& path, unsigned int count)
+{
+    cout << "Count: " << count << " (best of " << REPEATS << ")" << endl;
+    cout << "Build: " << COMPILER << (OPTIMIZED ? "" : " (unoptimised)")
+         << (UIntProbe::ENABLED ? " (instrumented)" : "") << endl;
+    cout << "Reference: " << path << endl;
+    cout << left << setw(18) << "operation"
+         << right << setw(12) << "ns/op" << setw(14) << "ref ns/op" << setw(10) << "change" << endl;
+
+    double logSum(0);
+    unsigned int compared(0);
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& result = results[i];
+        const map<string, double>::const_iterator found = reference.find(result.mName);
+
+        if (found == reference.end())
+            continue;
+
+        const double ratio = result.mNs / found->second;
+        logSum += log(ratio);
+        ++compared;
+
+        cout << left << setw(18) << result.mName << right << fixed
+             << setw(12) << setprecision(3) << result.mNs
+             << setw(14) << setprecision(3) << found->second
+             << setw(9) << setprecision(1) << showpos << ((ratio - 1) * 100) << noshowpos << '%' << endl;
+    }
+
+    if (compared)
+    {
+        cout << left << setw(18) << "geometric mean" << right << setw(35) << fixed << setprecision(1)
+             << showpos << ((exp(logSum / compared) - 1) * 100) << noshowpos << '%'
+             << " over " << compared << " cases" << endl;
+    }
+}
+
+void printCsv(const vector<Result>& results)
+{
+    cout << "operation,ns_per_op,ops_per_s,baseline_ns_per_op,ratio" << endl;
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& result = results[i];
+        cout << result.mName << ',' << setprecision(6) << result.mNs << ','
+             << (1e9 / result.mNs) << ',' << result.mBaselineNs << ','
+             << (result.mNs / result.mBaselineNs) << endl;
+    }
+}
+
+void printJson(const vector<Result>& results, unsigned int count)
+{
+    cout << "{\n  \"benchmark\": \"profile_u33\",\n  \"count\": " << count
+         << ",\n  \"repeats\": " << REPEATS
+         << ",\n  \"compiler\": \"" << COMPILER << "\""
+         << ",\n  \"optimized\": " << (OPTIMIZED ? "true" : "false")
+         << ",\n  \"instrumented\": " << (UIntProbe::ENABLED ? "true" : "false")
+         << ",\n  \"results\": [\n";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& result = results[i];
+        cout << "    {\"operation\": \"" << result.mName << "\", "
+             << setprecision(6)
+             << "\"ns_per_op\": " << result.mNs << ", "
+             << "\"ops_per_s\": " << (1e9 / result.mNs) << ", "
+             << "\"baseline_ns_per_op\": " << result.mBaselineNs << ", "
+             << "\"ratio\": " << (result.mNs / result.mBaselineNs) << "}"
+             << ((i + 1 < results.size()) ? "," : "") << "\n";
+    }
+
+    cout << "  ]\n}" << endl;
+}
+
+void printLayoutTable(const vector<LayoutResult>& results, unsigned int count)
+{
+    cout << "Count: " << count << " (best of " << REPEATS << ")" << endl;
+    cout << "Build: " << COMPILER << (OPTIMIZED ? "" : " (unoptimised)")
+         << (UIntProbe::ENABLED ? " (instrumented)" : "") << endl;
+    cout << left << setw(18) << "ns/op" << right;
+
+    for (unsigned int layout = 0; layout < LAYOUTS; ++layout)
+    {
+        const bool configured = (LAYOUT_VALUES[layout] == OMATH_U33_LAYOUT);
+        cout << setw(12) << (string(configured ? "*" : "") + LAYOUT_NAMES[layout]);
+    }
+
+    cout << setw(12) << "u64" << endl;
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const LayoutResult& result = results[i];
+        cout << left << setw(18) << result.mName << right << fixed << setprecision(3);
+
+        for (unsigned int layout = 0; layout < LAYOUTS; ++layout)
+        {
+            cout << setw(12) << result.mNs[layout];
+        }
+
+        cout << setw(12) << result.mBaselineNs << endl;
+    }
+}
+
+void printLayoutCsv(const vector<LayoutResult>& results)
+{
+    cout << "operation";
+
+    for (unsigned int layout = 0; layout < LAYOUTS; ++layout)
+    {
+        cout << ',' << LAYOUT_NAMES[layout] << "_ns_per_op";
+    }
+
+    cout << ",baseline_ns_per_op" << endl;
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const LayoutResult& result = results[i];
+        cout << result.mName << setprecision(6);
+
+        for (unsigned int layout = 0; layout < LAYOUTS; ++layout)
+        {
+            cout << ',' << result.mNs[layout];
+        }
+
+        cout << ',' << result.mBaselineNs << endl;
+    }
+}
+
+void printLayoutJson(const vector<LayoutResult>& results, unsigned int count)
+{
+    cout << "{\n  \"benchmark\": \"profile_u33_layouts\",\n  \"count\": " << count
+         << ",\n  \"repeats\": " << REPEATS
+         << ",\n  \"compiler\": \"" << COMPILER << "\""
+         << ",\n  \"optimized\": " << (OPTIMIZED ? "true" : "false")
+         << ",\n  \"instrumented\": " << (UIntProbe::ENABLED ? "true" : "false")
+         << ",\n  \"configured\": " << OMATH_U33_LAYOUT
+         << ",\n  \"results\": [\n";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const LayoutResult& result = results[i];
+        cout << "    {\"operation\": \"" << result.mName << "\", " << setprecision(6);
+
+        for (unsigned int layout = 0; layout < LAYOUTS; ++layout)
+        {
+            cout << "\"" << LAYOUT_NAMES[layout] << "_ns_per_op\": " << result.mNs[layout] << ", ";
+        }
+
+        cout << "\"baseline_ns_per_op\": " << result.mBaselineNs << "}"
+             << ((i + 1 < results.size()) ? "," : "") << "\n";
+    }
+
+    cout << "  ]\n}" << endl;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int count(10000000);
+    string format("table");
+    bool layouts(false);
+    string compare;
+
+    for (int arg = 1; arg < argc; ++arg)
+    {
+        if (strcmp(argv[arg], "--csv") == 0)
+        {
+            format = "csv";
+        }
+        else if (strcmp(argv[arg], "--json") == 0)
+        {
+            format = "json";
+        }
+        else if (strcmp(argv[arg], "--layouts") == 0)
+        {
+            layouts = true;
+        }
+        else if ((strcmp(argv[arg], "--compare") == 0) && (arg + 1 < argc))
+        {
+            compare = argv[++arg];
+        }
+        else
+        {
+            istringstream iss(argv[arg]);
+            if (!(iss >> count) || (count == 0))
+            {
+                cerr << "Usage: " << argv[0] << " [count] [--csv | --json] [--layouts] [--compare file.csv]" << endl;
+                return 1;
+            }
+        }
+    }
+
+    map<string, double> reference;
+    if (!compare.empty() && !readCsv(compare, reference))
+    {
+        cerr << "No results in " << compare << endl;
         return 1;
     }
 
+    makeTables();
+
+    if (layouts)
+    {
+        const vector<LayoutResult> results = runLayouts(count);
+
+        if (format == "csv")
+            printLayoutCsv(results);
+        else if (format == "json")
+            printLayoutJson(results, count);
+        else
+            printLayoutTable(results, count);
+
+        return 0;
+    }
+
+    const vector<Result> results = run(count);
+
+    if (!compare.empty())
+        printComparison(results, reference, compare, count);
+    else if (format == "csv")
+        printCsv(results);
+    else if (format == "json")
+        printJson(results, count);
+    else
+        printTable(results, count);
+
     return 0;
 }
@@ -0,0 +1,220 @@
+//------------------------------------------------------------------------------
+//
+// Filename: profile_u33flatmap.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+#include "U33FlatMap.h"
+
+/// Hash map benchmark: U33FlatMap<unsigned int> against
+/// std::unordered_map<U33, unsigned int> (with std::hash<U33>) on PTS keys
+/// a frame apart across the wrap, for insert, hit, miss and erase
+/// throughput and the bytes held per entry. Sizes run in decades from 10^4
+/// up to the maximum (10^6 by default).
+/// Usage: profile_u33flatmap [--max count]
+
+using namespace std;
+
+static size_t sAllocated(0);
+
+/// Counts the bytes the standard map holds
+template <typename T>
+struct CountingAllocator
+{
+    typedef T value_type;
+
+    CountingAllocator() {}
+    template <typename U> CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t count)
+    {
+        sAllocated += count * sizeof(T);
+        return allocator<T>().allocate(count);
+    }
+
+    void deallocate(T* pointer, size_t count)
+    {
+        sAllocated -= count * sizeof(T);
+        allocator<T>().deallocate(pointer, count);
+    }
+
+    template <typename U> bool operator==(const CountingAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const CountingAllocator<U>&) const { return false; }
+};
+
+typedef unordered_map<U33, unsigned int, hash<U33>, equal_to<U33>,
+                      CountingAllocator<pair<const U33, unsigned int> > > StandardMap;
+
+template <typename Function>
+double measure(size_t count, Function function)
+{
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    function();
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / count;
+}
+
+struct Result
+{
+    double mInsert;
+    double mHit;
+    double mMiss;
+    double mErase;
+    double mBytes;
+    unsigned int mSum;
+};
+
+Result runFlat(const vector<U33>& keys, const vector<U33>& misses)
+{
+    Result result;
+    result.mSum = 0;
+
+    U33FlatMap<unsigned int> map;
+    result.mInsert = measure(keys.size(), [&]()
+    {
+        for (size_t i = 0; i < keys.size(); ++i)
+            map.insert(keys[i], static_cast<unsigned int>(i));
+    });
+    result.mBytes = static_cast<double>(map.memoryBytes()) / keys.size();
+
+    result.mHit = measure(keys.size(), [&]()
+    {
+        for (size_t i = 0; i < keys.size(); ++i)
+            result.mSum += *map.find(keys[i]);
+    });
+
+    result.mMiss = measure(misses.size(), [&]()
+    {
+        for (size_t i = 0; i < misses.size(); ++i)
+            result.mSum += map.contains(misses[i]) ? 1 : 0;
+    });
+
+    result.mErase = measure(keys.size(), [&]()
+    {
+        for (size_t i = 0; i < keys.size(); ++i)
+            map.erase(keys[i]);
+    });
+
+    return result;
+}
+
+Result runStandard(const vector<U33>& keys, const vector<U33>& misses)
+{
+    Result result;
+    result.mSum = 0;
+
+    StandardMap map;
+    const size_t before = sAllocated;
+    result.mInsert = measure(keys.size(), [&]()
+    {
+        for (size_t i = 0; i < keys.size(); ++i)
+            map.insert(make_pair(keys[i], static_cast<unsigned int>(i)));
+    });
+    result.mBytes = static_cast<double>(sAllocated - before) / keys.size();
+
+    result.mHit = measure(keys.size(), [&]()
+    {
+        for (size_t i = 0; i < keys.size(); ++i)
+            result.mSum += map.find(keys[i])->second;
+    });
+
+    result.mMiss = measure(misses.size(), [&]()
+    {
+        for (size_t i = 0; i < misses.size(); ++i)
+            result.mSum += static_cast<unsigned int>(map.count(misses[i]));
+    });
+
+    result.mErase = measure(keys.size(), [&]()
+    {
+        for (size_t i = 0; i < keys.size(); ++i)
+            map.erase(keys[i]);
+    });
+
+    return result;
+}
+
+void print(const char* name, const Result& result)
+{
+    cout << setw(16) << name << fixed << setprecision(2)
+         << setw(10) << result.mInsert << setw(10) << result.mHit << setw(10) << result.mMiss
+         << setw(10) << result.mErase << setw(12) << result.mBytes << endl;
+}
+
+int main(int argc, char** argv)
+{
+    size_t maxCount(1000000);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if ((strcmp(argv[i], "--max") == 0) && (i + 1 < argc))
+        {
+            istringstream iss(argv[++i]);
+            iss >> maxCount;
+        }
+        else
+        {
+            cerr << "Usage: profile_u33flatmap [--max count]" << endl;
+            return 1;
+        }
+    }
+
+    cout << "All times ns/operation" << endl;
+
+    for (size_t count = 10000; count <= maxCount; count *= 10)
+    {
+        // PTS values a frame apart from just before the wrap; misses fall between them
+        vector<U33> keys(count);
+        vector<U33> misses(count);
+        U33 pts = U33(1, 0xffffffff) - U33(0, 90000 * 60);
+        for (size_t i = 0; i < count; ++i)
+        {
+            keys[i]   = pts;
+            misses[i] = pts + U33(0, 1501);
+            pts += U33(0, 3003);
+        }
+
+        const Result flat     = runFlat(keys, misses);
+        const Result standard = runStandard(keys, misses);
+
+        if (flat.mSum != standard.mSum)
+        {
+            cerr << "Lookup mismatch at " << count << endl;
+            return 2;
+        }
+
+        cout << endl << count << " entries" << endl;
+        cout << setw(16) << "" << setw(10) << "insert" << setw(10) << "hit" << setw(10) << "miss"
+             << setw(10) << "erase" << setw(12) << "bytes/entry" << endl;
+        print("U33FlatMap", flat);
+        print("unordered_map", standard);
+    }
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+//------------------------------------------------------------------------------
+//
+// Filename: profile_u33interval.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "U33Interval.h"
+
+/// Interval index benchmark: builds an index over count segments of 1 to
+/// 100 ms (90 kHz ticks) spread over the whole 33 bit range, so some wrap,
+/// then times single and batched stabbing and overlap queries against a
+/// linear scan with U33Interval::overlaps(). The index answers are checked
+/// against the scan on the scanned queries.
+/// Usage: profile_u33interval [--count n] [--queries n]
+
+using namespace std;
+
+static unsigned int sState(0x9e3779b9);
+
+unsigned int random32()
+{
+    sState ^= sState << 13; sState ^= sState >> 17; sState ^= sState << 5;
+    return sState;
+}
+
+U33 random33()
+{
+    return U33(random32() & 1, random32());
+}
+
+double since(const chrono::steady_clock::time_point& start)
+{
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+vector<size_t> sorted(const size_t* begin, const size_t* end)
+{
+    vector<size_t> ids(begin, end);
+    sort(ids.begin(), ids.end());
+    return ids;
+}
+
+int main(int argc, char** argv)
+{
+    size_t count(1 << 22);
+    size_t queries(1 << 18);
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        istringstream iss(argv[i + 1]);
+        if (strcmp(argv[i], "--count") == 0)
+            iss >> count;
+        else if (strcmp(argv[i], "--queries") == 0)
+            iss >> queries;
+        else
+        {
+            cerr << "Usage: profile_u33interval [--count n] [--queries n]" << endl;
+            return 1;
+        }
+    }
+
+    vector<U33Interval> segments(count);
+    for (size_t i = 0; i < count; ++i)
+        segments[i] = U33Interval::fromLength(random33(), U33(0, 90 + random32() % 9000));
+
+    vector<U33> points(queries);
+    vector<U33Interval> windows(queries);
+    for (size_t i = 0; i < queries; ++i)
+    {
+        points[i] = random33();
+        windows[i] = U33Interval::fromLength(random33(), U33(0, 3003));
+    }
+
+    U33IntervalIndex index;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    index.build(segments);
+    const double build = since(start);
+
+    vector<size_t> ids;
+    size_t found(0);
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < queries; ++i)
+    {
+        ids.clear();
+        index.stab(points[i], ids);
+        found += ids.size();
+    }
+    const double stab = since(start);
+
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < queries; ++i)
+    {
+        ids.clear();
+        index.overlapping(windows[i], ids);
+        found += ids.size();
+    }
+    const double overlap = since(start);
+
+    vector<size_t> stabIds;
+    vector<size_t> stabOffsets;
+    start = chrono::steady_clock::now();
+    index.stab(points.data(), queries, stabIds, stabOffsets);
+    const double stabBatch = since(start);
+
+    vector<size_t> overlapIds;
+    vector<size_t> overlapOffsets;
+    start = chrono::steady_clock::now();
+    index.overlapping(windows.data(), queries, overlapIds, overlapOffsets);
+    const double overlapBatch = since(start);
+
+    // the scan is slow, so only a few queries are scanned and checked
+    const size_t scanned = min<size_t>(queries, 16);
+    start = chrono::steady_clock::now();
+    for (size_t q = 0; q < scanned; ++q)
+    {
+        vector<size_t> expected;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (segments[i].overlaps(windows[q]))
+                expected.push_back(i);
+        }
+
+        if (expected != sorted(&overlapIds[0] + overlapOffsets[q], &overlapIds[0] + overlapOffsets[q + 1]))
+        {
+            cerr << "query " << q << " differs from the scan" << endl;
+            return 2;
+        }
+    }
+    const double scan = since(start);
+
+    cout << "Segments: " << count << ", queries: " << queries << ", "
+         << (index.memoryBytes() >> 20) << " MiB, " << found << " hits" << endl;
+    cout << fixed << setprecision(1);
+    cout << left << setw(20) << "build" << right << setw(12) << build / count << " ns/segment" << endl;
+    cout << left << setw(20) << "stab" << right << setw(12) << stab / queries << " ns/query" << endl;
+    cout << left << setw(20) << "stab batch" << right << setw(12) << stabBatch / queries << " ns/query" << endl;
+    cout << left << setw(20) << "overlapping" << right << setw(12) << overlap / queries << " ns/query" << endl;
+    cout << left << setw(20) << "overlapping batch" << right << setw(12) << overlapBatch / queries << " ns/query" << endl;
+    cout << left << setw(20) << "linear scan" << right << setw(12) << scan / scanned << " ns/query" << endl;
+
+    return 0;
+}
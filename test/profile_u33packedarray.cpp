@@ -0,0 +1,170 @@
+//------------------------------------------------------------------------------
+//
+// Filename: profile_u33packedarray.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "U33Batch.h"
+#include "U33PackedArray.h"
+
+/// Sequential scan benchmark: counting the values below a threshold in a
+/// std::vector<U33> against each U33PackedArray scan path, for every
+/// instruction set U33Batch offers. Each time is the best of five passes.
+/// Usage: profile_u33packedarray [--count n]
+
+using namespace std;
+
+static const int PASSES(5);
+
+template <typename Function>
+double measure(Function function, size_t& result)
+{
+    double best(0);
+
+    for (int pass = 0; pass < PASSES; ++pass)
+    {
+        const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        result = function();
+        const double time = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        best = ((pass == 0) || (time < best)) ? time : best;
+    }
+
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    size_t count(size_t(1) << 25);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if ((strcmp(argv[i], "--count") == 0) && (i + 1 < argc))
+        {
+            istringstream iss(argv[++i]);
+            iss >> count;
+        }
+        else
+        {
+            cerr << "Usage: profile_u33packedarray [--count n]" << endl;
+            return 1;
+        }
+    }
+
+    // xorshift values with bit 32 set about half the time
+    vector<U33> values(count);
+    unsigned int state(0x9e3779b9);
+    for (size_t i = 0; i < count; ++i)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        values[i] = U33(state >> 31, state * 2654435761u);
+    }
+
+    const U33PackedArray packed(values.data(), values.size());
+    const U33 limit(1, 0x40000000);
+
+    // every count is compared, so no scan can be optimised away
+    size_t expected(0);
+    const double vectorTime = measure([&]()
+    {
+        size_t below(0);
+        for (size_t i = 0; i < values.size(); ++i)
+            below += (values[i] < limit) ? 1 : 0;
+        return below;
+    }, expected);
+
+    cout << count << " values, " << expected << " below " << limit << ", best of "
+         << PASSES << " in ms" << endl;
+    cout << setw(24) << "std::vector<U33>" << fixed << setprecision(1) << setw(10) << vectorTime << endl;
+
+    const U33Batch::Isa best = U33Batch::getBestIsa();
+    for (int isa = U33Batch::ISA_SCALAR; isa <= best; ++isa)
+    {
+        U33Batch::setIsa(static_cast<U33Batch::Isa>(isa));
+
+        size_t results[5];
+        const double times[5] =
+        {
+            measure([&]()
+            {
+                size_t below(0);
+                for (U33PackedArray::ConstIterator it = packed.begin(); it != packed.end(); ++it)
+                    below += (*it < limit) ? 1 : 0;
+                return below;
+            }, results[0]),
+            measure([&]()
+            {
+                size_t below(0);
+                packed.forEach([&below, &limit](const U33& value) { below += (value < limit) ? 1 : 0; });
+                return below;
+            }, results[1]),
+            measure([&]()
+            {
+                size_t below(0);
+                packed.forEachWord([&below, &limit](unsigned int msb, unsigned int lsb32)
+                {
+                    below += (U33(msb, lsb32) < limit) ? 1 : 0;
+                });
+                return below;
+            }, results[2]),
+            measure([&]()
+            {
+                // msb then low word, branch free on random data
+                const unsigned int limitMsb = limit.getMsb();
+                const unsigned int limitLsb32 = limit.getLsb32();
+                return packed.countIf([limitMsb, limitLsb32](unsigned int msb, unsigned int lsb32)
+                {
+                    return ((msb < limitMsb) | ((msb == limitMsb) & (lsb32 < limitLsb32))) != 0;
+                });
+            }, results[3]),
+            measure([&]()
+            {
+                return packed.countLess(limit);
+            }, results[4])
+        };
+        const char* names[5] = { "iterator", "forEach", "forEachWord", "countIf", "countLess" };
+
+        cout << U33Batch::getIsaName(static_cast<U33Batch::Isa>(isa)) << endl;
+        for (int i = 0; i < 5; ++i)
+        {
+            if (results[i] != expected)
+            {
+                cerr << names[i] << " counted " << results[i] << ", expected " << expected << endl;
+                return 2;
+            }
+
+            cout << setw(24) << names[i] << setw(10) << times[i] << endl;
+        }
+    }
+
+    U33Batch::setIsa(best);
+
+    return 0;
+}
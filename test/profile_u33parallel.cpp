@@ -0,0 +1,167 @@
+//------------------------------------------------------------------------------
+//
+// Filename: profile_u33parallel.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "U33Parallel.h"
+#include "U33Rescaler.h"
+
+/// Scaling benchmark: U33Parallel::transform with typical per element
+/// functions on 1, 2, 4... up to the maximum threads (one per core by
+/// default), against the one thread time. Every run is checked bit for bit
+/// against the one thread output.
+/// Usage: profile_u33parallel [--count n] [--max-threads n] [--repeats n]
+
+using namespace std;
+
+static const U33 OFFSET(0, 90000);
+static const U33 LOW(0, 900000);
+static const U33 HIGH(1, 0x10000000);
+static constexpr U33Rescaler TO_FRAMES = U33Rescaler::fromRates(90000, 1, 30000, 1001);
+
+U33 offset(const U33& value)
+{
+    return value + OFFSET;
+}
+
+U33 rescale(const U33& value)
+{
+    const U33Rescaler::Extended frames = TO_FRAMES.rescale(value);
+    return U33(frames.getUpper() & 1, frames.getLsb32());
+}
+
+U33 clamp(const U33& value)
+{
+    return (value < LOW) ? LOW : ((HIGH < value) ? HIGH : value);
+}
+
+U33 remap(const U33& value)
+{
+    return rescale(clamp(offset(value)));
+}
+
+template <typename Function>
+double measure(const vector<U33>& input, vector<U33>& output, unsigned int repeats, Function function)
+{
+    double best = numeric_limits<double>::max();
+
+    for (unsigned int repeat = 0; repeat < repeats; ++repeat)
+    {
+        const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        U33Parallel::transform(input.data(), output.data(), input.size(), function);
+        best = min(best, chrono::duration<double, nano>(chrono::steady_clock::now() - start).count());
+    }
+
+    return best / static_cast<double>(input.size());
+}
+
+int main(int argc, char** argv)
+{
+    size_t count(1 << 24);
+    unsigned int maxThreads(max(thread::hardware_concurrency(), 1u));
+    unsigned int repeats(5);
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        istringstream iss(argv[i + 1]);
+        if (strcmp(argv[i], "--count") == 0)
+            iss >> count;
+        else if (strcmp(argv[i], "--max-threads") == 0)
+            iss >> maxThreads;
+        else if (strcmp(argv[i], "--repeats") == 0)
+            iss >> repeats;
+        else
+        {
+            cerr << "Usage: profile_u33parallel [--count n] [--max-threads n] [--repeats n]" << endl;
+            return 1;
+        }
+    }
+
+    vector<U33> input(count);
+    unsigned int state(0x9e3779b9);
+    for (size_t i = 0; i < count; ++i)
+    {
+        state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+        input[i] = U33(state & 1, state * 2654435761u);
+    }
+
+    vector<unsigned int> threads;
+    for (unsigned int t = 1; t < maxThreads; t *= 2)
+        threads.push_back(t);
+    threads.push_back(maxThreads);
+
+    const char* names[] = { "offset", "rescale", "clamp", "remap" };
+    U33 (*functions[])(const U33&) = { offset, rescale, clamp, remap };
+
+    cout << "Count: " << count << ", chunk " << U33Parallel::getChunkSize()
+         << " values, best of " << repeats << ", ns/value (speedup)" << endl;
+    cout << left << setw(10) << "threads" << right;
+    for (size_t f = 0; f < sizeof(names) / sizeof(names[0]); ++f)
+        cout << setw(18) << names[f];
+    cout << endl;
+
+    vector<vector<U33> > reference(sizeof(names) / sizeof(names[0]));
+    vector<double> single(sizeof(names) / sizeof(names[0]));
+    vector<U33> output(count);
+
+    for (size_t t = 0; t < threads.size(); ++t)
+    {
+        U33Parallel::setThreads(threads[t]);
+        cout << left << setw(10) << threads[t] << right << fixed;
+
+        for (size_t f = 0; f < sizeof(names) / sizeof(names[0]); ++f)
+        {
+            const double ns = measure(input, output, repeats, functions[f]);
+
+            if (t == 0)
+            {
+                reference[f] = output;
+                single[f] = ns;
+            }
+            else if (output != reference[f])
+            {
+                cerr << endl << names[f] << " differs on " << threads[t] << " threads" << endl;
+                return 2;
+            }
+
+            ostringstream cell;
+            cell << fixed << setprecision(3) << ns << " (" << setprecision(2) << (single[f] / ns) << "x)";
+            cout << setw(18) << cell.str();
+        }
+
+        cout << endl;
+    }
+
+    return 0;
+}
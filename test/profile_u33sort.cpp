@@ -0,0 +1,121 @@
+//------------------------------------------------------------------------------
+//
+// Filename: profile_u33sort.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "U33Sort.h"
+
+/// Sort benchmark: std::sort against U33Sort on random 33 bit keys, for
+/// vectors, key / payload pairs, the packed layout and a threaded histogram.
+/// Sizes run in decades from 10^4 up to the maximum (10^7 by default).
+/// Usage: profile_u33sort [--max count] [--threads n] [--seed n]
+
+using namespace std;
+
+template <typename Function>
+double measure(Function function)
+{
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    function();
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t maxCount(10000000);
+    unsigned int threads(max(thread::hardware_concurrency(), 1u));
+    unsigned int seed(33);
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        istringstream iss(argv[i + 1]);
+        if (strcmp(argv[i], "--max") == 0)
+            iss >> maxCount;
+        else if (strcmp(argv[i], "--threads") == 0)
+            iss >> threads;
+        else if (strcmp(argv[i], "--seed") == 0)
+            iss >> seed;
+        else
+        {
+            cerr << "Usage: profile_u33sort [--max count] [--threads n] [--seed n]" << endl;
+            return 1;
+        }
+    }
+
+    mt19937 random(seed);
+
+    cout << "Histogram threads: " << threads << ", all times ns/key" << endl;
+    cout << setw(11) << "count" << setw(11) << "std::sort" << setw(9) << "radix"
+         << setw(9) << "pairs" << setw(9) << "packed" << setw(10) << "threaded"
+         << setw(9) << "speedup" << endl;
+
+    for (size_t count = 10000; count <= maxCount; count *= 10)
+    {
+        vector<U33> input(count);
+        for (size_t i = 0; i < count; ++i)
+            input[i] = U33(random() & 1, random());
+
+        vector<U33> expected(input);
+        const double reference = measure([&]() { std::sort(expected.begin(), expected.end()); });
+
+        vector<U33> keys(input);
+        const double radix = measure([&]() { U33Sort::sort(keys); });
+
+        vector<U33> pairKeys(input);
+        vector<unsigned int> payloads(count);
+        for (size_t i = 0; i < count; ++i)
+            payloads[i] = static_cast<unsigned int>(i);
+        const double pairs = measure([&]() { U33Sort::sort(pairKeys, payloads); });
+
+        U33PackedArray packed(input.data(), count);
+        const double packedTime = measure([&]() { U33Sort::sort(packed); });
+
+        vector<U33> threadedKeys(input);
+        const double threaded = measure([&]() { U33Sort::sort(threadedKeys, threads); });
+
+        if (keys != expected || pairKeys != expected || threadedKeys != expected ||
+            !std::equal(packed.begin(), packed.end(), expected.begin()))
+        {
+            cerr << "Sort mismatch at " << count << endl;
+            return 2;
+        }
+
+        const double keysCount = static_cast<double>(count);
+        cout << setw(11) << count << fixed << setprecision(2)
+             << setw(11) << (reference / keysCount) << setw(9) << (radix / keysCount)
+             << setw(9) << (pairs / keysCount) << setw(9) << (packedTime / keysCount)
+             << setw(10) << (threaded / keysCount) << setw(8) << (reference / radix) << "x" << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,571 @@
+//------------------------------------------------------------------------------
+//
+// Filename: scan_ts.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "U33Unwrapper.h"
+#include "U33Wire.h"
+
+/// Transport stream triage: memory maps a capture, splits it into packet
+/// aligned chunks scanned in parallel, and reports the PTS / DTS / PCR of
+/// every PID with counts, gaps, wraps and out of order timestamps.
+///
+/// Usage: scan_ts <file> [--threads N] [--gap-ms N]
+
+using namespace std;
+
+static const size_t PACKET = 188;
+static const unsigned char SYNC = 0x47;
+static const unsigned int PIDS = 8192;
+
+/// Chunks are at least this many packets (~1.5 MB) to amortise the merge
+static const size_t MIN_CHUNK_PACKETS = 8192;
+
+/// Each thread gets this many chunks on average so stragglers balance out
+static const size_t CHUNKS_PER_THREAD = 8;
+
+/// The largest gap in ms whose 90 kHz tick count fits a word
+static const unsigned int MAX_GAP_MS = 0xffffffffu / 90;
+
+enum Kind
+{
+    KIND_PCR,
+    KIND_PTS,
+    KIND_DTS,
+    KINDS
+};
+
+static const char* const KIND_NAMES[KINDS] = { "PCR", "PTS", "DTS" };
+
+struct Options
+{
+    Options() : mThreads(0), mGapMs(1000) {}
+
+    string mFile;
+    unsigned int mThreads;
+    unsigned int mGapMs;
+};
+
+/// The timestamps of one kind on one PID, within a chunk or (once merged)
+/// across the file
+struct Track
+{
+    Track(unsigned int pid, Kind kind, const U33& maxStep) :
+        mPid(pid), mKind(kind), mCount(0), mWraps(0), mGaps(0), mBackward(0), mUnwrapper(maxStep)
+    {
+    }
+
+    void record(unsigned int flags)
+    {
+        mWraps    += ((flags & U33Unwrapper::FLAG_WRAP) && !(flags & U33Unwrapper::FLAG_BACKWARD)) ? 1 : 0;
+        mGaps     += (flags & U33Unwrapper::FLAG_DISCONTINUITY) ? 1 : 0;
+        mBackward += (flags & U33Unwrapper::FLAG_BACKWARD) ? 1 : 0;
+    }
+
+    void add(const U33& value)
+    {
+        unsigned int flags(0);
+        mUnwrapper.unwrap(value, flags);
+        if (flags & U33Unwrapper::FLAG_FIRST)
+        {
+            mFirst = value;
+        }
+        else
+        {
+            record(flags);
+        }
+
+        mLast = value;
+        ++mCount;
+    }
+
+    /// Append a later chunk, classifying the step across the boundary
+    void append(const Track& next)
+    {
+        U33Unwrapper boundary(mUnwrapper.getMaxStep());
+        unsigned int flags(0);
+        boundary.unwrap(mLast);
+        boundary.unwrap(next.mFirst, flags);
+        record(flags);
+
+        mCount    += next.mCount;
+        mWraps    += next.mWraps;
+        mGaps     += next.mGaps;
+        mBackward += next.mBackward;
+        mLast      = next.mLast;
+    }
+
+    unsigned int mPid;
+    Kind mKind;
+    size_t mCount;
+    size_t mWraps;
+    size_t mGaps;
+    size_t mBackward;
+    U33 mFirst;
+    U33 mLast;
+    U33Unwrapper mUnwrapper;
+};
+
+/// A range of the capture, from its first packet to the next chunk's first
+/// packet, and what was found in it
+struct Chunk
+{
+    Chunk() : mBegin(0), mEnd(0), mPackets(0), mSyncErrors(0), mSkippedBytes(0), mTransportErrors(0),
+              mMarkerErrors(0) {}
+
+    size_t mBegin;
+    size_t mEnd;
+    size_t mPackets;
+    size_t mSyncErrors;
+    size_t mSkippedBytes;
+    size_t mTransportErrors;
+    size_t mMarkerErrors;
+    vector<Track> mTracks;
+};
+
+/// Read only view of a whole file, mapped where the platform allows
+class MappedFile
+{
+public:
+    MappedFile() : mData(0), mSize(0)
+    {
+    }
+
+    ~MappedFile()
+    {
+#if !defined(_WIN32)
+        if (mData && mSize)
+        {
+            munmap(const_cast<unsigned char*>(mData), mSize);
+        }
+#endif
+    }
+
+    bool open(const string& name)
+    {
+#if defined(_WIN32)
+        ifstream file(name.c_str(), ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+        mBuffer.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+        mData = reinterpret_cast<const unsigned char*>(mBuffer.data());
+        mSize = mBuffer.size();
+        return true;
+#else
+        const int fd = ::open(name.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        if (info.st_size <= 0)
+        {
+            // an empty file is valid, there is nothing to map
+            close(fd);
+            return (info.st_size == 0);
+        }
+
+        void* data = mmap(0, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+
+#if defined(MADV_SEQUENTIAL)
+        // each thread streams through its own chunks
+        madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+#endif
+        mData = static_cast<const unsigned char*>(data);
+        mSize = static_cast<size_t>(info.st_size);
+        return true;
+#endif
+    }
+
+    const unsigned char* data() const
+    {
+        return mData;
+    }
+
+    size_t size() const
+    {
+        return mSize;
+    }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const unsigned char* mData;
+    size_t mSize;
+#if defined(_WIN32)
+    string mBuffer;
+#endif
+};
+
+/// The first offset in [from, limit) where a whole packet starts with a
+/// sync byte and so do the next two (those the file holds), or limit
+static size_t findSync(const unsigned char* data, size_t size, size_t from, size_t limit)
+{
+    for (size_t offset = from; (offset < limit) && (offset + PACKET <= size); ++offset)
+    {
+        const void* found = memchr(data + offset, SYNC, limit - offset);
+        if (!found)
+        {
+            break;
+        }
+
+        offset = static_cast<size_t>(static_cast<const unsigned char*>(found) - data);
+        if ((offset + PACKET <= size) &&
+            ((offset + PACKET >= size) || (data[offset + PACKET] == SYNC)) &&
+            ((offset + 2 * PACKET >= size) || (data[offset + 2 * PACKET] == SYNC)))
+        {
+            return offset;
+        }
+    }
+
+    return limit;
+}
+
+/// True for the PES stream ids whose header carries the optional fields
+/// (ISO 13818-1 table 2-21)
+static bool hasPesExtension(unsigned int streamId)
+{
+    return (streamId != 0xbc) && (streamId != 0xbe) && (streamId != 0xbf) &&
+           (streamId != 0xf0) && (streamId != 0xf1) && (streamId != 0xf2) &&
+           (streamId != 0xf8) && (streamId != 0xff);
+}
+
+/// Scans the chunks handed out by a shared counter, the slot table maps
+/// (PID, kind) to the index of the track in the current chunk
+class Scanner
+{
+public:
+    Scanner(const MappedFile& file, vector<Chunk>& chunks, atomic<size_t>& next, const U33& maxStep) :
+        mData(file.data()), mSize(file.size()), mChunks(chunks), mNext(next), mMaxStep(maxStep),
+        mSlots(PIDS * KINDS, -1)
+    {
+    }
+
+    void operator()()
+    {
+        for (size_t index = mNext++; index < mChunks.size(); index = mNext++)
+        {
+            scan(mChunks[index]);
+        }
+    }
+
+private:
+    Track& track(Chunk& chunk, unsigned int pid, Kind kind)
+    {
+        int& slot = mSlots[pid * KINDS + kind];
+        if (slot < 0)
+        {
+            slot = static_cast<int>(chunk.mTracks.size());
+            chunk.mTracks.push_back(Track(pid, kind, mMaxStep));
+        }
+
+        return chunk.mTracks[slot];
+    }
+
+    void scan(Chunk& chunk)
+    {
+        size_t offset = chunk.mBegin;
+        while ((offset < chunk.mEnd) && (offset + PACKET <= mSize))
+        {
+            const unsigned char* packet = mData + offset;
+            if (packet[0] != SYNC)
+            {
+                // a dropped or extra byte: pick the packets up again where
+                // they next line up, the next chunk finds its own start
+                const size_t resync = findSync(mData, mSize, offset + 1, chunk.mEnd);
+                ++chunk.mSyncErrors;
+                chunk.mSkippedBytes += resync - offset;
+                offset = resync;
+                continue;
+            }
+
+            ++chunk.mPackets;
+            offset += PACKET;
+
+            if (packet[1] & 0x80)
+            {
+                ++chunk.mTransportErrors;
+                continue;
+            }
+
+            const unsigned int pid = ((packet[1] & 0x1fu) << 8) | packet[2];
+            const unsigned int control = (packet[3] >> 4) & 0x3;
+            size_t start(4);
+
+            if (control & 0x2)
+            {
+                // adaptation field: length, flags, then the PCR when flagged
+                const size_t length = packet[4];
+                if ((length >= 7) && (packet[5] & 0x10))
+                {
+                    U33 base;
+                    unsigned int extension(0);
+                    U33Wire::decodePcr(packet + 6, base, extension);
+                    track(chunk, pid, KIND_PCR).add(base);
+                }
+
+                start = 5 + length;
+            }
+
+            // a PES header starts the payload when the unit start is set
+            if (!(control & 0x1) || !(packet[1] & 0x40) || (start + 14 > PACKET))
+            {
+                continue;
+            }
+
+            const unsigned char* pes = packet + start;
+            if ((pes[0] != 0) || (pes[1] != 0) || (pes[2] != 1) ||
+                !hasPesExtension(pes[3]) || ((pes[6] & 0xc0) != 0x80))
+            {
+                continue;
+            }
+
+            const unsigned int timestamps = pes[7] >> 6;
+            U33 value;
+            if (timestamps & 0x2)
+            {
+                if (U33Wire::decodeTimestamp(pes + 9, value))
+                {
+                    track(chunk, pid, KIND_PTS).add(value);
+                }
+                else
+                {
+                    ++chunk.mMarkerErrors;
+                }
+            }
+
+            if ((timestamps == 0x3) && (start + 19 <= PACKET))
+            {
+                if (U33Wire::decodeTimestamp(pes + 14, value))
+                {
+                    track(chunk, pid, KIND_DTS).add(value);
+                }
+                else
+                {
+                    ++chunk.mMarkerErrors;
+                }
+            }
+        }
+
+        // ready for the next chunk
+        for (size_t i = 0; i < chunk.mTracks.size(); ++i)
+        {
+            mSlots[chunk.mTracks[i].mPid * KINDS + chunk.mTracks[i].mKind] = -1;
+        }
+    }
+
+    const unsigned char* mData;
+    size_t mSize;
+    vector<Chunk>& mChunks;
+    atomic<size_t>& mNext;
+    U33 mMaxStep;
+    vector<int> mSlots;
+};
+
+static bool parse(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const string arg(argv[i]);
+        if (((arg == "--threads") || (arg == "--gap-ms")) && (i + 1 < argc))
+        {
+            istringstream iss(argv[++i]);
+            iss >> ((arg == "--threads") ? options.mThreads : options.mGapMs);
+            if (!iss)
+            {
+                return false;
+            }
+
+            if (options.mGapMs > MAX_GAP_MS)
+            {
+                // wider gaps would wrap the 33 bit step
+                cerr << "--gap-ms is at most " << MAX_GAP_MS << endl;
+                return false;
+            }
+        }
+        else if (options.mFile.empty() && (arg.compare(0, 2, "--") != 0))
+        {
+            options.mFile = arg;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return !options.mFile.empty();
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse(argc, argv, options))
+    {
+        cerr << "Usage: " << argv[0] << " <file> [--threads N] [--gap-ms N]" << endl;
+        return 1;
+    }
+
+    if (!options.mThreads)
+    {
+        options.mThreads = max(1u, thread::hardware_concurrency());
+    }
+
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    MappedFile file;
+    if (!file.open(options.mFile))
+    {
+        cerr << "Cannot open " << options.mFile << endl;
+        return 1;
+    }
+
+    const size_t sync = findSync(file.data(), file.size(), 0, file.size());
+    const size_t packets = (sync < file.size()) ? ((file.size() - sync) / PACKET) : 0;
+
+    // several chunks per thread, each starting at the first packet at or
+    // after its share of the file, so a glitch in one does not shift the rest
+    const size_t wanted = static_cast<size_t>(options.mThreads) * CHUNKS_PER_THREAD;
+    const size_t perChunk = max(MIN_CHUNK_PACKETS, (packets + wanted - 1) / wanted);
+
+    vector<Chunk> chunks((packets + perChunk - 1) / perChunk);
+    const size_t chunkBytes = perChunk * PACKET;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        const size_t share = sync + i * chunkBytes;
+        chunks[i].mBegin = findSync(file.data(), file.size(), share, min(share + chunkBytes, file.size()));
+    }
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        chunks[i].mEnd = (i + 1 < chunks.size()) ? chunks[i + 1].mBegin : file.size();
+    }
+
+    const U33 maxStep(0, options.mGapMs * 90u);
+    const unsigned int threads = static_cast<unsigned int>(min<size_t>(options.mThreads, max<size_t>(1, chunks.size())));
+    atomic<size_t> next(0);
+
+    vector<thread> workers;
+    for (unsigned int t = 1; t < threads; ++t)
+    {
+        workers.push_back(thread(Scanner(file, chunks, next, maxStep)));
+    }
+
+    Scanner(file, chunks, next, maxStep)();
+    for (size_t t = 0; t < workers.size(); ++t)
+    {
+        workers[t].join();
+    }
+
+    // stitch the chunks together in file order
+    map<pair<unsigned int, int>, Track> tracks;
+    Chunk total;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        total.mPackets         += chunks[i].mPackets;
+        total.mSyncErrors      += chunks[i].mSyncErrors;
+        total.mSkippedBytes    += chunks[i].mSkippedBytes;
+        total.mTransportErrors += chunks[i].mTransportErrors;
+        total.mMarkerErrors    += chunks[i].mMarkerErrors;
+
+        for (size_t j = 0; j < chunks[i].mTracks.size(); ++j)
+        {
+            const Track& track = chunks[i].mTracks[j];
+            const pair<unsigned int, int> key(track.mPid, track.mKind);
+            map<pair<unsigned int, int>, Track>::iterator found = tracks.find(key);
+            if (found == tracks.end())
+            {
+                tracks.insert(make_pair(key, track));
+            }
+            else
+            {
+                found->second.append(track);
+            }
+        }
+    }
+
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "File:             " << options.mFile << endl;
+    cout << "Bytes:            " << file.size() << " (first sync at " << sync << ")" << endl;
+    cout << "Packets:          " << total.mPackets << " in " << chunks.size() << " chunks on " << threads << " threads" << endl;
+    cout << "Sync errors:      " << total.mSyncErrors << " (" << total.mSkippedBytes << " bytes skipped)" << endl;
+    cout << "Transport errors: " << total.mTransportErrors << endl;
+    cout << "Marker errors:    " << total.mMarkerErrors << endl;
+    cout << "Scanned in:       " << fixed << setprecision(3) << seconds << " s ("
+         << setprecision(1) << (seconds > 0 ? (file.size() / seconds / 1e6) : 0.0) << " MB/s)" << endl;
+    cout << endl;
+
+    cout << "PID     Kind        Count  Wraps   Gaps  Out-of-order  First         Last" << endl;
+    for (map<pair<unsigned int, int>, Track>::const_iterator it = tracks.begin(); it != tracks.end(); ++it)
+    {
+        const Track& track = it->second;
+        ostringstream pid;
+        pid << "0x" << hex << setw(4) << setfill('0') << track.mPid;
+
+        ostringstream first;
+        ostringstream last;
+        first << track.mFirst;
+        last << track.mLast;
+
+        cout << left << setw(8) << pid.str() << setw(6) << KIND_NAMES[track.mKind] << right
+             << setw(11) << track.mCount << setw(7) << track.mWraps << setw(7) << track.mGaps
+             << setw(14) << track.mBackward << "  " << left << setw(14) << first.str() << last.str()
+             << right << endl;
+    }
+
+    return ((total.mSyncErrors + total.mTransportErrors + total.mMarkerErrors) == 0) ? 0 : 2;
+}
@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_atomicu33.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "AtomicU33.h"
+
+using namespace std;
+
+static constexpr U33 MAX33 = 0x1ffffffff_u33;
+
+void check(bool success, const char* backend, const char* what)
+{
+    if (!success)
+    {
+        cout << "FAILURE " << what << " (" << backend << ")" << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
+template <typename Atomic>
+void checkSingle(const char* backend)
+{
+    Atomic value(MAX33);
+
+    check(value.load() == MAX33, backend, "load");
+
+    // the same wrap as operator+= / operator-=
+    check(value.fetchAdd(2u) == MAX33, backend, "fetchAdd previous");
+    check(value.load() == U33(0, 1), backend, "fetchAdd wrap");
+    check(value.fetchSub(U33(0, 3)) == U33(0, 1), backend, "fetchSub previous");
+    check(value.load() == U33(1, 0xfffffffe), backend, "fetchSub wrap");
+    check(value.fetchAdd(U33(1, 0)) == U33(1, 0xfffffffe), backend, "fetchAdd U33");
+    check(value.load() == U33(0, 0xfffffffe), backend, "fetchAdd U33 value");
+
+    value.store(U33(1, 5));
+    check(value.exchange(U33(0, 7)) == U33(1, 5), backend, "exchange previous");
+    check(value.load() == U33(0, 7), backend, "exchange value");
+
+    U33 expected(0, 8);
+    check(!value.compareExchangeStrong(expected, U33(1, 1)), backend, "cas mismatch");
+    check((expected == U33(0, 7)) && (value.load() == U33(0, 7)), backend, "cas mismatch expected");
+    check(value.compareExchangeStrong(expected, U33(1, 1)), backend, "cas match");
+    check(value.load() == U33(1, 1), backend, "cas match value");
+
+    expected = U33(1, 1);
+    while (!value.compareExchangeWeak(expected, U33(0, 2)))
+    {
+        check(expected == U33(1, 1), backend, "weak cas spurious");
+    }
+    check(value.load() == U33(0, 2), backend, "weak cas value");
+}
+
+template <typename Atomic>
+void checkThreads(const char* backend)
+{
+    const unsigned int threads = 4;
+    const unsigned int count = 20000;
+
+    // start just below the wrap so the counter crosses it
+    const U33 start = MAX33 - (threads * count / 2);
+    Atomic counter(start);
+
+    // writers flip between the two sides of the 32 bit boundary, a torn
+    // read would see 0 or MAX33
+    Atomic flipper(U33(0, 0xffffffff));
+    atomic<bool> torn(false);
+    atomic<unsigned int> running(threads);
+
+    vector<thread> workers;
+    for (unsigned int t = 0; t < threads; ++t)
+    {
+        workers.push_back(thread([&, t]()
+        {
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                if (i & 1)
+                    counter.fetchSub(U33(0, 1));
+                else
+                    counter.fetchAdd(U33(0, 3));
+
+                const U33 next = (t & 1) ? U33(1, 0) : U33(0, 0xffffffff);
+                if (i % 3)
+                {
+                    flipper.store(next);
+                }
+                else
+                {
+                    U33 expected = flipper.load();
+                    flipper.compareExchangeWeak(expected, next);
+                }
+            }
+            running.fetch_sub(1);
+        }));
+    }
+
+    // a reader watching for torn values
+    while (running.load() > 0)
+    {
+        const U33 seen = flipper.load();
+        if ((seen != U33(1, 0)) && (seen != U33(0, 0xffffffff)))
+            torn.store(true);
+    }
+
+    for (size_t t = 0; t < workers.size(); ++t)
+        workers[t].join();
+
+    check(counter.load() == (start + U33(0, threads * count)), backend, "contended count");
+    check(!torn.load(), backend, "torn read");
+}
+
+int main()
+{
+    AtomicU33Cas cas;
+    cout << "Single word CAS lock free: " << boolalpha << cas.isLockFree() << endl;
+
+    checkSingle<AtomicU33Cas>("cas");
+    checkSingle<AtomicU33SeqLock>("seqlock");
+    checkSingle<AtomicU33>("default");
+
+    checkThreads<AtomicU33Cas>("cas");
+    checkThreads<AtomicU33SeqLock>("seqlock");
+
+    cout << "Sweet success!" << endl;
+
+    return 0;
+}
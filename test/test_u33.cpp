@@ -165,6 +165,191 @@ void checkSubtraction(U64 a, U64 b)
     }
 }
 
+void checkComparison(U64 a, U64 b)
+{
+    // convert the 64bit numbers to 33 bits
+    const U33 a33 = convert(a);
+    const U33 b33 = convert(b);
+
+    // check every comparison against the 64bit result
+    const bool success = ((a33 == b33) == (a == b)) &&
+                         ((a33 != b33) == (a != b)) &&
+                         ((a33 <  b33) == (a <  b)) &&
+                         ((a33 <= b33) == (a <= b)) &&
+                         ((a33 >  b33) == (a >  b)) &&
+                         ((a33 >= b33) == (a >= b));
+
+    // check for the lack of sweet success
+    if (!success || DumpAll)
+    {
+        cout << "==============================================================" << endl;
+        cout << "DUMP COMPARISON" << endl;
+        cout << "==============================================================" << endl;
+        cout << "a              : 0x" << hex << a << endl;
+        cout << "b              : 0x" << hex << b << endl;
+        cout << "a33            : " << a33 << endl;
+        cout << "b33            : " << b33 << endl;
+        cout << "success        : " << boolalpha << success << endl;
+        cout << "==============================================================" << endl << endl;
+    }
+
+    if (!success)
+    {
+        throw std::logic_error("Test failure");
+    }
+}
+
+void checkSerial(U64 a, U64 b, bool before, bool after, int distance)
+{
+    const U33 a33 = convert(a);
+    const U33 b33 = convert(b);
+
+    const bool success = (a33.isBefore(b33) == before) &&
+                         (a33.isAfter(b33) == after) &&
+                         (b33.isAfter(a33) == before) &&
+                         (a33.distanceTo(b33) == distance);
+
+    if (!success || DumpAll)
+    {
+        cout << "==============================================================" << endl;
+        cout << "DUMP SERIAL" << endl;
+        cout << "==============================================================" << endl;
+        cout << "a33            : " << a33 << endl;
+        cout << "b33            : " << b33 << endl;
+        cout << "isBefore       : " << boolalpha << a33.isBefore(b33) << endl;
+        cout << "isAfter        : " << boolalpha << a33.isAfter(b33) << endl;
+        cout << "distanceTo     : " << dec << a33.distanceTo(b33) << endl;
+        cout << "success        : " << boolalpha << success << endl;
+        cout << "==============================================================" << endl << endl;
+    }
+
+    if (!success)
+    {
+        throw std::logic_error("Test failure");
+    }
+}
+
+void checkMixed(U64 a, int b)
+{
+    // sign extend the value into the 33 bit space
+    const U64 b64 = static_cast<U64>(static_cast<long long>(b)) & MASK33;
+    const U64 u64 = static_cast<U64>(static_cast<unsigned int>(b));
+
+    const U33 a33 = convert(a);
+
+    const bool success = (convert(a33 + b) == ((a + b64) & MASK33)) &&
+                         (convert(a33 - b) == ((a - b64) & MASK33)) &&
+                         (convert(a33 + static_cast<unsigned int>(b)) == ((a + u64) & MASK33)) &&
+                         (convert(a33 - static_cast<unsigned int>(b)) == ((a - u64) & MASK33));
+
+    // check for the lack of sweet success
+    if (!success || DumpAll)
+    {
+        cout << "==============================================================" << endl;
+        cout << "DUMP MIXED" << endl;
+        cout << "==============================================================" << endl;
+        cout << "a              : 0x" << hex << a << endl;
+        cout << "b              : " << dec << b << endl;
+        cout << "a33 + b        : " << (a33 + b) << endl;
+        cout << "a33 - b        : " << (a33 - b) << endl;
+        cout << "success        : " << boolalpha << success << endl;
+        cout << "==============================================================" << endl << endl;
+    }
+
+    if (!success)
+    {
+        throw std::logic_error("Test failure");
+    }
+}
+
+void checkGetters(U64 a)
+{
+    const U33 a33 = convert(a);
+
+    const bool success = (a33.getMsb32() == static_cast<unsigned int>(a >> 1)) &&
+                         (a33.getLsb32() == static_cast<unsigned int>(a & MASK32)) &&
+                         (a33.getMsb() == ((a >> 32) != 0)) &&
+                         (a33.getLsb() == ((a & 1) != 0));
+
+    if (!success)
+    {
+        cout << "getters failed for 0x" << hex << a << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
+void checkAccumulation(U64 step, unsigned int count)
+{
+    // every carry out of the lower half must be counted exactly once
+    U33 sum;
+    U64 sum64(0);
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        sum += convert(step);
+        sum64 = (sum64 + step) & MASK33;
+
+        if (convert(sum) != sum64)
+        {
+            cout << "accumulation of 0x" << hex << step << " failed after " << dec << (i + 1) << endl;
+            throw std::logic_error("Test failure");
+        }
+    }
+}
+
+/// Frame durations in 90 kHz ticks for 23.976, 24, 25, 29.97, 30, 50, 59.94
+/// and 60 Hz, computed at compile time
+static constexpr U33 FRAME_TICKS[] = { (90000_u33 * 1001u) / 24000u, 90000_u33 / 24u,
+                                       90000_u33 / 25u, (90000_u33 * 1001u) / 30000u,
+                                       90000_u33 / 30u, 90000_u33 / 50u,
+                                       (90000_u33 * 1001u) / 60000u, 90000_u33 / 60u };
+
+static_assert(FRAME_TICKS[0] == 3753_u33, "23.976 Hz");
+static_assert(FRAME_TICKS[3] == 3003_u33, "29.97 Hz");
+static_assert(FRAME_TICKS[7] == 1500_u33, "60 Hz");
+
+// literals in every base, and constant arithmetic across the wrap
+static_assert(0x1'ffff'ffff_u33 == ~U33(), "hex literal");
+static_assert(8589934591_u33 == U33(1, 0xffffffff), "decimal literal");
+static_assert(0b1'0000'0000'0000'0000'0000'0000'0000'0000_u33 == U33(1, 0), "binary literal");
+static_assert(0777_u33 == U33(0, 511), "octal literal");
+static_assert(0_u33 == U33(), "zero literal");
+static_assert((0x1ffffffff_u33 + 3003_u33) == 3002_u33, "addition wraps");
+static_assert((0_u33 - 1u) == 0x1ffffffff_u33, "subtraction wraps");
+static_assert((0x123456789_u33 * 3u) == 0x169d0369b_u33, "multiplication");
+static_assert((0x1ffffffff_u33 / 90000u) == 95443_u33, "division");
+static_assert((0x1ffffffff_u33).divideBy<90000>() == 95443_u33, "constant division");
+static_assert((0x1ffffffff_u33).remainderBy<90000>() == 64591_u33, "constant remainder");
+static_assert((0x1ffffffff_u33 >> 1) == 0xffffffff_u33, "shift");
+static_assert((0x1ffffffff_u33).isBefore(5_u33), "serial order across the wrap");
+static_assert((0x1fffea070_u33).distanceTo(0_u33) == 90000, "serial distance");
+static_assert((0x1ffffffff_u33).addSaturate(1_u33) == 0x1ffffffff_u33, "saturation");
+static_assert(!UIntLiteral<33>::fits("0x200000000") && UIntLiteral<33>::fits("0x1ffffffff"), "literal range");
+static_assert(!UIntLiteral<33>::fits("1.5") && !UIntLiteral<33>::fits("08"), "literal digits");
+
+void checkLiterals()
+{
+    // the same values built at run time
+    const unsigned int rates[][2] = { { 24000, 1001 }, { 24, 1 }, { 25, 1 }, { 30000, 1001 },
+                                      { 30, 1 }, { 50, 1 }, { 60000, 1001 }, { 60, 1 } };
+
+    for (unsigned int i = 0; i < sizeof(rates) / sizeof(rates[0]); ++i)
+    {
+        const U64 expected = (90000ULL * rates[i][1]) / rates[i][0];
+        if (convert(FRAME_TICKS[i]) != expected)
+        {
+            cout << "frame ticks failed for rate " << i << endl;
+            throw std::logic_error("Test failure");
+        }
+    }
+
+    if (convert(UIntLiteral<33>::value("8'589'934'591")) != MASK33)
+    {
+        cout << "literal value failed" << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
 int main()
 {
     checkAddition(0x1, 0x1);
@@ -181,6 +366,41 @@ int main()
     checkSubtraction(0, 0);
     checkSubtraction(1234567, 1111111);
 
+    checkComparison(0x1, 0x1);
+    checkComparison(0x1, 0x2);
+    checkComparison(0x10000, 0xffff);
+    checkComparison(0x100000000, 0xffffffff);
+    checkComparison(0x1ffffffff, 0x1fffeffff);
+    checkComparison(0x1ffffffff, 0x0);
+
+    checkSerial(0x1, 0x1, false, false, 0);
+    checkSerial(0x1, 0x2, true, false, 1);
+    checkSerial(0x1ffffffff, 0x0, true, false, 1);
+    checkSerial(0x0, 0x1fffea070, false, true, -90000);
+    checkSerial(0x0, 0x100000000, false, false, -2147483647 - 1);
+    checkSerial(0x0, 0x0ffffffff, true, false, 2147483647);
+    checkSerial(0x0, 0x100000001, false, true, -2147483647 - 1);
+
+    checkMixed(0x1, 1);
+    checkMixed(0x1, -1);
+    checkMixed(0x0, -2147483647 - 1);
+    checkMixed(0x1ffffffff, 2147483647);
+    checkMixed(0x100000000, -65536);
+    checkMixed(1234567, 1111111);
+
+    checkGetters(0x0);
+    checkGetters(0x1);
+    checkGetters(0x1ffffffff);
+    checkGetters(0x100010000);
+    checkGetters(0x0fffeffff);
+    checkGetters(1234567);
+
+    checkAccumulation(0x2, 100000);
+    checkAccumulation(0xffff, 100000);
+    checkAccumulation(0x1fffffffd, 100000);
+
+    checkLiterals();
+
     cout << "Sweet success!" << endl;
 
     return 0;
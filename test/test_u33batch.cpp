@@ -0,0 +1,181 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_u33batch.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "U33Batch.h"
+
+using namespace std;
+
+static unsigned int sState(0x12345678);
+
+unsigned int random32()
+{
+    // xorshift
+    sState ^= sState << 13;
+    sState ^= sState >> 17;
+    sState ^= sState << 5;
+    return sState;
+}
+
+U33 randomU33()
+{
+    // bias towards the half word and wrap edges where the carries live
+    static const unsigned int EDGES[] = { 0x0, 0x1, 0xffff, 0x10000, 0xffffffff };
+
+    const unsigned int pick = random32() % 8;
+    const unsigned int lsb32 = (pick < 5) ? (EDGES[pick] + (random32() % 3) - 1) : random32();
+
+    return U33(random32() & 1, lsb32);
+}
+
+void fail(const char* what, U33Batch::Isa isa, size_t index, const U33& a, const U33& b)
+{
+    cout << "==============================================================" << endl;
+    cout << "FAILURE " << what << " (" << U33Batch::getIsaName(isa) << ")" << endl;
+    cout << "==============================================================" << endl;
+    cout << "index          : " << dec << index << endl;
+    cout << "a              : " << a << endl;
+    cout << "b              : " << b << endl;
+    cout << "==============================================================" << endl << endl;
+
+    throw std::logic_error("Test failure");
+}
+
+void checkIsa(U33Batch::Isa isa, size_t count)
+{
+    vector<U33> a(count);
+    vector<U33> b(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        a[i] = randomU33();
+        b[i] = (i % 5) ? randomU33() : a[i];
+
+        // serial number edges: half the range apart and near neighbours
+        if ((i % 7) == 3)
+            b[i] = a[i] + U33(1, 0);
+        else if ((i % 7) == 4)
+            b[i] = a[i] + static_cast<int>(random32() % 200) - 100;
+    }
+
+    const U33 scalar = randomU33();
+
+    vector<U33> sum(count);
+    vector<U33> diff(count);
+    vector<U33> sumScalar(count);
+    vector<U33> diffScalar(count);
+
+    // vector<bool> is not an array of bool
+    bool* equal       = new bool[count + 1];
+    bool* less        = new bool[count + 1];
+    bool* equalScalar = new bool[count + 1];
+    bool* lessScalar  = new bool[count + 1];
+    bool* before       = new bool[count + 1];
+    bool* after        = new bool[count + 1];
+    bool* beforeScalar = new bool[count + 1];
+    bool* afterScalar  = new bool[count + 1];
+    vector<int> distance(count);
+    vector<int> distanceScalar(count);
+
+    U33Batch::add(a.data(), b.data(), sum.data(), count);
+    U33Batch::sub(a.data(), b.data(), diff.data(), count);
+    U33Batch::add(a.data(), scalar, sumScalar.data(), count);
+    U33Batch::sub(a.data(), scalar, diffScalar.data(), count);
+    U33Batch::equal(a.data(), b.data(), equal, count);
+    U33Batch::less(a.data(), b.data(), less, count);
+    U33Batch::equal(a.data(), scalar, equalScalar, count);
+    U33Batch::less(a.data(), scalar, lessScalar, count);
+    U33Batch::isBefore(a.data(), b.data(), before, count);
+    U33Batch::isAfter(a.data(), b.data(), after, count);
+    U33Batch::isBefore(a.data(), scalar, beforeScalar, count);
+    U33Batch::isAfter(a.data(), scalar, afterScalar, count);
+    U33Batch::distance(a.data(), b.data(), distance.data(), count);
+    U33Batch::distance(a.data(), scalar, distanceScalar.data(), count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (sum[i] != (a[i] + b[i]))            fail("add", isa, i, a[i], b[i]);
+        if (diff[i] != (a[i] - b[i]))           fail("sub", isa, i, a[i], b[i]);
+        if (sumScalar[i] != (a[i] + scalar))    fail("add scalar", isa, i, a[i], scalar);
+        if (diffScalar[i] != (a[i] - scalar))   fail("sub scalar", isa, i, a[i], scalar);
+        if (equal[i] != (a[i] == b[i]))         fail("equal", isa, i, a[i], b[i]);
+        if (less[i] != (a[i] < b[i]))           fail("less", isa, i, a[i], b[i]);
+        if (equalScalar[i] != (a[i] == scalar)) fail("equal scalar", isa, i, a[i], scalar);
+        if (lessScalar[i] != (a[i] < scalar))   fail("less scalar", isa, i, a[i], scalar);
+        if (before[i] != a[i].isBefore(b[i]))   fail("before", isa, i, a[i], b[i]);
+        if (after[i] != a[i].isAfter(b[i]))     fail("after", isa, i, a[i], b[i]);
+        if (beforeScalar[i] != a[i].isBefore(scalar)) fail("before scalar", isa, i, a[i], scalar);
+        if (afterScalar[i] != a[i].isAfter(scalar))   fail("after scalar", isa, i, a[i], scalar);
+        if (distance[i] != a[i].distanceTo(b[i]))     fail("distance", isa, i, a[i], b[i]);
+        if (distanceScalar[i] != a[i].distanceTo(scalar)) fail("distance scalar", isa, i, a[i], scalar);
+    }
+
+    // in place
+    vector<U33> inPlace(a);
+    U33Batch::add(inPlace.data(), b.data(), inPlace.data(), count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (inPlace[i] != sum[i]) fail("add in place", isa, i, a[i], b[i]);
+    }
+
+    delete[] equal;
+    delete[] less;
+    delete[] equalScalar;
+    delete[] lessScalar;
+    delete[] before;
+    delete[] after;
+    delete[] beforeScalar;
+    delete[] afterScalar;
+}
+
+int main()
+{
+    const U33Batch::Isa best = U33Batch::getBestIsa();
+
+    cout << "Best instruction set: " << U33Batch::getIsaName(best) << endl;
+
+    for (int isa = U33Batch::ISA_SCALAR; isa <= best; ++isa)
+    {
+        if (U33Batch::setIsa(static_cast<U33Batch::Isa>(isa)) != isa)
+        {
+            throw std::logic_error("Could not select instruction set");
+        }
+
+        // odd sizes to cover every tail length
+        for (size_t count = 0; count < 20; ++count)
+        {
+            checkIsa(static_cast<U33Batch::Isa>(isa), count);
+        }
+
+        checkIsa(static_cast<U33Batch::Isa>(isa), 100003);
+    }
+
+    cout << "Sweet success!" << endl;
+
+    return 0;
+}
@@ -0,0 +1,238 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_u33flatmap.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "U33FlatMap.h"
+
+using namespace std;
+
+static unsigned int sState(0x2545f491);
+
+unsigned int random32()
+{
+    // xorshift
+    sState ^= sState << 13;
+    sState ^= sState >> 17;
+    sState ^= sState << 5;
+    return sState;
+}
+
+void check(bool success, const char* what)
+{
+    if (!success)
+    {
+        cout << "FAILURE " << what << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
+static_assert(UIntHash<33>::hash32(U33()) == 0, "zero hashes to zero");
+static_assert(UIntHash<33>::hash32(U33(1, 0)) != UIntHash<33>::hash32(U33(0, 0)), "bit 32 is hashed");
+
+void checkHash()
+{
+    check(std::hash<U33>()(U33(1, 1234)) == UIntHash<33>::hash32(U33(1, 1234)), "std::hash");
+    check(std::hash<UInt<64> >()(UInt<64>(5, 6)) != std::hash<UInt<64> >()(UInt<64>(6, 5)), "std::hash 64");
+
+    // a PTS series a frame apart spreads evenly over a power of two table
+    static const unsigned int BUCKETS = 1 << 12;
+    vector<unsigned int> counts(BUCKETS);
+    U33 pts(1, 0xfff00000);
+    for (unsigned int i = 0; i < BUCKETS * 16; ++i)
+    {
+        ++counts[UIntHash<33>::hash32(pts) & (BUCKETS - 1)];
+        pts += U33(0, 3003);
+    }
+    check(*max_element(counts.begin(), counts.end()) < 40, "spread");
+
+    // each input bit flips about half the output bits
+    unsigned int flipped(0);
+    for (unsigned int bit = 0; bit < 33; ++bit)
+    {
+        const U33 value(0, random32());
+        const U33 toggled = value ^ (U33(0, 1) << bit);
+        const unsigned int diff = UIntHash<33>::hash32(value) ^ UIntHash<33>::hash32(toggled);
+        for (unsigned int out = 0; out < 32; ++out)
+        {
+            flipped += (diff >> out) & 1;
+        }
+    }
+    check((flipped > 33 * 12) && (flipped < 33 * 20), "avalanche");
+
+    unordered_map<U33, int> standard;
+    standard[U33(1, 5)] = 3;
+    check(standard.count(U33(1, 5)) && !standard.count(U33(0, 5)), "unordered_map");
+}
+
+U33 randomKey(unsigned int domain)
+{
+    // a small domain forces long probe runs, the msb doubles it
+    return U33(random32() & 1, random32() % domain);
+}
+
+void checkMap(unsigned int domain, unsigned int operations)
+{
+    U33FlatMap<string> map;
+    unordered_map<U33, string> reference;
+
+    for (unsigned int i = 0; i < operations; ++i)
+    {
+        const U33 key = randomKey(domain);
+        const string value = to_string(random32());
+
+        switch (random32() % 4)
+        {
+        case 0:
+            check(map.insert(key, value) == reference.insert(make_pair(key, value)).second, "insert");
+            break;
+        case 1:
+            map[key] = value;
+            reference[key] = value;
+            break;
+        case 2:
+            check(map.erase(key) == (reference.erase(key) != 0), "erase");
+            break;
+        default:
+            {
+                const string* found = map.find(key);
+                const unordered_map<U33, string>::const_iterator expected = reference.find(key);
+                check((found != 0) == (expected != reference.end()), "find");
+                check(!found || (*found == expected->second), "find value");
+                check(map.contains(key) == (found != 0), "contains");
+            }
+            break;
+        }
+
+        check(map.size() == reference.size(), "size");
+    }
+
+    // every entry once, each matching the reference
+    size_t visited(0);
+    const U33FlatMap<string>& constMap = map;
+    for (U33FlatMap<string>::ConstIterator it = constMap.begin(); it != constMap.end(); ++it)
+    {
+        check(reference.at(it.key()) == it.value(), "iterate");
+        ++visited;
+    }
+    check(visited == reference.size(), "iterate count");
+
+    for (auto entry : map)
+    {
+        entry.second += "!";
+    }
+    for (const auto& expected : reference)
+    {
+        check(*map.find(expected.first) == expected.second + "!", "iterate write");
+    }
+
+    check(map.memoryBytes() == map.capacity() * (5 + sizeof(string)), "memory");
+    check(map.size() * 4 <= map.capacity() * 3, "load");
+
+    const size_t capacity = map.capacity();
+    map.clear();
+    check(map.empty() && (map.capacity() == capacity) && (map.begin() == map.end()), "clear");
+    check(!map.contains(reference.begin()->first), "cleared");
+}
+
+void checkSet()
+{
+    U33FlatSet set;
+    unordered_set<U33> reference;
+    check(set.empty() && (set.capacity() == 0) && (set.begin() == set.end()), "empty set");
+    check(!set.contains(U33()) && !set.erase(U33()), "empty lookup");
+
+    for (unsigned int i = 0; i < 200000; ++i)
+    {
+        const U33 key = randomKey(50000);
+        if (random32() % 3)
+        {
+            check(set.insert(key) == reference.insert(key).second, "set insert");
+        }
+        else
+        {
+            check(set.erase(key) == (reference.erase(key) != 0), "set erase");
+        }
+    }
+
+    check(set.size() == reference.size(), "set size");
+    check(set.memoryBytes() == set.capacity() * 5, "set memory");
+
+    vector<U33> keys(set.begin(), set.end());
+    vector<U33> expected(reference.begin(), reference.end());
+    sort(keys.begin(), keys.end());
+    sort(expected.begin(), expected.end());
+    check(keys == expected, "set iterate");
+
+    // erasing everything leaves no stray keys behind in the probe runs
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        check(set.erase(expected[i]), "drain");
+        check(!set.contains(expected[i]), "drained");
+    }
+    check(set.empty() && (set.begin() == set.end()), "drained set");
+}
+
+void checkReserve()
+{
+    U33FlatMap<unsigned int> map;
+    map.reserve(100000);
+
+    const size_t capacity = map.capacity();
+    check(capacity * 3 >= 100000 * 4, "reserve");
+
+    for (unsigned int i = 0; i < 100000; ++i)
+    {
+        map[U33(i & 1, i * 3003)] = i;
+    }
+    check(map.capacity() == capacity, "no rehash");
+
+    for (unsigned int i = 0; i < 100000; ++i)
+    {
+        check(*map.find(U33(i & 1, i * 3003)) == i, "reserved lookup");
+    }
+
+    map.reserve(10);
+    check(map.capacity() == capacity, "reserve never shrinks");
+}
+
+int main()
+{
+    checkHash();
+    checkMap(64, 20000);
+    checkMap(5000, 100000);
+    checkMap(0xffffffff, 100000);
+    checkSet();
+    checkReserve();
+
+    cout << "Sweet success!" << endl;
+    return 0;
+}
@@ -0,0 +1,261 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_u33interval.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "U33Interval.h"
+#include "U33Parallel.h"
+
+using namespace std;
+
+static unsigned int sState(0x2545f491);
+
+unsigned int random32()
+{
+    // xorshift
+    sState ^= sState << 13;
+    sState ^= sState >> 17;
+    sState ^= sState << 5;
+    return sState;
+}
+
+U33 random33()
+{
+    return U33(random32() & 1, random32());
+}
+
+void check(bool success, const char* what)
+{
+    if (!success)
+    {
+        cout << "FAILURE " << what << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
+static constexpr U33 TOP = ~U33();
+
+static constexpr U33Interval ACROSS(TOP - U33(0, 9), U33(0, 20));
+static_assert(ACROSS.getLength() == U33(0, 30) && ACROSS.isWrapped(), "wraps");
+static_assert(ACROSS.contains(U33()) && ACROSS.contains(TOP) && !ACROSS.contains(U33(0, 20)), "contains");
+static_assert(U33Interval(U33(0, 5), U33(0, 5)).isEmpty(), "empty");
+static_assert(!U33Interval(TOP - U33(0, 9), U33()).isWrapped(), "ends at the wrap");
+static_assert(!U33Interval(U33(), U33(0, 5)).isWrapped(), "starts at 0");
+static_assert(ACROSS.intersect(U33Interval(U33(0, 10), U33(0, 40))) == U33Interval(U33(0, 10), U33(0, 20)), "intersect");
+static_assert(ACROSS.unite(U33Interval(U33(0, 30), U33(0, 40))) == U33Interval(TOP - U33(0, 9), U33(0, 40)), "unite");
+
+// Returns a tick a little way from base, which is near 0 or the wrap
+U33 near(const U33& base)
+{
+    return base + U33(0, random32() % 48);
+}
+
+void checkOperations()
+{
+    // brute force every point in a window that covers both intervals
+    const U33 bases[] = { U33(), TOP - U33(0, 20), U33(0, 0x12345678) };
+    for (const U33& base : bases)
+    {
+        for (unsigned int round = 0; round < 2000; ++round)
+        {
+            const U33Interval a = U33Interval::fromLength(near(base), U33(0, random32() % 40));
+            const U33Interval b = U33Interval::fromLength(near(base), U33(0, random32() % 40));
+            const U33Interval both = a.intersect(b);
+            const U33Interval either = a.unite(b);
+
+            // the union is exact when the two meet or touch
+            const bool exact = a.isEmpty() || b.isEmpty() || (a.getEnd() == b.getStart()) ||
+                               (b.getEnd() == a.getStart()) || a.overlaps(b);
+
+            bool shared(false);
+            bool inside(true);
+            for (U33 point = base - U33(0, 8); point != base + U33(0, 100); point += U33(0, 1))
+            {
+                const bool inA = a.contains(point);
+                const bool inB = b.contains(point);
+                shared |= inA && inB;
+                inside &= !inB || inA;
+
+                check(both.contains(point) == (inA && inB), "intersect");
+                check(either.contains(point) == (inA || inB) || (!exact && !(inA || inB)), "unite");
+            }
+            check(a.overlaps(b) == shared, "overlaps");
+            check(b.overlaps(a) == shared, "overlaps reversed");
+            check(a.contains(b) == inside, "contains");
+            check(either.contains(a) && either.contains(b), "unite holds both");
+        }
+    }
+
+    // empty intervals meet nothing, even at their start
+    const U33Interval none(U33(0, 10), U33(0, 10));
+    const U33Interval some(U33(0, 5), U33(0, 15));
+    check(!none.overlaps(some) && !some.overlaps(none), "empty overlap");
+    check(some.intersect(none).isEmpty() && none.intersect(some).isEmpty(), "empty intersect");
+    check(some.contains(none) && !none.contains(U33(0, 10)), "empty contains");
+    check(some.unite(none) == some && none.unite(some) == some, "empty unite");
+
+    // two long arcs meet twice, from each start
+    const U33Interval first(U33(0, 100), TOP - U33(0, 99));
+    const U33Interval second(U33(1, 100), U33(1, 50));
+    check(first.intersect(second) == U33Interval(U33(1, 100), TOP - U33(0, 99)), "two pieces, other's start");
+    check(second.intersect(first) == U33Interval(U33(0, 100), U33(1, 50)), "two pieces, this start");
+    check(first.unite(second) == U33Interval::fromLength(U33(0, 100), TOP), "whole circle saturates");
+}
+
+// Returns the ids of intervals meeting query, sorted
+vector<size_t> scan(const vector<U33Interval>& intervals, const U33Interval& query)
+{
+    vector<size_t> ids;
+    for (size_t i = 0; i < intervals.size(); ++i)
+    {
+        if (intervals[i].overlaps(query))
+        {
+            ids.push_back(i);
+        }
+    }
+    return ids;
+}
+
+vector<size_t> sorted(vector<size_t> ids)
+{
+    sort(ids.begin(), ids.end());
+    return ids;
+}
+
+// Returns an interval that is short, long, near the wrap or anywhere
+U33Interval randomInterval()
+{
+    switch (random32() % 4)
+    {
+        case 0:  return U33Interval::fromLength(TOP - U33(0, random32() % 5000), U33(0, random32() % 10000));
+        case 1:  return U33Interval::fromLength(random33(), U33(0, random32() % 100000));
+        case 2:  return U33Interval::fromLength(U33(0, random32() % 5000), U33(0, random32() % 10000));
+        default: return U33Interval(random33(), random33());
+    }
+}
+
+void checkIndex()
+{
+    U33IntervalIndex index;
+    vector<size_t> ids;
+
+    index.stab(U33(), ids);
+    index.overlapping(ACROSS, ids);
+    check(index.empty() && ids.empty(), "empty index");
+
+    for (size_t count : { 1, 2, 3, 7, 16, 17, 100, 1000, 5000 })
+    {
+        vector<U33Interval> intervals(count);
+        for (U33Interval& interval : intervals)
+        {
+            interval = randomInterval();
+        }
+        intervals[0] = U33Interval();
+        index.build(intervals);
+        check(index.size() == count && index.getInterval(count - 1) == intervals[count - 1], "build");
+
+        vector<U33> points;
+        vector<U33Interval> queries;
+        for (unsigned int round = 0; round < 200; ++round)
+        {
+            const U33Interval query = randomInterval();
+            const U33 point = (round & 1) ? query.getStart() : random33();
+            points.push_back(point);
+            queries.push_back(query);
+
+            ids.clear();
+            index.stab(point, ids);
+            check(sorted(ids) == scan(intervals, U33Interval::fromLength(point, U33(0, 1))), "stab");
+
+            ids.clear();
+            index.overlapping(query, ids);
+            check(sorted(ids) == scan(intervals, query), "overlapping");
+        }
+
+        // batches match the single queries for any thread count
+        for (unsigned int threads : { 1, 3 })
+        {
+            U33Parallel::setThreads(threads);
+            U33Parallel::setChunkSize(7);
+
+            vector<size_t> offsets;
+            index.stab(points.data(), points.size(), ids, offsets);
+            check(offsets.size() == points.size() + 1 && offsets.back() == ids.size(), "stab offsets");
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                vector<size_t> one;
+                index.stab(points[i], one);
+                check(vector<size_t>(ids.begin() + offsets[i], ids.begin() + offsets[i + 1]) == one, "stab batch");
+            }
+
+            index.overlapping(queries.data(), queries.size(), ids, offsets);
+            check(offsets.size() == queries.size() + 1 && offsets.back() == ids.size(), "overlapping offsets");
+            for (size_t i = 0; i < queries.size(); ++i)
+            {
+                vector<size_t> one;
+                index.overlapping(queries[i], one);
+                check(vector<size_t>(ids.begin() + offsets[i], ids.begin() + offsets[i + 1]) == one,
+                      "overlapping batch");
+            }
+        }
+        U33Parallel::setThreads(0);
+        U33Parallel::setChunkSize(0);
+    }
+
+    // a long interval last in start order is found through the nodes past
+    // the end of the tree, for every tree shape
+    for (unsigned int count = 1; count <= 80; ++count)
+    {
+        vector<U33Interval> intervals;
+        for (unsigned int i = 0; i + 1 < count; ++i)
+        {
+            intervals.push_back(U33Interval::fromLength(U33(0, i * 10), U33(0, 5)));
+        }
+        intervals.push_back(U33Interval::fromLength(U33(0, count * 10), U33(0, 1000)));
+        index.build(intervals);
+
+        for (unsigned int point = 0; point < count * 10 + 1010; point += 3)
+        {
+            ids.clear();
+            index.stab(U33(0, point), ids);
+            check(sorted(ids) == scan(intervals, U33Interval::fromLength(U33(0, point), U33(0, 1))), "stab edge");
+        }
+    }
+
+    index.clear();
+    check(index.empty() && index.memoryBytes() == 0, "clear");
+}
+
+int main()
+{
+    checkOperations();
+    checkIndex();
+
+    cout << "Sweet success!" << endl;
+    return 0;
+}
@@ -0,0 +1,249 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_u33packedarray.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "U33Batch.h"
+#include "U33PackedArray.h"
+
+using namespace std;
+
+void check(bool success, const char* what)
+{
+    if (!success)
+    {
+        cout << "FAILURE " << what << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
+bool same(const U33PackedArray& packed, const vector<U33>& values)
+{
+    if (packed.size() != values.size())
+        return false;
+
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        if (packed[i] != values[i])
+            return false;
+    }
+
+    return std::equal(packed.begin(), packed.end(), values.begin());
+}
+
+vector<U33> makeValues(size_t count)
+{
+    vector<U33> values;
+    unsigned int state(0x2545f491);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        values.push_back(U33(state >> 31, state * 2654435761u));
+    }
+
+    return values;
+}
+
+void checkAppend()
+{
+    const vector<U33> values = makeValues(1000);
+
+    // single values, bulk from every alignment and the array constructor
+    U33PackedArray single;
+    for (size_t i = 0; i < values.size(); ++i)
+        single.push_back(values[i]);
+    check(same(single, values), "push_back");
+
+    for (size_t split = 0; split < 70; ++split)
+    {
+        U33PackedArray bulk;
+        bulk.append(values.data(), split);
+        bulk.append(values.data() + split, values.size() - split);
+        check(same(bulk, values), "append");
+    }
+
+    // lower words sharing bit 32, from every alignment
+    for (size_t split = 0; split < 70; ++split)
+    {
+        vector<unsigned int> words;
+        vector<U33> expected;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            words.push_back(values[i].getLsb32());
+            expected.push_back(U33((i < split) ? 0 : 1, values[i].getLsb32()));
+        }
+
+        U33PackedArray bulk;
+        bulk.appendWords(words.data(), split, false);
+        bulk.appendWords(words.data() + split, words.size() - split, true);
+        check(same(bulk, expected), "appendWords");
+    }
+
+    const U33PackedArray constructed(values.data(), values.size());
+    check(same(constructed, values), "constructor");
+    check(constructed.toVector() == values, "toVector");
+
+    vector<U33> part(100);
+    constructed.copyTo(33, part.size(), part.data());
+    check(std::equal(part.begin(), part.end(), values.begin() + 33), "copyTo");
+}
+
+void checkModify()
+{
+    vector<U33> values = makeValues(100);
+    U33PackedArray packed(values.data(), values.size());
+
+    for (size_t i = 0; i < values.size(); i += 3)
+    {
+        values[i] = U33(!values[i].getMsb(), ~values[i].getLsb32());
+        packed.set(i, values[i]);
+    }
+    check(same(packed, values), "set");
+
+    // shrinking must clear the unused plane bits for later pushes
+    packed.resize(40);
+    values.resize(40);
+    packed.push_back(U33(0, 7));
+    values.push_back(U33(0, 7));
+    check(same(packed, values), "resize down");
+
+    packed.resize(90, U33(1, 5));
+    values.resize(90, U33(1, 5));
+    check(same(packed, values), "resize up");
+
+    packed.assign(values.data(), 10);
+    check(packed.size() == 10 && packed[9] == values[9], "assign");
+
+    bool thrown(false);
+    try
+    {
+        packed.at(10);
+    }
+    catch (const std::out_of_range&)
+    {
+        thrown = true;
+    }
+    check(thrown, "at");
+
+    packed.clear();
+    check(packed.empty(), "clear");
+}
+
+void checkIterator()
+{
+    const vector<U33> values = makeValues(77);
+    const U33PackedArray packed(values.data(), values.size());
+
+    U33PackedArray::ConstIterator it = packed.begin();
+    check(*(it + 40) == values[40], "iterator +");
+    check(*(40 + it) == values[40], "iterator + reversed");
+    check((it + 5)->getLsb32() == values[5].getLsb32(), "iterator ->");
+    check(it[76] == values[76], "iterator []");
+    check((packed.end() - packed.begin()) == 77, "iterator distance");
+
+    it += 10;
+    --it;
+    check(*it++ == values[9] && *it == values[10], "iterator step");
+
+    size_t count(0);
+    for (U33PackedArray::ConstIterator i = packed.begin(); i != packed.end(); ++i)
+        ++count;
+    check(count == values.size(), "iterator loop");
+
+    vector<U33> visited;
+    packed.forEach([&visited](const U33& value) { visited.push_back(value); });
+    check(visited == values, "forEach");
+
+    vector<U33> words;
+    packed.forEachWord([&words](unsigned int msb, unsigned int lsb32) { words.push_back(U33(msb, lsb32)); });
+    check(words == values, "forEachWord");
+}
+
+void checkCount()
+{
+    const U33Batch::Isa best = U33Batch::getBestIsa();
+
+    // whole plane words, a partial word and limits on, between and either
+    // side of the values, with bit 32 clear and set
+    const size_t sizes[] = { 0, 5, 32, 77, 1000 };
+    for (int isa = U33Batch::ISA_SCALAR; isa <= best; ++isa)
+    {
+        U33Batch::setIsa(static_cast<U33Batch::Isa>(isa));
+
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+        {
+            const vector<U33> values = makeValues(sizes[s]);
+            const U33PackedArray packed(values.data(), values.size());
+
+            vector<U33> limits = { U33(), U33(0, 1), U33(0, 0x80000000), U33(1, 0), U33(1, 0x7fffffff), ~U33() };
+            for (size_t i = 0; i < values.size(); i += 7)
+            {
+                limits.push_back(values[i]);
+                limits.push_back(values[i] + U33(0, 1));
+            }
+
+            for (size_t l = 0; l < limits.size(); ++l)
+            {
+                const U33 limit = limits[l];
+                const size_t expected = std::count_if(values.begin(), values.end(),
+                                                      [&limit](const U33& value) { return value < limit; });
+
+                check(packed.countLess(limit) == expected, "countLess");
+                check(packed.countIf([&limit](unsigned int msb, unsigned int lsb32) { return U33(msb, lsb32) < limit; })
+                      == expected, "countIf");
+            }
+        }
+    }
+
+    U33Batch::setIsa(best);
+}
+
+void checkMemory()
+{
+    const vector<U33> values = makeValues(32000);
+    const U33PackedArray packed(values.data(), values.size());
+
+    // 4.125 bytes per value
+    check(packed.memoryBytes() == (32000 * 4 + 1000 * 4), "memory");
+}
+
+int main()
+{
+    checkAppend();
+    checkModify();
+    checkIterator();
+    checkCount();
+    checkMemory();
+
+    cout << "Sweet success!" << endl;
+
+    return 0;
+}
@@ -0,0 +1,234 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_u33parallel.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "U33Parallel.h"
+#include "U33Reduce.h"
+
+using namespace std;
+
+static unsigned int sState(0x9e3779b9);
+
+unsigned int random32()
+{
+    // xorshift
+    sState ^= sState << 13;
+    sState ^= sState >> 17;
+    sState ^= sState << 5;
+    return sState;
+}
+
+void check(bool success, const char* what, size_t count)
+{
+    if (!success)
+    {
+        cout << "FAILURE " << what << " (" << U33Parallel::getThreads() << " threads, "
+             << U33Parallel::getChunkSize() << " per chunk, count " << count << ")" << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
+// a mix of the transforms the library is used for
+U33 remap(const U33& value)
+{
+    const U33 shifted = value + U33(0, 90000);
+    const U33 limit(1, 0);
+    const U33 clamped = (shifted < limit) ? shifted : limit;
+
+    return (clamped * 300u).divideBy<1001>();
+}
+
+void checkCount(size_t count)
+{
+    vector<U33> values(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        values[i] = U33(random32() & 1, random32());
+    }
+
+    vector<U33> expected(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        expected[i] = remap(values[i]);
+    }
+
+    // out of place, then in place
+    vector<U33> out(count);
+    U33Parallel::transform(values.data(), out.data(), count, remap);
+    check(out == expected, "transform", count);
+
+    vector<U33> inPlace(values);
+    U33Parallel::transform(inPlace.data(), inPlace.data(), count, remap);
+    check(inPlace == expected, "transform in place", count);
+
+    inPlace = values;
+    U33Parallel::forEach(inPlace.data(), count, [](U33& value) { value = remap(value); });
+    check(inPlace == expected, "forEach", count);
+
+    // every index once, per chunk partial sums combined in order
+    vector<atomic<unsigned int> > visits(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        visits[i].store(0);
+    }
+
+    const size_t size   = U33Parallel::getChunkSize();
+    const size_t chunks = (count + size - 1) / size;
+    vector<U33> partial(chunks);
+
+    U33Parallel::forChunks(count, [&](size_t chunk, size_t begin, size_t end)
+    {
+        check((begin == chunk * size) && (end == min(count, begin + size)), "chunk bounds", count);
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            visits[i].fetch_add(1);
+            partial[chunk] += values[i];
+        }
+    });
+
+    U33 total;
+    for (size_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        total += partial[chunk];
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        check(visits[i].load() == 1, "visited once", count);
+    }
+
+    check(total == U33Reduce::sum(values.data(), count), "per chunk sum", count);
+}
+
+void checkUneven()
+{
+    // the cost grows with the index, so the later runs get stolen from
+    const size_t count = 1 << 14;
+    vector<U33> values(count);
+    vector<U33> out(count);
+    vector<U33> expected(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        values[i] = U33(0, static_cast<unsigned int>(i));
+
+        U33 value(values[i]);
+        for (size_t j = 0; j < i / 256; ++j)
+        {
+            value = (value * 3u) + 1;
+        }
+        expected[i] = value;
+    }
+
+    U33Parallel::forChunks(count, [&](size_t, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            U33 value(values[i]);
+            for (size_t j = 0; j < i / 256; ++j)
+            {
+                value = (value * 3u) + 1;
+            }
+            out[i] = value;
+        }
+    });
+
+    check(out == expected, "uneven work", count);
+}
+
+void checkErrors()
+{
+    const size_t count = 100000;
+    vector<U33> values(count);
+
+    bool thrown(false);
+    try
+    {
+        U33Parallel::forEach(values.data(), count, [](U33& value)
+        {
+            if (value == U33())
+            {
+                throw std::runtime_error("zero");
+            }
+        });
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+
+    check(thrown, "exception rethrown", count);
+
+    // nested calls run inline rather than waiting on the pool
+    vector<U33> out(count);
+    U33Parallel::forChunks(count, [&](size_t, size_t begin, size_t end)
+    {
+        U33Parallel::transform(values.data() + begin, out.data() + begin, end - begin,
+                               [](const U33& value) { return value + 1; });
+    });
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        check(out[i] == U33(0, 1), "nested call", count);
+    }
+}
+
+int main()
+{
+    const size_t counts[] = { 0, 1, 2, 100, 4095, 4096, 4097, 3 * 4096, 100000, (1 << 18) + 3 };
+    const unsigned int threads[] = { 1, 2, 3, 8 };
+    const size_t chunkSizes[] = { 0, 1, 1000 };
+
+    for (size_t s = 0; s < sizeof(chunkSizes) / sizeof(chunkSizes[0]); ++s)
+    {
+        U33Parallel::setChunkSize(chunkSizes[s]);
+
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t)
+        {
+            U33Parallel::setThreads(threads[t]);
+
+            for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+            {
+                // one value per chunk is slow enough without the big counts
+                if ((chunkSizes[s] != 1) || (counts[c] <= 100000))
+                {
+                    checkCount(counts[c]);
+                }
+            }
+
+            checkUneven();
+            checkErrors();
+        }
+    }
+
+    cout << "Sweet success!" << endl;
+
+    return 0;
+}
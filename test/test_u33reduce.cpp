@@ -0,0 +1,205 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_u33reduce.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "U33Batch.h"
+#include "U33Reduce.h"
+
+using namespace std;
+
+static unsigned int sState(0x9e3779b9);
+
+unsigned int random32()
+{
+    // xorshift
+    sState ^= sState << 13;
+    sState ^= sState >> 17;
+    sState ^= sState << 5;
+    return sState;
+}
+
+void check(bool success, const char* what, U33Batch::Isa isa, size_t count, const U33& got, const U33& expected)
+{
+    if (!success)
+    {
+        cout << "==============================================================" << endl;
+        cout << "FAILURE " << what << " (" << U33Batch::getIsaName(isa) << ", "
+             << U33Reduce::getThreads() << " threads)" << endl;
+        cout << "==============================================================" << endl;
+        cout << "count          : " << dec << count << endl;
+        cout << "got            : " << got << endl;
+        cout << "expected       : " << expected << endl;
+        cout << "==============================================================" << endl << endl;
+
+        throw std::logic_error("Test failure");
+    }
+}
+
+void checkScan(bool inclusive, const vector<U33>& values, const U33& init, U33Batch::Isa isa)
+{
+    const size_t count = values.size();
+    const char* what = inclusive ? "inclusiveScan" : "exclusiveScan";
+
+    vector<U33> expected(count);
+    U33 running(init);
+    for (size_t i = 0; i < count; ++i)
+    {
+        expected[i] = inclusive ? (running + values[i]) : running;
+        running += values[i];
+    }
+
+    // out of place, then in place
+    vector<U33> out(count);
+    vector<U33> inPlace(values);
+
+    if (inclusive)
+    {
+        U33Reduce::inclusiveScan(values.data(), out.data(), count, init);
+        U33Reduce::inclusiveScan(inPlace.data(), inPlace.data(), count, init);
+    }
+    else
+    {
+        U33Reduce::exclusiveScan(values.data(), out.data(), count, init);
+        U33Reduce::exclusiveScan(inPlace.data(), inPlace.data(), count, init);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        check(out[i] == expected[i], what, isa, i, out[i], expected[i]);
+        check(inPlace[i] == expected[i], what, isa, i, inPlace[i], expected[i]);
+    }
+}
+
+void checkValues(const vector<U33>& values, U33Batch::Isa isa)
+{
+    const size_t count = values.size();
+
+    // the sequential loops
+    U33 sum;
+    U33 min = count ? values[0] : U33();
+    U33 max = min;
+    U33 earliest = min;
+    U33 latest = min;
+    const U33 base = count ? (values[0] + U33(1, 0)) : U33();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        sum += values[i];
+        min = (values[i] < min) ? values[i] : min;
+        max = (max < values[i]) ? values[i] : max;
+        earliest = ((values[i] - base) < (earliest - base)) ? values[i] : earliest;
+        latest = ((latest - base) < (values[i] - base)) ? values[i] : latest;
+    }
+
+    const U33 gotSum = U33Reduce::sum(values.data(), count);
+    const U33 gotMin = U33Reduce::min(values.data(), count);
+    const U33 gotMax = U33Reduce::max(values.data(), count);
+    const U33 gotEarliest = U33Reduce::earliest(values.data(), count);
+    const U33 gotLatest = U33Reduce::latest(values.data(), count);
+
+    check(gotSum == sum, "sum", isa, count, gotSum, sum);
+    check(gotMin == min, "min", isa, count, gotMin, min);
+    check(gotMax == max, "max", isa, count, gotMax, max);
+    check(gotEarliest == earliest, "earliest", isa, count, gotEarliest, earliest);
+    check(gotLatest == latest, "latest", isa, count, gotLatest, latest);
+
+    checkScan(true, values, U33(), isa);
+    checkScan(false, values, U33(), isa);
+    checkScan(true, values, U33(1, 0xfffffff0), isa);
+    checkScan(false, values, U33(0, 12345), isa);
+}
+
+void checkIsa(U33Batch::Isa isa, size_t count)
+{
+    vector<U33> values(count);
+
+    // random values
+    for (size_t i = 0; i < count; ++i)
+    {
+        values[i] = U33(random32() & 1, random32());
+    }
+    checkValues(values, isa);
+
+    // all ones, the most carries out of every lsb16 lane
+    for (size_t i = 0; i < count; ++i)
+    {
+        values[i] = ~U33();
+    }
+    checkValues(values, isa);
+
+    // a timestamp series across the wrap with reordering
+    U33 pts(1, 0xffffffff - 90000);
+    for (size_t i = 0; i < count; ++i)
+    {
+        values[i] = pts + (((i % 3) == 1) ? 6006u : 0u);
+        pts += 3003u;
+    }
+    checkValues(values, isa);
+}
+
+void checkSeries()
+{
+    // earliest / latest follow the series across the wrap
+    const U33 series[] = { U33(1, 0xffffff00), U33(1, 0xfffffff0), U33(0, 0x10), U33(1, 0xfffffe00), U33(0, 0x100) };
+    const size_t count = sizeof(series) / sizeof(series[0]);
+
+    check(U33Reduce::earliest(series, count) == U33(1, 0xfffffe00), "earliest series", U33Batch::getIsa(),
+          count, U33Reduce::earliest(series, count), U33(1, 0xfffffe00));
+    check(U33Reduce::latest(series, count) == U33(0, 0x100), "latest series", U33Batch::getIsa(),
+          count, U33Reduce::latest(series, count), U33(0, 0x100));
+    check(U33Reduce::min(series, count) == U33(0, 0x10), "min series", U33Batch::getIsa(),
+          count, U33Reduce::min(series, count), U33(0, 0x10));
+}
+
+int main()
+{
+    const U33Batch::Isa best = U33Batch::getBestIsa();
+    const size_t counts[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 63, 1000, (3 << 16) + 7 };
+    const unsigned int threads[] = { 1, 3 };
+
+    for (int isa = U33Batch::ISA_SCALAR; isa <= best; ++isa)
+    {
+        U33Batch::setIsa(static_cast<U33Batch::Isa>(isa));
+
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t)
+        {
+            U33Reduce::setThreads(threads[t]);
+
+            for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+            {
+                checkIsa(static_cast<U33Batch::Isa>(isa), counts[c]);
+            }
+        }
+
+        checkSeries();
+    }
+
+    cout << "Sweet success!" << endl;
+
+    return 0;
+}
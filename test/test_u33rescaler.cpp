@@ -0,0 +1,237 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_u33rescaler.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "U33Rescaler.h"
+
+using namespace std;
+
+typedef U33Rescaler::Extended Extended;
+
+static unsigned int sState(0x2545f491);
+
+unsigned int random32()
+{
+    // xorshift
+    sState ^= sState << 13;
+    sState ^= sState >> 17;
+    sState ^= sState << 5;
+    return sState;
+}
+
+void check(bool success, const char* what, unsigned int num, unsigned int den)
+{
+    if (!success)
+    {
+        cout << "FAILURE " << what << " (" << num << " / " << den << ")" << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
+// 90 kHz to 27 MHz is exact, NTSC frames are 3003 ticks
+static constexpr U33Rescaler TO_27MHZ = U33Rescaler::fromRates(90000, 1, 27000000, 1);
+static constexpr U33Rescaler TO_FRAMES = U33Rescaler::fromRates(90000, 1, 30000, 1001, U33Rescaler::ROUND_DOWN);
+
+static_assert(TO_27MHZ.getNumerator() == 300 && TO_27MHZ.getDenominator() == 1, "reduced");
+static_assert(TO_27MHZ.rescale(90000_u33) == Extended(0, 27000000), "one second");
+static_assert(TO_27MHZ.rescale(0x1'ffff'ffff_u33) == Extended(0x257, 0xfffffed4), "whole range");
+static_assert(TO_FRAMES.getNumerator() == 1 && TO_FRAMES.getDenominator() == 3003, "reduced");
+static_assert(TO_FRAMES.rescale(U33(0, 3003 * 1000 - 1)) == Extended(0, 999), "rounded down");
+
+typedef unsigned long long u64;
+
+/// ticks * num / den, rounded, by schoolbook long multiplication and
+/// division on 32 bit words; false if the result does not fit 64 bits
+bool reference(const Extended& ticks, unsigned int num, unsigned int den, U33Rescaler::Rounding rounding,
+               Extended& result)
+{
+    // the 96 bit product, most significant word first
+    const u64 low  = static_cast<u64>(ticks.getLsb32()) * num;
+    const u64 high = static_cast<u64>(ticks.getUpper()) * num + (low >> 32);
+    const unsigned int product[3] = { static_cast<unsigned int>(high >> 32), static_cast<unsigned int>(high),
+                                      static_cast<unsigned int>(low) };
+
+    unsigned int quotient[3] = { 0, 0, 0 };
+    u64 remainder(0);
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        const u64 part = (remainder << 32) | product[i];
+        quotient[i] = static_cast<unsigned int>(part / den);
+        remainder   = part % den;
+    }
+
+    bool up(false);
+    switch (rounding)
+    {
+    case U33Rescaler::ROUND_DOWN:
+        break;
+    case U33Rescaler::ROUND_UP:
+        up = (remainder != 0);
+        break;
+    case U33Rescaler::ROUND_NEAREST:
+        up = (2 * remainder >= den);
+        break;
+    case U33Rescaler::ROUND_NEAREST_EVEN:
+        up = (2 * remainder > den) || ((2 * remainder == den) && (quotient[2] & 1));
+        break;
+    }
+
+    const u64 rounded = ((static_cast<u64>(quotient[1]) << 32) | quotient[2]) + (up ? 1 : 0);
+    result = Extended(static_cast<unsigned int>(rounded >> 32), static_cast<unsigned int>(rounded));
+    return (quotient[0] == 0) && !(up && (rounded == 0));
+}
+
+void checkRatio(unsigned int num, unsigned int den)
+{
+    static const U33Rescaler::Rounding ROUNDINGS[4] = { U33Rescaler::ROUND_DOWN, U33Rescaler::ROUND_UP,
+                                                        U33Rescaler::ROUND_NEAREST, U33Rescaler::ROUND_NEAREST_EVEN };
+
+    // the edges of each word, then random values
+    vector<U33> ticks;
+    vector<Extended> times;
+    const unsigned int edges[5] = { 0, 1, 2, 0x7fffffff, 0xffffffff };
+    for (unsigned int i = 0; i < 5; ++i)
+    {
+        for (unsigned int j = 0; j < 5; ++j)
+        {
+            ticks.push_back(U33(edges[i] & 1, edges[j]));
+            times.push_back(Extended(edges[i], edges[j]));
+        }
+    }
+    for (unsigned int i = 0; i < 500; ++i)
+    {
+        ticks.push_back(U33(random32() & 1, random32()));
+        times.push_back(Extended(random32() >> (random32() % 32), random32()));
+
+        // just either side of a multiple of den
+        const unsigned int near = random32() % 3;
+        ticks.push_back(U33(0, den) * U33(0, random32() % 1000) + U33(0, near) - U33(0, 1));
+    }
+
+    for (unsigned int r = 0; r < 4; ++r)
+    {
+        const U33Rescaler rescaler(num, den, ROUNDINGS[r]);
+
+        vector<Extended> batch(ticks.size());
+        rescaler.rescale(ticks.data(), batch.data(), ticks.size());
+        for (size_t i = 0; i < ticks.size(); ++i)
+        {
+            // only where the result fits 64 bits
+            Extended expected;
+            if (reference(Extended(ticks[i].getUpper(), ticks[i].getLsb32()), num, den, ROUNDINGS[r], expected))
+            {
+                check(rescaler.rescale(ticks[i]) == expected, "U33", num, den);
+                check(batch[i] == rescaler.rescale(ticks[i]), "U33 batch", num, den);
+            }
+        }
+
+        vector<Extended> timeBatch(times.size());
+        rescaler.rescale(times.data(), timeBatch.data(), times.size());
+        for (size_t i = 0; i < times.size(); ++i)
+        {
+            Extended expected;
+            if (reference(times[i], num, den, ROUNDINGS[r], expected))
+            {
+                check(rescaler.rescale(times[i]) == expected, "Extended", num, den);
+                check(timeBatch[i] == rescaler.rescale(times[i]), "Extended batch", num, den);
+            }
+        }
+    }
+}
+
+void checkExact()
+{
+    // the clocks in use, both ways
+    const unsigned int rates[][2] = { { 90000, 1 }, { 27000000, 1 }, { 48000, 1 }, { 44100, 1 },
+                                      { 30000, 1001 }, { 24000, 1001 }, { 60000, 1001 }, { 25, 1 } };
+    const unsigned int count = sizeof(rates) / sizeof(rates[0]);
+
+    for (unsigned int from = 0; from < count; ++from)
+    {
+        for (unsigned int to = 0; to < count; ++to)
+        {
+            const U33Rescaler rescaler = U33Rescaler::fromRates(rates[from][0], rates[from][1], rates[to][0], rates[to][1]);
+            checkRatio(rescaler.getNumerator(), rescaler.getDenominator());
+        }
+    }
+
+    // awkward factors, including a denominator of all ones
+    checkRatio(0, 7);
+    checkRatio(1, 1);
+    checkRatio(0xffffffff, 1);
+    checkRatio(1, 0xffffffff);
+    checkRatio(0xfffffffe, 0xffffffff);
+    checkRatio(0x80000001, 0x80000000);
+    for (unsigned int i = 0; i < 20; ++i)
+    {
+        checkRatio(random32(), random32() | 1);
+        checkRatio(random32() >> (random32() % 32), (random32() >> (random32() % 32)) | 1);
+    }
+}
+
+void checkErrors()
+{
+    bool thrown(false);
+    try
+    {
+        U33Rescaler(1, 0);
+    }
+    catch (const std::invalid_argument&)
+    {
+        thrown = true;
+    }
+    check(thrown, "zero denominator", 1, 0);
+
+    thrown = false;
+    try
+    {
+        U33Rescaler::fromRates(0x10001, 1, 1, 0x10000);
+    }
+    catch (const std::invalid_argument&)
+    {
+        thrown = true;
+    }
+    check(thrown, "overflow", 1, 0);
+
+    // 44.1 kHz samples of a 90 kHz second, either side of the half
+    const U33Rescaler nearest = U33Rescaler::fromRates(90000, 1, 44100, 1);
+    check(nearest.getNumerator() == 49 && nearest.getDenominator() == 100, "44.1", 49, 100);
+    check(nearest.rescale(U33(0, 90000)) == Extended(0, 44100), "44.1 second", 49, 100);
+    check(U33Rescaler(1, 2, U33Rescaler::ROUND_NEAREST).rescale(U33(0, 5)) == Extended(0, 3), "half up", 1, 2);
+    check(U33Rescaler(1, 2, U33Rescaler::ROUND_NEAREST_EVEN).rescale(U33(0, 5)) == Extended(0, 2), "half even", 1, 2);
+    check(U33Rescaler(1, 2, U33Rescaler::ROUND_NEAREST_EVEN).rescale(U33(0, 7)) == Extended(0, 4), "half even up", 1, 2);
+}
+
+int main()
+{
+    checkErrors();
+    checkExact();
+
+    cout << "Sweet success!" << endl;
+    return 0;
+}
@@ -0,0 +1,293 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_u33seekindex.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "U33SeekIndex.h"
+
+using namespace std;
+
+typedef U33SeekIndex::Extended Extended;
+typedef U33SeekIndex::Offset Offset;
+
+static unsigned int sState(0x2545f491);
+
+unsigned int random32()
+{
+    // xorshift
+    sState ^= sState << 13;
+    sState ^= sState >> 17;
+    sState ^= sState << 5;
+    return sState;
+}
+
+void check(bool success, const char* what, size_t count)
+{
+    if (!success)
+    {
+        cout << "FAILURE " << what << " (" << count << " entries)" << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
+bool byTime(const pair<Extended, Offset>& lhs, const pair<Extended, Offset>& rhs)
+{
+    return (lhs.first < rhs.first);
+}
+
+/// The unwrapped entries an index should hold, stably sorted by time
+vector<pair<Extended, Offset> > expectedEntries(const vector<U33>& pts, const vector<Offset>& offsets)
+{
+    vector<pair<Extended, Offset> > entries;
+    U33Unwrapper unwrapper;
+    for (size_t i = 0; i < pts.size(); ++i)
+    {
+        entries.push_back(make_pair(unwrapper.unwrap(pts[i]), offsets[i]));
+    }
+
+    stable_sort(entries.begin(), entries.end(), byTime);
+    return entries;
+}
+
+size_t expectedFind(const vector<Extended>& times, const Extended& time)
+{
+    const size_t upper = upper_bound(times.begin(), times.end(), time) - times.begin();
+    return (upper != 0) ? (upper - 1) : U33SeekIndex::NPOS;
+}
+
+void checkIndex(const U33SeekIndex& index, const vector<U33>& pts, const vector<Offset>& offsets)
+{
+    const vector<pair<Extended, Offset> > entries = expectedEntries(pts, offsets);
+    const size_t count = pts.size();
+    check(index.size() == count, "size", count);
+
+    vector<Extended> times;
+    for (size_t i = 0; i < count; ++i)
+    {
+        times.push_back(entries[i].first);
+    }
+
+    // every entry, either side of it, and past both ends
+    vector<Extended> queries;
+    for (size_t i = 0; i < count; ++i)
+    {
+        check(index.getTime(i) == times[i], "getTime", count);
+        check(index.getOffset(i) == entries[i].second, "getOffset", count);
+        check(index.getPts(i) == U33(times[i].getMsb32() & 1, times[i].getLsb32()), "getPts", count);
+
+        queries.push_back(times[i] - Extended(0, 1));
+        queries.push_back(times[i]);
+        queries.push_back(times[i] + Extended(0, 1));
+    }
+    queries.push_back(Extended());
+    queries.push_back(Extended(~0u, ~0u));
+
+    vector<size_t> batch(queries.size());
+    index.find(queries.data(), queries.size(), batch.data());
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        const size_t expected = expectedFind(times, queries[i]);
+        check(index.find(queries[i]) == expected, "find time", count);
+        check(batch[i] == expected, "batch find time", count);
+    }
+
+    // seeking to each entry's own PTS lands on the last entry with that time
+    for (size_t i = 0; i < count; ++i)
+    {
+        Offset offset;
+        check(index.seek(pts[i], offset), "seek", count);
+        check(offset == entries[expectedFind(times, times[0] + Extended(0, (pts[i] - pts[0]).getLsb32()))].second, "seek offset", count);
+    }
+
+    // PTS lookups agree with time lookups inside the 2^32 ticks after the start
+    vector<U33> ptsQueries;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        ptsQueries.push_back(U33(random32() & 1, random32()));
+    }
+    vector<size_t> ptsBatch(ptsQueries.size());
+    index.find(ptsQueries.data(), ptsQueries.size(), ptsBatch.data());
+    for (size_t i = 0; i < ptsQueries.size(); ++i)
+    {
+        size_t expected = U33SeekIndex::NPOS;
+        if (count != 0)
+        {
+            const U33 step = ptsQueries[i] - index.getPts(0);
+            expected = step.getMsb() ? U33SeekIndex::NPOS : expectedFind(times, times[0] + Extended(0, step.getLsb32()));
+        }
+
+        check(index.find(ptsQueries[i]) == expected, "find pts", count);
+        check(ptsBatch[i] == expected, "batch find pts", count);
+    }
+}
+
+void checkEmpty()
+{
+    U33SeekIndex index;
+    check(index.empty() && !index.isMapped(), "empty", 0);
+    check(index.find(Extended(0, 5)) == U33SeekIndex::NPOS, "empty find", 0);
+    check(index.find(U33(0, 5)) == U33SeekIndex::NPOS, "empty find pts", 0);
+
+    Offset offset;
+    check(!index.seek(U33(0, 5), offset), "empty seek", 0);
+    checkIndex(index, vector<U33>(), vector<Offset>());
+}
+
+void checkShapes()
+{
+    // every tree shape up to a few full levels, with runs of equal times
+    for (size_t count = 1; count <= 70; ++count)
+    {
+        vector<U33> pts;
+        vector<Offset> offsets;
+        for (size_t i = 0; i < count; ++i)
+        {
+            pts.push_back(U33(0, 1000 + static_cast<unsigned int>((i / 3) * 10)));
+            offsets.push_back(Offset(0, static_cast<unsigned int>(i * 188)));
+        }
+
+        U33SeekIndex index;
+        index.build(pts, offsets);
+        checkIndex(index, pts, offsets);
+
+        // equal times keep recording order, so the last of a run is found
+        const size_t last = index.find(U33(0, 1000));
+        check(index.getOffset(last) == Offset(0, static_cast<unsigned int>(min<size_t>(count, 3) - 1) * 188), "ties", count);
+    }
+}
+
+void makeRecording(size_t count, vector<U33>& pts, vector<Offset>& offsets)
+{
+    // 29.97 Hz frames from a minute before the wrap, B frames reordered
+    // (I0 P3 B1 B2), with offsets running past 4 GB
+    static const unsigned int ORDER[4] = { 0, 3, 1, 2 };
+    const U33 start = U33(1, 0xffffffff) - U33(0, 90000 * 60);
+
+    pts.clear();
+    offsets.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t frame = ((i / 4) * 4) + ORDER[i % 4];
+        pts.push_back(start + U33(0, static_cast<unsigned int>(frame * 3003)));
+        offsets.push_back(Offset(static_cast<unsigned int>(i >> 12), static_cast<unsigned int>(i << 20)));
+    }
+}
+
+void checkWrap()
+{
+    vector<U33> pts;
+    vector<Offset> offsets;
+    makeRecording(20000, pts, offsets);
+
+    U33SeekIndex index;
+    index.build(pts, offsets);
+    checkIndex(index, pts, offsets);
+
+    // either side of the wrap
+    Offset offset;
+    check(index.seek(U33(1, 0xffffffff), offset), "seek before wrap", 0);
+    check(index.getPts(index.find(U33(1, 0xffffffff))) < U33(1, 0xffffffff), "before wrap", 0);
+    check(index.seek(U33(0, 100000), offset), "seek after wrap", 0);
+    check(index.getPts(index.find(U33(0, 100000))) <= U33(0, 100000), "after wrap", 0);
+
+    // before the first entry there is nothing to seek to
+    check(!index.seek(pts[0] - U33(0, 1), offset), "before start", 0);
+    check(index.seek(pts[0], offset) && (offset == Offset()), "at start", 0);
+
+    // a recording several wraps long looks up unwrapped times
+    vector<U33> longPts;
+    vector<Offset> longOffsets;
+    for (unsigned int i = 0; i < 4000; ++i)
+    {
+        longPts.push_back(U33(0, i * 0x00800000u) + U33(0, i * 0x00800000u));
+        longOffsets.push_back(Offset(0, i));
+    }
+    index.build(longPts, longOffsets);
+    check(index.getTime(3999) == Extended(0, 3999) * Extended(0, 0x01000000), "long end", 0);
+    check(index.find(Extended(0, 2500) * Extended(0, 0x01000000)) == 2500, "long find", 0);
+}
+
+void checkFiles()
+{
+    vector<U33> pts;
+    vector<Offset> offsets;
+    makeRecording(5000, pts, offsets);
+
+    U33SeekIndex built;
+    built.build(pts, offsets);
+    check(built.save("test_u33seekindex.idx"), "save", 0);
+
+    U33SeekIndex loaded;
+    check(loaded.load("test_u33seekindex.idx"), "load", 0);
+    check(loaded.memoryBytes() == built.memoryBytes(), "loaded size", 0);
+    checkIndex(loaded, pts, offsets);
+
+    // a bad file leaves the loaded entries alone
+    check(!loaded.load("test_u33seekindex.missing"), "load missing", 0);
+    {
+        ofstream file("test_u33seekindex.bad", ios::binary);
+        file << "not an index";
+    }
+    check(!loaded.load("test_u33seekindex.bad"), "load bad", 0);
+    check(loaded.size() == pts.size(), "kept", 0);
+
+    // a rebuild replaces the mapping
+    loaded.build(pts.data(), offsets.data(), 100);
+    check(!loaded.isMapped() && (loaded.size() == 100), "rebuilt", 0);
+
+    U33SeekIndex empty;
+    check(empty.save("test_u33seekindex.idx") && loaded.load("test_u33seekindex.idx"), "empty file", 0);
+    check(loaded.empty(), "empty loaded", 0);
+
+    std::remove("test_u33seekindex.idx");
+    std::remove("test_u33seekindex.bad");
+
+    bool thrown(false);
+    try
+    {
+        built.build(pts, vector<Offset>(1));
+    }
+    catch (const std::invalid_argument&)
+    {
+        thrown = true;
+    }
+    check(thrown && (built.size() == pts.size()), "size mismatch", 0);
+}
+
+int main()
+{
+    checkEmpty();
+    checkShapes();
+    checkWrap();
+    checkFiles();
+
+    cout << "Sweet success!" << endl;
+    return 0;
+}
@@ -0,0 +1,145 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_u33sort.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "U33Sort.h"
+
+using namespace std;
+
+static unsigned int sState(0x2545f491);
+
+unsigned int random32()
+{
+    // xorshift
+    sState ^= sState << 13;
+    sState ^= sState >> 17;
+    sState ^= sState << 5;
+    return sState;
+}
+
+void check(bool success, const char* what, size_t count, unsigned int threads)
+{
+    if (!success)
+    {
+        cout << "FAILURE " << what << " (" << count << " keys, " << threads << " threads)" << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
+bool byKey(const pair<U33, unsigned int>& lhs, const pair<U33, unsigned int>& rhs)
+{
+    return (lhs.first < rhs.first);
+}
+
+void checkKeys(const vector<U33>& keys, unsigned int threads)
+{
+    vector<U33> expected(keys);
+    std::sort(expected.begin(), expected.end());
+
+    vector<U33> sorted(keys);
+    U33Sort::sort(sorted, threads);
+    check(sorted == expected, "vector", keys.size(), threads);
+
+    U33PackedArray packed(keys.data(), keys.size());
+    U33Sort::sort(packed, threads);
+    check(packed.toVector() == expected, "packed", keys.size(), threads);
+
+    // payloads are the original positions, so stability shows
+    vector<pair<U33, unsigned int> > pairs;
+    vector<unsigned int> payloads;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        pairs.push_back(make_pair(keys[i], static_cast<unsigned int>(i)));
+        payloads.push_back(static_cast<unsigned int>(i));
+    }
+    std::stable_sort(pairs.begin(), pairs.end(), byKey);
+
+    vector<U33> pairKeys(keys);
+    U33Sort::sort(pairKeys, payloads, threads);
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        check((pairKeys[i] == pairs[i].first) && (payloads[i] == pairs[i].second), "pairs", keys.size(), threads);
+    }
+}
+
+void checkCount(size_t count, unsigned int threads)
+{
+    vector<U33> keys(count);
+
+    // random keys
+    for (size_t i = 0; i < count; ++i)
+        keys[i] = U33(random32() & 1, random32());
+    checkKeys(keys, threads);
+
+    // few distinct keys, many ties
+    for (size_t i = 0; i < count; ++i)
+        keys[i] = U33(random32() & 1, random32() % 5);
+    checkKeys(keys, threads);
+
+    // only the top digit differs, the lower passes are skipped
+    for (size_t i = 0; i < count; ++i)
+        keys[i] = U33(random32() & 1, random32() & 0xffc00000);
+    checkKeys(keys, threads);
+
+    // a timestamp series across the wrap, already nearly sorted
+    U33 pts(1, 0xffffffff - 90000);
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys[i] = pts + (((i % 3) == 1) ? 6006u : 0u);
+        pts += 3003u;
+    }
+    checkKeys(keys, threads);
+
+    // descending, and all equal
+    for (size_t i = 0; i < count; ++i)
+        keys[i] = U33(1, 0xffffffff) - static_cast<unsigned int>(i);
+    checkKeys(keys, threads);
+
+    std::fill(keys.begin(), keys.end(), U33(1, 0x12345678));
+    checkKeys(keys, threads);
+}
+
+int main()
+{
+    const size_t counts[] = { 0, 1, 2, 63, 64, 65, 1000, 4097, (3 << 16) + 11 };
+    const unsigned int threads[] = { 1, 3 };
+
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t)
+    {
+        for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+        {
+            checkCount(counts[c], threads[t]);
+        }
+    }
+
+    cout << "Sweet success!" << endl;
+
+    return 0;
+}
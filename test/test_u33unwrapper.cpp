@@ -0,0 +1,237 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_u33unwrapper.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "U33Unwrapper.h"
+
+using namespace std;
+
+typedef unsigned long long u64;
+
+static const u64 RANGE = 1ull << 33;
+
+void check(bool success, const char* what)
+{
+    if (!success)
+    {
+        cout << "FAILURE " << what << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
+u64 toU64(const U33Unwrapper::Extended& value)
+{
+    return (static_cast<u64>(value.getMsb32()) << 32) | value.getLsb32();
+}
+
+U33 toU33(u64 value)
+{
+    return U33(static_cast<unsigned int>(value >> 32) & 1, static_cast<unsigned int>(value));
+}
+
+/// A 90 kHz PTS stream starting just before a wrap, with B frame reordering
+/// and a forward and backward jump part way through
+vector<u64> makeTimeline(size_t count)
+{
+    vector<u64> timeline;
+    unsigned int state(0x9e3779b9);
+    u64 pts = RANGE - 3003 * 50;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        if (i == count / 3)
+            pts += RANGE / 2 - 1;           // half a wrap forwards
+        else if (i == (2 * count) / 3)
+            pts -= 90000 * 60;              // a minute backwards
+        else
+            pts += 3003;
+
+        // every third frame is presented before its predecessor
+        timeline.push_back((i % 3 == 2) ? pts - 6006 - (state % 100) : pts);
+    }
+
+    return timeline;
+}
+
+void checkStream()
+{
+    const vector<u64> timeline = makeTimeline(30000);
+    const U33 maxStep(0, 90000 * 10);
+
+    U33Unwrapper unwrapper(maxStep);
+    check(!unwrapper.isStarted(), "not started");
+
+    size_t wraps(0), backward(0), jumps(0);
+
+    for (size_t i = 0; i < timeline.size(); ++i)
+    {
+        unsigned int flags(0);
+        const u64 extended = toU64(unwrapper.unwrap(toU33(timeline[i]), flags));
+
+        // the first sample anchors epoch 0
+        const u64 expected = timeline[i] - (timeline[0] / RANGE) * RANGE;
+        if (extended != expected)
+        {
+            cout << i << " " << extended << " != " << expected << endl;
+            check(false, "extended value");
+        }
+
+        check(((flags & U33Unwrapper::FLAG_FIRST) != 0) == (i == 0), "first flag");
+
+        if (i > 0)
+        {
+            const bool back = timeline[i] < timeline[i - 1];
+            const u64 distance = back ? timeline[i - 1] - timeline[i] : timeline[i] - timeline[i - 1];
+            const bool wrap = (timeline[i] / RANGE) != (timeline[i - 1] / RANGE);
+
+            check(((flags & U33Unwrapper::FLAG_BACKWARD) != 0) == back, "backward flag");
+            check(((flags & U33Unwrapper::FLAG_WRAP) != 0) == wrap, "wrap flag");
+            check(((flags & U33Unwrapper::FLAG_DISCONTINUITY) != 0) == (distance > 90000 * 10), "discontinuity flag");
+
+            wraps += wrap ? 1 : 0;
+            backward += back ? 1 : 0;
+            jumps += (distance > 90000 * 10) ? 1 : 0;
+        }
+
+        check(toU64(unwrapper.getExtended()) == expected, "getExtended");
+        check(unwrapper.getLast() == toU33(timeline[i]), "getLast");
+    }
+
+    // the stream really covers the interesting cases
+    check(wraps >= 3 && backward >= timeline.size() / 3 && jumps == 2, "coverage");
+
+    unwrapper.reset();
+    check(!unwrapper.isStarted() && unwrapper.getEpoch() == 0, "reset");
+    check(toU64(unwrapper.unwrap(U33(1, 5))) == RANGE / 2 + 5, "restart");
+    check(unwrapper.getMaxStep() == maxStep, "getMaxStep");
+}
+
+void checkEdges()
+{
+    U33Unwrapper unwrapper;
+
+    // just under half the range is followed forwards
+    check(toU64(unwrapper.unwrap(U33(0, 0))) == 0, "zero");
+    check(toU64(unwrapper.unwrap(U33(0, 0xffffffff))) == RANGE / 2 - 1, "half forwards");
+    check(toU64(unwrapper.unwrap(U33(1, 0xfffffffe))) == RANGE - 2, "half again");
+
+    // crossing the wrap forwards
+    unsigned int flags(0);
+    check(toU64(unwrapper.unwrap(U33(0, 1), flags)) == RANGE + 1, "wrap forwards");
+    check(flags == U33Unwrapper::FLAG_WRAP && unwrapper.getEpoch() == 1, "wrap forwards flags");
+
+    // and back again
+    check(toU64(unwrapper.unwrap(U33(1, 0xffffffff), flags)) == RANGE - 1, "wrap backwards");
+    check(flags == (U33Unwrapper::FLAG_WRAP | U33Unwrapper::FLAG_BACKWARD), "wrap backwards flags");
+    check(unwrapper.getEpoch() == 0, "epoch back to 0");
+
+    // a step of exactly half the range counts as backwards, and the default
+    // maximum step never reports a discontinuity
+    check(toU64(unwrapper.unwrap(U33(0, 0xffffffff), flags)) == RANGE / 2 - 1, "half backwards");
+    check(flags == U33Unwrapper::FLAG_BACKWARD, "half backwards flags");
+
+    // a reordered frame before the first one, across the wrap, is clamped
+    // to 0 rather than placed 2^64 - 2003 ticks on
+    U33Unwrapper early;
+    early.unwrap(U33(0, 1000));
+    check(toU64(early.unwrap(U33(0, 1000) - U33(0, 3003), flags)) == 0, "before the start");
+    check(flags == (U33Unwrapper::FLAG_WRAP | U33Unwrapper::FLAG_BACKWARD | U33Unwrapper::FLAG_CLAMPED),
+          "before the start flags");
+    check(toU64(early.getExtended()) == 0 && early.getEpoch() == 0xffffffff, "before the start state");
+    check(toU64(early.unwrap(U33(0, 4003), flags)) == 4003 && flags == U33Unwrapper::FLAG_WRAP, "back after the start");
+
+    // the batch path clamps the same samples
+    const U33 samples[] = { U33(0, 1000), U33(1, 0xfffffc11), U33(0, 4003), U33(1, 0xfffffff0), U33(0, 0) };
+    U33Unwrapper::Extended out[5];
+    unsigned char batchFlags[5];
+    U33Unwrapper batch;
+    batch.unwrap(samples, 5, out, batchFlags);
+    check(toU64(out[0]) == 1000 && toU64(out[1]) == 0 && toU64(out[2]) == 4003, "batch clamp");
+    check(toU64(out[3]) == 0 && toU64(out[4]) == 0, "batch clamp again");
+    check((batchFlags[1] & U33Unwrapper::FLAG_CLAMPED) && !(batchFlags[2] & U33Unwrapper::FLAG_CLAMPED) &&
+          (batchFlags[3] & U33Unwrapper::FLAG_CLAMPED) && !(batchFlags[4] & U33Unwrapper::FLAG_CLAMPED), "batch clamp flags");
+}
+
+void checkBatch()
+{
+    const vector<u64> timeline = makeTimeline(5000);
+    const U33 maxStep(0, 90000 * 10);
+
+    vector<U33> values;
+    for (size_t i = 0; i < timeline.size(); ++i)
+        values.push_back(toU33(timeline[i]));
+
+    U33Unwrapper single(maxStep);
+    vector<U33Unwrapper::Extended> expected(values.size());
+    vector<unsigned char> expectedFlags(values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        unsigned int flags(0);
+        expected[i] = single.unwrap(values[i], flags);
+        expectedFlags[i] = static_cast<unsigned char>(flags);
+    }
+
+    // the same stream split into batches of many sizes
+    const size_t sizes[] = {1, 2, 7, 255, 256, 257, 1000, 5000};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        U33Unwrapper batch(maxStep);
+        vector<U33Unwrapper::Extended> out(values.size());
+        vector<unsigned char> flags(values.size());
+
+        for (size_t first = 0; first < values.size(); first += sizes[s])
+        {
+            const size_t count = min(sizes[s], values.size() - first);
+            batch.unwrap(&values[first], count, &out[first], (s % 2) ? &flags[first] : 0);
+        }
+
+        check(out == expected, "batch values");
+        check((s % 2) == 0 || flags == expectedFlags, "batch flags");
+        check(batch.getExtended() == single.getExtended(), "batch state");
+    }
+
+    // an empty batch changes nothing
+    U33Unwrapper empty;
+    empty.unwrap(values.data(), 0, 0, 0);
+    check(!empty.isStarted(), "empty batch");
+}
+
+int main()
+{
+    checkStream();
+    checkEdges();
+    checkBatch();
+
+    cout << "Sweet success!" << endl;
+
+    return 0;
+}
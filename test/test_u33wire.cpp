@@ -0,0 +1,240 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_u33wire.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "U33Wire.h"
+
+typedef unsigned long long U64;
+
+using namespace std;
+
+void check(bool success, const char* what, U64 value)
+{
+    if (!success)
+    {
+        cout << "FAILURE " << what << " 0x" << hex << value << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
+U33 convert(U64 ref)
+{
+    return U33(static_cast<unsigned int>(ref >> 32) & 1, static_cast<unsigned int>(ref));
+}
+
+U64 convert(const U33& ref)
+{
+    return (static_cast<U64>(ref.getUpper()) << 32) | ref.getLsb32();
+}
+
+/// Big endian bit writer, written field by field from the standard's syntax
+class BitWriter
+{
+public:
+    explicit BitWriter(unsigned char* out) : mOut(out), mBit(0) {}
+
+    void put(U64 value, unsigned int bits)
+    {
+        for (unsigned int i = bits; i > 0; --i)
+        {
+            const unsigned int bit = static_cast<unsigned int>((value >> (i - 1)) & 1);
+            mOut[mBit / 8] = static_cast<unsigned char>((mOut[mBit / 8] & ~(0x80 >> (mBit % 8))) |
+                                                        (bit << (7 - (mBit % 8))));
+            ++mBit;
+        }
+    }
+
+private:
+    unsigned char* mOut;
+    unsigned int mBit;
+};
+
+void referenceTimestamp(unsigned char* out, U64 value, unsigned int prefix)
+{
+    BitWriter writer(out);
+    writer.put(prefix, 4);
+    writer.put(value >> 30, 3);
+    writer.put(1, 1);
+    writer.put((value >> 15) & 0x7fff, 15);
+    writer.put(1, 1);
+    writer.put(value & 0x7fff, 15);
+    writer.put(1, 1);
+}
+
+void referencePcr(unsigned char* out, U64 base, unsigned int extension)
+{
+    BitWriter writer(out);
+    writer.put(base, 33);
+    writer.put(0x3f, 6);
+    writer.put(extension, 9);
+}
+
+void checkKnown()
+{
+    // PTS only, zero and the maximum
+    const unsigned char zero[] = { 0x21, 0x00, 0x01, 0x00, 0x01 };
+    const unsigned char full[] = { 0x2f, 0xff, 0xff, 0xff, 0xff };
+    unsigned char out[U33Wire::PCR_BYTES];
+
+    U33Wire::encodeTimestamp(out, U33(), U33Wire::PREFIX_PTS);
+    check(memcmp(out, zero, 5) == 0, "pts zero", 0);
+    U33Wire::encodeTimestamp(out, U33(1, 0xffffffff), U33Wire::PREFIX_PTS);
+    check(memcmp(out, full, 5) == 0, "pts max", 0);
+
+    // one second at 90 kHz as a DTS: 90000 = 0x15f90
+    const unsigned char second[] = { 0x11, 0x00, 0x05, 0xbf, 0x21 };
+    U33Wire::encodeTimestamp(out, U33(0, 90000), U33Wire::PREFIX_DTS);
+    check(memcmp(out, second, 5) == 0, "dts one second", 90000);
+
+    U33 value;
+    check(U33Wire::decodeTimestamp(second, value) && (value == U33(0, 90000)), "decode one second", 90000);
+
+    // PCR zero keeps the reserved bits set
+    const unsigned char pcrZero[] = { 0x00, 0x00, 0x00, 0x00, 0x7e, 0x00 };
+    U33Wire::encodePcr(out, U33(), 0);
+    check(memcmp(out, pcrZero, 6) == 0, "pcr zero", 0);
+
+    const unsigned char pcrFull[] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+    U33Wire::encodePcr(out, U33(1, 0xffffffff), 0x1ff);
+    check(memcmp(out, pcrFull, 6) == 0, "pcr max", 0);
+
+    check(U33Wire::toPcrTicks(U33(1, 0xffffffff), 299) ==
+          UInt<42>(0x257, 0xffffffff), "pcr ticks", 0);
+}
+
+void checkMarkers()
+{
+    unsigned char out[U33Wire::TIMESTAMP_BYTES];
+    U33Wire::encodeTimestamp(out, U33(1, 0x12345678), U33Wire::PREFIX_PTS_DTS);
+
+    const unsigned int positions[] = { 0, 2, 4 };
+    for (unsigned int m = 0; m < 3; ++m)
+    {
+        unsigned char broken[U33Wire::TIMESTAMP_BYTES];
+        memcpy(broken, out, sizeof(broken));
+        broken[positions[m]] &= 0xfe;
+
+        U33 value;
+        check(!U33Wire::decodeTimestamp(broken, value), "marker", m);
+        check(value == U33(1, 0x12345678), "value with a bad marker", m);
+    }
+}
+
+void checkRandom()
+{
+    U64 state(0x9e3779b97f4a7c15ULL);
+
+    for (unsigned int i = 0; i < 100000; ++i)
+    {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        const U64 value = (state >> (i % 31)) & 0x1ffffffffULL;
+        const unsigned int prefix = 1 + (i % 3);
+        const unsigned int extension = static_cast<unsigned int>(state >> 40) % 300;
+
+        unsigned char expected[U33Wire::PCR_BYTES] = { 0 };
+        unsigned char actual[U33Wire::PCR_BYTES] = { 0 };
+
+        referenceTimestamp(expected, value, prefix);
+        U33Wire::encodeTimestamp(actual, convert(value), prefix);
+        check(memcmp(expected, actual, U33Wire::TIMESTAMP_BYTES) == 0, "encode timestamp", value);
+
+        U33 decoded;
+        check(U33Wire::decodeTimestamp(expected, decoded) && (convert(decoded) == value), "decode timestamp", value);
+
+        referencePcr(expected, value, extension);
+        U33Wire::encodePcr(actual, convert(value), extension);
+        check(memcmp(expected, actual, U33Wire::PCR_BYTES) == 0, "encode pcr", value);
+
+        unsigned int decodedExtension(0);
+        U33Wire::decodePcr(expected, decoded, decodedExtension);
+        check((convert(decoded) == value) && (decodedExtension == extension), "decode pcr", value);
+
+        const UInt<42> ticks = U33Wire::toPcrTicks(decoded, decodedExtension);
+        check(((static_cast<U64>(ticks.getUpper()) << 32) | ticks.getLsb32()) == (value * 300 + extension),
+              "pcr ticks", value);
+    }
+}
+
+void checkBatch()
+{
+    // 188 byte packets with the field at an odd offset
+    const size_t count = 1000;
+    const size_t stride = 188;
+    const size_t offset = 13;
+
+    vector<U33> values(count);
+    vector<unsigned int> extensions(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        values[i] = U33(i & 1, static_cast<unsigned int>(i * 2654435761u));
+        extensions[i] = static_cast<unsigned int>(i % 300);
+    }
+
+    vector<unsigned char> packets(count * stride, 0x47);
+    vector<unsigned char> expected(packets);
+
+    U33Wire::encodeTimestamps(&packets[offset], stride, values.data(), count, U33Wire::PREFIX_PTS);
+    for (size_t i = 0; i < count; ++i)
+        referenceTimestamp(&expected[offset + i * stride], convert(values[i]), U33Wire::PREFIX_PTS);
+    check(packets == expected, "batch encode timestamps", 0);
+
+    // corrupt one marker to check the flags
+    packets[offset + 7 * stride + 2] &= 0xfe;
+
+    vector<U33> decoded(count);
+    bool* valid = new bool[count];
+    const size_t good = U33Wire::decodeTimestamps(&packets[offset], stride, decoded.data(), count, valid);
+    check((good == count - 1) && !valid[7] && valid[8], "batch markers", good);
+    check(decoded == values, "batch decode timestamps", 0);
+    delete[] valid;
+
+    U33Wire::encodePcrs(&packets[offset], stride, values.data(), extensions.data(), count);
+    for (size_t i = 0; i < count; ++i)
+        referencePcr(&expected[offset + i * stride], convert(values[i]), extensions[i]);
+    check(packets == expected, "batch encode pcr", 0);
+
+    vector<unsigned int> decodedExtensions(count);
+    U33Wire::decodePcrs(&packets[offset], stride, decoded.data(), decodedExtensions.data(), count);
+    check((decoded == values) && (decodedExtensions == extensions), "batch decode pcr", 0);
+
+    // the bytes around the fields are untouched
+    check((packets[offset - 1] == 0x47) && (packets[offset + U33Wire::PCR_BYTES] == 0x47), "batch bounds", 0);
+}
+
+int main()
+{
+    checkKnown();
+    checkMarkers();
+    checkRandom();
+    checkBatch();
+
+    cout << "Sweet success!" << endl;
+
+    return 0;
+}
@@ -0,0 +1,369 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_uint.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <iostream>
+#include <stdexcept>
+#include "UInt.h"
+
+typedef unsigned long long U64;
+
+using namespace std;
+
+template <unsigned int Bits>
+U64 mask()
+{
+    return (Bits >= 64) ? ~0ULL : ((1ULL << (Bits % 64)) - 1);
+}
+
+template <typename T>
+T convert(const U64& ref)
+{
+    const U64 val = ref & mask<T::BITS>();
+
+    return T(static_cast<unsigned int>(val >> 32),
+             static_cast<unsigned int>(val & 0xffffffff));
+}
+
+template <typename T>
+U64 convert(const T& ref)
+{
+    return (static_cast<U64>(ref.getUpper()) << 32) | ref.getLsb32();
+}
+
+template <typename T>
+void fail(const char* what, U64 a, U64 b)
+{
+    cout << "==============================================================" << endl;
+    cout << "FAILURE " << what << " (" << dec << T::BITS << " bits)" << endl;
+    cout << "==============================================================" << endl;
+    cout << "a              : 0x" << hex << a << endl;
+    cout << "b              : 0x" << hex << b << endl;
+    cout << "a as UInt      : " << convert<T>(a) << endl;
+    cout << "b as UInt      : " << convert<T>(b) << endl;
+    cout << "==============================================================" << endl << endl;
+
+    throw std::logic_error("Test failure");
+}
+
+template <typename T>
+void checkPair(U64 a, U64 b)
+{
+    const U64 m = mask<T::BITS>();
+    a &= m;
+    b &= m;
+
+    const T a2 = convert<T>(a);
+    const T b2 = convert<T>(b);
+
+    if (convert(a2) != a)
+        fail<T>("round trip", a, b);
+
+    if (convert(a2 + b2) != ((a + b) & m))
+        fail<T>("addition", a, b);
+
+    if (convert(a2 - b2) != ((a - b) & m))
+        fail<T>("subtraction", a, b);
+
+    T acc(a2);
+    acc += b2;
+    acc -= b2;
+    if (acc != a2)
+        fail<T>("changers", a, b);
+
+    const bool compare = ((a2 == b2) == (a == b)) &&
+                         ((a2 != b2) == (a != b)) &&
+                         ((a2 <  b2) == (a <  b)) &&
+                         ((a2 <= b2) == (a <= b)) &&
+                         ((a2 >  b2) == (a >  b)) &&
+                         ((a2 >= b2) == (a >= b));
+    if (!compare)
+        fail<T>("comparison", a, b);
+
+    // carry / borrow in both states, then saturation
+    for (unsigned int in = 0; in < 2; ++in)
+    {
+        const U64 total   = a + b + in;
+        const bool carry  = (T::BITS < 64) ? (total > m) : ((total < a) || ((total == a) && (in || b)));
+        const bool borrow = (a < b) || ((a == b) && in);
+
+        bool carryFlag(in != 0);
+        bool borrowFlag(in != 0);
+        if ((convert(a2.addCarry(b2, carryFlag)) != (total & m)) || (carryFlag != carry) ||
+            (convert(a2.subBorrow(b2, borrowFlag)) != ((a - b - in) & m)) || (borrowFlag != borrow))
+            fail<T>("carry / borrow", a, b);
+    }
+
+    const bool wraps = ((a + b) & m) < a;
+    if ((convert(a2.addSaturate(b2)) != (wraps ? m : (a + b) & m)) ||
+        (convert(a2.subSaturate(b2)) != ((a < b) ? 0 : (a - b))))
+        fail<T>("saturate", a, b);
+
+    // serial numbers, sign extending b - a from the top bit
+    const U64 ahead = (b - a) & m;
+    const U64 half  = (m >> 1) + 1;
+    const long long signedAhead = static_cast<long long>(ahead << (64 - T::BITS)) >> (64 - T::BITS);
+    const long long distance = (signedAhead > 0x7fffffffLL) ? 0x7fffffffLL :
+                               (signedAhead < -0x80000000LL) ? -0x80000000LL : signedAhead;
+    if ((a2.isBefore(b2) != ((ahead != 0) && (ahead < half))) ||
+        (a2.isAfter(b2) != (ahead > half)) ||
+        (a2.distanceTo(b2) != distance))
+        fail<T>("serial", a, b);
+
+    const int i = static_cast<int>(static_cast<unsigned int>(b));
+    const U64 i64 = static_cast<U64>(static_cast<long long>(i));
+    if ((convert(a2 + i) != ((a + i64) & m)) ||
+        (convert(a2 - i) != ((a - i64) & m)))
+        fail<T>("mixed int", a, b);
+
+    const unsigned int u = static_cast<unsigned int>(b);
+    if ((convert(a2 + u) != ((a + u) & m)) ||
+        (convert(a2 - u) != ((a - u) & m)))
+        fail<T>("mixed unsigned", a, b);
+
+    if (convert(a2 * b2) != ((a * b) & m))
+        fail<T>("multiplication", a, b);
+
+    const U64 quotient  = b ? (a / b) : m;
+    const U64 remainder = b ? (a % b) : a;
+    if ((convert(a2 / b2) != quotient) || (convert(a2 % b2) != remainder))
+        fail<T>("division", a, b);
+
+    if ((convert(a2 & b2) != (a & b)) ||
+        (convert(a2 | b2) != (a | b)) ||
+        (convert(a2 ^ b2) != (a ^ b)) ||
+        (convert(~a2) != (~a & m)))
+        fail<T>("bitwise", a, b);
+
+    const unsigned int shift = static_cast<unsigned int>(b % (T::BITS + 2));
+    const U64 left  = (shift >= T::BITS) ? 0 : ((a << shift) & m);
+    const U64 right = (shift >= T::BITS) ? 0 : (a >> shift);
+    if ((convert(a2 << shift) != left) || (convert(a2 >> shift) != right))
+        fail<T>("shift", a, shift);
+
+    T changed(a2);
+    changed *= b2;
+    changed ^= a2;
+    changed <<= 1;
+    changed >>= 2;
+    if (convert(changed) != (((((((a * b) & m) ^ a) << 1) & m) >> 2)))
+        fail<T>("changers", a, b);
+
+    const unsigned int bits = T::BITS;
+    const U64 msb32 = (bits > 32) ? (a >> (bits - 32)) : a;
+    if ((a2.getMsb() != (((a >> (bits - 1)) & 1) != 0)) ||
+        (a2.getLsb() != ((a & 1) != 0)) ||
+        (a2.getMsb32() != static_cast<unsigned int>(msb32)) ||
+        (a2.getLsb32() != static_cast<unsigned int>(a)))
+        fail<T>("getters", a, b);
+}
+
+template <typename T>
+void checkWidth()
+{
+    const U64 m = mask<T::BITS>();
+
+    // boundary values around every word and half word edge
+    const U64 edges[] = { 0, 1, 2, 0xfffe, 0xffff, 0x10000, 0x10001,
+                          0x7fffffff, 0x80000000, 0xffffffff, 0x100000000ULL,
+                          0x100000001ULL, 0xffffffffffffULL,
+                          m - 1, m, m >> 1, (m >> 1) + 1 };
+    const unsigned int count = sizeof(edges) / sizeof(edges[0]);
+
+    for (unsigned int i = 0; i < count; ++i)
+        for (unsigned int j = 0; j < count; ++j)
+            checkPair<T>(edges[i], edges[j]);
+
+    // pseudo random pairs (xorshift)
+    U64 state(0x9e3779b97f4a7c15ULL);
+    for (unsigned int i = 0; i < 20000; ++i)
+    {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        const U64 a = state;
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        const U64 b = (i & 1) ? state : (a + (state & 0xffff));
+
+        checkPair<T>(a, b);
+    }
+}
+
+template <typename T>
+void checkRaw()
+{
+    const T value(0x5, 0x12345678);
+
+    unsigned int msb(0);
+    unsigned int lsb16(0);
+    value.getRaw(msb, lsb16);
+
+    const U64 expected = convert(value);
+    if ((msb != static_cast<unsigned int>(expected >> 16)) ||
+        (lsb16 != static_cast<unsigned int>(expected & 0xffff)))
+        fail<T>("raw", expected, 0);
+}
+
+template <typename T>
+void checkDivider(unsigned int divisor)
+{
+    const UIntDivider<T::BITS, typename T::LayoutType> divider(divisor);
+    const U64 m = mask<T::BITS>();
+
+    U64 state(0x2545f4914f6cdd1dULL ^ divisor);
+    for (unsigned int i = 0; i < 2000; ++i)
+    {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+
+        // the edges of the range and of each quotient step matter most
+        U64 a = state & m;
+        switch (i % 4)
+        {
+            case 0: a = m - (state & 0xff); break;
+            case 1: a = (((state & m) / divisor) * divisor) & m; break;
+            case 2: a = ((((state & m) / divisor) * divisor) - 1) & m; break;
+            default: break;
+        }
+        if (i < 256) a = i;
+
+        const T a2 = convert<T>(a);
+        if ((convert(divider.divide(a2)) != (a / divisor)) ||
+            (convert(divider.remainder(a2)) != (a % divisor)))
+            fail<T>("divider", a, divisor);
+    }
+}
+
+template <typename T>
+void checkDividers()
+{
+    const unsigned int divisors[] = { 1, 2, 3, 5, 7, 10, 300, 1001, 65535, 65536,
+                                      90000, 27000000, 0x7fffffff, 0x80000000,
+                                      0x80000001, 0xfffffffe, 0xffffffff };
+
+    for (unsigned int i = 0; i < sizeof(divisors) / sizeof(divisors[0]); ++i)
+        checkDivider<T>(divisors[i]);
+
+    unsigned int state(0x1234567);
+    for (unsigned int i = 0; i < 64; ++i)
+    {
+        state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+        checkDivider<T>((state >> (i % 32)) | 1);
+    }
+
+    // the compile time path
+    const T a = convert<T>(0x1fedcba98ULL);
+    if ((convert(a.template divideBy<90000>()) != ((0x1fedcba98ULL & mask<T::BITS>()) / 90000)) ||
+        (convert(a.template remainderBy<1001>()) != ((0x1fedcba98ULL & mask<T::BITS>()) % 1001)))
+        fail<T>("divideBy", 0x1fedcba98ULL, 90000);
+}
+
+// every layout evaluates at compile time
+static_assert((UInt<8>(0, 0xff) + 1u) == UInt<8>(), "word layout wraps");
+static_assert((UInt<32>(0, 0xffffffff) * 0xffffffffu) == UInt<32>(0, 1), "word layout multiplies");
+static_assert((UInt<42>(0x3ff, 0xffffffff) + 1u) == UInt<42>(), "split 16 layout wraps");
+static_assert((UInt<64>(0xffffffff, 0xffffffff) * 3u) == UInt<64>(0xffffffff, 0xfffffffd), "split 32 layout multiplies");
+static_assert((UInt<64>(0x12345678, 0x9abcdef0) / UInt<64>(0, 0x10000)) == UInt<64>(0x1234, 0x56789abc), "long division");
+static_assert(UInt<64>(0xffffffff, 0xffffffff).divideBy<27000000>() == UInt<64>(0x9f, 0x12a7232e), "constant division");
+static_assert(UInt<48>(0x8000, 0).distanceTo(UInt<48>()) == -2147483647 - 1, "saturated distance");
+
+void checkChain()
+{
+    // a 64 bit accumulator from a U33 low part and a UInt<31> high part
+    typedef UInt<33> Low;
+    typedef UInt<31> High;
+
+    U64 state(0x2545f4914f6cdd1dULL);
+    U64 sum(0), diff(0);
+    Low sumLo, diffLo;
+    High sumHi, diffHi;
+
+    for (unsigned int i = 0; i < 10000; ++i)
+    {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        const U64 value = state >> (i % 64);
+
+        const Low lo = convert<Low>(value);
+        const High hi = convert<High>(value >> 33);
+
+        bool carry(false);
+        sumLo = sumLo.addCarry(lo, carry);
+        sumHi = sumHi.addCarry(hi, carry);
+        sum += value;
+
+        bool borrow(false);
+        diffLo = diffLo.subBorrow(lo, borrow);
+        diffHi = diffHi.subBorrow(hi, borrow);
+        diff -= value;
+
+        if (((convert(sumHi) << 33) | convert(sumLo)) != sum)
+            fail<Low>("chained addition", sum, value);
+        if (((convert(diffHi) << 33) | convert(diffLo)) != diff)
+            fail<Low>("chained subtraction", diff, value);
+    }
+}
+
+int main()
+{
+    checkWidth< UInt<1> >();
+    checkWidth< UInt<8> >();
+    checkWidth< UInt<31> >();
+    checkWidth< UInt<32> >();
+    checkWidth< UInt<33> >();
+    checkWidth< UInt<35> >();
+    checkWidth< UInt<42> >();
+    checkWidth< UInt<47> >();
+    checkWidth< UInt<48> >();
+    checkWidth< UInt<63> >();
+    checkWidth< UInt<64> >();
+
+    // every layout that can hold 33 bits
+    checkWidth< UInt<33, UIntSplit32Layout<33> > >();
+    checkWidth< UInt<33, UIntNative64Layout<33> > >();
+    checkWidth< UInt<33, UIntSplit16Layout<33> > >();
+    checkWidth< UInt<42, UIntNative64Layout<42> > >();
+    checkWidth< UInt<64, UIntNative64Layout<64> > >();
+
+    checkDividers< UInt<16> >();
+    checkDividers< UInt<32> >();
+    checkDividers< UInt<33> >();
+    checkDividers< UInt<42> >();
+    checkDividers< UInt<48> >();
+    checkDividers< UInt<64> >();
+    checkDividers< UInt<33, UIntSplit32Layout<33> > >();
+    checkDividers< UInt<33, UIntNative64Layout<33> > >();
+    checkDividers< UInt<33, UIntSplit16Layout<33> > >();
+    checkDividers< UInt<64, UIntNative64Layout<64> > >();
+
+    checkRaw< UInt<33> >();
+    checkRaw< UInt<42> >();
+    checkRaw< UInt<48> >();
+    checkRaw< UInt<33, UIntSplit32Layout<33> > >();
+    checkRaw< UInt<33, UIntNative64Layout<33> > >();
+    checkRaw< UInt<33, UIntSplit16Layout<33> > >();
+
+    checkChain();
+
+    cout << "Sweet success!" << endl;
+
+    return 0;
+}
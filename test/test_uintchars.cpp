@@ -0,0 +1,276 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_uintchars.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "U33.h"
+#include "UIntChars.h"
+
+typedef unsigned long long U64;
+
+using namespace std;
+
+template <unsigned int Bits>
+U64 mask()
+{
+    return (Bits >= 64) ? ~0ULL : ((1ULL << (Bits % 64)) - 1);
+}
+
+template <typename T>
+T convert(U64 ref)
+{
+    const U64 val = ref & mask<T::BITS>();
+
+    return T(static_cast<unsigned int>(val >> 32), static_cast<unsigned int>(val & 0xffffffff));
+}
+
+template <typename T>
+U64 convert(const T& ref)
+{
+    return (static_cast<U64>(ref.getUpper()) << 32) | ref.getLsb32();
+}
+
+void check(bool success, const char* what, unsigned int bits, U64 value)
+{
+    if (!success)
+    {
+        cout << "FAILURE " << what << " (" << dec << bits << " bits) 0x" << hex << value << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
+template <typename T>
+void checkValue(U64 value)
+{
+    const unsigned int bits = T::BITS;
+    value &= mask<T::BITS>();
+    const T v = convert<T>(value);
+
+    char expected[32];
+    char text[32];
+
+    const UIntChars::Base bases[] = { UIntChars::BASE_DECIMAL, UIntChars::BASE_HEX };
+    for (unsigned int b = 0; b < 2; ++b)
+    {
+        const UIntChars::Base base = bases[b];
+        snprintf(expected, sizeof(expected), (base == UIntChars::BASE_HEX) ? "%llx" : "%llu", value);
+        const size_t length = strlen(expected);
+
+        // exact fit, then one short
+        const UIntChars::ToResult written = UIntChars::toChars(text, text + length, v, base);
+        check((written.mError == UIntChars::ERROR_NONE) && (written.mPtr == text + length) &&
+              (written.mCount == 1) && (memcmp(text, expected, length) == 0), "toChars", bits, value);
+
+        const UIntChars::ToResult small = UIntChars::toChars(text, text + length - 1, v, base);
+        check((small.mError == UIntChars::ERROR_TOO_SMALL) && (small.mPtr == text + length - 1),
+              "toChars too small", bits, value);
+
+        // round trip, stopping at the terminator
+        T parsed;
+        const UIntChars::FromResult read = UIntChars::fromChars(expected, expected + length + 1, parsed, base);
+        check((read.mError == UIntChars::ERROR_NONE) && (read.mPtr == expected + length) &&
+              (convert(parsed) == value), "fromChars", bits, value);
+
+        // leading zeros and upper case hex
+        string padded = string("000") + expected;
+        for (size_t i = 0; i < padded.size(); ++i)
+            padded[i] = static_cast<char>(toupper(padded[i]));
+        parsed = T();
+        const UIntChars::FromResult zeros = UIntChars::fromChars(padded.data(), padded.data() + padded.size(), parsed, base);
+        check((zeros.mError == UIntChars::ERROR_NONE) && (convert(parsed) == value), "fromChars padded", bits, value);
+    }
+}
+
+template <typename T>
+void checkRange()
+{
+    const unsigned int bits = T::BITS;
+    const U64 maximum = mask<T::BITS>();
+    char text[32];
+
+    check(UIntCharsSize<T::BITS>::HEX == (bits + 3) / 4, "hex size", bits, 0);
+    snprintf(text, sizeof(text), "%llu", maximum);
+    check(UIntCharsSize<T::BITS>::DECIMAL == strlen(text), "decimal size", bits, 0);
+
+    // one more than the maximum, where that still fits a U64
+    if (bits < 64)
+    {
+        const T sentinel = convert<T>(0x5a5a5a5a5a5a5a5aULL);
+        const UIntChars::Base bases[] = { UIntChars::BASE_DECIMAL, UIntChars::BASE_HEX };
+        for (unsigned int b = 0; b < 2; ++b)
+        {
+            snprintf(text, sizeof(text), (bases[b] == UIntChars::BASE_HEX) ? "%llx" : "%llu", maximum + 1);
+            T parsed(sentinel);
+            const UIntChars::FromResult read = UIntChars::fromChars(text, text + strlen(text), parsed, bases[b]);
+            check((read.mError == UIntChars::ERROR_OUT_OF_RANGE) && (read.mPtr == text + strlen(text)) &&
+                  (parsed == sentinel), "out of range", bits, maximum + 1);
+        }
+    }
+
+    // random values of every length
+    U64 state(0x9e3779b97f4a7c15ULL);
+    for (unsigned int i = 0; i < 2000; ++i)
+    {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        checkValue<T>(state >> (i % 64));
+    }
+
+    const U64 edges[] = { 0, 1, 9, 10, 15, 16, 999999999, 1000000000, 0xffffffff,
+                          0x100000000ULL, 9999999999ULL, 10000000000ULL, maximum - 1, maximum };
+    for (unsigned int i = 0; i < sizeof(edges) / sizeof(edges[0]); ++i)
+        checkValue<T>(edges[i]);
+}
+
+void checkErrors()
+{
+    const U33 sentinel(1, 0x12345678);
+    U33 value(sentinel);
+
+    const char* empty = "";
+    UIntChars::FromResult read = UIntChars::fromChars(empty, empty, value);
+    check((read.mError == UIntChars::ERROR_INVALID) && (read.mPtr == empty) && (value == sentinel), "empty", 33, 0);
+
+    const char* sign = "-1";
+    read = UIntChars::fromChars(sign, sign + 2, value);
+    check((read.mError == UIntChars::ERROR_INVALID) && (read.mPtr == sign), "sign", 33, 0);
+
+    const char* prefix = "0x1f";
+    read = UIntChars::fromChars(prefix, prefix + 4, value, UIntChars::BASE_HEX);
+    check((read.mError == UIntChars::ERROR_NONE) && (read.mPtr == prefix + 1) && (value == U33()), "no prefix", 33, 0);
+
+    const char* trailing = "8589934591 tail";
+    read = UIntChars::fromChars(trailing, trailing + strlen(trailing), value);
+    check((read.mError == UIntChars::ERROR_NONE) && (read.mPtr == trailing + 10) &&
+          (value == U33(1, 0xffffffff)), "trailing", 33, 0);
+
+    const char* longest = "8589934592";
+    read = UIntChars::fromChars(longest, longest + 10, value);
+    check((read.mError == UIntChars::ERROR_OUT_OF_RANGE) && (value == U33(1, 0xffffffff)), "longest", 33, 0);
+
+    const char* topNibble = "200000000";
+    read = UIntChars::fromChars(topNibble, topNibble + 9, value, UIntChars::BASE_HEX);
+    check(read.mError == UIntChars::ERROR_OUT_OF_RANGE, "top nibble", 33, 0);
+
+    const char* zeros = "0000000000000000000000000001";
+    read = UIntChars::fromChars(zeros, zeros + strlen(zeros), value);
+    check((read.mError == UIntChars::ERROR_NONE) && (value == U33(0, 1)), "many zeros", 33, 0);
+}
+
+void checkBatch()
+{
+    vector<U33> values;
+    unsigned int state(0x2545f491);
+    for (unsigned int i = 0; i < 1000; ++i)
+    {
+        state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+        values.push_back(U33(state >> 31, state * 2654435761u) >> (i % 33));
+    }
+
+    const UIntChars::Base bases[] = { UIntChars::BASE_DECIMAL, UIntChars::BASE_HEX };
+    for (unsigned int b = 0; b < 2; ++b)
+    {
+        vector<char> text(values.size() * (UIntCharsSize<33>::DECIMAL + 1));
+        char* first = text.data();
+
+        const UIntChars::ToResult written = UIntChars::toChars(first, first + text.size(), values.data(),
+                                                               values.size(), ',', bases[b]);
+        check((written.mError == UIntChars::ERROR_NONE) && (written.mCount == values.size()), "batch toChars", 33, b);
+
+        // matches the single value formatting
+        string joined;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            char single[16];
+            const UIntChars::ToResult one = UIntChars::toChars(single, single + sizeof(single), values[i], bases[b]);
+            joined += (i ? "," : "") + string(single, one.mPtr);
+        }
+        check(string(first, written.mPtr) == joined, "batch text", 33, b);
+
+        vector<U33> parsed(values.size() + 5);
+        const UIntChars::FromResult read = UIntChars::fromChars(first, written.mPtr, parsed.data(),
+                                                                parsed.size(), ',', bases[b]);
+        check((read.mError == UIntChars::ERROR_NONE) && (read.mCount == values.size()) &&
+              (read.mPtr == written.mPtr), "batch fromChars", 33, b);
+        parsed.resize(values.size());
+        check(parsed == values, "batch round trip", 33, b);
+
+        // a buffer that stops part way
+        const size_t half = joined.size() / 2;
+        const UIntChars::ToResult partial = UIntChars::toChars(first, first + half, values.data(),
+                                                               values.size(), ',', bases[b]);
+        check((partial.mError == UIntChars::ERROR_TOO_SMALL) && (partial.mCount < values.size()) &&
+              (string(first, partial.mPtr) == joined.substr(0, partial.mPtr - first)) &&
+              (joined[partial.mPtr - first] == ','), "batch too small", 33, b);
+    }
+
+    // a bad value reports where it failed
+    const char* bad = "1,2,x,4";
+    U33 out[4];
+    const UIntChars::FromResult read = UIntChars::fromChars(bad, bad + 7, out, 4, ',');
+    check((read.mError == UIntChars::ERROR_INVALID) && (read.mCount == 2) && (read.mPtr == bad + 4), "batch invalid", 33, 0);
+}
+
+void checkStream()
+{
+    // the stream state is left as it was found
+    ostringstream stream;
+    stream << U33(0, 0xff) << ' ' << 255 << ' ' << setw(4) << 7 << ' ' << setw(12) << U33(1, 0);
+    check(stream.str() == "0x0000000ff 255    7  0x100000000", "stream state", 33, 0);
+}
+
+int main()
+{
+    checkRange<UInt<1> >();
+    checkRange<UInt<4> >();
+    checkRange<UInt<8> >();
+    checkRange<UInt<30> >();
+    checkRange<UInt<31> >();
+    checkRange<UInt<32> >();
+    checkRange<UInt<33> >();
+    checkRange<UInt<35> >();
+    checkRange<UInt<42> >();
+    checkRange<UInt<48> >();
+    checkRange<UInt<60> >();
+    checkRange<UInt<63> >();
+    checkRange<UInt<64> >();
+    checkRange<UInt<33, UIntSplit32Layout<33> > >();
+    checkRange<UInt<33, UIntNative64Layout<33> > >();
+    checkRange<UInt<33, UIntSplit16Layout<33> > >();
+
+    checkErrors();
+    checkBatch();
+    checkStream();
+
+    cout << "Sweet success!" << endl;
+
+    return 0;
+}
@@ -0,0 +1,303 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_uintcounters.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "U33.h"
+#include "UIntCounters.h"
+
+using namespace std;
+
+typedef pair<UIntProbe::Event, unsigned int> Expected;
+
+static constexpr U33 MAX(1, 0xffffffff);
+
+void check(bool success, const char* what)
+{
+    if (!success)
+    {
+        cout << "FAILURE " << what << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
+// constant evaluation never counts, so instrumented builds still fold these
+static_assert(MAX + 1u == U33(), "constexpr wrap");
+static_assert(U33() - 1 == MAX, "constexpr underflow");
+static_assert(U33(0, 900000).divideBy<90000>() == U33(0, 10), "constexpr divideBy");
+static_assert(MAX.addSaturate(U33(0, 1)) == MAX, "constexpr saturation");
+static_assert(U33(0, 5).distanceTo(U33(0, 0xfffffff0)) == 0x7fffffff, "constexpr distance");
+
+/// Every count is the expected one when instrumented, and zero otherwise
+void expect(const UIntCounters& counters, const char* what, const vector<Expected>& expected)
+{
+    for (unsigned int i = 0; i < UIntProbe::EVENT_COUNT; ++i)
+    {
+        const UIntProbe::Event event = static_cast<UIntProbe::Event>(i);
+        unsigned int count(0);
+
+        for (size_t j = 0; j < expected.size(); ++j)
+        {
+            count += (expected[j].first == event) ? expected[j].second : 0;
+        }
+
+        if (counters.get(event) != UIntCounters::Count(0, UIntProbe::ENABLED ? count : 0))
+        {
+            cout << UIntCounters::getName(event) << ": " << counters.get(event) << endl;
+            check(false, what);
+        }
+    }
+}
+
+/// The counts of the operations function runs
+template <typename Function>
+UIntCounters measure(Function function)
+{
+    UIntCounters::reset();
+    function();
+    return UIntCounters::snapshot();
+}
+
+void checkOperators()
+{
+    // the operands are runtime values
+    volatile unsigned int three(3);
+    const U33 small(0, three);
+    const U33 large(1, three);
+    const U33 zero;
+    U33 sink;
+
+    expect(measure([&] { sink = small + large; }), "add",
+           { Expected(UIntProbe::ADD, 1) });
+    expect(measure([&] { sink = MAX + small; }), "add wrap",
+           { Expected(UIntProbe::ADD, 1), Expected(UIntProbe::ADD_WRAP, 1) });
+    expect(measure([&] { sink = large - small; }), "sub",
+           { Expected(UIntProbe::SUB, 1) });
+    expect(measure([&] { sink = small - large; }), "sub underflow",
+           { Expected(UIntProbe::SUB, 1), Expected(UIntProbe::SUB_UNDERFLOW, 1) });
+    expect(measure([&] { sink = large; sink += MAX; sink -= MAX; sink -= large; sink -= small; }), "changers",
+           { Expected(UIntProbe::ADD, 1), Expected(UIntProbe::ADD_WRAP, 1),
+             Expected(UIntProbe::SUB, 3), Expected(UIntProbe::SUB_UNDERFLOW, 2) });
+
+    // a negative int counts as the opposite operation
+    expect(measure([&] { sink = large + 1u; }), "add unsigned",
+           { Expected(UIntProbe::ADD_UINT, 1), Expected(UIntProbe::ADD, 1) });
+    expect(measure([&] { sink = small + -1; }), "add negative",
+           { Expected(UIntProbe::ADD_INT, 1), Expected(UIntProbe::SUB, 1) });
+    expect(measure([&] { sink = small + -4; }), "add negative underflow",
+           { Expected(UIntProbe::ADD_INT, 1), Expected(UIntProbe::SUB, 1), Expected(UIntProbe::SUB_UNDERFLOW, 1) });
+    expect(measure([&] { sink = MAX + 1; }), "add int wrap",
+           { Expected(UIntProbe::ADD_INT, 1), Expected(UIntProbe::ADD, 1), Expected(UIntProbe::ADD_WRAP, 1) });
+    expect(measure([&] { sink = small - 4u; }), "sub unsigned underflow",
+           { Expected(UIntProbe::SUB_UINT, 1), Expected(UIntProbe::SUB, 1), Expected(UIntProbe::SUB_UNDERFLOW, 1) });
+    expect(measure([&] { sink = small - 4; }), "sub int underflow",
+           { Expected(UIntProbe::SUB_INT, 1), Expected(UIntProbe::SUB, 1), Expected(UIntProbe::SUB_UNDERFLOW, 1) });
+    expect(measure([&] { sink = MAX - -1; }), "sub negative wrap",
+           { Expected(UIntProbe::SUB_INT, 1), Expected(UIntProbe::ADD, 1), Expected(UIntProbe::ADD_WRAP, 1) });
+    expect(measure([&] { sink = large - -1; }), "sub negative",
+           { Expected(UIntProbe::SUB_INT, 1), Expected(UIntProbe::ADD, 1) });
+
+    expect(measure([&] { sink = large * small; sink *= large; sink = large * 3u; }), "mul",
+           { Expected(UIntProbe::MUL, 3), Expected(UIntProbe::MUL_UINT, 1) });
+    // the long division's own steps are not counted, remainderBy() counts the
+    // multiply and subtract after its division
+    expect(measure([&] { sink = large / small; sink = large % small; sink /= small; sink %= small; }), "divide",
+           { Expected(UIntProbe::DIVIDE, 4) });
+    expect(measure([&] { sink = large / zero; sink = large % 0u; }), "divide by zero",
+           { Expected(UIntProbe::DIVIDE, 2), Expected(UIntProbe::DIVIDE_BY_ZERO, 2),
+             Expected(UIntProbe::MODULO_UINT, 1) });
+    expect(measure([&] { sink = large.divideBy<90000>(); sink = large.remainderBy<90000>(); }), "divide constant",
+           { Expected(UIntProbe::DIVIDE_CONSTANT, 2), Expected(UIntProbe::MUL, 1),
+             Expected(UIntProbe::MUL_UINT, 1), Expected(UIntProbe::SUB, 1) });
+
+    expect(measure([&] { sink = large.addSaturate(small); sink = MAX.addSaturate(small); }), "add saturate",
+           { Expected(UIntProbe::SATURATE, 2), Expected(UIntProbe::SATURATED, 1) });
+    expect(measure([&] { sink = large.subSaturate(small); sink = small.subSaturate(large); }), "sub saturate",
+           { Expected(UIntProbe::SATURATE, 2), Expected(UIntProbe::SATURATED, 1) });
+
+    volatile bool before(false);
+    volatile int distance(0);
+
+    expect(measure([&] { before = small.isBefore(large); before = MAX.isAfter(small); }), "serial",
+           { Expected(UIntProbe::SERIAL, 2) });
+    expect(measure([&] { distance = large.distanceTo(large + 5u); distance = small.distanceTo(large); }), "distance",
+           { Expected(UIntProbe::SERIAL, 2), Expected(UIntProbe::DISTANCE_CLAMPED, 1),
+             Expected(UIntProbe::ADD, 1), Expected(UIntProbe::ADD_UINT, 1) });
+    check(distance == -0x7fffffff - 1, "distance result");
+
+    // shifts, bitwise operators, comparisons and other widths are not counted
+    expect(measure([&] { sink = (large << 3) ^ (small >> 1) ^ (~large & small); before = (large < small); }), "uncounted",
+           {});
+    expect(measure([&] { UInt<64> wide(0xffffffff, 0xffffffff); wide += UInt<64>(0, 1); before = (wide == UInt<64>()); }), "uint64",
+           {});
+}
+
+void checkMixed()
+{
+    volatile unsigned int three(3);
+    const U33 large(1, three);
+    U33 sink;
+
+    // each operator / operand type pair has its own bucket
+    expect(measure([&] { sink = large + 1u; }), "add_uint",
+           { Expected(UIntProbe::ADD_UINT, 1), Expected(UIntProbe::ADD, 1) });
+    expect(measure([&] { sink = large + 1; }), "add_int",
+           { Expected(UIntProbe::ADD_INT, 1), Expected(UIntProbe::ADD, 1) });
+    expect(measure([&] { sink = large - 1u; }), "sub_uint",
+           { Expected(UIntProbe::SUB_UINT, 1), Expected(UIntProbe::SUB, 1) });
+    expect(measure([&] { sink = large - 1; }), "sub_int",
+           { Expected(UIntProbe::SUB_INT, 1), Expected(UIntProbe::SUB, 1) });
+    expect(measure([&] { sink = large * 3u; }), "mul_uint",
+           { Expected(UIntProbe::MUL_UINT, 1), Expected(UIntProbe::MUL, 1) });
+    expect(measure([&] { sink = large / 3u; }), "divide_uint",
+           { Expected(UIntProbe::DIVIDE_UINT, 1), Expected(UIntProbe::DIVIDE, 1) });
+    expect(measure([&] { sink = large % 3u; }), "modulo_uint",
+           { Expected(UIntProbe::MODULO_UINT, 1), Expected(UIntProbe::DIVIDE, 1) });
+
+    // together, a different number of each, none leaking into another
+    expect(measure([&]
+    {
+        sink = large + 1u;
+        for (unsigned int i = 0; i < 2; ++i) sink = large + 1;
+        for (unsigned int i = 0; i < 3; ++i) sink = large - 1u;
+        for (unsigned int i = 0; i < 4; ++i) sink = large - 1;
+        for (unsigned int i = 0; i < 5; ++i) sink = large * 3u;
+        for (unsigned int i = 0; i < 6; ++i) sink = large / 3u;
+        for (unsigned int i = 0; i < 7; ++i) sink = large % 3u;
+    }), "mixed buckets",
+           { Expected(UIntProbe::ADD_UINT, 1), Expected(UIntProbe::ADD_INT, 2),
+             Expected(UIntProbe::SUB_UINT, 3), Expected(UIntProbe::SUB_INT, 4),
+             Expected(UIntProbe::MUL_UINT, 5), Expected(UIntProbe::DIVIDE_UINT, 6),
+             Expected(UIntProbe::MODULO_UINT, 7),
+             Expected(UIntProbe::ADD, 3), Expected(UIntProbe::SUB, 7),
+             Expected(UIntProbe::MUL, 5), Expected(UIntProbe::DIVIDE, 13) });
+}
+
+void checkThreads()
+{
+    UIntCounters::reset();
+
+    // finished threads fold their counts into the retired sums
+    vector<thread> threads;
+
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        threads.push_back(thread([]
+        {
+            U33 value;
+            for (unsigned int j = 0; j < 1000; ++j)
+            {
+                value += U33(0, j);
+            }
+        }));
+    }
+
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        threads[i].join();
+    }
+
+    expect(UIntCounters::snapshot(), "finished threads",
+           { Expected(UIntProbe::ADD, 4000) });
+
+    // a running thread's counts are read in place
+    mutex lock;
+    condition_variable changed;
+    bool counted(false);
+    bool done(false);
+
+    thread running([&]
+    {
+        U33 value(MAX);
+        for (unsigned int j = 0; j < 500; ++j)
+        {
+            value -= U33(0, 1);
+        }
+
+        unique_lock<mutex> guard(lock);
+        counted = true;
+        changed.notify_all();
+        changed.wait(guard, [&] { return done; });
+    });
+
+    {
+        unique_lock<mutex> guard(lock);
+        changed.wait(guard, [&] { return counted; });
+    }
+
+    expect(UIntCounters::snapshot(), "running thread",
+           { Expected(UIntProbe::ADD, 4000), Expected(UIntProbe::SUB, 500) });
+
+    // a reset while the thread runs zeroes its counts too
+    UIntCounters::reset();
+    expect(UIntCounters::snapshot(), "reset", {});
+
+    {
+        lock_guard<mutex> guard(lock);
+        done = true;
+        changed.notify_all();
+    }
+
+    running.join();
+    expect(UIntCounters::snapshot(), "joined after reset", {});
+}
+
+void checkOutput()
+{
+    const U33 one(0, 1);
+    const UIntCounters counters = measure([&] { U33 sum = one + one; sum -= one; sum = sum - one; sum = sum - one; });
+
+    const string text = counters.toText();
+    const string json = counters.toJson();
+    const string add = UIntProbe::ENABLED ? "1" : "0";
+    const string sub = UIntProbe::ENABLED ? "3" : "0";
+
+    check(text.find("add                                    " + add + "\n") == 0, "text first line");
+    check(text.find("\nsub                                    " + sub + "\n") != string::npos, "text sub");
+    check(text.find("\ndistance_clamped                       0\n") != string::npos, "text last line");
+    check(json.find("{\n  \"add\": " + add + ",\n  \"sub\": " + sub + ",\n") == 0, "json start");
+    check(json.find(",\n  \"sub_underflow\": " + string(UIntProbe::ENABLED ? "1" : "0") + ",\n") != string::npos, "json underflow");
+    check(json.find("\n  \"distance_clamped\": 0\n}\n") != string::npos, "json end");
+}
+
+int main()
+{
+    cout << "Instrumentation " << (UIntProbe::ENABLED ? "on" : "off") << endl;
+
+    checkOperators();
+    checkMixed();
+    checkThreads();
+    checkOutput();
+
+    cout << "Sweet success!" << endl;
+    return 0;
+}
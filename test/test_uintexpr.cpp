@@ -0,0 +1,126 @@
+//------------------------------------------------------------------------------
+//
+// Filename: test_uintexpr.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <iostream>
+#include <stdexcept>
+#include "UIntExpr.h"
+
+typedef unsigned long long U64;
+
+using namespace std;
+
+static U64 sState(0x9e3779b97f4a7c15ULL);
+
+U64 random64()
+{
+    // xorshift
+    sState ^= sState << 13;
+    sState ^= sState >> 7;
+    sState ^= sState << 17;
+    return sState;
+}
+
+template <typename T>
+T randomValue()
+{
+    const U64 value = random64();
+    return T(static_cast<unsigned int>(value >> 32), static_cast<unsigned int>(value));
+}
+
+template <typename T>
+void check(bool success, const char* what, const T& value)
+{
+    if (!success)
+    {
+        cout << "FAILURE " << what << " (" << T::BITS << " bits) " << value << endl;
+        throw std::logic_error("Test failure");
+    }
+}
+
+// chains are constexpr and fold to the left to right result
+static constexpr U33 PTS(1, 0xfffff000);
+static constexpr U33 FUSED = U33Expr(PTS) + U33(0, 0x2000) - U33(1, 0x10) + 5 - 3u;
+static_assert(FUSED == PTS + U33(0, 0x2000) - U33(1, 0x10) + 5 - 3u, "constexpr chain");
+
+template <typename T>
+void checkChains()
+{
+    typedef UIntExpr<T::BITS, typename T::LayoutType> Expr;
+
+    for (unsigned int i = 0; i < 100000; ++i)
+    {
+        const T a = randomValue<T>();
+        const T b = randomValue<T>();
+        const T c = randomValue<T>();
+        const T d = randomValue<T>();
+        const int n = static_cast<int>(random64());
+        const unsigned int u = static_cast<unsigned int>(random64());
+
+        check<T>(T(Expr(a)) == a, "single term", a);
+        check<T>(T(Expr(a) + b) == (a + b), "a + b", a);
+        check<T>(T(Expr(a) - b) == (a - b), "a - b", a);
+        check<T>(T(Expr(a) + b - c + d) == (a + b - c + d), "a + b - c + d", a);
+        check<T>(T(Expr(a) - b - c - d) == (a - b - c - d), "a - b - c - d", a);
+        check<T>(T(Expr(a) + n - u + b) == (a + n - u + b), "int / unsigned terms", a);
+        check<T>(T(Expr(a) - n + u - b) == (a - n + u - b), "negated int / unsigned terms", a);
+        check<T>(T(Expr(a) - (Expr(b) + c - d)) == (a - (b + c - d)), "nested chain", a);
+        check<T>((Expr(a) + b - c).value() == (a + b - c), "value()", a);
+    }
+
+    // terms are held by value, the chain outlives them
+    const T base = randomValue<T>();
+    const auto chain = Expr(base) + T(0, 1) - T(0, 2);
+    check<T>(T(chain) == (base + T(0, 1) - T(0, 2)), "stored chain", base);
+
+    // a long run of wrapping terms
+    const T max = ~T();
+    T expected(base);
+    T fused = Expr(base) + max + max + max + max + max + max + max + max - max - max + 1 - 0x7fffffff;
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        expected = expected + max;
+    }
+    expected = expected - max - max + 1 - 0x7fffffff;
+    check<T>(fused == expected, "wrapping run", fused);
+}
+
+int main()
+{
+    checkChains< UInt<8> >();
+    checkChains< UInt<32> >();
+    checkChains< UInt<33> >();
+    checkChains< UInt<42> >();
+    checkChains< UInt<64> >();
+    checkChains< UInt<33, UIntSplit16Layout<33> > >();
+    checkChains< UInt<33, UIntSplit32Layout<33> > >();
+    checkChains< UInt<33, UIntNative64Layout<33> > >();
+    checkChains< UInt<47, UIntSplit16Layout<47> > >();
+    checkChains< UInt<64, UIntNative64Layout<64> > >();
+
+    cout << "Sweet success!" << endl;
+
+    return 0;
+}
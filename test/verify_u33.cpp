@@ -0,0 +1,401 @@
+//------------------------------------------------------------------------------
+//
+// Filename: verify_u33.cpp
+// Author:   Ed FitzGerald
+//
+// Copyright (c) 2012 Ed FitzGerald
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "U33.h"
+
+/// Differential checker: every U33 operator against the same operation on a
+/// masked 64 bit integer, over boundary sweeps, random pairs and a full sweep
+/// of the left operand, spread across every core.
+///
+/// Usage: verify_u33 [--quick] [--threads N] [--random N] [--seed N]
+
+typedef unsigned long long U64;
+
+using namespace std;
+
+static const U64 MASK33 = 0x1ffffffffULL;
+static const U64 HALF33 = 0x100000000ULL;
+
+/// Cases are handed to the threads in chunks of this size
+static const U64 CHUNK = 1 << 14;
+
+/// The exhaustive sweep checks full division on one left operand in this many
+static const U64 DIVISION_STRIDE = 61;
+
+struct Options
+{
+    bool mQuick;
+    unsigned int mThreads;
+    U64 mRandom;
+    U64 mSeed;
+};
+
+struct Failure
+{
+    mutex mLock;
+    atomic<bool> mFailed;
+    string mWhat;
+    U64 mA;
+    U64 mB;
+};
+
+static Failure sFailure;
+
+//------------------------------------------------------------------------------
+// Conversion
+//------------------------------------------------------------------------------
+U33 convert(U64 ref)
+{
+    return U33(static_cast<unsigned int>(ref >> 32) & 1,
+               static_cast<unsigned int>(ref & 0xffffffff));
+}
+
+U64 convert(const U33& ref)
+{
+    return (static_cast<U64>(ref.getUpper()) << 32) | ref.getLsb32();
+}
+
+U64 mix(U64 value)
+{
+    // splitmix64, so any case can be generated from its index alone
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+//------------------------------------------------------------------------------
+// The reference check
+//------------------------------------------------------------------------------
+const char* checkPair(U64 a, U64 b, bool division)
+{
+    const U33 a33 = convert(a);
+    const U33 b33 = convert(b);
+
+    if (convert(a33) != a)                                  return "round trip";
+    if (convert(a33 + b33) != ((a + b) & MASK33))           return "operator+";
+    if (convert(a33 - b33) != ((a - b) & MASK33))           return "operator-";
+    if (convert(a33 * b33) != ((a * b) & MASK33))           return "operator*";
+
+    bool carry(true), borrow(true);
+    if ((convert(a33.addCarry(b33, carry)) != ((a + b + 1) & MASK33)) ||
+        (carry != ((a + b + 1) > MASK33)))                  return "addCarry";
+    if ((convert(a33.subBorrow(b33, borrow)) != ((a - b - 1) & MASK33)) ||
+        (borrow != (a <= b)))                               return "subBorrow";
+    if ((convert(a33.addSaturate(b33)) != min(a + b, MASK33)) ||
+        (convert(a33.subSaturate(b33)) != ((a > b) ? (a - b) : 0)))
+                                                            return "saturate";
+
+    if ((convert(a33 & b33) != (a & b)) ||
+        (convert(a33 | b33) != (a | b)) ||
+        (convert(a33 ^ b33) != (a ^ b)) ||
+        (convert(~a33) != (~a & MASK33)))                   return "bitwise";
+
+    const unsigned int shift = static_cast<unsigned int>(b % 35);
+    const U64 left  = (shift >= 33) ? 0 : ((a << shift) & MASK33);
+    const U64 right = (shift >= 33) ? 0 : (a >> shift);
+    if (convert(a33 << shift) != left)                      return "operator<<";
+    if (convert(a33 >> shift) != right)                     return "operator>>";
+
+    if (((a33 == b33) != (a == b)) ||
+        ((a33 != b33) != (a != b)) ||
+        ((a33 <  b33) != (a <  b)) ||
+        ((a33 <= b33) != (a <= b)) ||
+        ((a33 >  b33) != (a >  b)) ||
+        ((a33 >= b33) != (a >= b)))                         return "comparison";
+
+    const U64 ahead = (b - a) & MASK33;
+    const long long signedAhead = static_cast<long long>(ahead << 31) >> 31;
+    const long long distance = max(min(signedAhead, 0x7fffffffLL), -0x80000000LL);
+    if ((a33.isBefore(b33) != ((ahead != 0) && (ahead < HALF33))) ||
+        (a33.isAfter(b33) != (ahead > HALF33)) ||
+        (a33.distanceTo(b33) != distance))                  return "serial";
+
+    const int i = static_cast<int>(static_cast<unsigned int>(b));
+    const U64 i64 = static_cast<U64>(static_cast<long long>(i));
+    if ((convert(a33 + i) != ((a + i64) & MASK33)) ||
+        (convert(a33 - i) != ((a - i64) & MASK33)))         return "mixed int";
+
+    const unsigned int u = static_cast<unsigned int>(b);
+    if ((convert(a33 + u) != ((a + u) & MASK33)) ||
+        (convert(a33 - u) != ((a - u) & MASK33)))           return "mixed unsigned";
+
+    U33 changed(a33);
+    changed += b33;
+    changed *= a33;
+    changed -= b33;
+    changed ^= a33;
+    if (convert(changed) != (((((a + b) * a) - b) ^ a) & MASK33))
+                                                            return "changers";
+
+    if ((a33.getMsb() != ((a >> 32) != 0)) ||
+        (a33.getLsb() != ((a & 1) != 0)) ||
+        (a33.getMsb32() != static_cast<unsigned int>(a >> 1)) ||
+        (a33.getLsb32() != static_cast<unsigned int>(a)))   return "getters";
+
+    if ((convert(a33.divideBy<90000>()) != (a / 90000)) ||
+        (convert(a33.remainderBy<90000>()) != (a % 90000)) ||
+        (convert(a33.divideBy<1001>()) != (a / 1001)) ||
+        (convert(a33.divideBy<3>()) != (a / 3)))            return "divideBy";
+
+    if (division)
+    {
+        const U64 quotient  = b ? (a / b) : MASK33;
+        const U64 remainder = b ? (a % b) : a;
+        if (convert(a33 / b33) != quotient)                 return "operator/";
+        if (convert(a33 % b33) != remainder)                return "operator%";
+        if ((convert(a33 / u) != (u ? (a / u) : MASK33)) ||
+            (convert(a33 % u) != (u ? (a % u) : a)))        return "operator/ unsigned";
+    }
+
+    return 0;
+}
+
+void fail(const char* what, U64 a, U64 b)
+{
+    lock_guard<mutex> lock(sFailure.mLock);
+
+    if (!sFailure.mFailed.load())
+    {
+        sFailure.mWhat = what;
+        sFailure.mA = a;
+        sFailure.mB = b;
+        sFailure.mFailed.store(true);
+    }
+}
+
+//------------------------------------------------------------------------------
+// The parallel runner
+//------------------------------------------------------------------------------
+template <typename Generator>
+void runPhase(const Options& options, const char* name, U64 total, Generator generator)
+{
+    atomic<U64> next(0);
+
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    auto worker = [&]()
+    {
+        for (;;)
+        {
+            const U64 first = next.fetch_add(CHUNK);
+            if ((first >= total) || sFailure.mFailed.load(memory_order_relaxed))
+                return;
+
+            const U64 last = min(first + CHUNK, total);
+            for (U64 index = first; index < last; ++index)
+            {
+                U64 a(0), b(0);
+                const bool division = generator(index, a, b);
+
+                const char* what = checkPair(a & MASK33, b & MASK33, division);
+                if (what)
+                {
+                    fail(what, a & MASK33, b & MASK33);
+                    return;
+                }
+            }
+        }
+    };
+
+    vector<thread> threads;
+    for (unsigned int t = 1; t < options.mThreads; ++t)
+        threads.push_back(thread(worker));
+    worker();
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << left << setw(12) << name << right
+         << setw(16) << total << " cases "
+         << fixed << setprecision(2) << setw(9) << seconds << " s "
+         << setprecision(0) << setw(14) << (total / max(seconds, 1e-9)) << " cases/s" << endl;
+}
+
+//------------------------------------------------------------------------------
+// The phases
+//------------------------------------------------------------------------------
+vector<U64> makeBoundaries(bool quick)
+{
+    // every carry / borrow edge of the 17 / 16 split, the 32 bit words and the wrap
+    const U64 edges[] = { 0x0, 0x8000, 0x10000, 0x18000, 0x20000, 0x7fffffff, 0x80000000,
+                          0xffffffff, 0x100000000ULL, 0x100010000ULL, 0x17fffffffULL,
+                          0x180000000ULL, 0x1fffe0000ULL, 0x1ffff0000ULL, 0x1ffffffffULL };
+    const int reach = quick ? 2 : 16;
+
+    vector<U64> values;
+    for (size_t e = 0; e < sizeof(edges) / sizeof(edges[0]); ++e)
+        for (int k = -reach; k <= reach; ++k)
+            values.push_back((edges[e] + static_cast<U64>(static_cast<long long>(k))) & MASK33);
+
+    sort(values.begin(), values.end());
+    values.erase(unique(values.begin(), values.end()), values.end());
+
+    return values;
+}
+
+void boundarySweep(const Options& options)
+{
+    const vector<U64> values = makeBoundaries(options.mQuick);
+    const U64 count = values.size();
+
+    runPhase(options, "boundary", count * count,
+             [&values, count](U64 index, U64& a, U64& b)
+             {
+                 a = values[index / count];
+                 b = values[index % count];
+                 return true;
+             });
+}
+
+void randomSweep(const Options& options)
+{
+    const U64 seed = options.mSeed;
+
+    runPhase(options, "random", options.mRandom,
+             [seed](U64 index, U64& a, U64& b)
+             {
+                 const U64 r = mix(seed ^ (index * 2));
+                 const U64 s = mix(seed ^ (index * 2 + 1));
+
+                 // half the pairs close together, where the serial edges live
+                 a = r;
+                 b = (s & 1) ? s : (r + (s >> 48) - 0x8000);
+                 return true;
+             });
+}
+
+void exhaustiveSweep(const Options& options)
+{
+    // every left operand against a few partners, or windows around the edges
+    const U64 partners[] = { 0x0, 0x1, 0x10000, 0xffffffff, 0x100000000ULL, 0x1ffffffffULL };
+    const U64 partnerCount = sizeof(partners) / sizeof(partners[0]);
+
+    const U64 window = 1 << 14;
+    const U64 windows[] = { 0x0, 0x100000000ULL - window / 2, 0x200000000ULL - window };
+    const U64 span = options.mQuick ? (3 * window) : (MASK33 + 1);
+    const bool quick = options.mQuick;
+
+    runPhase(options, "exhaustive", span * partnerCount,
+             [&partners, &windows, partnerCount, window, quick](U64 index, U64& a, U64& b)
+             {
+                 const U64 offset = index / partnerCount;
+                 a = quick ? (windows[offset / window] + (offset % window)) : offset;
+                 b = partners[index % partnerCount];
+                 return ((offset % DIVISION_STRIDE) == 0);
+             });
+}
+
+bool parse(int argc, char** argv, Options& options)
+{
+    options.mQuick   = false;
+    options.mThreads = max(thread::hardware_concurrency(), 1u);
+    options.mRandom  = 0;
+    options.mSeed    = 0x5eed;
+
+    for (int arg = 1; arg < argc; ++arg)
+    {
+        if (strcmp(argv[arg], "--quick") == 0)
+        {
+            options.mQuick = true;
+            continue;
+        }
+
+        if ((arg + 1) >= argc)
+            return false;
+
+        istringstream iss(argv[arg + 1]);
+        U64 value(0);
+        if (!(iss >> value))
+            return false;
+
+        if (strcmp(argv[arg], "--threads") == 0)
+            options.mThreads = max(static_cast<unsigned int>(value), 1u);
+        else if (strcmp(argv[arg], "--random") == 0)
+            options.mRandom = value;
+        else if (strcmp(argv[arg], "--seed") == 0)
+            options.mSeed = value;
+        else
+            return false;
+
+        ++arg;
+    }
+
+    if (options.mRandom == 0)
+        options.mRandom = options.mQuick ? 20000 : 100000000;
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse(argc, argv, options))
+    {
+        cerr << "Usage: " << argv[0] << " [--quick] [--threads N] [--random N] [--seed N]" << endl;
+        return 1;
+    }
+
+    cout << "Threads: " << options.mThreads << (options.mQuick ? " (quick)" : "") << endl;
+
+    sFailure.mFailed.store(false);
+
+    boundarySweep(options);
+    if (!sFailure.mFailed.load())
+        randomSweep(options);
+    if (!sFailure.mFailed.load())
+        exhaustiveSweep(options);
+
+    if (sFailure.mFailed.load())
+    {
+        cout << "==============================================================" << endl;
+        cout << "FAILURE " << sFailure.mWhat << endl;
+        cout << "==============================================================" << endl;
+        cout << "a              : 0x" << hex << sFailure.mA << endl;
+        cout << "b              : 0x" << hex << sFailure.mB << endl;
+        cout << "a33            : " << convert(sFailure.mA) << endl;
+        cout << "b33            : " << convert(sFailure.mB) << endl;
+        cout << "==============================================================" << endl << endl;
+
+        return 1;
+    }
+
+    cout << "Sweet success!" << endl;
+
+    return 0;
+}